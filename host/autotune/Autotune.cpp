@@ -0,0 +1,488 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include <array>
+#include <cmath>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+#include <esp_log.h>
+
+#include "Random.hpp"
+#include "Accelerator.hpp"
+#include "EtcController.hpp"
+#include "WorkStealingPool.hpp"
+#include "adc/AdcFrameReduction.hpp"
+#include "board/Gpio.hpp"
+#include "clock/VirtualClock.hpp"
+#include "filter/AdaptiveFilter.hpp"
+#include "runtime/Mailbox.hpp"
+#include "stepper/MotorBridge.hpp"
+#include "stepper/MotorController.hpp"
+
+// Motor set up as in main.cpp
+constexpr uint32_t const motorMinimalSpeed = 500;
+constexpr uint32_t const motorMaximalSpeed = 4000;
+constexpr uint32_t const motorMaximalSteps = 500;
+
+// The control nodes run once per tick, the motion nodes in between at these periods
+constexpr uint32_t const controlPeriod_InUS = 1000;
+constexpr uint32_t const motorPeriod_InUS = 20;
+constexpr uint32_t const bridgePeriod_InUS = 100;
+
+constexpr uint32_t const frameSize_InResults = 64;
+constexpr uint32_t const frameSize_InBytes = frameSize_InResults * adcResultSize_InBytes;
+
+// Pedal travel the Accelerator assumes without a stored calibration, and the full scale of the host ADC conversion
+constexpr uint32_t const pedalMinimalVoltage_InMillivolts = 1000;
+constexpr uint32_t const pedalMaximalVoltage_InMillivolts = 2500;
+constexpr uint32_t const adcFullScale_InMillivolts = 3100;
+
+// Every scenario is ridden in gear, clutch engaged, away from the idle and rev limits
+constexpr uint32_t const vehicleRevolutions_InRPM = 4000;
+constexpr uint32_t const vehicleSpeed_InKilometersPerHour = 60;
+
+constexpr uint32_t const defaultNumberOfCandidates = 1000;
+constexpr uint32_t const defaultNumberOfScenarios = 4;
+constexpr uint32_t const defaultScenarioDuration_InMS = 5000;
+constexpr uint32_t const defaultNoise_InMillivolts = 6;
+constexpr uint32_t const defaultNumberOfRanked = 10;
+
+namespace {
+
+struct ParameterRange {
+  float minimal;
+  float maximal;
+};
+
+// The default motion limits cap the motor at 1500 steps/s and 30000 steps/s^2, there is nothing to gain above
+constexpr ParameterRange const speedRange = {motorMinimalSpeed, 1500};
+constexpr ParameterRange const accelerationRange = {2000, 30000};
+constexpr ParameterRange const decelerationRange = {2000, 30000};
+constexpr ParameterRange const filterMinCutoffRange = {200, 3000};
+constexpr ParameterRange const filterBetaRange = {0, 100};
+
+enum Cost {
+  COST_TRACKING = 0,
+  COST_OVERSHOOT,
+  COST_STEPS,
+  COST_ENERGY,
+  COST_COUNT
+};
+
+using Costs = std::array<double, COST_COUNT>;
+
+constexpr std::array<char const *, ridingProfileCount> const ridingProfileNames = {"soft", "road", "sport"};
+
+struct Scenario {
+  // Noise free pedal the rider asked for, one value per tick
+  std::vector<uint8_t> pedal_InPercentage;
+
+  // What the ADC delivered for it, one frame per tick back to back
+  std::vector<uint8_t> frames;
+};
+
+struct Candidate {
+  uint32_t index;
+  RidingProfile profile;
+  Costs costs;
+  double score;
+};
+
+struct Options {
+  uint32_t numberOfCandidates = defaultNumberOfCandidates;
+  uint32_t numberOfScenarios = defaultNumberOfScenarios;
+  uint32_t scenarioDuration_InMS = defaultScenarioDuration_InMS;
+  uint32_t noise_InMillivolts = defaultNoise_InMillivolts;
+  uint32_t numberOfRanked = defaultNumberOfRanked;
+  uint32_t numberOfThreads = std::max(1U, std::thread::hardware_concurrency());
+  uint64_t seed = 1;
+  Costs weights = {1, 1, 1, 1};
+};
+
+void printUsage(char const *programName) {
+  std::fprintf(stderr, "Usage: %s [--candidates <n>] [--scenarios <n>] [--duration <ms>] [--noise <mv>] [--seed <n>] [--threads <n>] [--top <n>] [--weights <tracking>:<overshoot>:<steps>:<energy>]\n", programName);
+  std::fprintf(stderr, "Simulates Accelerator, EtcController, MotorBridge and MotorController for sampled riding profiles on seeded pedal scenarios.\n");
+  std::fprintf(stderr, "Candidates 0..2 are the soft, road and sport profiles as shipped. The output is the same for a seed on any number of threads.\n");
+}
+
+bool parseOptions(int const argc, char *argv[], Options &options) {
+  for (int i = 1; i < argc; ++i) {
+    if (i + 1 >= argc) {
+      return false;
+    }
+
+    auto const *const value = argv[i + 1];
+    auto const *const option = argv[i++];
+
+    if (std::strcmp(option, "--weights") == 0) {
+      if (std::sscanf(value, "%lf:%lf:%lf:%lf", &options.weights[COST_TRACKING], &options.weights[COST_OVERSHOOT], &options.weights[COST_STEPS], &options.weights[COST_ENERGY]) != COST_COUNT) {
+        return false;
+      }
+      continue;
+    }
+
+    char *end = nullptr;
+    auto const number = std::strtoull(value, &end, 10);
+    if (end == value or *end != '\0') {
+      return false;
+    }
+
+    if (std::strcmp(option, "--candidates") == 0 and number >= ridingProfileCount) {
+      options.numberOfCandidates = static_cast<uint32_t>(number);
+    } else if (std::strcmp(option, "--scenarios") == 0 and number > 0) {
+      options.numberOfScenarios = static_cast<uint32_t>(number);
+    } else if (std::strcmp(option, "--duration") == 0 and number > 0) {
+      options.scenarioDuration_InMS = static_cast<uint32_t>(number);
+    } else if (std::strcmp(option, "--noise") == 0) {
+      options.noise_InMillivolts = static_cast<uint32_t>(number);
+    } else if (std::strcmp(option, "--seed") == 0) {
+      options.seed = number;
+    } else if (std::strcmp(option, "--threads") == 0 and number > 0) {
+      options.numberOfThreads = static_cast<uint32_t>(number);
+    } else if (std::strcmp(option, "--top") == 0) {
+      options.numberOfRanked = static_cast<uint32_t>(number);
+    } else {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/**
+ * Holds, steps and ramps between random openings, a third of the moves close the pedal completely
+ */
+Scenario makeScenario(uint64_t const seed, Options const &options) {
+  Random random(seed);
+
+  std::vector<double> pedal_InPercentage;
+  pedal_InPercentage.reserve(options.scenarioDuration_InMS);
+
+  double currentPedal_InPercentage = 0;
+  while (pedal_InPercentage.size() < options.scenarioDuration_InMS) {
+    auto const holdTime_InMS = static_cast<uint32_t>(random.uniform(100, 600));
+    pedal_InPercentage.insert(pedal_InPercentage.end(), holdTime_InMS, currentPedal_InPercentage);
+
+    auto const targetPedal_InPercentage = random.uniform() < 0.3 ? 0.0 : random.uniform(0, 100);
+    auto const rampTime_InMS = random.uniform() < 0.4 ? 1 : static_cast<uint32_t>(random.uniform(30, 400));
+
+    for (uint32_t i = 1; i <= rampTime_InMS; ++i) {
+      pedal_InPercentage.push_back(currentPedal_InPercentage + (targetPedal_InPercentage - currentPedal_InPercentage) * i / rampTime_InMS);
+    }
+
+    currentPedal_InPercentage = targetPedal_InPercentage;
+  }
+  pedal_InPercentage.resize(options.scenarioDuration_InMS);
+
+  Scenario scenario;
+  scenario.pedal_InPercentage.reserve(pedal_InPercentage.size());
+  scenario.frames.resize(pedal_InPercentage.size() * frameSize_InBytes);
+
+  for (std::size_t tick = 0; tick < pedal_InPercentage.size(); ++tick) {
+    scenario.pedal_InPercentage.push_back(static_cast<uint8_t>(std::lround(pedal_InPercentage[tick])));
+
+    auto const voltage_InMillivolts = pedalMinimalVoltage_InMillivolts + pedal_InPercentage[tick] * (pedalMaximalVoltage_InMillivolts - pedalMinimalVoltage_InMillivolts) / 100;
+
+    for (uint32_t i = 0; i < frameSize_InResults; ++i) {
+      auto const noisyVoltage_InMillivolts = voltage_InMillivolts + options.noise_InMillivolts * random.normal();
+      auto const rawData = std::clamp<long>(std::lround(noisyVoltage_InMillivolts * adcResultDataMask / adcFullScale_InMillivolts), 0, adcResultDataMask);
+
+      // Channel bits above the data field like on the target
+      uint32_t const word = (3 << 13) | static_cast<uint32_t>(rawData);
+      std::memcpy(&scenario.frames[(tick * frameSize_InResults + i) * adcResultSize_InBytes], &word, sizeof(word));
+    }
+  }
+
+  return scenario;
+}
+
+RidingProfile sampleProfile(uint64_t const seed) {
+  Random random(seed);
+
+  auto profile = defaultRidingProfile;
+  profile.motorSpeed_InStepsPerSecond = static_cast<float>(random.uniform(speedRange.minimal, speedRange.maximal));
+  profile.motorAcceleration_InStepsPerSecondPerSecond = static_cast<float>(random.uniform(accelerationRange.minimal, accelerationRange.maximal));
+  profile.motorDeceleration_InStepsPerSecondPerSecond = static_cast<float>(random.uniform(decelerationRange.minimal, decelerationRange.maximal));
+  profile.filterMinCutoff_InMilliHertz = static_cast<uint32_t>(random.uniform(filterMinCutoffRange.minimal, filterMinCutoffRange.maximal));
+  profile.filterBeta = static_cast<uint32_t>(random.uniform(filterBetaRange.minimal, filterBetaRange.maximal));
+
+  return profile;
+}
+
+/**
+ * Costs of one profile on one scenario.
+ * The reference is what EtcController commands for the noise free pedal, so the costs only see filter and motor.
+ * Tracking is the RMS distance to it and overshoot the furthest the motor ran past it, both in fine steps.
+ * Steps is the fine step travel, energy the kinetic energy moved in and out of the rotor in (steps/ms)^2 / 2.
+ */
+Costs simulate(RidingProfile const &profile, Scenario const &scenario) {
+  auto clock = std::make_shared<VirtualClock>();
+  motor::host::setTimeFunction([clock]() {
+    return clock->getTime_InUS();
+  });
+
+  auto motorController = std::make_shared<MotorController>(motorMinimalSpeed, motorMaximalSpeed, motorMaximalSteps, clock);
+  motorController->setSpeed(profile.motorSpeed_InStepsPerSecond);
+  motorController->setAcceleration(profile.motorAcceleration_InStepsPerSecondPerSecond);
+  motorController->setDeceleration(profile.motorDeceleration_InStepsPerSecondPerSecond);
+  motorController->moveToHome();
+
+  auto motorSetpointMailbox = std::make_shared<Mailbox<MotorSetpoint>>();
+  auto motorStatusMailbox = std::make_shared<Mailbox<MotorStatus>>();
+  auto motorBridge = std::make_shared<MotorBridge>(motorController, motorSetpointMailbox, motorStatusMailbox, clock);
+
+  MotorSetpoint motorSetpoint = {
+      .position = 0,
+      .speed = profile.motorSpeed_InStepsPerSecond,
+      .wakeRequest = 0,
+      .sleepRequest = 0,
+      .trace = {},
+  };
+
+  auto parameters = EtcControllerParameters{};
+  parameters.profile = profile;
+
+  auto etcController = std::make_shared<EtcController>(clock);
+  auto referenceController = std::make_shared<EtcController>(clock);
+
+  int32_t referencePosition_InSteps = 0;
+  for (auto const &controller : {etcController, referenceController}) {
+    controller->setParameters(parameters);
+    controller->setVehicleRPM(vehicleRevolutions_InRPM);
+    controller->setVehicleSpeed(vehicleSpeed_InKilometersPerHour);
+  }
+
+  etcController->registerChangeValueCallback(
+      [&](uint32_t const motorPosition, TraceTag const traceTag) {
+        motorSetpoint.position = motorPosition;
+        motorSetpoint.trace = traceTag;
+        motorSetpointMailbox->write(motorSetpoint);
+      });
+  referenceController->registerChangeValueCallback(
+      [&](uint32_t const motorPosition, TraceTag) {
+        referencePosition_InSteps = static_cast<int32_t>(motorPosition * motorMaximalSteps / 100);
+      });
+
+  auto accelerator = std::make_shared<Accelerator>(1000000 / controlPeriod_InUS, frameSize_InResults, clock);
+  accelerator->setFilter(std::make_unique<AdaptiveFilter>(accelerator->getFramePeriod_InUS(), profile.filterMinCutoff_InMilliHertz, profile.filterBeta));
+  accelerator->registerChangeAccelerateCallback(
+      [&](uint32_t const acceleratorValue_InPercentage, TraceTag const traceTag) {
+        etcController->setAcceleratorValue(acceleratorValue_InPercentage, traceTag);
+      });
+
+  double squaredErrorSum = 0;
+  double maximalOvershoot_InSteps = 0;
+  double travel_InSteps = 0;
+  double energy = 0;
+
+  int32_t approachDirection = 0;
+  int32_t lastReferencePosition_InSteps = 0;
+  int32_t lastPosition_InSteps = motorController->getPosition();
+  int32_t lastVelocity_InStepsPerTick = 0;
+
+  auto const numberOfTicks = static_cast<uint32_t>(scenario.pedal_InPercentage.size());
+  for (uint32_t tick = 0; tick < numberOfTicks; ++tick) {
+    auto const time_InUS = static_cast<uint64_t>(tick) * controlPeriod_InUS;
+    clock->setTime(time_InUS);
+
+    accelerator->processFrame(&scenario.frames[tick * frameSize_InBytes], frameSize_InBytes, {tick + 1, time_InUS});
+    etcController->spinOnce();
+
+    referenceController->setAcceleratorValue(scenario.pedal_InPercentage[tick]);
+    referenceController->spinOnce();
+
+    for (uint32_t offset_InUS = 0; offset_InUS < controlPeriod_InUS; offset_InUS += motorPeriod_InUS) {
+      clock->setTime(time_InUS + offset_InUS);
+
+      if (offset_InUS % bridgePeriod_InUS == 0) {
+        motorBridge->spinOnce();
+      }
+      motorController->spinOnce();
+    }
+
+    auto const position_InSteps = motorController->getPosition();
+
+    // Overshoot is running past a new reference on the far side from where the motor started towards it
+    if (referencePosition_InSteps != lastReferencePosition_InSteps) {
+      auto const approach_InSteps = referencePosition_InSteps == lastPosition_InSteps ? referencePosition_InSteps - lastReferencePosition_InSteps : referencePosition_InSteps - lastPosition_InSteps;
+      approachDirection = approach_InSteps > 0 ? 1 : -1;
+      lastReferencePosition_InSteps = referencePosition_InSteps;
+    }
+
+    auto const error_InSteps = position_InSteps - referencePosition_InSteps;
+
+    squaredErrorSum += static_cast<double>(error_InSteps) * error_InSteps;
+    maximalOvershoot_InSteps = std::max(maximalOvershoot_InSteps, static_cast<double>(approachDirection * error_InSteps));
+
+    auto const velocity_InStepsPerTick = position_InSteps - lastPosition_InSteps;
+    travel_InSteps += std::abs(velocity_InStepsPerTick);
+    energy += std::abs(velocity_InStepsPerTick * velocity_InStepsPerTick - lastVelocity_InStepsPerTick * lastVelocity_InStepsPerTick) / 2.0;
+
+    lastPosition_InSteps = position_InSteps;
+    lastVelocity_InStepsPerTick = velocity_InStepsPerTick;
+  }
+
+  // Pin writes of the host backend pile up per thread
+  board::gpioRecordReset();
+
+  return {
+      std::sqrt(squaredErrorSum / numberOfTicks),
+      maximalOvershoot_InSteps,
+      travel_InSteps,
+      energy,
+  };
+}
+
+double median(std::vector<double> values) {
+  auto const middle = values.begin() + static_cast<std::ptrdiff_t>(values.size() / 2);
+  std::nth_element(values.begin(), middle, values.end());
+
+  return *middle;
+}
+
+/**
+ * Every cost is divided by its median over the candidates, so the weights compare like with like
+ */
+void scoreCandidates(std::vector<Candidate> &candidates, Costs const &weights) {
+  Costs scales = {};
+
+  for (uint32_t cost = 0; cost < COST_COUNT; ++cost) {
+    std::vector<double> values;
+    values.reserve(candidates.size());
+
+    for (auto const &candidate : candidates) {
+      values.push_back(candidate.costs[cost]);
+    }
+
+    auto const scale = median(std::move(values));
+    scales[cost] = scale > 0 ? scale : 1;
+  }
+
+  for (auto &candidate : candidates) {
+    candidate.score = 0;
+
+    for (uint32_t cost = 0; cost < COST_COUNT; ++cost) {
+      candidate.score += weights[cost] * candidate.costs[cost] / scales[cost];
+    }
+  }
+}
+
+void printCandidate(uint32_t const rank, Candidate const &candidate) {
+  auto const &profile = candidate.profile;
+  auto const *const name = candidate.index < ridingProfileCount ? ridingProfileNames[candidate.index] : "";
+
+  std::printf("%4u  %9u  %-5s  %5.0f  %6.0f  %6.0f  %6lu  %4lu  %8.2f  %9.1f  %7.0f  %8.0f  %6.3f\n",
+              rank,
+              candidate.index,
+              name,
+              profile.motorSpeed_InStepsPerSecond,
+              profile.motorAcceleration_InStepsPerSecondPerSecond,
+              profile.motorDeceleration_InStepsPerSecondPerSecond,
+              static_cast<unsigned long>(profile.filterMinCutoff_InMilliHertz),
+              static_cast<unsigned long>(profile.filterBeta),
+              candidate.costs[COST_TRACKING],
+              candidate.costs[COST_OVERSHOOT],
+              candidate.costs[COST_STEPS],
+              candidate.costs[COST_ENERGY],
+              candidate.score);
+}
+
+}// namespace
+
+int main(int argc, char *argv[]) {
+  Options options;
+  if (not parseOptions(argc, argv, options)) {
+    printUsage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  // Every simulation sets its filter, the group delay line would drown the table
+  esp_log_level_set("*", ESP_LOG_WARN);
+
+  // Scenarios and candidates draw from streams of their own, nothing depends on which thread runs what
+  Random seeds(options.seed);
+
+  std::vector<Scenario> scenarios;
+  for (uint32_t i = 0; i < options.numberOfScenarios; ++i) {
+    scenarios.push_back(makeScenario(seeds.next(), options));
+  }
+
+  std::vector<Candidate> candidates(options.numberOfCandidates);
+  for (uint32_t i = 0; i < options.numberOfCandidates; ++i) {
+    candidates[i].index = i;
+    candidates[i].profile = i < ridingProfileCount ? defaultRidingProfiles[i] : sampleProfile(seeds.next());
+  }
+
+  WorkStealingPool pool(options.numberOfThreads);
+  for (auto &candidate : candidates) {
+    pool.submit([&candidate, &scenarios]() {
+      candidate.costs = {};
+
+      for (auto const &scenario : scenarios) {
+        auto const costs = simulate(candidate.profile, scenario);
+
+        for (uint32_t cost = 0; cost < COST_COUNT; ++cost) {
+          candidate.costs[cost] += costs[cost] / static_cast<double>(scenarios.size());
+        }
+      }
+    });
+  }
+
+  auto const startTime = std::chrono::steady_clock::now();
+  pool.run();
+  auto const runTime_InS = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+  std::fprintf(stderr, "%u candidates x %u scenarios on %u threads in %.2f s, %lu tasks stolen\n",
+               options.numberOfCandidates,
+               options.numberOfScenarios,
+               pool.getNumberOfThreads(),
+               runTime_InS,
+               static_cast<unsigned long>(pool.getNumberOfStolenTasks()));
+
+  scoreCandidates(candidates, options.weights);
+
+  std::vector<Candidate const *> ranking;
+  for (auto const &candidate : candidates) {
+    ranking.push_back(&candidate);
+  }
+
+  std::sort(ranking.begin(), ranking.end(), [](Candidate const *left, Candidate const *right) {
+    if (left->score != right->score) {
+      return left->score < right->score;
+    }
+    return left->index < right->index;
+  });
+
+  std::printf("seed %lu, weights %g:%g:%g:%g\n", static_cast<unsigned long>(options.seed), options.weights[COST_TRACKING], options.weights[COST_OVERSHOOT], options.weights[COST_STEPS], options.weights[COST_ENERGY]);
+  std::printf("rank  candidate  name   speed   accel   decel  cutoff  beta  tracking  overshoot    steps    energy   score\n");
+
+  for (uint32_t rank = 0; rank < ranking.size(); ++rank) {
+    // The shipped profiles are always listed to compare against
+    if (rank < options.numberOfRanked or ranking[rank]->index < ridingProfileCount) {
+      printCandidate(rank + 1, *ranking[rank]);
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
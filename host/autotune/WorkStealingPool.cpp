@@ -0,0 +1,104 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include "WorkStealingPool.hpp"
+
+#include <thread>
+
+WorkStealingPool::WorkStealingPool(uint32_t const numberOfThreads) : m_numberOfThreads(numberOfThreads > 0 ? numberOfThreads : 1),
+                                                                     m_taskQueues(),
+                                                                     m_nextTaskQueue(0),
+                                                                     m_numberOfStolenTasks(0) {
+  for (uint32_t i = 0; i < m_numberOfThreads; ++i) {
+    m_taskQueues.push_back(std::make_unique<TaskQueue>());
+  }
+}
+
+uint32_t WorkStealingPool::getNumberOfThreads() const {
+  return m_numberOfThreads;
+}
+
+uint64_t WorkStealingPool::getNumberOfStolenTasks() const {
+  return m_numberOfStolenTasks.load(std::memory_order_relaxed);
+}
+
+void WorkStealingPool::submit(WorkStealingPoolTaskFunction task) {
+  auto &taskQueue = *m_taskQueues[m_nextTaskQueue];
+  m_nextTaskQueue = (m_nextTaskQueue + 1) % m_numberOfThreads;
+
+  std::lock_guard<std::mutex> const lock(taskQueue.mutex);
+  taskQueue.tasks.push_back(std::move(task));
+}
+
+void WorkStealingPool::run() {
+  std::vector<std::thread> workers;
+  workers.reserve(m_numberOfThreads - 1);
+
+  for (uint32_t i = 1; i < m_numberOfThreads; ++i) {
+    workers.emplace_back(&WorkStealingPool::work, this, i);
+  }
+
+  // The calling thread is worker 0
+  work(0);
+
+  for (auto &worker : workers) {
+    worker.join();
+  }
+}
+
+bool WorkStealingPool::takeOwnTask(uint32_t const workerIndex, WorkStealingPoolTaskFunction &task) {
+  auto &taskQueue = *m_taskQueues[workerIndex];
+
+  std::lock_guard<std::mutex> const lock(taskQueue.mutex);
+  if (taskQueue.tasks.empty()) {
+    return false;
+  }
+
+  task = std::move(taskQueue.tasks.back());
+  taskQueue.tasks.pop_back();
+
+  return true;
+}
+
+bool WorkStealingPool::stealTask(uint32_t const workerIndex, WorkStealingPoolTaskFunction &task) {
+  for (uint32_t offset = 1; offset < m_numberOfThreads; ++offset) {
+    auto &taskQueue = *m_taskQueues[(workerIndex + offset) % m_numberOfThreads];
+
+    std::lock_guard<std::mutex> const lock(taskQueue.mutex);
+    if (taskQueue.tasks.empty()) {
+      continue;
+    }
+
+    task = std::move(taskQueue.tasks.front());
+    taskQueue.tasks.pop_front();
+
+    m_numberOfStolenTasks.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  return false;
+}
+
+void WorkStealingPool::work(uint32_t const workerIndex) {
+  WorkStealingPoolTaskFunction task = nullptr;
+
+  // Tasks do not submit tasks, so once every deque is empty there is nothing left to wait for
+  while (takeOwnTask(workerIndex, task) or stealTask(workerIndex, task)) {
+    task();
+  }
+}
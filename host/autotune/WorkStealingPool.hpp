@@ -0,0 +1,71 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <mutex>
+#include <deque>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <functional>
+
+using WorkStealingPoolTaskFunction = std::function<void()>;
+
+/**
+ * Fixed set of worker threads with a task deque each.
+ * A worker takes from the back of its own deque and, once that runs dry, steals from the front of the others.
+ */
+class WorkStealingPool {
+public:
+  explicit WorkStealingPool(uint32_t numberOfThreads);
+  ~WorkStealingPool() = default;
+
+public:
+  [[nodiscard]] uint32_t getNumberOfThreads() const;
+  [[nodiscard]] uint64_t getNumberOfStolenTasks() const;
+
+public:
+  /**
+   * Tasks are dealt to the workers in turn, nothing runs before run()
+   */
+  void submit(WorkStealingPoolTaskFunction task);
+
+  /**
+   * Runs every submitted task and returns when the last one is done
+   */
+  void run();
+
+private:
+  struct TaskQueue {
+    std::mutex mutex;
+    std::deque<WorkStealingPoolTaskFunction> tasks;
+  };
+
+private:
+  bool takeOwnTask(uint32_t workerIndex, WorkStealingPoolTaskFunction &task);
+  bool stealTask(uint32_t workerIndex, WorkStealingPoolTaskFunction &task);
+  void work(uint32_t workerIndex);
+
+private:
+  uint32_t const m_numberOfThreads;
+  std::vector<std::unique_ptr<TaskQueue>> m_taskQueues;
+  uint32_t m_nextTaskQueue;
+  std::atomic<uint64_t> m_numberOfStolenTasks;
+};
@@ -0,0 +1,818 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include <new>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <algorithm>
+#include <functional>
+#include <poll.h>
+
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+#include "Pty.hpp"
+#include "Random.hpp"
+#include "TelemetryDecoder.hpp"
+#include "Accelerator.hpp"
+#include "ModeButton.hpp"
+#include "SetupButton.hpp"
+#include "EtcController.hpp"
+#include "adc/AdcFrameReduction.hpp"
+#include "board/Gpio.hpp"
+#include "clock/VirtualClock.hpp"
+#include "filter/AdaptiveFilter.hpp"
+#include "filter/BoxcarFilter.hpp"
+#include "filter/KalmanFilter.hpp"
+#include "filter/MedianFilter.hpp"
+#include "gpio/InputPin.hpp"
+#include "log/DeferredLog.hpp"
+#include "ota/OtaReceiver.hpp"
+#include "runtime/Mailbox.hpp"
+#include "runtime/RingBuffer.hpp"
+#include "stepper/MotorBridge.hpp"
+#include "stepper/MotorDriver.hpp"
+#include "stepper/MotorController.hpp"
+#include "telemetry/PosixTransport.hpp"
+#include "telemetry/TelemetryLink.hpp"
+
+// Every heap allocation of the process goes through here, a case is charged with what it allocates while timed
+std::atomic<uint64_t> numberOfAllocations(0);
+
+void *operator new(std::size_t const size) {
+  numberOfAllocations.fetch_add(1, std::memory_order_relaxed);
+
+  if (auto *const pointer = std::malloc(size == 0 ? 1 : size)) {
+    return pointer;
+  }
+
+  throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t const size) {
+  return operator new(size);
+}
+
+void operator delete(void *pointer) noexcept {
+  std::free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept {
+  std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept {
+  std::free(pointer);
+}
+
+void operator delete[](void *pointer, std::size_t) noexcept {
+  std::free(pointer);
+}
+
+namespace {
+
+constexpr uint64_t const minimalBatchTime_InNS = 50 * 1000 * 1000;
+constexpr uint32_t const numberOfRepetitions = 5;
+
+constexpr uint32_t const frameSize_InResults = 64;
+
+// Default control rate, one ADC frame per millisecond
+constexpr uint32_t const controlTicksPerSecond = 1000;
+
+// Raw results of the pedal at about 1.2 V and 2.0 V
+constexpr uint32_t const restRawData = 1600;
+constexpr uint32_t const pressedRawData = 2600;
+
+// Pedal at rest with ADC noise, one filter input per frame
+constexpr uint32_t const numberOfPedalSamples = 4096;
+constexpr int32_t const pedalRestVoltage_InMillivolts = 1000;
+constexpr double const pedalNoise_InMillivolts = 6;
+
+constexpr uint8_t const modeButton1PinNumber = 7;
+constexpr uint8_t const modeButton2PinNumber = 6;
+constexpr uint8_t const setupButtonPinNumber = 5;
+
+// One tick of ride log frames, well inside one batch
+constexpr uint32_t const telemetryPtyFramesPerTick = 16;
+constexpr std::size_t const telemetryPtyFrameSize = 240;
+
+using BenchmarkRun = std::function<void(uint64_t numberOfOperations)>;
+using BenchmarkSetUp = std::function<BenchmarkRun()>;
+
+struct Benchmark {
+  char const *name;
+  BenchmarkSetUp setUp;
+};
+
+struct BenchmarkResult {
+  std::string name;
+  double nanosecondsPerOperation;
+  double cyclesPerOperation;
+  double allocationsPerOperation;
+  uint64_t numberOfOperations;
+};
+
+// Keeps the optimizer from dropping results nobody reads
+volatile uint32_t sink = 0;
+
+std::array<uint8_t, frameSize_InResults * adcResultSize_InBytes> makeFrame(uint32_t const rawData) {
+  std::array<uint8_t, frameSize_InResults * adcResultSize_InBytes> frame = {};
+
+  for (uint32_t i = 0; i < frameSize_InResults; ++i) {
+    // Channel bits above the data field, the reduction has to mask them away
+    uint32_t const word = (3 << 13) | ((rawData + i % 4) & adcResultDataMask);
+    std::memcpy(frame.data() + i * adcResultSize_InBytes, &word, sizeof(word));
+  }
+
+  return frame;
+}
+
+using AdcReduction = AdcFrameSum (*)(uint8_t const *frame, uint32_t sizeInBytes);
+
+struct AdcBenchmarkFrame {
+  alignas(16) std::array<uint8_t, adcMaximalFrameSize_InBytes> data;
+};
+
+/**
+ * One frame per operation, cycles/op is the cost of reducing a frame of that many results
+ */
+BenchmarkRun adcReduceFrameRun(AdcReduction const reduction, uint32_t const numberOfResults) {
+  auto frame = std::make_shared<AdcBenchmarkFrame>();
+
+  for (uint32_t i = 0; i < numberOfResults; ++i) {
+    uint32_t const word = (3 << 13) | ((restRawData + i % 4) & adcResultDataMask);
+    std::memcpy(frame->data.data() + i * adcResultSize_InBytes, &word, sizeof(word));
+  }
+
+  return [frame, reduction, numberOfResults](uint64_t const numberOfOperations) {
+    for (uint64_t i = 0; i < numberOfOperations; ++i) {
+      auto const frameSum = reduction(frame->data.data(), numberOfResults * adcResultSize_InBytes);
+      sink = sink + frameSum.sum;
+    }
+  };
+}
+
+BenchmarkRun adcReduceFrameSetUp() {
+  return adcReduceFrameRun(adcReduceFrame, frameSize_InResults);
+}
+
+BenchmarkRun adcReduceFramePortableSetUp() {
+  return adcReduceFrameRun(adcReduceFramePortable, frameSize_InResults);
+}
+
+BenchmarkRun adcReduceLargestFrameSetUp() {
+  return adcReduceFrameRun(adcReduceFrame, adcMaximalOversamplingRatio);
+}
+
+BenchmarkRun adcReduceLargestFramePortableSetUp() {
+  return adcReduceFrameRun(adcReduceFramePortable, adcMaximalOversamplingRatio);
+}
+
+BenchmarkRun acceleratorProcessFrameSetUp() {
+  auto accelerator = std::make_shared<Accelerator>();
+  accelerator->registerChangeAccelerateCallback([](uint32_t const value, TraceTag) {
+    sink = sink + value;
+  });
+
+  // Alternating frames move the pedal past the threshold every time, so the conversion and callback always run
+  auto frames = std::make_shared<std::array<std::array<uint8_t, frameSize_InResults * adcResultSize_InBytes>, 2>>();
+  (*frames)[0] = makeFrame(restRawData);
+  (*frames)[1] = makeFrame(pressedRawData);
+
+  return [accelerator, frames](uint64_t const numberOfOperations) {
+    for (uint64_t i = 0; i < numberOfOperations; ++i) {
+      auto const &frame = (*frames)[i % 2];
+      accelerator->processFrame(frame.data(), frame.size(), {static_cast<uint32_t>(i + 1), i});
+    }
+  };
+}
+
+BenchmarkRun acceleratorConvertVoltageSetUp() {
+  auto accelerator = std::make_shared<Accelerator>();
+
+  return [accelerator](uint64_t const numberOfOperations) {
+    for (uint64_t i = 0; i < numberOfOperations; ++i) {
+      sink = sink + accelerator->convertVoltageToPercentage(900 + static_cast<uint32_t>(i % 1700));
+    }
+  };
+}
+
+/**
+ * Cost of one filter sample on a noisy resting pedal
+ */
+BenchmarkRun filterSampleRun(IFilterPtr filterPointer) {
+  auto filter = std::shared_ptr<IFilter>(std::move(filterPointer));
+  filter->reset(pedalRestVoltage_InMillivolts);
+
+  auto samples = std::make_shared<std::vector<int32_t>>(numberOfPedalSamples);
+  Random random(1);
+  for (auto &sample : *samples) {
+    sample = pedalRestVoltage_InMillivolts + static_cast<int32_t>(pedalNoise_InMillivolts * random.normal());
+  }
+
+  return [filter, samples](uint64_t const numberOfOperations) {
+    for (uint64_t i = 0; i < numberOfOperations; ++i) {
+      int32_t output = 0;
+      if (filter->process((*samples)[i % numberOfPedalSamples], output)) {
+        sink = sink + static_cast<uint32_t>(output);
+      }
+    }
+  };
+}
+
+BenchmarkRun boxcarFilterSampleSetUp() {
+  return filterSampleRun(std::make_unique<BoxcarFilter>(4));
+}
+
+BenchmarkRun medianFilterSampleSetUp() {
+  return filterSampleRun(std::make_unique<MedianFilter>(5));
+}
+
+BenchmarkRun kalmanFilterSampleSetUp() {
+  return filterSampleRun(std::make_unique<KalmanFilter>());
+}
+
+BenchmarkRun adaptiveFilterSampleSetUp() {
+  return filterSampleRun(std::make_unique<AdaptiveFilter>());
+}
+
+BenchmarkRun etcControllerProcessSetUp() {
+  auto clock = std::make_shared<VirtualClock>(1000000);
+  auto etcController = std::make_shared<EtcController>(clock);
+  etcController->registerChangeValueCallback([](uint32_t const value, TraceTag) {
+    sink = sink + value;
+  });
+  etcController->setVehicleRPM(3000);
+  etcController->setVehicleSpeed(40);
+
+  // One control tick per operation, the pedal sweeps so the output changes on most of them
+  return [clock, etcController](uint64_t const numberOfOperations) {
+    for (uint64_t i = 0; i < numberOfOperations; ++i) {
+      clock->advance(1000);
+      etcController->setAcceleratorValue(static_cast<uint32_t>((i * 7) % 101));
+      etcController->spinOnce();
+    }
+  };
+}
+
+/**
+ * One operation is one second of riding at the control rate, so ns/op is the CPU time the controller takes per second.
+ * The inputs are handed in every tick as the nodes do, only the pedal differs between the two cases.
+ */
+BenchmarkRun etcControllerSecondRun(bool const isPedalMoving) {
+  auto clock = std::make_shared<VirtualClock>(1000000);
+  auto etcController = std::make_shared<EtcController>(clock);
+  etcController->registerChangeValueCallback([](uint32_t const value, TraceTag) {
+    sink = sink + value;
+  });
+
+  return [clock, etcController, isPedalMoving](uint64_t const numberOfOperations) {
+    for (uint64_t i = 0; i < numberOfOperations; ++i) {
+      for (uint32_t tick = 0; tick < controlTicksPerSecond; ++tick) {
+        clock->advance(1000000 / controlTicksPerSecond);
+        etcController->setAcceleratorValue(isPedalMoving ? (tick * 7) % 101 : 30);
+        etcController->setVehicleRPM(5000);
+        etcController->setVehicleSpeed(80);
+        etcController->spinOnce();
+      }
+    }
+  };
+}
+
+BenchmarkRun etcControllerCruiseSecondSetUp() {
+  return etcControllerSecondRun(false);
+}
+
+BenchmarkRun etcControllerSweepSecondSetUp() {
+  return etcControllerSecondRun(true);
+}
+
+BenchmarkRun motorControllerMoveSetUp() {
+  auto clock = std::make_shared<VirtualClock>(1000000);
+  motor::host::setTimeFunction([clock]() {
+    return clock->getTime_InUS();
+  });
+
+  auto motorController = std::make_shared<MotorController>(100, 1000, 500, clock);
+  motorController->setAcceleration(20000);
+  motorController->setDeceleration(20000);
+
+  // A new target every 2000 ticks of 20 us, long enough to finish the move in coarse and fine microsteps
+  return [clock, motorController](uint64_t const numberOfOperations) {
+    board::gpioRecordReset();
+
+    for (uint64_t i = 0; i < numberOfOperations; ++i) {
+      if (i % 2000 == 0) {
+        motorController->setPosition((i / 2000) % 2 == 0 ? 80 : 10);
+      }
+
+      clock->advance(20);
+      motorController->spinOnce();
+    }
+  };
+}
+
+/**
+ * One STEP pulse, the rising and the falling edge with their timing checks, half of it per edge
+ */
+BenchmarkRun motorDriverStepPulseSetUp() {
+  auto clock = std::make_shared<VirtualClock>(1000000);
+  auto motorDriver = std::make_shared<MotorDriver>(clock);
+
+  // Far enough apart that the driver never waits for the minimal pulse width
+  return [clock, motorDriver](uint64_t const numberOfOperations) {
+    for (uint64_t i = 0; i < numberOfOperations; ++i) {
+      clock->advance(10);
+      motorDriver->stepUp();
+      clock->advance(10);
+      motorDriver->stepDown();
+    }
+  };
+}
+
+BenchmarkRun motorDriverSetMicrostepSetUp() {
+  auto motorDriver = std::make_shared<MotorDriver>(std::make_shared<VirtualClock>());
+
+  return [motorDriver](uint64_t const numberOfOperations) {
+    board::gpioRecordReset();
+
+    for (uint64_t i = 0; i < numberOfOperations; ++i) {
+      motorDriver->setMicrostep(i % 2 == 0 ? 8 : 32);
+    }
+  };
+}
+
+BenchmarkRun modeButtonProcessSetUp() {
+  auto modeButton = std::make_shared<ModeButton>(modeButton1PinNumber, modeButton2PinNumber);
+  modeButton->registerChangeValueCallback([](ModeButtonState const modeButtonState) {
+    sink = sink + modeButtonState;
+  });
+
+  // The switch moves between mode 1 and mode 3 on every operation
+  return [modeButton](uint64_t const numberOfOperations) {
+    for (uint64_t i = 0; i < numberOfOperations; ++i) {
+      auto const isMode1 = i % 2 == 0;
+      gpio::host::setInputLevel(modeButton1PinNumber, isMode1 ? gpio::PIN_LEVEL_LOW : gpio::PIN_LEVEL_HIGH);
+      gpio::host::setInputLevel(modeButton2PinNumber, isMode1 ? gpio::PIN_LEVEL_HIGH : gpio::PIN_LEVEL_LOW);
+      modeButton->spinOnce();
+    }
+
+    gpio::host::releaseInputs();
+  };
+}
+
+BenchmarkRun setupButtonProcessSetUp() {
+  auto clock = std::make_shared<VirtualClock>(1000000);
+  auto setupButton = std::make_shared<SetupButton>(setupButtonPinNumber, 1000000, 100000, 5000000, clock);
+  setupButton->registerChangeValueCallback([](SetupButtonState const setupButtonState) {
+    sink = sink + setupButtonState;
+  });
+
+  // Held for 200 ticks of 10 ms, released for 200, every hold reaches HELD but not LONG_HELD
+  return [clock, setupButton](uint64_t const numberOfOperations) {
+    for (uint64_t i = 0; i < numberOfOperations; ++i) {
+      clock->advance(10000);
+      gpio::host::setInputLevel(setupButtonPinNumber, (i / 200) % 2 == 0 ? gpio::PIN_LEVEL_LOW : gpio::PIN_LEVEL_HIGH);
+      setupButton->spinOnce();
+    }
+
+    gpio::host::releaseInputs();
+  };
+}
+
+/**
+ * Uncontended cost of publishing a setpoint and taking a snapshot of it, the contended behaviour is in the runtime test
+ */
+BenchmarkRun mailboxWriteReadSetUp() {
+  auto mailbox = std::make_shared<Mailbox<MotorSetpoint>>();
+
+  return [mailbox](uint64_t const numberOfOperations) {
+    for (uint64_t i = 0; i < numberOfOperations; ++i) {
+      MotorSetpoint setpoint = {};
+      setpoint.position = static_cast<uint32_t>(i);
+      mailbox->write(setpoint);
+      sink = sink + mailbox->read(setpoint) + setpoint.position;
+    }
+  };
+}
+
+BenchmarkRun ringBufferPushPopSetUp() {
+  auto ringBuffer = std::make_shared<RingBuffer<uint64_t, 64>>();
+
+  return [ringBuffer](uint64_t const numberOfOperations) {
+    for (uint64_t i = 0; i < numberOfOperations; ++i) {
+      uint64_t value = 0;
+      ringBuffer->push(i);
+      if (ringBuffer->pop(value)) {
+        sink = sink + static_cast<uint32_t>(value);
+      }
+    }
+  };
+}
+
+/**
+ * What a node pays for a log message on the hot path, the queue is drained raw in batches as the log task would
+ */
+BenchmarkRun deferredLogRecordSetUp() {
+  auto records = std::make_shared<std::array<LogRecord, 64>>();
+
+  return [records](uint64_t const numberOfOperations) {
+    for (uint64_t i = 0; i < numberOfOperations; ++i) {
+      deferredLog(LOG_MOTOR_CONTROLLER_MOVING_HOME, static_cast<int32_t>(i));
+
+      if (i % records->size() == records->size() - 1) {
+        sink = sink + static_cast<uint32_t>(deferredLogDrain(records->data(), records->size()));
+      }
+    }
+
+    sink = sink + static_cast<uint32_t>(deferredLogDrain(records->data(), records->size()));
+  };
+}
+
+/**
+ * Formatting the same message, the part of an inline ESP_LOGI that deferredLog moves to the log task.
+ * The inline call also pays the output itself on top of this.
+ */
+BenchmarkRun deferredLogFormatSetUp() {
+  return [](uint64_t const numberOfOperations) {
+    char line[128] = {0};
+
+    for (uint64_t i = 0; i < numberOfOperations; ++i) {
+      LogRecord const record = {
+          .timestamp_InMS = static_cast<uint32_t>(i),
+          .messageId = LOG_MOTOR_CONTROLLER_MOVING_HOME,
+          .reserved = 0,
+          .arguments = {static_cast<int32_t>(i), 0},
+      };
+      sink = sink + static_cast<uint32_t>(deferredLogFormat(record, line, sizeof(line)));
+    }
+  };
+}
+
+/**
+ * Partition that takes everything, leaves the receiver with the copy into the queue and the hash
+ */
+class NullOtaWriter : public IOtaWriter {
+public:
+  bool begin(uint32_t) override {
+    return true;
+  }
+
+  bool write(uint8_t const *data, std::size_t const size) override {
+    sink = sink + data[size - 1];
+    return true;
+  }
+
+  bool end() override {
+    return true;
+  }
+
+  void abort() override {
+  }
+};
+
+/**
+ * One full size chunk from the transport through the queue into the hash and the writer, the flash write itself excluded
+ */
+BenchmarkRun otaReceiveChunkSetUp() {
+  auto receiver = std::make_shared<OtaReceiver>(std::make_unique<NullOtaWriter>());
+  auto chunk = std::make_shared<std::array<uint8_t, otaChunkMaxSize>>();
+
+  Random random(3);
+  for (auto &byte : *chunk) {
+    byte = static_cast<uint8_t>(random.next());
+  }
+
+  return [receiver, chunk](uint64_t const numberOfOperations) {
+    // An image larger than the run, it is never finished
+    receiver->abort();
+    receiver->process();
+    receiver->begin(UINT32_MAX, {});
+    receiver->process();
+
+    for (uint64_t i = 0; i < numberOfOperations; ++i) {
+      receiver->receive(static_cast<uint16_t>(i), chunk->data(), chunk->size());
+      receiver->process();
+    }
+
+    sink = sink + receiver->getState();
+  };
+}
+
+/**
+ * Device link on the slave end of a pty, the benchmark plays the host on the master
+ */
+struct TelemetryPtyRig {
+  TelemetryPtyRig() : pty(), deviceLink(std::make_unique<PosixTransport>(pty.getSlavePath())), hostLink(pty.createMasterTransport()), decoder() {
+  }
+
+  /**
+   * Runs the device link and reads the master until that many more frames arrived
+   */
+  void exchange(uint32_t const numberOfFrames) {
+    auto const expectedNumberOfFrames = decoder.getNumberOfFrames() + numberOfFrames;
+    uint8_t chunk[4096];
+
+    while (decoder.getNumberOfFrames() < expectedNumberOfFrames) {
+      deviceLink.spinOnce();
+
+      pollfd master = {pty.getFileDescriptor(), POLLIN, 0};
+      if (poll(&master, 1, 1000) <= 0) {
+        std::fprintf(stderr, "telemetry: no frame within a second\n");
+        std::exit(EXIT_FAILURE);
+      }
+
+      auto const numberOfBytes = pty.read(chunk, sizeof(chunk));
+      decoder.feed(chunk, numberOfBytes, [](uint8_t const channel, uint8_t const *, std::size_t const size) {
+        sink = sink + channel + static_cast<uint32_t>(size);
+      });
+    }
+  }
+
+  Pty pty;
+  TelemetryLink deviceLink;
+  TelemetryLink hostLink;
+  TelemetryDecoder decoder;
+};
+
+/**
+ * One command from the host through the pty, the device link and back as a response, ns/op is the round trip
+ */
+BenchmarkRun telemetryPtyCommandSetUp() {
+  auto rig = std::make_shared<TelemetryPtyRig>();
+  rig->deviceLink.registerCommand(1, [](uint8_t const *, std::size_t const size) {
+    sink = sink + static_cast<uint32_t>(size);
+    return TELEMETRY_COMMAND_STATUS_OK;
+  });
+
+  return [rig](uint64_t const numberOfOperations) {
+    uint8_t const command[] = {1, 0x10, 0x00, 0x20, 0x30};
+
+    for (uint64_t i = 0; i < numberOfOperations; ++i) {
+      rig->hostLink.send(TELEMETRY_CHANNEL_COMMAND, command, sizeof(command));
+      rig->hostLink.flush();
+      rig->exchange(1);
+    }
+  };
+}
+
+/**
+ * One tick of ride log through the pty, encoded, written in one batch, read and decoded on the host.
+ * Every operation carries telemetryPtyFramesPerTick frames of telemetryPtyFrameSize bytes.
+ */
+BenchmarkRun telemetryPtyRideLogSetUp() {
+  auto rig = std::make_shared<TelemetryPtyRig>();
+  auto payload = std::make_shared<std::array<uint8_t, telemetryPtyFrameSize>>();
+
+  Random random(45);
+  for (auto &byte : *payload) {
+    byte = static_cast<uint8_t>(random.next());
+  }
+
+  return [rig, payload](uint64_t const numberOfOperations) {
+    for (uint64_t i = 0; i < numberOfOperations; ++i) {
+      for (uint32_t frame = 0; frame < telemetryPtyFramesPerTick; ++frame) {
+        rig->deviceLink.send(TELEMETRY_CHANNEL_RIDE_LOG, payload->data(), payload->size());
+      }
+      rig->exchange(telemetryPtyFramesPerTick);
+    }
+  };
+}
+
+std::vector<Benchmark> const benchmarks = {
+    {"adc_reduce_frame", adcReduceFrameSetUp},
+    {"adc_reduce_frame_portable", adcReduceFramePortableSetUp},
+    {"adc_reduce_largest_frame", adcReduceLargestFrameSetUp},
+    {"adc_reduce_largest_frame_portable", adcReduceLargestFramePortableSetUp},
+    {"accelerator_process_frame", acceleratorProcessFrameSetUp},
+    {"accelerator_convert_voltage", acceleratorConvertVoltageSetUp},
+    {"filter_boxcar_sample", boxcarFilterSampleSetUp},
+    {"filter_median_sample", medianFilterSampleSetUp},
+    {"filter_kalman_sample", kalmanFilterSampleSetUp},
+    {"filter_adaptive_sample", adaptiveFilterSampleSetUp},
+    {"etc_controller_process", etcControllerProcessSetUp},
+    {"etc_controller_cruise_second", etcControllerCruiseSecondSetUp},
+    {"etc_controller_sweep_second", etcControllerSweepSecondSetUp},
+    {"motor_controller_move", motorControllerMoveSetUp},
+    {"motor_driver_step_pulse", motorDriverStepPulseSetUp},
+    {"motor_driver_set_microstep", motorDriverSetMicrostepSetUp},
+    {"mode_button_process", modeButtonProcessSetUp},
+    {"setup_button_process", setupButtonProcessSetUp},
+    {"mailbox_write_read", mailboxWriteReadSetUp},
+    {"ring_buffer_push_pop", ringBufferPushPopSetUp},
+    {"deferred_log_record", deferredLogRecordSetUp},
+    {"deferred_log_format", deferredLogFormatSetUp},
+    {"ota_receive_chunk", otaReceiveChunkSetUp},
+    {"telemetry_pty_command", telemetryPtyCommandSetUp},
+    {"telemetry_pty_ride_log", telemetryPtyRideLogSetUp},
+};
+
+uint64_t getTime_InNS() {
+  auto const timeSinceEpoch = std::chrono::steady_clock::now().time_since_epoch();
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(timeSinceEpoch).count());
+}
+
+/**
+ * Time stamp counter, it ticks at a fixed reference rate rather than the core clock. Zero where there is none.
+ */
+uint64_t getCycles() {
+#if defined(__x86_64__)
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+/**
+ * The batch grows until it runs long enough to time, then the median of the repetitions is taken
+ */
+BenchmarkResult runBenchmark(Benchmark const &benchmark) {
+  auto const run = benchmark.setUp();
+
+  uint64_t numberOfOperations = 1000;
+  run(numberOfOperations);
+
+  while (true) {
+    auto const startTime_InNS = getTime_InNS();
+    run(numberOfOperations);
+    if (getTime_InNS() - startTime_InNS >= minimalBatchTime_InNS) {
+      break;
+    }
+
+    numberOfOperations *= 2;
+  }
+
+  std::vector<double> nanosecondsPerOperation;
+  std::vector<double> cyclesPerOperation;
+  uint64_t allocations = 0;
+
+  for (uint32_t repetition = 0; repetition < numberOfRepetitions; ++repetition) {
+    auto const allocationsBefore = numberOfAllocations.load();
+    auto const startTime_InNS = getTime_InNS();
+    auto const startCycles = getCycles();
+
+    run(numberOfOperations);
+
+    auto const cycles = getCycles() - startCycles;
+    auto const duration_InNS = getTime_InNS() - startTime_InNS;
+    allocations += numberOfAllocations.load() - allocationsBefore;
+
+    nanosecondsPerOperation.push_back(static_cast<double>(duration_InNS) / static_cast<double>(numberOfOperations));
+    cyclesPerOperation.push_back(static_cast<double>(cycles) / static_cast<double>(numberOfOperations));
+  }
+
+  std::sort(nanosecondsPerOperation.begin(), nanosecondsPerOperation.end());
+  std::sort(cyclesPerOperation.begin(), cyclesPerOperation.end());
+
+  return {
+      .name = benchmark.name,
+      .nanosecondsPerOperation = nanosecondsPerOperation[numberOfRepetitions / 2],
+      .cyclesPerOperation = cyclesPerOperation[numberOfRepetitions / 2],
+      .allocationsPerOperation = static_cast<double>(allocations) / static_cast<double>(numberOfOperations * numberOfRepetitions),
+      .numberOfOperations = numberOfOperations,
+  };
+}
+
+/**
+ * Reads the ns/op of every case from a file written with --json, one case per line
+ */
+bool readBaseline(char const *path, std::vector<BenchmarkResult> &baseline) {
+  std::ifstream file(path);
+  if (not file) {
+    return false;
+  }
+
+  std::string line;
+  while (std::getline(file, line)) {
+    auto const namePosition = line.find("\"name\": \"");
+    auto const timePosition = line.find("\"ns_per_op\": ");
+    if (namePosition == std::string::npos or timePosition == std::string::npos) {
+      continue;
+    }
+
+    auto const nameStart = namePosition + std::strlen("\"name\": \"");
+    auto const nameEnd = line.find('"', nameStart);
+
+    BenchmarkResult result = {};
+    result.name = line.substr(nameStart, nameEnd - nameStart);
+    result.nanosecondsPerOperation = std::strtod(line.c_str() + timePosition + std::strlen("\"ns_per_op\": "), nullptr);
+    baseline.push_back(result);
+  }
+
+  return true;
+}
+
+void printText(std::vector<BenchmarkResult> const &results, std::vector<BenchmarkResult> const &baseline) {
+  std::printf("%-32s %12s %12s %12s %12s", "benchmark", "ns/op", "cycles/op", "allocs/op", "operations");
+  if (not baseline.empty()) {
+    std::printf(" %12s", "vs baseline");
+  }
+  std::printf("\n");
+
+  for (auto const &result : results) {
+    std::printf("%-32s %12.1f %12.1f %12.3f %12lu", result.name.c_str(), result.nanosecondsPerOperation, result.cyclesPerOperation, result.allocationsPerOperation,
+                static_cast<unsigned long>(result.numberOfOperations));
+
+    auto const reference = std::find_if(baseline.begin(), baseline.end(), [&result](BenchmarkResult const &entry) {
+      return entry.name == result.name;
+    });
+    if (reference != baseline.end() and reference->nanosecondsPerOperation > 0) {
+      std::printf(" %+11.1f%%", (result.nanosecondsPerOperation / reference->nanosecondsPerOperation - 1) * 100);
+    }
+
+    std::printf("\n");
+  }
+}
+
+void printJson(std::vector<BenchmarkResult> const &results) {
+  std::printf("{\n");
+  std::printf("  \"compiler\": \"%s\",\n", __VERSION__);
+  std::printf("  \"benchmarks\": [\n");
+
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    auto const &result = results[i];
+    std::printf("    {\"name\": \"%s\", \"ns_per_op\": %.1f, \"cycles_per_op\": %.1f, \"allocs_per_op\": %.3f, \"operations\": %lu}%s\n",
+                result.name.c_str(), result.nanosecondsPerOperation, result.cyclesPerOperation, result.allocationsPerOperation,
+                static_cast<unsigned long>(result.numberOfOperations), i + 1 < results.size() ? "," : "");
+  }
+
+  std::printf("  ]\n");
+  std::printf("}\n");
+}
+
+void printUsage(char const *programName) {
+  std::fprintf(stderr, "Usage: %s [--json] [--compare <baseline.json>] [--filter <substring>]\n", programName);
+}
+
+}// namespace
+
+int main(int argc, char *argv[]) {
+  auto isJson = false;
+  char const *baselinePath = nullptr;
+  char const *filter = nullptr;
+
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--json") == 0) {
+      isJson = true;
+      continue;
+    }
+
+    if (std::strcmp(argv[i], "--compare") == 0 and i + 1 < argc) {
+      baselinePath = argv[++i];
+      continue;
+    }
+
+    if (std::strcmp(argv[i], "--filter") == 0 and i + 1 < argc) {
+      filter = argv[++i];
+      continue;
+    }
+
+    printUsage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  std::vector<BenchmarkResult> baseline;
+  if (baselinePath and not readBaseline(baselinePath, baseline)) {
+    std::fprintf(stderr, "Cannot read baseline %s\n", baselinePath);
+    return EXIT_FAILURE;
+  }
+
+  std::vector<BenchmarkResult> results;
+  for (auto const &benchmark : benchmarks) {
+    if (filter and std::strstr(benchmark.name, filter) == nullptr) {
+      continue;
+    }
+
+    results.push_back(runBenchmark(benchmark));
+  }
+
+  if (isJson) {
+    printJson(results);
+  } else {
+    printText(results, baseline);
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,87 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "log/DeferredLog.hpp"
+
+constexpr std::size_t const lineSize = 128;
+
+namespace {
+
+void printUsage(char const *programName) {
+  std::fprintf(stderr, "Usage: %s [<records.bin>]\n", programName);
+  std::fprintf(stderr, "Decodes raw deferred log records, as taken out with deferredLogDrain, from the file or from stdin.\n");
+  std::fprintf(stderr, "Records are read in the byte order of the unit, little endian.\n");
+}
+
+}// namespace
+
+int main(int argc, char *argv[]) {
+  if (argc > 2 or (argc == 2 and std::strcmp(argv[1], "--help") == 0)) {
+    printUsage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  auto *const input = argc == 2 ? std::fopen(argv[1], "rb") : stdin;
+  if (input == nullptr) {
+    std::fprintf(stderr, "Unable to open %s\n", argv[1]);
+    return EXIT_FAILURE;
+  }
+
+  uint32_t numberOfRecords = 0;
+  uint32_t numberOfUnknown = 0;
+
+  LogRecord record = {};
+  char line[lineSize] = {0};
+
+  bool isTruncated = false;
+
+  while (true) {
+    auto const size = std::fread(&record, 1, sizeof(record), input);
+    if (size < sizeof(record)) {
+      isTruncated = size > 0;
+      break;
+    }
+
+    deferredLogFormat(record, line, sizeof(line));
+
+    auto const tag = record.messageId < LOG_MESSAGE_COUNT ? logMessageFormats[record.messageId].tag : "log";
+    std::printf("(%u) %s: %s\n", record.timestamp_InMS, tag, line);
+
+    numberOfRecords += 1;
+    if (record.messageId >= LOG_MESSAGE_COUNT) {
+      numberOfUnknown += 1;
+    }
+  }
+
+  if (input != stdin) {
+    std::fclose(input);
+  }
+
+  std::fprintf(stderr, "%u records, %u unknown%s\n", numberOfRecords, numberOfUnknown, isTruncated ? ", last record cut" : "");
+
+  // A partial record at the end means the dump is cut or not a record dump at all
+  if (isTruncated or numberOfUnknown > 0) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,333 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "Storage.hpp"
+#include "Accelerator.hpp"
+#include "ModeButton.hpp"
+#include "SetupButton.hpp"
+#include "EtcController.hpp"
+#include "clock/VirtualClock.hpp"
+#include "filter/AdaptiveFilter.hpp"
+#include "profile/RidingProfileSelector.hpp"
+#include "replay/MappedFile.hpp"
+#include "replay/RideReplay.hpp"
+#include "replay/RideLogWriter.hpp"
+#include "runtime/Mailbox.hpp"
+#include "stepper/MotorBridge.hpp"
+#include "stepper/MotorController.hpp"
+#include "trace/LatencyHistogram.hpp"
+
+// Motor set up as in main.cpp
+constexpr uint32_t const motorMinimalSpeed = 500;
+constexpr uint32_t const motorMaximalSpeed = 4000;
+constexpr uint32_t const motorMaximalSteps = 500;
+constexpr uint32_t const motorDefaultSpeed = 1500;
+constexpr uint32_t const motorDefaultAcceleration = 15000;
+constexpr uint32_t const motorDefaultDeceleration = 30000;
+
+// The control nodes run once per tick, the motion nodes in between at these periods
+constexpr uint32_t const controlPeriod_InUS = 1000;
+constexpr uint32_t const motorPeriod_InUS = 20;
+constexpr uint32_t const bridgePeriod_InUS = 100;
+
+// Latencies are summarized per window like the reports of the unit
+constexpr uint32_t const latencyWindow_InUS = 1000000;
+
+namespace {
+
+void printUsage(char const *programName) {
+  std::fprintf(stderr, "Usage: %s <ride.log> [--output <replayed.log>] [--reference <other.log>] [--pedal <min_mv>:<max_mv>] [--p99 <us>]\n", programName);
+  std::fprintf(stderr, "Replays the inputs of a ride log through Accelerator, EtcController, MotorBridge and MotorController.\n");
+  std::fprintf(stderr, "The replayed outputs are compared with the reference, by default the outputs recorded in the log.\n");
+  std::fprintf(stderr, "Exits with 1 when the output trajectories differ or the frame to step p99 of a one second window exceeds --p99.\n");
+}
+
+bool writeFile(char const *path, std::vector<uint8_t> const &data) {
+  auto *const file = std::fopen(path, "wb");
+  if (file == nullptr) {
+    return false;
+  }
+
+  auto const isWritten = std::fwrite(data.data(), 1, data.size(), file) == data.size();
+  std::fclose(file);
+
+  return isWritten;
+}
+
+}// namespace
+
+int main(int argc, char *argv[]) {
+  if (argc < 2) {
+    printUsage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  char const *logPath = argv[1];
+  char const *outputPath = nullptr;
+  char const *referencePath = nullptr;
+  uint32_t pedalMinimalVoltage_InMillivolts = 0;
+  uint32_t pedalMaximalVoltage_InMillivolts = 0;
+  uint32_t maximalP99_InUS = 0;
+
+  for (int i = 2; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--output") == 0 and i + 1 < argc) {
+      outputPath = argv[++i];
+      continue;
+    }
+
+    if (std::strcmp(argv[i], "--reference") == 0 and i + 1 < argc) {
+      referencePath = argv[++i];
+      continue;
+    }
+
+    if (std::strcmp(argv[i], "--pedal") == 0 and i + 1 < argc) {
+      unsigned long minimal = 0;
+      unsigned long maximal = 0;
+      if (std::sscanf(argv[++i], "%lu:%lu", &minimal, &maximal) != 2 or minimal >= maximal) {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+      }
+
+      pedalMinimalVoltage_InMillivolts = static_cast<uint32_t>(minimal);
+      pedalMaximalVoltage_InMillivolts = static_cast<uint32_t>(maximal);
+      continue;
+    }
+
+    if (std::strcmp(argv[i], "--p99") == 0 and i + 1 < argc) {
+      maximalP99_InUS = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+      continue;
+    }
+
+    printUsage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  MappedFile const logFile(logPath);
+  RideLogReader const reader(logFile.getData(), logFile.getSize());
+  if (not reader.isValid()) {
+    std::fprintf(stderr, "%s is not a ride log\n", logPath);
+    return EXIT_FAILURE;
+  }
+
+  // The log does not carry the pedal calibration, it goes where the Accelerator loads it from
+  if (pedalMaximalVoltage_InMillivolts > 0) {
+    Storage storage("accelerator");
+    storage.setValue("min_mv", pedalMinimalVoltage_InMillivolts);
+    storage.setValue("max_mv", pedalMaximalVoltage_InMillivolts);
+    storage.commit();
+  }
+
+  auto clock = std::make_shared<VirtualClock>();
+  motor::host::setTimeFunction([clock]() {
+    return clock->getTime_InUS();
+  });
+
+  std::vector<uint8_t> replayedLog;
+  RideLogWriter rideLogWriter([&replayedLog](uint8_t const *data, std::size_t const size) {
+    replayedLog.insert(replayedLog.end(), data, data + size);
+  });
+
+  auto motorController = std::make_shared<MotorController>(motorMinimalSpeed, motorMaximalSpeed, motorMaximalSteps, clock);
+  motorController->setSpeed(motorDefaultSpeed);
+  motorController->setAcceleration(motorDefaultAcceleration);
+  motorController->setDeceleration(motorDefaultDeceleration);
+  motorController->moveToHome();
+
+  auto latencyHistogram = std::make_shared<LatencyHistogram>();
+  motorController->setLatencyHistogram(latencyHistogram);
+
+  uint32_t numberOfLatencyWindows = 0;
+  LatencySummary worstLatencyWindow = {};
+  uint64_t latencyWindowStartTime_InUS = 0;
+
+  auto const takeLatencyWindow = [&]() {
+    auto const summary = latencyHistogram->takeSummary();
+    if (summary.numberOfSamples == 0) {
+      return;
+    }
+
+    numberOfLatencyWindows += 1;
+    if (summary.p99_InUS > worstLatencyWindow.p99_InUS) {
+      worstLatencyWindow = summary;
+    }
+  };
+
+  auto profileSelector = std::make_shared<RidingProfileSelector>();
+
+  auto motorSetpointMailbox = std::make_shared<Mailbox<MotorSetpoint>>();
+  auto motorStatusMailbox = std::make_shared<Mailbox<MotorStatus>>();
+  auto motorBridge = std::make_shared<MotorBridge>(motorController, motorSetpointMailbox, motorStatusMailbox, clock);
+  motorBridge->setProfileSelector(profileSelector);
+
+  MotorSetpoint motorSetpoint = {
+      .position = 0,
+      .speed = motorDefaultSpeed,
+      .wakeRequest = 0,
+      .sleepRequest = 0,
+      .trace = {},
+  };
+
+  auto etcController = std::make_shared<EtcController>(clock);
+  etcController->setProfileSelector(profileSelector);
+  etcController->registerChangeValueCallback(
+      [&](uint32_t const motorPosition, TraceTag const traceTag) {
+        motorSetpoint.position = motorPosition;
+        motorSetpoint.trace = traceTag;
+        motorSetpointMailbox->write(motorSetpoint);
+
+        MotorStatus motorStatus = {};
+        motorStatusMailbox->read(motorStatus);
+        rideLogWriter.writeOutput(clock->getTime_InUS(), {.command = motorPosition, .motorPosition = motorStatus.position});
+      });
+
+  auto accelerator = std::make_shared<Accelerator>(1000000 / controlPeriod_InUS, 64, clock);
+  std::vector<IFilterPtr> pedalFilters;
+  for (auto const &profile : defaultRidingProfiles) {
+    pedalFilters.push_back(std::make_unique<AdaptiveFilter>(accelerator->getFramePeriod_InUS(), profile.filterMinCutoff_InMilliHertz, profile.filterBeta));
+  }
+  accelerator->setFilters(std::move(pedalFilters));
+  accelerator->selectFilter(ridingProfileCount - 1);
+  accelerator->registerChangeAccelerateCallback(
+      [&](uint32_t const acceleratorValue_InPercentage, TraceTag const traceTag) {
+        etcController->setAcceleratorValue(acceleratorValue_InPercentage, traceTag);
+      });
+
+  RideReplay rideReplay(reader, controlPeriod_InUS);
+
+  uint32_t frameSequence = 0;
+  rideReplay.registerFrameCallback(
+      [&](uint8_t const *frame, uint32_t const size) {
+        rideLogWriter.writeFrame(clock->getTime_InUS(), frame, static_cast<uint16_t>(size));
+
+        frameSequence = frameSequence + 1 == 0 ? 1 : frameSequence + 1;
+        accelerator->processFrame(frame, size, {frameSequence, clock->getTime_InUS()});
+      });
+
+  rideReplay.registerVehicleCallback(
+      [&](RideLogVehicle const &vehicle) {
+        rideLogWriter.writeVehicle(clock->getTime_InUS(), vehicle);
+
+        etcController->setVehicleRPM(vehicle.revolutionPerMinute);
+        etcController->setVehicleSpeed(vehicle.speed_InKilometersPerHour);
+        etcController->setVehicleClutchState(vehicle.clutchIsEnabled != 0);
+      });
+
+  // Button handling as in main.cpp, calibration and motion identification are not replayed
+  RideLogButtons lastButtons = {
+      .modeButtonState = MODE_BUTTON_STATE_UNKNOWN,
+      .setupButtonState = SETUP_BUTTON_RELEASED,
+      .launchButtonState = SETUP_BUTTON_RELEASED,
+  };
+  rideReplay.registerButtonsCallback(
+      [&](RideLogButtons const &buttons) {
+        rideLogWriter.writeButtons(clock->getTime_InUS(), buttons);
+
+        if (buttons.setupButtonState != lastButtons.setupButtonState) {
+          if (buttons.setupButtonState == SETUP_BUTTON_HELD) {
+            etcController->modeEnable();
+          }
+          if (buttons.setupButtonState == SETUP_BUTTON_PRESSED) {
+            etcController->modeDisable();
+          }
+        }
+
+        auto const modeButtonState = static_cast<ModeButtonState>(buttons.modeButtonState);
+        if (buttons.modeButtonState != lastButtons.modeButtonState and modeButtonState != MODE_BUTTON_STATE_UNKNOWN) {
+          auto const profileIndex = static_cast<uint32_t>(modeButtonState - MODE_BUTTON_STATE_MODE_1);
+          profileSelector->select(profileIndex);
+          accelerator->selectFilter(profileIndex);
+        }
+
+        if (buttons.launchButtonState != lastButtons.launchButtonState) {
+          if (buttons.launchButtonState == SETUP_BUTTON_HELD and etcController->getVehicleSpeed() == 0) {
+            etcController->launchEnable();
+          }
+          if (buttons.launchButtonState == SETUP_BUTTON_PRESSED) {
+            etcController->launchDisable();
+          }
+        }
+
+        lastButtons = buttons;
+      });
+
+  rideReplay.registerTickCallback(
+      [&](uint64_t const timeInUS) {
+        if (timeInUS - latencyWindowStartTime_InUS >= latencyWindow_InUS) {
+          takeLatencyWindow();
+          latencyWindowStartTime_InUS = timeInUS;
+        }
+
+        clock->setTime(timeInUS);
+        etcController->spinOnce();
+
+        for (uint32_t offset_InUS = 0; offset_InUS < controlPeriod_InUS; offset_InUS += motorPeriod_InUS) {
+          clock->setTime(timeInUS + offset_InUS);
+
+          if (offset_InUS % bridgePeriod_InUS == 0) {
+            motorBridge->spinOnce();
+          }
+          motorController->spinOnce();
+        }
+      });
+
+  auto const numberOfRecords = rideReplay.run();
+  takeLatencyWindow();
+
+  RideLogReader const replayedReader(replayedLog.data(), replayedLog.size());
+
+  std::printf("records          %lu\n", static_cast<unsigned long>(numberOfRecords));
+  std::printf("replayed digest  %016lx\n", static_cast<unsigned long>(rideLogOutputDigest(replayedReader)));
+  std::printf("latency windows  %u, worst p50 %u us p99 %u us max %u us\n", numberOfLatencyWindows, worstLatencyWindow.p50_InUS, worstLatencyWindow.p99_InUS,
+              worstLatencyWindow.maximum_InUS);
+
+  if (outputPath and not writeFile(outputPath, replayedLog)) {
+    std::fprintf(stderr, "Cannot write %s\n", outputPath);
+    return EXIT_FAILURE;
+  }
+
+  MappedFile const referenceFile(referencePath ? referencePath : logPath);
+  RideLogReader const referenceReader(referenceFile.getData(), referenceFile.getSize());
+  if (not referenceReader.isValid()) {
+    std::fprintf(stderr, "%s is not a ride log\n", referencePath);
+    return EXIT_FAILURE;
+  }
+
+  std::printf("reference digest %016lx\n", static_cast<unsigned long>(rideLogOutputDigest(referenceReader)));
+
+  auto isPassed = true;
+
+  uint64_t differenceTime_InUS = 0;
+  if (rideLogFindFirstDifference(referenceReader, replayedReader, differenceTime_InUS)) {
+    std::printf("outputs differ from %lu us on\n", static_cast<unsigned long>(differenceTime_InUS));
+    isPassed = false;
+  } else {
+    std::printf("outputs identical\n");
+  }
+
+  if (maximalP99_InUS > 0 and worstLatencyWindow.p99_InUS > maximalP99_InUS) {
+    std::printf("latency p99 above %u us\n", maximalP99_InUS);
+    isPassed = false;
+  }
+
+  return isPassed ? EXIT_SUCCESS : 1;
+}
@@ -0,0 +1,54 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+
+/**
+ * Host stand-in for the ESP-IDF error codes, a failed check aborts like on the target
+ */
+using esp_err_t = int;
+
+constexpr esp_err_t const ESP_OK = 0;
+constexpr esp_err_t const ESP_FAIL = -1;
+constexpr esp_err_t const ESP_ERR_NOT_FOUND = 0x105;
+constexpr esp_err_t const ESP_ERR_NVS_NO_FREE_PAGES = 0x110d;
+constexpr esp_err_t const ESP_ERR_NVS_NEW_VERSION_FOUND = 0x1110;
+
+inline char const *esp_err_to_name(esp_err_t const code) {
+  if (code == ESP_OK) {
+    return "ESP_OK";
+  }
+
+  if (code == ESP_ERR_NOT_FOUND) {
+    return "ESP_ERR_NOT_FOUND";
+  }
+
+  return "ESP_FAIL";
+}
+
+#define ESP_ERROR_CHECK(x)                                                           \
+  do {                                                                               \
+    esp_err_t const errorCode = (x);                                                 \
+    if (errorCode != ESP_OK) {                                                       \
+      std::fprintf(stderr, "%s failed: %s\n", #x, esp_err_to_name(errorCode));      \
+      std::abort();                                                                  \
+    }                                                                                \
+  } while (0)
@@ -0,0 +1,55 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <cstdio>
+
+enum esp_log_level_t {
+  ESP_LOG_NONE = 0,
+  ESP_LOG_ERROR,
+  ESP_LOG_WARN,
+  ESP_LOG_INFO,
+  ESP_LOG_DEBUG,
+  ESP_LOG_VERBOSE
+};
+
+namespace esp_log::host {
+
+inline esp_log_level_t &level() {
+  static esp_log_level_t logLevel = ESP_LOG_INFO;
+  return logLevel;
+}
+
+}// namespace esp_log::host
+
+/**
+ * Host stand-in, the level applies to every tag
+ */
+inline void esp_log_level_set(char const *, esp_log_level_t const level) {
+  esp_log::host::level() = level;
+}
+
+/**
+ * Host stand-in for the ESP-IDF log macros, everything goes to stderr
+ */
+#define ESP_LOG_HOST(messageLevel, letter, tag, format, ...) ((esp_log::host::level() >= (messageLevel)) ? static_cast<void>(std::fprintf(stderr, letter " %s: " format "\n", tag, ##__VA_ARGS__)) : static_cast<void>(0))
+#define ESP_LOGE(tag, format, ...) ESP_LOG_HOST(ESP_LOG_ERROR, "E", tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) ESP_LOG_HOST(ESP_LOG_WARN, "W", tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) ESP_LOG_HOST(ESP_LOG_INFO, "I", tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) static_cast<void>(tag)
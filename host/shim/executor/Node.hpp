@@ -0,0 +1,44 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <memory>
+
+namespace executor {
+
+/**
+ * Host stand-in for the executor component node.
+ * There is no executor on the host, simulations and tools step nodes themselves with spinOnce().
+ */
+class Node {
+public:
+  virtual ~Node() = default;
+
+public:
+  void spinOnce() {
+    process();
+  }
+
+private:
+  virtual void process() = 0;
+};
+
+using NodePtr = std::shared_ptr<Node>;
+
+}// namespace executor
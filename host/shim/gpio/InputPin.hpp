@@ -0,0 +1,81 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "gpio/PinLevel.hpp"
+#include "gpio/interface/IInputPin.hpp"
+
+namespace gpio {
+
+namespace host {
+
+constexpr uint8_t const numberOfPins = 64;
+
+/**
+ * Levels driven from outside, a pin nobody drove reads its idle level
+ */
+inline std::array<int8_t, numberOfPins> &inputLevels() {
+  static std::array<int8_t, numberOfPins> levels = [] {
+    std::array<int8_t, numberOfPins> result = {};
+    result.fill(-1);
+    return result;
+  }();
+  return levels;
+}
+
+inline void setInputLevel(uint8_t const pinNumber, PinLevel const level) {
+  inputLevels()[pinNumber % numberOfPins] = static_cast<int8_t>(level);
+}
+
+inline void releaseInputs() {
+  inputLevels().fill(-1);
+}
+
+}// namespace host
+
+/**
+ * Host stand-in for the gpio component input pin, the level is set by host::setInputLevel()
+ */
+class InputPin : public IInputPin<PinLevel> {
+public:
+  InputPin(uint8_t const pinNumber, PinLevel const idleLevel) : m_pinNumber(pinNumber % host::numberOfPins),
+                                                                m_idleLevel(idleLevel) {
+  }
+
+  ~InputPin() override = default;
+
+public:
+  [[nodiscard]] PinLevel getLevel() const override {
+    auto const level = host::inputLevels()[m_pinNumber];
+    if (level < 0) {
+      return m_idleLevel;
+    }
+
+    return static_cast<PinLevel>(level);
+  }
+
+private:
+  uint8_t const m_pinNumber;
+  PinLevel const m_idleLevel;
+};
+
+}// namespace gpio
@@ -0,0 +1,161 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <array>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * Host stand-in for the mbedtls SHA-256, a plain software implementation of FIPS 180-4.
+ * SHA-224 is not supported, starts() fails when it is asked for.
+ */
+struct mbedtls_sha256_context {
+  std::array<uint32_t, 8> state;
+  std::array<uint8_t, 64> block;
+  uint64_t size_InBytes;
+};
+
+namespace mbedtls::host {
+
+constexpr std::array<uint32_t, 64> const sha256RoundConstants = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+inline uint32_t rotateRight(uint32_t const value, uint32_t const count) {
+  return (value >> count) | (value << (32 - count));
+}
+
+inline void sha256Compress(std::array<uint32_t, 8> &state, uint8_t const *block) {
+  std::array<uint32_t, 64> words = {};
+
+  for (std::size_t i = 0; i < 16; ++i) {
+    words[i] = static_cast<uint32_t>(block[i * 4]) << 24 | static_cast<uint32_t>(block[i * 4 + 1]) << 16 | static_cast<uint32_t>(block[i * 4 + 2]) << 8 | block[i * 4 + 3];
+  }
+
+  for (std::size_t i = 16; i < 64; ++i) {
+    auto const sigma0 = rotateRight(words[i - 15], 7) ^ rotateRight(words[i - 15], 18) ^ (words[i - 15] >> 3);
+    auto const sigma1 = rotateRight(words[i - 2], 17) ^ rotateRight(words[i - 2], 19) ^ (words[i - 2] >> 10);
+    words[i] = words[i - 16] + sigma0 + words[i - 7] + sigma1;
+  }
+
+  auto [a, b, c, d, e, f, g, h] = state;
+
+  for (std::size_t i = 0; i < 64; ++i) {
+    auto const sum1 = rotateRight(e, 6) ^ rotateRight(e, 11) ^ rotateRight(e, 25);
+    auto const choice = (e & f) ^ (~e & g);
+    auto const temporary1 = h + sum1 + choice + sha256RoundConstants[i] + words[i];
+    auto const sum0 = rotateRight(a, 2) ^ rotateRight(a, 13) ^ rotateRight(a, 22);
+    auto const majority = (a & b) ^ (a & c) ^ (b & c);
+    auto const temporary2 = sum0 + majority;
+
+    h = g;
+    g = f;
+    f = e;
+    e = d + temporary1;
+    d = c;
+    c = b;
+    b = a;
+    a = temporary1 + temporary2;
+  }
+
+  state[0] += a;
+  state[1] += b;
+  state[2] += c;
+  state[3] += d;
+  state[4] += e;
+  state[5] += f;
+  state[6] += g;
+  state[7] += h;
+}
+
+}// namespace mbedtls::host
+
+inline void mbedtls_sha256_init(mbedtls_sha256_context *context) {
+  *context = {};
+}
+
+inline void mbedtls_sha256_free(mbedtls_sha256_context *context) {
+  *context = {};
+}
+
+inline int mbedtls_sha256_starts(mbedtls_sha256_context *context, int const is224) {
+  if (is224 != 0) {
+    return -1;
+  }
+
+  context->state = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+  context->size_InBytes = 0;
+
+  return 0;
+}
+
+inline int mbedtls_sha256_update(mbedtls_sha256_context *context, unsigned char const *input, std::size_t size) {
+  auto blockFill = static_cast<std::size_t>(context->size_InBytes % 64);
+  context->size_InBytes += size;
+
+  while (size > 0) {
+    auto const part = std::min(size, 64 - blockFill);
+    std::memcpy(context->block.data() + blockFill, input, part);
+
+    blockFill += part;
+    input += part;
+    size -= part;
+
+    if (blockFill == 64) {
+      mbedtls::host::sha256Compress(context->state, context->block.data());
+      blockFill = 0;
+    }
+  }
+
+  return 0;
+}
+
+inline int mbedtls_sha256_finish(mbedtls_sha256_context *context, unsigned char *output) {
+  auto const size_InBits = context->size_InBytes * 8;
+  auto const blockFill = static_cast<std::size_t>(context->size_InBytes % 64);
+
+  // A one bit, zeros up to 56 bytes into a block and the message length in bits, big endian
+  std::array<uint8_t, 72> padding = {0x80};
+  auto const paddingSize = (blockFill < 56 ? 56 : 120) - blockFill;
+
+  for (std::size_t i = 0; i < 8; ++i) {
+    padding[paddingSize + i] = static_cast<uint8_t>(size_InBits >> (56 - i * 8));
+  }
+
+  mbedtls_sha256_update(context, padding.data(), paddingSize + 8);
+
+  for (std::size_t i = 0; i < 8; ++i) {
+    output[i * 4] = static_cast<uint8_t>(context->state[i] >> 24);
+    output[i * 4 + 1] = static_cast<uint8_t>(context->state[i] >> 16);
+    output[i * 4 + 2] = static_cast<uint8_t>(context->state[i] >> 8);
+    output[i * 4 + 3] = static_cast<uint8_t>(context->state[i]);
+  }
+
+  return 0;
+}
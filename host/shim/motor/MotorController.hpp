@@ -0,0 +1,220 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <cmath>
+#include <chrono>
+#include <memory>
+#include <cstdint>
+#include <functional>
+
+#include "motor/driver/interface/IDriver.hpp"
+
+namespace motor {
+
+namespace host {
+
+using TimeFunction = std::function<uint64_t()>;
+
+inline TimeFunction &timeFunction() {
+  static thread_local TimeFunction function = [] {
+    auto const timeSinceEpoch = std::chrono::steady_clock::now().time_since_epoch();
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(timeSinceEpoch).count());
+  };
+  return function;
+}
+
+/**
+ * Simulations hand in their virtual clock so steps are timed against it, per thread so parallel runs keep their own
+ */
+inline void setTimeFunction(TimeFunction function) {
+  timeFunction() = std::move(function);
+}
+
+}// namespace host
+
+/**
+ * Host stand-in for the stepper component controller.
+ * Trapezoid profile in the microstep set by setMicrostep(), the speed is updated once per step from v^2 = v0^2 + 2a.
+ * It follows the interface of the component, not its exact timing, so results on the host are indicative only.
+ */
+class MotorController {
+public:
+  explicit MotorController(std::shared_ptr<driver::interface::IDriver> driver) : m_driver(std::move(driver)) {
+  }
+
+  ~MotorController() = default;
+
+public:
+  void setMicrostep(uint32_t const microstep) {
+    m_driver->setMicrostep(microstep);
+  }
+
+  void setSpeedInStepsPerSecond(float const speed) {
+    m_maximalSpeed = std::fabs(speed);
+  }
+
+  void setAccelerationInStepsPerSecondPerSecond(float const acceleration) {
+    m_acceleration = std::fabs(acceleration);
+  }
+
+  void setDecelerationInStepsPerSecondPerSecond(float const deceleration) {
+    m_deceleration = std::fabs(deceleration);
+  }
+
+  void setCurrentPositionInSteps(int32_t const position) {
+    m_position = position;
+    m_target = position;
+    m_velocity = 0;
+  }
+
+  void setTargetPositionInSteps(int32_t const position) {
+    m_target = position;
+  }
+
+  void setCurrentPositionAsHomeAndStop() {
+    setCurrentPositionInSteps(0);
+  }
+
+public:
+  [[nodiscard]] int32_t getCurrentPositionInSteps() const {
+    return m_position;
+  }
+
+  [[nodiscard]] int32_t getDistanceToTargetSigned() const {
+    return m_target - m_position;
+  }
+
+  [[nodiscard]] float getCurrentVelocityInStepsPerSecond() const {
+    return m_velocity;
+  }
+
+  [[nodiscard]] bool isHomed() const {
+    return m_position == 0 and m_velocity == 0;
+  }
+
+public:
+  /**
+   * Blocking move, the steps are issued back to back without pacing
+   */
+  void moveToPositionInSteps(int32_t const position) {
+    m_target = position;
+
+    while (m_position != m_target) {
+      step(m_target > m_position ? 1 : -1);
+    }
+
+    m_velocity = 0;
+  }
+
+  /**
+   * Issue at most one step, only when its time has come
+   */
+  void processMovement() {
+    auto const time_InUS = host::timeFunction()();
+
+    if (m_velocity != 0 and time_InUS - m_lastStepTime_InUS < m_stepInterval_InUS) {
+      return;
+    }
+
+    updateVelocity();
+    if (m_velocity == 0) {
+      return;
+    }
+
+    step(m_velocity > 0 ? 1 : -1);
+
+    m_lastStepTime_InUS = time_InUS;
+    m_stepInterval_InUS = static_cast<uint64_t>(1000000.0F / std::fabs(m_velocity));
+  }
+
+private:
+  void updateVelocity() {
+    auto const distance = m_target - m_position;
+    auto const speed = std::fabs(m_velocity);
+    auto const direction = distance > 0 ? 1.0F : -1.0F;
+
+    if (m_acceleration == 0 or m_deceleration == 0) {
+      m_velocity = distance == 0 ? 0 : direction * m_maximalSpeed;
+      return;
+    }
+
+    auto const stepsToStop = speed * speed / (2 * m_deceleration);
+
+    if (distance == 0 and stepsToStop <= 1) {
+      m_velocity = 0;
+      return;
+    }
+
+    if (speed == 0) {
+      m_velocity = direction * std::fmin(std::sqrt(2 * m_acceleration), m_maximalSpeed);
+      return;
+    }
+
+    // Moving away from the target, brake down to a stop before turning around.
+    // Less than one more step of braking stops at once, a tiny remainder would stretch the next step interval without bound.
+    if (distance == 0 or m_velocity * direction < 0) {
+      auto const brakedSpeedSquared = speed * speed - 2 * m_deceleration;
+      m_velocity = brakedSpeedSquared <= 2 * m_deceleration ? 0 : (m_velocity > 0 ? 1.0F : -1.0F) * std::sqrt(brakedSpeedSquared);
+      return;
+    }
+
+    // Too fast to stop in time, brake by one step worth of speed but keep closing in
+    if (stepsToStop >= static_cast<float>(std::abs(distance)) or speed > m_maximalSpeed) {
+      m_velocity = direction * std::sqrt(std::fmax(speed * speed - 2 * m_deceleration, 2 * m_deceleration));
+      return;
+    }
+
+    m_velocity = direction * std::fmin(std::sqrt(speed * speed + 2 * m_acceleration), m_maximalSpeed);
+  }
+
+  void step(int8_t const direction) {
+    if (direction != m_direction) {
+      m_direction = direction;
+      m_driver->setDirection(direction > 0 ? driver::MOTOR_ROTATE_CW : driver::MOTOR_ROTATE_CCW);
+    }
+
+    m_driver->stepUp();
+    m_driver->stepDown();
+
+    m_position += direction;
+  }
+
+private:
+  std::shared_ptr<driver::interface::IDriver> m_driver;
+
+private:
+  float m_maximalSpeed = 1000;
+  float m_acceleration = 0;
+  float m_deceleration = 0;
+
+private:
+  int32_t m_position = 0;
+  int32_t m_target = 0;
+  float m_velocity = 0;
+  int8_t m_direction = 0;
+
+private:
+  uint64_t m_lastStepTime_InUS = 0;
+  uint64_t m_stepInterval_InUS = 0;
+};
+
+}// namespace motor
+
+using MotorControllerPtr = std::unique_ptr<motor::MotorController>;
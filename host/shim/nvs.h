@@ -0,0 +1,99 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <cstdint>
+
+#include "esp_err.h"
+
+/**
+ * Host stand-in for NVS, namespaces live in memory for the lifetime of the process.
+ * A commit is not needed for reads, like on the target where the handle sees its own writes.
+ * Calls are serialized, so simulations on several threads can open their storage at the same time.
+ */
+using nvs_handle_t = uint32_t;
+
+enum nvs_open_mode_t {
+  NVS_READONLY = 0,
+  NVS_READWRITE
+};
+
+namespace nvs::host {
+
+inline std::map<std::string, std::map<std::string, uint32_t>> &storage() {
+  static std::map<std::string, std::map<std::string, uint32_t>> namespaces;
+  return namespaces;
+}
+
+inline std::map<nvs_handle_t, std::string> &handles() {
+  static std::map<nvs_handle_t, std::string> openHandles;
+  return openHandles;
+}
+
+inline std::mutex &mutex() {
+  static std::mutex storageMutex;
+  return storageMutex;
+}
+
+}// namespace nvs::host
+
+inline esp_err_t nvs_open(char const *nameSpace, nvs_open_mode_t, nvs_handle_t *handle) {
+  std::lock_guard<std::mutex> const lock(nvs::host::mutex());
+
+  static nvs_handle_t lastHandle = 0;
+
+  *handle = ++lastHandle;
+  nvs::host::handles()[*handle] = nameSpace;
+
+  return ESP_OK;
+}
+
+inline void nvs_close(nvs_handle_t const handle) {
+  std::lock_guard<std::mutex> const lock(nvs::host::mutex());
+
+  nvs::host::handles().erase(handle);
+}
+
+inline esp_err_t nvs_get_u32(nvs_handle_t const handle, char const *key, uint32_t *value) {
+  std::lock_guard<std::mutex> const lock(nvs::host::mutex());
+
+  auto &values = nvs::host::storage()[nvs::host::handles()[handle]];
+
+  auto const iterator = values.find(key);
+  if (iterator == values.end()) {
+    return ESP_ERR_NOT_FOUND;
+  }
+
+  *value = iterator->second;
+  return ESP_OK;
+}
+
+inline esp_err_t nvs_set_u32(nvs_handle_t const handle, char const *key, uint32_t const value) {
+  std::lock_guard<std::mutex> const lock(nvs::host::mutex());
+
+  nvs::host::storage()[nvs::host::handles()[handle]][key] = value;
+  return ESP_OK;
+}
+
+inline esp_err_t nvs_commit(nvs_handle_t) {
+  return ESP_OK;
+}
@@ -0,0 +1,200 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+constexpr double const lockUpSlip_InRPM = 30;
+
+struct EngineModelConfiguration {
+  // Closed throttle, warm and without load
+  double idleRevolutions_InRPM = 1050;
+  double maximalRevolutions_InRPM = 11000;
+
+  // Share of the full torque over the opening, 1 - exp(-(opening / scale)^shape), little air passes a nearly closed plate
+  double openingScale_InPercentage = 8;
+  double openingShape = 1.2;
+
+  // Free revving time constants, the engine spins up faster than it drops
+  double riseTime_InS = 0.15;
+  double fallTime_InS = 0.45;
+
+  // Throttle body following the commanded opening
+  double throttleRate_InPercentagePerSecond = 400;
+
+  // Engine revolutions per km/h in each gear, first gear first
+  std::array<double, 6> gearRatios_InRPMPerKPH = {125, 90, 72, 61, 54, 49};
+
+  // Vehicle acceleration at full torque and engine braking with the throttle closed, both in gear
+  double driveAcceleration_InKPHPerSecond = 12;
+  double engineBraking_InKPHPerSecond = 4;
+  double rollingDrag_InKPHPerSecond = 0.5;
+
+  // The engaged clutch holds far more than the engine makes, it pulls the engine to the road speed with this time constant
+  double clutchSlipTime_InS = 0.15;
+};
+
+/**
+ * Engine, throttle body, clutch and vehicle on the road, coarse enough to run seconds of riding in a millisecond.
+ * The engine settles to a free revving speed set by the opening with a first order lag, in gear it is tied to the road.
+ * Meant to check the closed loop behaviour of the controller on the host, not to predict absolute numbers.
+ */
+class EngineModel {
+public:
+  explicit EngineModel(EngineModelConfiguration const &configuration = {}) : m_configuration(configuration),
+                                                                              m_command_InPercentage(0),
+                                                                              m_throttle_InPercentage(0),
+                                                                              m_revolutions_InRPM(configuration.idleRevolutions_InRPM),
+                                                                              m_speed_InKilometersPerHour(0),
+                                                                              m_acceleration_InKilometersPerHourPerSecond(0),
+                                                                              m_gear(0),
+                                                                              m_isClutchEngaged(false),
+                                                                              m_brake_InKilometersPerHourPerSecond(0),
+                                                                              m_load_InRPM(0) {
+  }
+
+public:
+  [[nodiscard]] uint32_t getRevolutions_InRPM() const {
+    return static_cast<uint32_t>(std::lround(m_revolutions_InRPM));
+  }
+
+  [[nodiscard]] double getExactRevolutions_InRPM() const {
+    return m_revolutions_InRPM;
+  }
+
+  /**
+   * As the speedometer shows it, in whole km/h
+   */
+  [[nodiscard]] uint32_t getSpeed_InKilometersPerHour() const {
+    return static_cast<uint32_t>(m_speed_InKilometersPerHour);
+  }
+
+  [[nodiscard]] double getExactSpeed_InKilometersPerHour() const {
+    return m_speed_InKilometersPerHour;
+  }
+
+  [[nodiscard]] double getAcceleration_InKilometersPerHourPerSecond() const {
+    return m_acceleration_InKilometersPerHourPerSecond;
+  }
+
+  [[nodiscard]] double getThrottle_InPercentage() const {
+    return m_throttle_InPercentage;
+  }
+
+  [[nodiscard]] bool isClutchEngaged() const {
+    return m_isClutchEngaged;
+  }
+
+  /**
+   * Engine speed the selected gear asks for at the current road speed
+   */
+  [[nodiscard]] double getRoadRevolutions_InRPM() const {
+    if (m_gear == 0) {
+      return 0;
+    }
+
+    return m_speed_InKilometersPerHour * m_configuration.gearRatios_InRPMPerKPH[m_gear - 1];
+  }
+
+public:
+  void setOpening(double const openingInPercentage) {
+    m_command_InPercentage = std::clamp(openingInPercentage, 0.0, 100.0);
+  }
+
+  /**
+   * @param gear Zero is neutral
+   */
+  void setGear(uint32_t const gear) {
+    m_gear = std::min<uint32_t>(gear, m_configuration.gearRatios_InRPMPerKPH.size());
+  }
+
+  void setClutchEngaged(bool const isClutchEngaged) {
+    m_isClutchEngaged = isClutchEngaged;
+  }
+
+  void setSpeed(double const speedInKilometersPerHour) {
+    m_speed_InKilometersPerHour = speedInKilometersPerHour;
+  }
+
+  void setBrake(double const decelerationInKilometersPerHourPerSecond) {
+    m_brake_InKilometersPerHourPerSecond = decelerationInKilometersPerHourPerSecond;
+  }
+
+  /**
+   * Load on the crankshaft, as the drop of the free revving speed it causes
+   */
+  void setLoad(double const loadInRPM) {
+    m_load_InRPM = loadInRPM;
+  }
+
+public:
+  void advance(double const timeStepInS) {
+    auto const throttleStep = m_configuration.throttleRate_InPercentagePerSecond * timeStepInS;
+    m_throttle_InPercentage += std::clamp(m_command_InPercentage - m_throttle_InPercentage, -throttleStep, throttleStep);
+
+    auto const torque = 1.0 - std::exp(-std::pow(m_throttle_InPercentage / m_configuration.openingScale_InPercentage, m_configuration.openingShape));
+    auto const freeRevolutions_InRPM =
+        m_configuration.idleRevolutions_InRPM - m_load_InRPM + (m_configuration.maximalRevolutions_InRPM - m_configuration.idleRevolutions_InRPM) * torque;
+
+    auto const timeConstant_InS = freeRevolutions_InRPM > m_revolutions_InRPM ? m_configuration.riseTime_InS : m_configuration.fallTime_InS;
+
+    if (not m_isClutchEngaged or m_gear == 0) {
+      m_acceleration_InKilometersPerHourPerSecond = -m_configuration.rollingDrag_InKPHPerSecond - m_brake_InKilometersPerHourPerSecond;
+      m_revolutions_InRPM += (freeRevolutions_InRPM - m_revolutions_InRPM) * timeStepInS / timeConstant_InS;
+    } else {
+      auto const roadRevolutions_InRPM = getRoadRevolutions_InRPM();
+      auto const slip_InRPM = m_revolutions_InRPM - roadRevolutions_InRPM;
+
+      // The engine drives the bike while it runs faster than the road, engine braking only once the clutch locked up
+      auto const engineBraking = slip_InRPM > 0 ? 0.0 : m_configuration.engineBraking_InKPHPerSecond * (1.0 - torque);
+      m_acceleration_InKilometersPerHourPerSecond = m_configuration.driveAcceleration_InKPHPerSecond * torque - engineBraking - m_configuration.rollingDrag_InKPHPerSecond -
+                                                    m_brake_InKilometersPerHourPerSecond;
+
+      if (std::fabs(slip_InRPM) > lockUpSlip_InRPM) {
+        m_revolutions_InRPM -= slip_InRPM * timeStepInS / m_configuration.clutchSlipTime_InS;
+      }
+    }
+
+    m_speed_InKilometersPerHour = std::max(0.0, m_speed_InKilometersPerHour + m_acceleration_InKilometersPerHourPerSecond * timeStepInS);
+
+    // Locked up the engine turns with the wheel
+    if (m_isClutchEngaged and m_gear > 0 and std::fabs(m_revolutions_InRPM - getRoadRevolutions_InRPM()) <= lockUpSlip_InRPM) {
+      m_revolutions_InRPM = getRoadRevolutions_InRPM();
+    }
+
+    m_revolutions_InRPM = std::max(0.0, m_revolutions_InRPM);
+  }
+
+private:
+  EngineModelConfiguration m_configuration;
+
+private:
+  double m_command_InPercentage;
+  double m_throttle_InPercentage;
+  double m_revolutions_InRPM;
+  double m_speed_InKilometersPerHour;
+  double m_acceleration_InKilometersPerHourPerSecond;
+  uint32_t m_gear;
+  bool m_isClutchEngaged;
+  double m_brake_InKilometersPerHourPerSecond;
+  double m_load_InRPM;
+};
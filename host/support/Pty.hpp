@@ -0,0 +1,106 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <termios.h>
+
+#include "telemetry/interface/ITransport.hpp"
+
+/**
+ * Pseudo-terminal pair, the device side opens the slave path with PosixTransport and the test plays the host on the master
+ */
+class Pty {
+public:
+  Pty() : m_masterFileDescriptor(posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK)) {
+    if (m_masterFileDescriptor < 0) {
+      return;
+    }
+
+    if (grantpt(m_masterFileDescriptor) != 0 or unlockpt(m_masterFileDescriptor) != 0) {
+      close(m_masterFileDescriptor);
+      m_masterFileDescriptor = -1;
+    }
+  }
+
+  ~Pty() {
+    if (m_masterFileDescriptor >= 0) {
+      close(m_masterFileDescriptor);
+    }
+  }
+
+  Pty(Pty const &) = delete;
+  Pty &operator=(Pty const &) = delete;
+
+public:
+  [[nodiscard]] bool isOpen() const {
+    return m_masterFileDescriptor >= 0;
+  }
+
+  [[nodiscard]] int getFileDescriptor() const {
+    return m_masterFileDescriptor;
+  }
+
+  [[nodiscard]] char const *getSlavePath() const {
+    return isOpen() ? ptsname(m_masterFileDescriptor) : "";
+  }
+
+public:
+  std::size_t write(uint8_t const *data, std::size_t const size) const {
+    auto const numberOfBytes = ::write(m_masterFileDescriptor, data, size);
+    return numberOfBytes < 0 ? 0 : static_cast<std::size_t>(numberOfBytes);
+  }
+
+  std::size_t read(uint8_t *data, std::size_t const size) const {
+    auto const numberOfBytes = ::read(m_masterFileDescriptor, data, size);
+    return numberOfBytes < 0 ? 0 : static_cast<std::size_t>(numberOfBytes);
+  }
+
+public:
+  /**
+   * The master end as a transport, so a TelemetryLink can encode what the host sends. The pair has to outlive it.
+   */
+  [[nodiscard]] ITransportPtr createMasterTransport() const {
+    return std::make_unique<MasterTransport>(*this);
+  }
+
+private:
+  class MasterTransport : public ITransport {
+  public:
+    explicit MasterTransport(Pty const &pty) : m_pty(pty) {
+    }
+
+  public:
+    std::size_t write(uint8_t const *data, std::size_t const size) override {
+      return m_pty.write(data, size);
+    }
+
+    std::size_t read(uint8_t *data, std::size_t const size) override {
+      return m_pty.read(data, size);
+    }
+
+  private:
+    Pty const &m_pty;
+  };
+
+private:
+  int m_masterFileDescriptor;
+};
@@ -0,0 +1,60 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+/**
+ * splitmix64, the same sequence on every platform and standard library
+ */
+class Random {
+public:
+  explicit Random(uint64_t const seed) : m_state(seed) {
+  }
+
+public:
+  uint64_t next() {
+    m_state += 0x9E3779B97F4A7C15;
+
+    auto value = m_state;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EB;
+
+    return value ^ (value >> 31);
+  }
+
+  double uniform() {
+    return static_cast<double>(next() >> 11) * 0x1.0p-53;
+  }
+
+  double uniform(double const minimal, double const maximal) {
+    return minimal + (maximal - minimal) * uniform();
+  }
+
+  /**
+   * Irwin-Hall of four with unit variance, close enough to a gaussian for ADC noise
+   */
+  double normal() {
+    return (uniform() + uniform() + uniform() + uniform() - 2.0) * std::sqrt(3.0);
+  }
+
+private:
+  uint64_t m_state;
+};
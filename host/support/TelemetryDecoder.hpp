@@ -0,0 +1,107 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Host end of the TelemetryLink framing, splits a byte stream on the delimiters, COBS decodes and checks the CRC.
+ * Frames failing either are counted and dropped, decoding goes on with the next delimiter.
+ */
+class TelemetryDecoder {
+public:
+  TelemetryDecoder() : m_encoded(), m_decoded(), m_numberOfFrames(0), m_numberOfCorrupted(0) {
+  }
+
+public:
+  [[nodiscard]] uint32_t getNumberOfFrames() const {
+    return m_numberOfFrames;
+  }
+
+  [[nodiscard]] uint32_t getNumberOfCorrupted() const {
+    return m_numberOfCorrupted;
+  }
+
+public:
+  /**
+   * @param onFrame Called with the channel, the payload and its size for every frame that passed the CRC
+   */
+  template<typename FrameFunction>
+  void feed(uint8_t const *data, std::size_t const size, FrameFunction const &onFrame) {
+    for (std::size_t index = 0; index < size; ++index) {
+      if (data[index] != 0) {
+        m_encoded.push_back(data[index]);
+        continue;
+      }
+
+      if (decode()) {
+        m_numberOfFrames += 1;
+        onFrame(m_decoded[0], m_decoded.data() + 1, m_decoded.size() - 3);
+      } else {
+        m_numberOfCorrupted += 1;
+      }
+
+      m_encoded.clear();
+    }
+  }
+
+private:
+  bool decode() {
+    m_decoded.clear();
+
+    std::size_t position = 0;
+    while (position < m_encoded.size()) {
+      auto const code = m_encoded[position++];
+      if (position + code - 1 > m_encoded.size()) {
+        return false;
+      }
+
+      m_decoded.insert(m_decoded.end(), m_encoded.begin() + static_cast<std::ptrdiff_t>(position), m_encoded.begin() + static_cast<std::ptrdiff_t>(position + code - 1));
+      position += code - 1;
+
+      if (code != 0xFF and position < m_encoded.size()) {
+        m_decoded.push_back(0);
+      }
+    }
+
+    // Channel and CRC at least
+    if (m_decoded.size() < 3) {
+      return false;
+    }
+
+    uint16_t crc = 0xFFFF;
+    for (std::size_t index = 0; index + 2 < m_decoded.size(); ++index) {
+      crc ^= static_cast<uint16_t>(m_decoded[index] << 8);
+      for (uint32_t bit = 0; bit < 8; ++bit) {
+        crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+      }
+    }
+
+    auto const receivedCrc = static_cast<uint16_t>(m_decoded[m_decoded.size() - 2] | (m_decoded[m_decoded.size() - 1] << 8));
+    return crc == receivedCrc;
+  }
+
+private:
+  std::vector<uint8_t> m_encoded;
+  std::vector<uint8_t> m_decoded;
+  uint32_t m_numberOfFrames;
+  uint32_t m_numberOfCorrupted;
+};
@@ -0,0 +1,92 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include <cstdio>
+#include <cstring>
+
+#include "Test.hpp"
+#include "Random.hpp"
+#include "adc/AdcFrameReduction.hpp"
+
+// A few bytes past the largest frame, so sizes that are no multiple of a result or a block are covered too
+constexpr uint32_t const maximalSize_InBytes = adcMaximalFrameSize_InBytes + 7;
+constexpr uint32_t const numberOfRandomFrames = 20000;
+
+namespace {
+
+alignas(16) uint8_t buffer[maximalSize_InBytes + 16];
+
+bool isEqual(AdcFrameSum const &left, AdcFrameSum const &right) {
+  return left.sum == right.sum and left.numberOfValues == right.numberOfValues;
+}
+
+/**
+ * Random conversion results with the channel and unit bits set, so a missing mask shows up in the sum
+ */
+void fillRandom(Random &random) {
+  for (auto &byte : buffer) {
+    byte = static_cast<uint8_t>(random.next());
+  }
+}
+
+}// namespace
+
+int main() {
+  Random random(41);
+  uint32_t numberOfMismatches = 0;
+  uint32_t numberOfFrames = 0;
+
+  // Every size at every alignment within a block, the block split and the tail see every remainder
+  fillRandom(random);
+  for (uint32_t offset = 0; offset < 16; ++offset) {
+    for (uint32_t size = 0; size <= maximalSize_InBytes; ++size) {
+      auto const portable = adcReduceFramePortable(buffer + offset, size);
+      numberOfMismatches += isEqual(portable, adcReduceFrame(buffer + offset, size)) ? 0 : 1;
+      numberOfFrames += 1;
+    }
+  }
+
+  // Fresh data for each frame at the sizes the decimation hands out
+  for (uint32_t i = 0; i < numberOfRandomFrames; ++i) {
+    fillRandom(random);
+
+    auto const ratio = 1 + static_cast<uint32_t>(random.next() % adcMaximalOversamplingRatio);
+    auto const size = ratio * adcResultSize_InBytes;
+    auto const offset = (random.next() % 4 == 0) ? static_cast<uint32_t>(random.next() % 16) : 0;
+
+    auto const portable = adcReduceFramePortable(buffer + offset, size);
+    numberOfMismatches += isEqual(portable, adcReduceFrame(buffer + offset, size)) ? 0 : 1;
+    numberOfFrames += 1;
+  }
+
+  std::printf("adc reduction: %u frames, %u differ from the portable reduction\n", numberOfFrames, numberOfMismatches);
+  CHECK(numberOfMismatches == 0);
+
+  // The largest frame of full scale results, no lane may wrap
+  std::memset(buffer, 0xFF, sizeof(buffer));
+  auto const fullScale = adcReduceFrame(buffer, adcMaximalFrameSize_InBytes);
+  CHECK(fullScale.numberOfValues == adcMaximalOversamplingRatio);
+  CHECK(fullScale.sum == adcMaximalOversamplingRatio * adcResultDataMask);
+
+  // A frame too short for a single result is empty, not a division by zero later
+  auto const empty = adcReduceFrame(buffer, adcResultSize_InBytes - 1);
+  CHECK(empty.numberOfValues == 0);
+  CHECK(empty.sum == 0);
+
+  return test::finish();
+}
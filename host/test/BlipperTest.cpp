@@ -0,0 +1,132 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include "Test.hpp"
+#include "EngineRig.hpp"
+
+constexpr uint32_t const downshiftGear = 4;
+constexpr double const downshiftSpeed_InKilometersPerHour = 80;
+constexpr double const braking_InKilometersPerHourPerSecond = 15;
+constexpr uint32_t const brakingTime_InMS = 1000;
+
+// Clutch lever in, foot on the lever and out again
+constexpr uint32_t const clutchTime_InMS = 150;
+
+// From the clutch edge to the first opening, in control ticks
+constexpr uint32_t const maximalReactionTime_InMS = 5;
+
+// The blip aims at the lower gear with a tolerance, by the clutch out edge the engine already fell back somewhat
+constexpr uint32_t const maximalClosestMismatch_InRPM = 150;
+constexpr uint32_t const maximalBlippedMismatch_InRPM = 400;
+
+namespace {
+
+struct DownshiftResult {
+  uint32_t reactionTime_InMS;
+  uint32_t peakOpening_InPercentage;
+  uint32_t closestMismatch_InRPM;
+  int32_t mismatch_InRPM;
+};
+
+/**
+ * Braking in gear on a closed throttle, clutch in, one gear down and clutch out
+ * @return Mismatch is the engine RPM less the RPM the lower gear asks for on the clutch out edge, the closest one is over the whole shift
+ */
+DownshiftResult downshift(EngineRig &rig) {
+  rig.engine.setGear(downshiftGear);
+  rig.engine.setClutchEngaged(true);
+  rig.engine.setSpeed(downshiftSpeed_InKilometersPerHour);
+  rig.engine.setBrake(braking_InKilometersPerHourPerSecond);
+
+  rig.run(brakingTime_InMS, 0);
+
+  auto const openingBefore_InPercentage = rig.output_InPercentage;
+  auto const lowerGearRatio_InRPMPerKPH = EngineModelConfiguration{}.gearRatios_InRPMPerKPH[downshiftGear - 2];
+
+  DownshiftResult result = {clutchTime_InMS, 0, UINT32_MAX, 0};
+  rig.engine.setClutchEngaged(false);
+  for (uint32_t i = 0; i < clutchTime_InMS; ++i) {
+    rig.tick(0);
+
+    if (rig.output_InPercentage > openingBefore_InPercentage and result.reactionTime_InMS == clutchTime_InMS) {
+      result.reactionTime_InMS = i;
+    }
+
+    result.peakOpening_InPercentage = std::max(result.peakOpening_InPercentage, rig.output_InPercentage);
+
+    auto const lowerGearRevolutions_InRPM = rig.engine.getExactSpeed_InKilometersPerHour() * lowerGearRatio_InRPMPerKPH;
+    auto const mismatch_InRPM = static_cast<uint32_t>(std::fabs(rig.engine.getExactRevolutions_InRPM() - lowerGearRevolutions_InRPM));
+    result.closestMismatch_InRPM = std::min(result.closestMismatch_InRPM, mismatch_InRPM);
+  }
+
+  rig.engine.setGear(downshiftGear - 1);
+  result.mismatch_InRPM = static_cast<int32_t>(rig.engine.getExactRevolutions_InRPM() - rig.engine.getRoadRevolutions_InRPM());
+  rig.engine.setClutchEngaged(true);
+
+  return result;
+}
+
+}// namespace
+
+int main() {
+  EngineRig blippedRig;
+  auto const blipped = downshift(blippedRig);
+  std::printf("blipped downshift: first opening %u ms after the clutch edge, peak %u %%, closest %u RPM, %ld RPM off on the clutch out\n",
+              blipped.reactionTime_InMS, blipped.peakOpening_InPercentage, blipped.closestMismatch_InRPM, static_cast<long>(blipped.mismatch_InRPM));
+
+  EtcControllerParameters noBlipParameters = {};
+  noBlipParameters.blipper.minimumSpeed_InKilometersPerHour = UINT32_MAX;
+
+  EngineRig unblippedRig(noBlipParameters);
+  auto const unblipped = downshift(unblippedRig);
+  std::printf("unblipped downshift: %ld RPM off on the clutch out\n", static_cast<long>(unblipped.mismatch_InRPM));
+
+  CHECK(blipped.reactionTime_InMS <= maximalReactionTime_InMS);
+  CHECK(blipped.closestMismatch_InRPM <= maximalClosestMismatch_InRPM);
+  CHECK(static_cast<uint32_t>(std::abs(blipped.mismatch_InRPM)) <= maximalBlippedMismatch_InRPM);
+  CHECK(std::abs(blipped.mismatch_InRPM) * 2 < std::abs(unblipped.mismatch_InRPM));
+
+  // A steady closed throttle roll with the clutch pulled is no downshift
+  EngineModelConfiguration rollConfiguration = {};
+  rollConfiguration.engineBraking_InKPHPerSecond = 0;
+  rollConfiguration.rollingDrag_InKPHPerSecond = 0;
+
+  EngineRig rollRig({}, rollConfiguration);
+  rollRig.engine.setGear(downshiftGear);
+  rollRig.engine.setClutchEngaged(true);
+  rollRig.engine.setSpeed(downshiftSpeed_InKilometersPerHour);
+  rollRig.run(brakingTime_InMS, 0);
+
+  auto const rollOpening_InPercentage = rollRig.output_InPercentage;
+  uint32_t rollPeakOpening_InPercentage = 0;
+  rollRig.engine.setClutchEngaged(false);
+  for (uint32_t i = 0; i < clutchTime_InMS; ++i) {
+    rollRig.tick(0);
+    rollPeakOpening_InPercentage = std::max(rollPeakOpening_InPercentage, rollRig.output_InPercentage);
+  }
+
+  std::printf("steady roll: peak %u %% with the clutch pulled\n", rollPeakOpening_InPercentage);
+  CHECK(rollPeakOpening_InPercentage <= rollOpening_InPercentage);
+
+  return test::finish();
+}
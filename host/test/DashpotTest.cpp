@@ -0,0 +1,155 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include "Test.hpp"
+#include "EngineRig.hpp"
+
+// Warm engine on the idle screw alone runs a little below the idle control target
+constexpr double const screwIdle_InRPM = 1100;
+
+constexpr uint32_t const revvingPedal_InPercentage = 30;
+constexpr uint32_t const revvingTime_InMS = 2000;
+constexpr uint32_t const observationTime_InMS = 4000;
+
+// Rolling on in second gear before shutting the throttle
+constexpr uint32_t const overrunGear = 2;
+constexpr double const overrunSpeed_InKilometersPerHour = 50;
+constexpr uint32_t const overrunPedal_InPercentage = 20;
+
+constexpr double const takenUpShare = 0.9;
+
+constexpr uint32_t const minimalClosingTime_InMS = 100;
+constexpr uint32_t const maximalClosingTime_InMS = 1000;
+constexpr double const maximalIdleDip_InRPM = 150;
+constexpr uint32_t const minimalTakeUpGain = 10;
+constexpr uint32_t const maximalTakeUpTime_InMS = 500;
+
+namespace {
+
+struct SnapShutResult {
+  uint32_t closingTime_InMS;
+  double lowest_InRPM;
+  uint32_t takeUpTime_InMS;
+};
+
+/**
+ * Pedal held, then snapped shut
+ * @return Closing time is until the output is fully closed or the idle offset took over.
+ * Take up is from the engine starting to hold the bike back until it holds it back nearly fully, the driveline slack closes over it
+ */
+SnapShutResult snapShut(EngineRig &rig, uint32_t const pedalInPercentage) {
+  rig.run(revvingTime_InMS, pedalInPercentage);
+
+  std::vector<double> accelerations_InKilometersPerHourPerSecond(observationTime_InMS);
+  SnapShutResult result = {observationTime_InMS, rig.engine.getExactRevolutions_InRPM(), 0};
+
+  auto lastOutput_InPercentage = rig.output_InPercentage;
+
+  for (uint32_t i = 0; i < observationTime_InMS; ++i) {
+    rig.tick(0);
+
+    result.lowest_InRPM = std::min(result.lowest_InRPM, rig.engine.getExactRevolutions_InRPM());
+    accelerations_InKilometersPerHourPerSecond[i] = rig.engine.getAcceleration_InKilometersPerHourPerSecond();
+
+    auto const isClosed = rig.output_InPercentage == 0 or rig.output_InPercentage > lastOutput_InPercentage;
+    if (isClosed and result.closingTime_InMS == observationTime_InMS) {
+      result.closingTime_InMS = i;
+    }
+
+    lastOutput_InPercentage = rig.output_InPercentage;
+  }
+
+  auto const overrun_InKilometersPerHourPerSecond = accelerations_InKilometersPerHourPerSecond.back();
+  if (overrun_InKilometersPerHourPerSecond < 0) {
+    auto const reversal = std::find_if(accelerations_InKilometersPerHourPerSecond.begin(), accelerations_InKilometersPerHourPerSecond.end(), [](double const acceleration) {
+      return acceleration < 0;
+    });
+    auto const takenUp = std::find_if(reversal, accelerations_InKilometersPerHourPerSecond.end(), [overrun_InKilometersPerHourPerSecond](double const acceleration) {
+      return acceleration <= takenUpShare * overrun_InKilometersPerHourPerSecond;
+    });
+
+    result.takeUpTime_InMS = static_cast<uint32_t>(takenUp - reversal);
+  }
+
+  return result;
+}
+
+EtcControllerParameters withoutDashpot() {
+  EtcControllerParameters parameters = {};
+
+  for (auto &row : parameters.dashpot.catchOpening_InPercentage) {
+    row.fill(0);
+  }
+  for (auto &row : parameters.dashpot.closingRate_InPercentagePerSecond) {
+    row.fill(UINT16_MAX);
+  }
+
+  return parameters;
+}
+
+}// namespace
+
+int main() {
+  EngineModelConfiguration engineConfiguration = {};
+  engineConfiguration.idleRevolutions_InRPM = screwIdle_InRPM;
+
+  // Revving in neutral and letting go, the engine has to settle into idle without dropping far below it
+  EngineRig neutralRig({}, engineConfiguration);
+  auto const neutral = snapShut(neutralRig, revvingPedal_InPercentage);
+
+  EngineRig neutralBareRig(withoutDashpot(), engineConfiguration);
+  auto const neutralBare = snapShut(neutralBareRig, revvingPedal_InPercentage);
+
+  std::printf("neutral snap shut: closed after %u ms, %.0f RPM lowest, without the dashpot %u ms and %.0f RPM\n", neutral.closingTime_InMS, neutral.lowest_InRPM,
+              neutralBare.closingTime_InMS, neutralBare.lowest_InRPM);
+
+  // Rolling on in gear and letting go, the driveline has to take up the overrun gently
+  EngineRig overrunRig({}, engineConfiguration);
+  overrunRig.engine.setGear(overrunGear);
+  overrunRig.engine.setClutchEngaged(true);
+  overrunRig.engine.setSpeed(overrunSpeed_InKilometersPerHour);
+  auto const overrun = snapShut(overrunRig, overrunPedal_InPercentage);
+
+  EngineRig overrunBareRig(withoutDashpot(), engineConfiguration);
+  overrunBareRig.engine.setGear(overrunGear);
+  overrunBareRig.engine.setClutchEngaged(true);
+  overrunBareRig.engine.setSpeed(overrunSpeed_InKilometersPerHour);
+  auto const overrunBare = snapShut(overrunBareRig, overrunPedal_InPercentage);
+
+  std::printf("overrun snap shut: closed after %u ms, taken up over %u ms, without the dashpot %u ms and %u ms\n", overrun.closingTime_InMS, overrun.takeUpTime_InMS,
+              overrunBare.closingTime_InMS, overrunBare.takeUpTime_InMS);
+
+  auto const idleTarget_InRPM = static_cast<double>(EtcControllerParameters{}.idleControl.targetRevolutions_InRPM);
+  CHECK(neutral.closingTime_InMS >= minimalClosingTime_InMS);
+  CHECK(neutral.closingTime_InMS <= maximalClosingTime_InMS);
+  CHECK(neutral.lowest_InRPM + maximalIdleDip_InRPM >= idleTarget_InRPM);
+
+  CHECK(overrun.takeUpTime_InMS >= overrunBare.takeUpTime_InMS * minimalTakeUpGain);
+  CHECK(overrun.takeUpTime_InMS <= maximalTakeUpTime_InMS);
+
+  // Opening is never shaped, the output follows the pedal on the same tick as without the dashpot
+  neutralRig.tick(revvingPedal_InPercentage);
+  neutralBareRig.tick(revvingPedal_InPercentage);
+  CHECK(neutralRig.output_InPercentage == neutralBareRig.output_InPercentage);
+
+  return test::finish();
+}
@@ -0,0 +1,71 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <memory>
+#include <cstdint>
+
+#include "EngineModel.hpp"
+#include "EtcController.hpp"
+#include "clock/VirtualClock.hpp"
+
+constexpr uint32_t const engineRigTick_InUS = 1000;
+
+/**
+ * Controller closed over the engine model, one tick hands the vehicle state in as the nodes do and moves both on by a millisecond.
+ * The motor is taken as ideal, the model's throttle body follows the commanded opening at its own rate.
+ */
+struct EngineRig {
+  explicit EngineRig(EtcControllerParameters const &parameters = {}, EngineModelConfiguration const &configuration = {}) :
+      clock(std::make_shared<VirtualClock>(1000000)),
+      etcController(std::make_shared<EtcController>(clock)),
+      engine(configuration),
+      output_InPercentage(0) {
+    etcController->setParameters(parameters);
+    etcController->registerChangeValueCallback([this](uint32_t const value, TraceTag) {
+      output_InPercentage = value;
+      engine.setOpening(value);
+    });
+  }
+
+  EngineRig(EngineRig const &) = delete;
+  EngineRig &operator=(EngineRig const &) = delete;
+
+  void tick(uint32_t const pedalInPercentage) {
+    etcController->setVehicleRPM(engine.getRevolutions_InRPM());
+    etcController->setVehicleSpeed(engine.getSpeed_InKilometersPerHour());
+    etcController->setVehicleClutchState(engine.isClutchEngaged());
+    etcController->setAcceleratorValue(pedalInPercentage);
+    etcController->spinOnce();
+
+    clock->advance(engineRigTick_InUS);
+    engine.advance(engineRigTick_InUS / 1e6);
+  }
+
+  void run(uint32_t const durationInMS, uint32_t const pedalInPercentage) {
+    for (uint32_t i = 0; i < durationInMS * 1000 / engineRigTick_InUS; ++i) {
+      tick(pedalInPercentage);
+    }
+  }
+
+  VirtualClockPtr clock;
+  std::shared_ptr<EtcController> etcController;
+  EngineModel engine;
+  uint32_t output_InPercentage;
+};
@@ -0,0 +1,163 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include <cmath>
+#include <vector>
+#include <cstdio>
+#include <functional>
+
+#include "Test.hpp"
+#include "Random.hpp"
+#include "filter/AdaptiveFilter.hpp"
+#include "filter/BoxcarFilter.hpp"
+#include "filter/KalmanFilter.hpp"
+#include "filter/MedianFilter.hpp"
+#include "profile/RidingProfile.hpp"
+
+// One filter input per ADC frame at the default control rate
+constexpr uint32_t const samplePeriod_InUS = 1000;
+
+constexpr int32_t const restVoltage_InMillivolts = 1000;
+constexpr int32_t const pressedVoltage_InMillivolts = 1800;
+constexpr double const noise_InMillivolts = 6;
+
+constexpr uint32_t const numberOfNoiseSamples = 5000;
+constexpr uint32_t const numberOfSettleSamples = 1000;
+constexpr uint32_t const numberOfStepSamples = 2000;
+constexpr uint32_t const numberOfRampSamples = 3000;
+constexpr int32_t const rampSlope_InMillivoltsPerSample = 2;
+
+namespace {
+
+struct FilterCase {
+  char const *name;
+  std::function<IFilterPtr()> makeFilter;
+};
+
+struct FilterFigures {
+  double inputNoise_InMillivolts;
+  double outputNoise_InMillivolts;
+  double rampLag_InSamples;
+  uint32_t stepHalfLatency_InSamples;
+  uint32_t stepSettleLatency_InSamples;
+};
+
+/**
+ * Output noise on a resting pedal, after the filter settled
+ */
+void measureNoise(IFilter &filter, FilterFigures &figures) {
+  Random random(1);
+  filter.reset(restVoltage_InMillivolts);
+
+  double inputSquares = 0;
+  double outputSquares = 0;
+  uint32_t numberOfOutputs = 0;
+
+  for (uint32_t i = 0; i < numberOfNoiseSamples; ++i) {
+    auto const noise = noise_InMillivolts * random.normal();
+    inputSquares += noise * noise;
+
+    int32_t output = 0;
+    if (filter.process(restVoltage_InMillivolts + static_cast<int32_t>(std::lround(noise)), output) and i >= numberOfSettleSamples) {
+      auto const error = static_cast<double>(output - restVoltage_InMillivolts);
+      outputSquares += error * error;
+      numberOfOutputs += 1;
+    }
+  }
+
+  figures.inputNoise_InMillivolts = std::sqrt(inputSquares / numberOfNoiseSamples);
+  figures.outputNoise_InMillivolts = std::sqrt(outputSquares / numberOfOutputs);
+}
+
+/**
+ * Samples from a clean step until the output passed half and 90 % of it
+ */
+void measureStep(IFilter &filter, FilterFigures &figures) {
+  filter.reset(restVoltage_InMillivolts);
+
+  auto const stepHeight = pressedVoltage_InMillivolts - restVoltage_InMillivolts;
+  figures.stepHalfLatency_InSamples = numberOfStepSamples;
+  figures.stepSettleLatency_InSamples = numberOfStepSamples;
+
+  for (uint32_t i = 0; i < numberOfStepSamples; ++i) {
+    int32_t output = 0;
+    if (not filter.process(pressedVoltage_InMillivolts, output)) {
+      continue;
+    }
+
+    if (output - restVoltage_InMillivolts >= stepHeight / 2 and figures.stepHalfLatency_InSamples == numberOfStepSamples) {
+      figures.stepHalfLatency_InSamples = i;
+    }
+    if (output - restVoltage_InMillivolts >= stepHeight * 9 / 10) {
+      figures.stepSettleLatency_InSamples = i;
+      break;
+    }
+  }
+}
+
+/**
+ * Lag behind a clean constant rate ramp once the filter followed it for a while, this is what the group delay describes
+ */
+void measureRamp(IFilter &filter, FilterFigures &figures) {
+  filter.reset(0);
+
+  figures.rampLag_InSamples = 0;
+
+  for (uint32_t i = 0; i < numberOfRampSamples; ++i) {
+    auto const input = static_cast<int32_t>(i) * rampSlope_InMillivoltsPerSample;
+
+    int32_t output = 0;
+    if (filter.process(input, output)) {
+      figures.rampLag_InSamples = static_cast<double>(input - output) / rampSlope_InMillivoltsPerSample;
+    }
+  }
+}
+
+}// namespace
+
+int main() {
+  std::vector<FilterCase> const filterCases = {
+      {"boxcar 4", []() { return std::make_unique<BoxcarFilter>(4); }},
+      {"median 5", []() { return std::make_unique<MedianFilter>(5); }},
+      {"kalman", []() { return std::make_unique<KalmanFilter>(); }},
+      {"adaptive soft", []() { return std::make_unique<AdaptiveFilter>(samplePeriod_InUS, defaultRidingProfiles[0].filterMinCutoff_InMilliHertz, defaultRidingProfiles[0].filterBeta); }},
+      {"adaptive road", []() { return std::make_unique<AdaptiveFilter>(samplePeriod_InUS, defaultRidingProfiles[1].filterMinCutoff_InMilliHertz, defaultRidingProfiles[1].filterBeta); }},
+      {"adaptive sport", []() { return std::make_unique<AdaptiveFilter>(samplePeriod_InUS, defaultRidingProfiles[2].filterMinCutoff_InMilliHertz, defaultRidingProfiles[2].filterBeta); }},
+  };
+
+  std::printf("%-16s %12s %12s %12s %12s %12s %12s\n", "filter", "delay", "ramp lag", "step 50%", "step 90%", "noise in", "noise out");
+
+  for (auto const &filterCase : filterCases) {
+    auto const filter = filterCase.makeFilter();
+
+    FilterFigures figures = {};
+    measureNoise(*filter, figures);
+    measureStep(*filter, figures);
+    measureRamp(*filter, figures);
+
+    std::printf("%-16s %12.1f %12.1f %12u %12u %12.2f %12.2f\n", filterCase.name, filter->getGroupDelay(), figures.rampLag_InSamples,
+                figures.stepHalfLatency_InSamples, figures.stepSettleLatency_InSamples, figures.inputNoise_InMillivolts, figures.outputNoise_InMillivolts);
+
+    // Every stage has to earn its delay, and the reported group delay has to cover the lag it really has
+    CHECK(figures.outputNoise_InMillivolts < figures.inputNoise_InMillivolts);
+    CHECK(figures.rampLag_InSamples <= filter->getGroupDelay() + 1);
+    CHECK(figures.stepSettleLatency_InSamples < numberOfStepSamples);
+  }
+
+  return test::finish();
+}
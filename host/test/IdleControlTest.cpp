@@ -0,0 +1,115 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <numeric>
+#include <vector>
+
+#include "Test.hpp"
+#include "EngineRig.hpp"
+
+// Warm engine on the idle screw alone runs a little below the target
+constexpr double const screwIdle_InRPM = 1100;
+constexpr double const loadStep_InRPM = 500;
+
+constexpr uint32_t const settleTime_InMS = 3000;
+constexpr uint32_t const observationTime_InMS = 6000;
+
+constexpr double const maximalSag_InRPM = 300;
+constexpr double const recoveredBand_InRPM = 50;
+constexpr uint32_t const maximalRecoveryTime_InMS = 1500;
+
+// The output is in whole percent, near closed one percent is a few hundred RPM and the loop dithers between two openings.
+// Idle holds on average over the last seconds, the dither is reported.
+constexpr uint32_t const averageTime_InMS = 3000;
+constexpr uint32_t const ditherWindow_InMS = 200;
+constexpr double const averageBand_InRPM = 100;
+
+namespace {
+
+struct LoadStepResult {
+  double lowest_InRPM;
+  uint32_t recoveryTime_InMS;
+  double average_InRPM;
+  double ditherLowest_InRPM;
+  double ditherHighest_InRPM;
+};
+
+/**
+ * Idling in neutral until settled, then a load step on the crankshaft
+ * @return Recovery is the time from the step until the RPM came back near the target from its lowest point, the average and the dither are over the last seconds
+ */
+LoadStepResult loadStep(EngineRig &rig, double const targetInRPM) {
+  rig.run(settleTime_InMS, 0);
+  rig.engine.setLoad(loadStep_InRPM);
+
+  std::vector<double> revolutions_InRPM(observationTime_InMS);
+  for (auto &revolution_InRPM : revolutions_InRPM) {
+    rig.tick(0);
+    revolution_InRPM = rig.engine.getExactRevolutions_InRPM();
+  }
+
+  auto const averageStart = revolutions_InRPM.end() - averageTime_InMS;
+  auto const lowest = std::min_element(revolutions_InRPM.begin(), averageStart);
+  auto const recovered = std::find_if(lowest, revolutions_InRPM.end(), [targetInRPM](double const revolution_InRPM) {
+    return revolution_InRPM + recoveredBand_InRPM >= targetInRPM;
+  });
+
+  LoadStepResult result = {*lowest, static_cast<uint32_t>(recovered - revolutions_InRPM.begin()), 0, targetInRPM * 10, 0};
+
+  for (auto window = averageStart; window != revolutions_InRPM.end(); window += ditherWindow_InMS) {
+    auto const windowAverage_InRPM = std::accumulate(window, window + ditherWindow_InMS, 0.0) / ditherWindow_InMS;
+    result.ditherLowest_InRPM = std::min(result.ditherLowest_InRPM, windowAverage_InRPM);
+    result.ditherHighest_InRPM = std::max(result.ditherHighest_InRPM, windowAverage_InRPM);
+  }
+
+  result.average_InRPM = std::accumulate(averageStart, revolutions_InRPM.end(), 0.0) / averageTime_InMS;
+  return result;
+}
+
+}// namespace
+
+int main() {
+  EngineModelConfiguration engineConfiguration = {};
+  engineConfiguration.idleRevolutions_InRPM = screwIdle_InRPM;
+
+  EtcControllerParameters parameters = {};
+  auto const target_InRPM = static_cast<double>(parameters.idleControl.targetRevolutions_InRPM);
+
+  EngineRig rig(parameters, engineConfiguration);
+  auto const controlled = loadStep(rig, target_InRPM);
+  std::printf("idle control: %.0f RPM lowest after a %.0f RPM load step, within %.0f RPM after %u ms, %.0f RPM on average dithering %.0f..%.0f RPM\n",
+              controlled.lowest_InRPM, loadStep_InRPM, recoveredBand_InRPM, controlled.recoveryTime_InMS, controlled.average_InRPM, controlled.ditherLowest_InRPM,
+              controlled.ditherHighest_InRPM);
+
+  EtcControllerParameters screwParameters = {};
+  screwParameters.idleControl.maximalOffset_InPercentage = 0;
+
+  EngineRig screwRig(screwParameters, engineConfiguration);
+  auto const screw = loadStep(screwRig, target_InRPM);
+  std::printf("idle screw: %.0f RPM lowest, %.0f RPM on average\n", screw.lowest_InRPM, screw.average_InRPM);
+
+  CHECK(target_InRPM - controlled.lowest_InRPM <= maximalSag_InRPM);
+  CHECK(controlled.recoveryTime_InMS <= maximalRecoveryTime_InMS);
+  CHECK(std::fabs(controlled.average_InRPM - target_InRPM) <= averageBand_InRPM);
+  CHECK(std::fabs(screw.average_InRPM - target_InRPM) > averageBand_InRPM);
+
+  return test::finish();
+}
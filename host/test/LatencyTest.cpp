@@ -0,0 +1,240 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "Test.hpp"
+#include "Random.hpp"
+#include "Accelerator.hpp"
+#include "EtcController.hpp"
+#include "adc/AdcFrameReduction.hpp"
+#include "clock/VirtualClock.hpp"
+#include "runtime/Mailbox.hpp"
+#include "stepper/MotorBridge.hpp"
+#include "stepper/MotorController.hpp"
+#include "trace/LatencyReporter.hpp"
+
+// Motor set up as in main.cpp
+constexpr uint32_t const motorMinimalSpeed = 500;
+constexpr uint32_t const motorMaximalSpeed = 4000;
+constexpr uint32_t const motorMaximalSteps = 500;
+constexpr uint32_t const motorDefaultSpeed = 1500;
+constexpr uint32_t const motorDefaultAcceleration = 15000;
+constexpr uint32_t const motorDefaultDeceleration = 30000;
+
+// The control nodes run once per tick, the motion nodes in between at these periods
+constexpr uint32_t const controlPeriod_InUS = 1000;
+constexpr uint32_t const motorPeriod_InUS = 20;
+constexpr uint32_t const bridgePeriod_InUS = 100;
+
+constexpr uint32_t const frameSize_InResults = 64;
+constexpr uint32_t const frameSize_InBytes = frameSize_InResults * adcResultSize_InBytes;
+
+// Pedal travel the Accelerator assumes without a stored calibration, and the full scale of the host ADC conversion
+constexpr uint32_t const pedalMinimalVoltage_InMillivolts = 1000;
+constexpr uint32_t const pedalMaximalVoltage_InMillivolts = 2500;
+constexpr uint32_t const adcFullScale_InMillivolts = 3100;
+constexpr double const pedalNoise_InMillivolts = 6;
+
+// Reported once a second like on the unit
+constexpr uint32_t const reportPeriod_InMS = 1000;
+constexpr uint32_t const numberOfWindows = 10;
+
+// The motion path stalls for this long in one window, a stand-in for a regression in it
+constexpr uint32_t const regressionWindow = 4;
+constexpr uint32_t const regressionBridgePeriod_InUS = 5000;
+
+// Gate on the frame to step latency of every window.
+// A sleeping driver takes its 2 ms wake time first, the first step then comes at the start speed, up to 2 ms at the minimal one.
+constexpr uint32_t const maximalP99_InUS = 4500;
+
+namespace {
+
+/**
+ * Pedal ramps and holds like the autotune scenarios, one value per tick
+ */
+std::vector<double> makePedal(uint64_t const seed, uint32_t const durationInMS) {
+  Random random(seed);
+  std::vector<double> pedal_InPercentage;
+  double currentPedal_InPercentage = 0;
+
+  while (pedal_InPercentage.size() < durationInMS) {
+    auto const holdTime_InMS = static_cast<uint32_t>(random.uniform(20, 300));
+    pedal_InPercentage.insert(pedal_InPercentage.end(), holdTime_InMS, currentPedal_InPercentage);
+
+    auto const targetPedal_InPercentage = random.uniform(0, 100);
+    auto const rampTime_InMS = random.uniform() < 0.3 ? 1 : static_cast<uint32_t>(random.uniform(30, 400));
+
+    for (uint32_t i = 1; i <= rampTime_InMS; ++i) {
+      pedal_InPercentage.push_back(currentPedal_InPercentage + (targetPedal_InPercentage - currentPedal_InPercentage) * i / rampTime_InMS);
+    }
+
+    currentPedal_InPercentage = targetPedal_InPercentage;
+  }
+
+  pedal_InPercentage.resize(durationInMS);
+  return pedal_InPercentage;
+}
+
+void makeFrame(Random &random, double const pedalInPercentage, uint8_t *frame) {
+  auto const voltage_InMillivolts = pedalMinimalVoltage_InMillivolts + pedalInPercentage * (pedalMaximalVoltage_InMillivolts - pedalMinimalVoltage_InMillivolts) / 100;
+
+  for (uint32_t i = 0; i < frameSize_InResults; ++i) {
+    auto const noisyVoltage_InMillivolts = voltage_InMillivolts + pedalNoise_InMillivolts * random.normal();
+    auto const rawData = std::clamp<long>(std::lround(noisyVoltage_InMillivolts * adcResultDataMask / adcFullScale_InMillivolts), 0, adcResultDataMask);
+
+    // Channel bits above the data field like on the target
+    uint32_t const word = (3 << 13) | static_cast<uint32_t>(rawData);
+    std::memcpy(frame + i * adcResultSize_InBytes, &word, sizeof(word));
+  }
+}
+
+/**
+ * Tagged frames through Accelerator, EtcController, MotorBridge and MotorController on a virtual clock,
+ * with the histogram and its reporter wired as in main.cpp
+ * @return Summary of every report window
+ */
+std::vector<LatencySummary> ride(uint32_t const slowWindow) {
+  auto clock = std::make_shared<VirtualClock>();
+  motor::host::setTimeFunction([clock]() {
+    return clock->getTime_InUS();
+  });
+
+  auto latencyHistogram = std::make_shared<LatencyHistogram>();
+  auto latencyReporter = std::make_shared<LatencyReporter>(latencyHistogram);
+
+  std::vector<LatencySummary> summaries;
+  latencyReporter->registerReportCallback([&summaries](LatencySummary const &summary) {
+    summaries.push_back(summary);
+  });
+
+  auto motorController = std::make_shared<MotorController>(motorMinimalSpeed, motorMaximalSpeed, motorMaximalSteps, clock);
+  motorController->setSpeed(motorDefaultSpeed);
+  motorController->setAcceleration(motorDefaultAcceleration);
+  motorController->setDeceleration(motorDefaultDeceleration);
+  motorController->setLatencyHistogram(latencyHistogram);
+  motorController->moveToHome();
+
+  auto motorSetpointMailbox = std::make_shared<Mailbox<MotorSetpoint>>();
+  auto motorStatusMailbox = std::make_shared<Mailbox<MotorStatus>>();
+  auto motorBridge = std::make_shared<MotorBridge>(motorController, motorSetpointMailbox, motorStatusMailbox, clock);
+
+  MotorSetpoint motorSetpoint = {
+      .position = 0,
+      .speed = motorDefaultSpeed,
+      .wakeRequest = 0,
+      .sleepRequest = 0,
+      .trace = {},
+  };
+
+  auto etcController = std::make_shared<EtcController>(clock);
+  etcController->setVehicleRPM(4000);
+  etcController->setVehicleSpeed(60);
+  etcController->registerChangeValueCallback([&](uint32_t const motorPosition, TraceTag const traceTag) {
+    motorSetpoint.position = motorPosition;
+    motorSetpoint.trace = traceTag;
+    motorSetpointMailbox->write(motorSetpoint);
+  });
+
+  auto accelerator = std::make_shared<Accelerator>(1000000 / controlPeriod_InUS, frameSize_InResults, clock);
+  accelerator->registerChangeAccelerateCallback([&](uint32_t const acceleratorValue_InPercentage, TraceTag const traceTag) {
+    etcController->setAcceleratorValue(acceleratorValue_InPercentage, traceTag);
+  });
+
+  Random random(5);
+  auto const pedal_InPercentage = makePedal(3, numberOfWindows * reportPeriod_InMS);
+  std::vector<uint8_t> frame(frameSize_InBytes);
+
+  for (uint32_t tick = 0; tick < pedal_InPercentage.size(); ++tick) {
+    auto const time_InUS = static_cast<uint64_t>(tick) * controlPeriod_InUS;
+    clock->setTime(time_InUS);
+
+    makeFrame(random, pedal_InPercentage[tick], frame.data());
+    accelerator->processFrame(frame.data(), frameSize_InBytes, {tick + 1, time_InUS});
+    etcController->spinOnce();
+
+    auto const window = tick / reportPeriod_InMS;
+    auto const period_InUS = window == slowWindow ? regressionBridgePeriod_InUS : bridgePeriod_InUS;
+
+    for (uint32_t offset_InUS = 0; offset_InUS < controlPeriod_InUS; offset_InUS += motorPeriod_InUS) {
+      clock->setTime(time_InUS + offset_InUS);
+
+      if ((time_InUS + offset_InUS) % period_InUS == 0) {
+        motorBridge->spinOnce();
+      }
+      motorController->spinOnce();
+    }
+
+    if ((tick + 1) % reportPeriod_InMS == 0) {
+      latencyReporter->spinOnce();
+    }
+  }
+
+  return summaries;
+}
+
+void printSummaries(char const *name, std::vector<LatencySummary> const &summaries) {
+  for (std::size_t i = 0; i < summaries.size(); ++i) {
+    auto const &summary = summaries[i];
+    std::printf("%s window %lu: %u samples, p50 %u us, p99 %u us, max %u us\n", name, static_cast<unsigned long>(i), summary.numberOfSamples, summary.p50_InUS,
+                summary.p99_InUS, summary.maximum_InUS);
+  }
+}
+
+/**
+ * Every window of the healthy chain stays under the gate
+ */
+void testGate() {
+  auto const summaries = ride(numberOfWindows);
+  printSummaries("healthy", summaries);
+
+  CHECK(summaries.size() == numberOfWindows);
+  for (auto const &summary : summaries) {
+    CHECK(summary.numberOfSamples > 0);
+    CHECK(summary.p99_InUS <= maximalP99_InUS);
+  }
+}
+
+/**
+ * A regression fails the gate in its own window, the windows after it are clean again
+ */
+void testRegression() {
+  auto const summaries = ride(regressionWindow);
+  printSummaries("regressed", summaries);
+
+  if (not CHECK(summaries.size() == numberOfWindows)) {
+    return;
+  }
+
+  for (uint32_t i = 0; i < numberOfWindows; ++i) {
+    CHECK((summaries[i].p99_InUS > maximalP99_InUS) == (i == regressionWindow));
+  }
+}
+
+}// namespace
+
+int main() {
+  testGate();
+  testRegression();
+
+  return test::finish();
+}
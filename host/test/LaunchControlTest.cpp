@@ -0,0 +1,110 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include <algorithm>
+#include <cstdio>
+
+#include "Test.hpp"
+#include "EngineRig.hpp"
+
+constexpr uint32_t const targetRevolutions_InRPM = 4500;
+
+// The rider sits on the throttle well below the target before snapping it open
+constexpr uint32_t const lowPedal_InPercentage = 5;
+constexpr uint32_t const lowPedalTime_InMS = 3000;
+
+constexpr uint32_t const snapSettleTime_InMS = 1000;
+
+// Overshoot of the held RPM right after the snap, with a wound up integral it runs to the limiter
+constexpr uint32_t const maximalOvershoot_InRPM = 600;
+constexpr uint32_t const holdTolerance_InRPM = 250;
+
+// Free revving at full throttle the engine runs far past anything launch control holds
+constexpr uint32_t const unheldRevolutions_InRPM = 8000;
+
+namespace {
+
+struct SnapResult {
+  uint32_t peakRevolutions_InRPM;
+  uint32_t finalRevolutions_InRPM;
+};
+
+/**
+ * Standing in first with the clutch pulled, a while on a small opening, then the throttle snapped fully open
+ */
+SnapResult snapFromStandstill(EngineRig &rig) {
+  rig.engine.setGear(1);
+  rig.engine.setClutchEngaged(false);
+  rig.run(lowPedalTime_InMS, lowPedal_InPercentage);
+
+  SnapResult result = {0, 0};
+  for (uint32_t i = 0; i < snapSettleTime_InMS; ++i) {
+    rig.tick(100);
+    result.peakRevolutions_InRPM = std::max(result.peakRevolutions_InRPM, rig.engine.getRevolutions_InRPM());
+  }
+
+  result.finalRevolutions_InRPM = rig.engine.getRevolutions_InRPM();
+  return result;
+}
+
+}// namespace
+
+int main() {
+  EtcControllerParameters parameters = {};
+  parameters.launchControl.targetRevolutions_InRPM = targetRevolutions_InRPM;
+
+  EngineRig rig(parameters);
+  rig.etcController->launchEnable();
+
+  auto const launch = snapFromStandstill(rig);
+  std::printf("launch snap: peak %u RPM, held at %u RPM\n", launch.peakRevolutions_InRPM, launch.finalRevolutions_InRPM);
+
+  CHECK(launch.peakRevolutions_InRPM <= targetRevolutions_InRPM + maximalOvershoot_InRPM);
+  CHECK(launch.finalRevolutions_InRPM + holdTolerance_InRPM >= targetRevolutions_InRPM);
+  CHECK(launch.finalRevolutions_InRPM <= targetRevolutions_InRPM + holdTolerance_InRPM);
+
+  // Clutch out on full throttle up to the release speed
+  rig.engine.setClutchEngaged(true);
+  uint32_t launchTime_InMS = 0;
+  while (rig.engine.getSpeed_InKilometersPerHour() < parameters.launchControl.releaseSpeed_InKilometersPerHour + 5 and launchTime_InMS < 20000) {
+    rig.tick(100);
+    launchTime_InMS += 1;
+  }
+
+  std::printf("launch: %u km/h after %u ms\n", rig.engine.getSpeed_InKilometersPerHour(), launchTime_InMS);
+  CHECK(rig.engine.getSpeed_InKilometersPerHour() >= parameters.launchControl.releaseSpeed_InKilometersPerHour);
+
+  // Off the throttle and braking to a stop, the clutch pulled before the engine would stall
+  rig.engine.setBrake(20);
+  while (rig.engine.getSpeed_InKilometersPerHour() > 10) {
+    rig.tick(0);
+  }
+  rig.engine.setClutchEngaged(false);
+  while (rig.engine.getExactSpeed_InKilometersPerHour() > 0) {
+    rig.tick(0);
+  }
+  rig.engine.setBrake(0);
+  rig.run(2000, 0);
+
+  // Not armed again, the next stop must not hold the engine
+  auto const unarmed = snapFromStandstill(rig);
+  std::printf("snap after the launch: peak %u RPM\n", unarmed.peakRevolutions_InRPM);
+  CHECK(unarmed.peakRevolutions_InRPM >= unheldRevolutions_InRPM);
+
+  return test::finish();
+}
@@ -0,0 +1,109 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include <array>
+#include <limits>
+#include <cstdio>
+#include <cstring>
+
+#include "Test.hpp"
+#include "log/DeferredLog.hpp"
+
+// Line buffer of the flush and the decoder
+constexpr std::size_t const lineSize = 128;
+
+namespace {
+
+/**
+ * Every argument is passed as long, any other conversion reads garbage on the unit
+ */
+bool hasOnlyLongConversions(char const *format, uint32_t &numberOfConversions) {
+  numberOfConversions = 0;
+
+  for (auto const *position = std::strchr(format, '%'); position != nullptr; position = std::strchr(position + 1, '%')) {
+    if (std::strncmp(position, "%ld", 3) != 0 and std::strncmp(position, "%lu", 3) != 0) {
+      return false;
+    }
+    numberOfConversions += 1;
+  }
+
+  return true;
+}
+
+void testFormats() {
+  for (uint16_t messageId = 0; messageId < LOG_MESSAGE_COUNT; ++messageId) {
+    auto const &[tag, format] = logMessageFormats[messageId];
+
+    uint32_t numberOfConversions = 0;
+    CHECK(tag != nullptr and format != nullptr);
+    CHECK(hasOnlyLongConversions(format, numberOfConversions));
+    CHECK(numberOfConversions <= 2);
+
+    // The widest arguments still fit the line
+    LogRecord const record = {
+        .timestamp_InMS = std::numeric_limits<uint32_t>::max(),
+        .messageId = messageId,
+        .reserved = 0,
+        .arguments = {std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::min()},
+    };
+
+    char line[lineSize] = {0};
+    auto const length = deferredLogFormat(record, line, sizeof(line));
+    CHECK(length > 0 and length < lineSize - 1);
+  }
+
+  LogRecord const unknown = {.timestamp_InMS = 0, .messageId = LOG_MESSAGE_COUNT, .reserved = 0, .arguments = {0, 0}};
+  char line[lineSize] = {0};
+  deferredLogFormat(unknown, line, sizeof(line));
+  CHECK(std::strncmp(line, "Unknown message", 15) == 0);
+}
+
+/**
+ * Records come out raw in the order they went in, with their arguments
+ */
+void testDrain() {
+  std::array<LogRecord, 8> records = {};
+  while (deferredLogDrain(records.data(), records.size()) > 0) {
+  }
+
+  deferredLog(LOG_MODE_BUTTON_MODE, 2);
+  deferredLog(LOG_ACCELERATOR_FILTER, 1, 6500);
+  deferredLog(LOG_SETUP_BUTTON_PRESSED);
+
+  CHECK(deferredLogDrain(records.data(), 2) == 2);
+  CHECK(records[0].messageId == LOG_MODE_BUTTON_MODE and records[0].arguments[0] == 2);
+  CHECK(records[1].messageId == LOG_ACCELERATOR_FILTER and records[1].arguments[0] == 1 and records[1].arguments[1] == 6500);
+  CHECK(records[0].timestamp_InMS <= records[1].timestamp_InMS);
+
+  CHECK(deferredLogDrain(records.data(), records.size()) == 1);
+  CHECK(records[0].messageId == LOG_SETUP_BUTTON_PRESSED);
+  CHECK(deferredLogDrain(records.data(), records.size()) == 0);
+
+  char line[lineSize] = {0};
+  deferredLogFormat({.timestamp_InMS = 0, .messageId = LOG_ACCELERATOR_FILTER, .reserved = 0, .arguments = {1, 6500}}, line, sizeof(line));
+  CHECK(std::strcmp(line, "Filter 1 selected, group delay 6500 us") == 0);
+}
+
+}// namespace
+
+int main() {
+  testFormats();
+  testDrain();
+
+  return test::finish();
+}
@@ -0,0 +1,189 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "Test.hpp"
+#include "EtcController.hpp"
+#include "clock/VirtualClock.hpp"
+#include "runtime/Mailbox.hpp"
+#include "stepper/MotorBridge.hpp"
+#include "stepper/MotorController.hpp"
+
+// Motor set up as in main.cpp
+constexpr uint32_t const motorMinimalSpeed = 500;
+constexpr uint32_t const motorMaximalSpeed = 4000;
+constexpr uint32_t const motorMaximalSteps = 500;
+constexpr uint32_t const motorPeriod_InUS = 20;
+
+constexpr uint32_t const softProfileIndex = 0;
+constexpr uint32_t const sportProfileIndex = ridingProfileCount - 1;
+
+// Faster than the ramp, every switch lands in the middle of the last one
+constexpr uint32_t const toggleInterval_InMS = 70;
+constexpr uint32_t const numberOfToggles = 12;
+constexpr uint32_t const controlPedal_InPercentage = 50;
+
+// A ramp changes the output by a fraction of a percent per tick, a step shows as more than one percent
+constexpr uint32_t const maximalOutputStep_InPercentage = 1;
+
+// Positions in fine microsteps, sampled every millisecond, speeds compared over windows of this length
+constexpr uint32_t const velocityWindow_InMS = 20;
+constexpr uint32_t const moveTimeout_InMS = 3000;
+
+// The steepest ramp of any profile over a window, and a coarse step either side of each window end
+constexpr double const steepestRamp_InStepsPerSecondPerSecond = 30000;
+constexpr double const positionResolution_InSteps = 4;
+constexpr double const maximalSpeedChange_InStepsPerSecond =
+    steepestRamp_InStepsPerSecondPerSecond * velocityWindow_InMS / 1000 + 4 * positionResolution_InSteps * 1000 / velocityWindow_InMS;
+
+namespace {
+
+/**
+ * Pedal held while the rider flicks through the modes, the output may only ever move by the ramp
+ */
+void testControllerOutput() {
+  auto clock = std::make_shared<VirtualClock>(1000000);
+  auto selector = std::make_shared<RidingProfileSelector>(defaultRidingProfiles, softProfileIndex);
+  auto etcController = std::make_shared<EtcController>(clock);
+
+  uint32_t output_InPercentage = 0;
+  etcController->registerChangeValueCallback([&output_InPercentage](uint32_t const value, TraceTag) {
+    output_InPercentage = value;
+  });
+  etcController->setProfileSelector(selector);
+  etcController->setVehicleRPM(3000);
+  etcController->setVehicleSpeed(40);
+  etcController->setAcceleratorValue(controlPedal_InPercentage);
+  etcController->spinOnce();
+
+  auto lastOutput_InPercentage = output_InPercentage;
+  uint32_t largestStep_InPercentage = 0;
+
+  for (uint32_t toggle = 0; toggle <= numberOfToggles; ++toggle) {
+    selector->select(toggle % 2 == 0 ? sportProfileIndex : softProfileIndex);
+
+    // The last one is left to finish its ramp
+    auto const duration_InMS = toggle < numberOfToggles ? toggleInterval_InMS : 1000;
+    for (uint32_t i = 0; i < duration_InMS; ++i) {
+      clock->advance(1000);
+      etcController->spinOnce();
+
+      auto const step_InPercentage = std::max(output_InPercentage, lastOutput_InPercentage) - std::min(output_InPercentage, lastOutput_InPercentage);
+      largestStep_InPercentage = std::max(largestStep_InPercentage, step_InPercentage);
+      lastOutput_InPercentage = output_InPercentage;
+    }
+  }
+
+  auto const &finalProfile = defaultRidingProfiles[numberOfToggles % 2 == 0 ? sportProfileIndex : softProfileIndex];
+  auto const expectedOutput_InPercentage = ridingProfileMapThrottle(finalProfile, controlPedal_InPercentage);
+
+  std::printf("controller: %u mode switches every %u ms, largest output step %u %%, settled at %u %% for %u %%\n", numberOfToggles + 1, toggleInterval_InMS,
+              largestStep_InPercentage, output_InPercentage, expectedOutput_InPercentage);
+
+  CHECK(largestStep_InPercentage <= maximalOutputStep_InPercentage);
+  CHECK(output_InPercentage == expectedOutput_InPercentage);
+}
+
+struct MoveResult {
+  uint32_t duration_InMS;
+  double largestSpeedChange_InStepsPerSecond;
+};
+
+/**
+ * Full travel through the bridge as on the motion core, the mode flicked back and forth while the motor moves
+ * @return The speed change is the largest between two windows one window apart
+ */
+MoveResult moveWithToggles(bool const isToggling) {
+  auto clock = std::make_shared<VirtualClock>(1000000);
+  motor::host::setTimeFunction([clock]() {
+    return clock->getTime_InUS();
+  });
+
+  auto selector = std::make_shared<RidingProfileSelector>(defaultRidingProfiles, softProfileIndex);
+  auto motorController = std::make_shared<MotorController>(motorMinimalSpeed, motorMaximalSpeed, motorMaximalSteps, clock);
+  auto setpointMailbox = std::make_shared<Mailbox<MotorSetpoint>>();
+  auto statusMailbox = std::make_shared<Mailbox<MotorStatus>>();
+  auto motorBridge = std::make_shared<MotorBridge>(motorController, setpointMailbox, statusMailbox, clock);
+
+  motorBridge->setProfileSelector(selector);
+  motorController->moveToHome();
+
+  MotorSetpoint setpoint = {};
+  setpoint.position = 100;
+  setpointMailbox->write(setpoint);
+
+  std::vector<int32_t> positions_InSteps;
+  uint32_t toggle = 0;
+
+  while (positions_InSteps.size() < moveTimeout_InMS) {
+    auto const time_InMS = static_cast<uint32_t>(positions_InSteps.size());
+    if (isToggling and time_InMS % toggleInterval_InMS == 0 and toggle < numberOfToggles) {
+      selector->select(toggle % 2 == 0 ? sportProfileIndex : softProfileIndex);
+      toggle += 1;
+    }
+
+    for (uint32_t i = 0; i < 1000 / motorPeriod_InUS; ++i) {
+      clock->advance(motorPeriod_InUS);
+      motorBridge->spinOnce();
+      motorController->spinOnce();
+    }
+
+    positions_InSteps.push_back(motorController->getPosition());
+    if (motorController->getDistanceToTarget() == 0) {
+      break;
+    }
+  }
+
+  MoveResult result = {static_cast<uint32_t>(positions_InSteps.size()), 0};
+
+  for (auto i = 2 * velocityWindow_InMS; i < positions_InSteps.size(); ++i) {
+    auto const speed_InStepsPerSecond = (positions_InSteps[i] - positions_InSteps[i - velocityWindow_InMS]) * 1000.0 / velocityWindow_InMS;
+    auto const previousSpeed_InStepsPerSecond = (positions_InSteps[i - velocityWindow_InMS] - positions_InSteps[i - 2 * velocityWindow_InMS]) * 1000.0 / velocityWindow_InMS;
+    result.largestSpeedChange_InStepsPerSecond = std::max(result.largestSpeedChange_InStepsPerSecond, std::fabs(speed_InStepsPerSecond - previousSpeed_InStepsPerSecond));
+  }
+
+  return result;
+}
+
+/**
+ * The motor has to take the new speed and ramps over in the middle of a move, without dropping or jumping its speed
+ */
+void testMotorMotion() {
+  auto const steady = moveWithToggles(false);
+  auto const toggled = moveWithToggles(true);
+
+  std::printf("motor: full travel in %u ms in soft, %u ms flicking the modes, largest speed change %.0f and %.0f steps/s over %u ms\n", steady.duration_InMS,
+              toggled.duration_InMS, steady.largestSpeedChange_InStepsPerSecond, toggled.largestSpeedChange_InStepsPerSecond, velocityWindow_InMS);
+
+  // Sport for half of the flicks, a move that kept the speed it started with would take as long as in soft
+  CHECK(toggled.duration_InMS < steady.duration_InMS);
+  CHECK(toggled.largestSpeedChange_InStepsPerSecond <= maximalSpeedChange_InStepsPerSecond);
+}
+
+}// namespace
+
+int main() {
+  testControllerOutput();
+  testMotorMotion();
+
+  return test::finish();
+}
@@ -0,0 +1,324 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <numbers>
+
+#include "Test.hpp"
+#include "Random.hpp"
+#include "Storage.hpp"
+#include "board/Board.hpp"
+#include "gpio/InputPin.hpp"
+#include "clock/VirtualClock.hpp"
+#include "stepper/MotorController.hpp"
+#include "stepper/MotionIdentifier.hpp"
+
+// Motor set up as in main.cpp
+constexpr uint32_t const motorMinimalSpeed = 500;
+constexpr uint32_t const motorMaximalSpeed = 4000;
+constexpr uint32_t const motorMaximalSteps = 500;
+// The motion limits alone hold the moves back
+constexpr uint32_t const motorMaximalAcceleration = 1000000;
+
+constexpr uint32_t const motorPeriod_InUS = 20;
+constexpr uint32_t const identifierPeriod_InUS = 1000;
+constexpr uint32_t const identificationTimeout_InUS = 600 * 1000000U;
+constexpr uint32_t const moveTimeout_InUS = 2000000;
+constexpr uint32_t const settleTime_InUS = 100 * 1000;
+
+// Rotor pulled by the field towards the commanded microstep, one electrical cycle is 128 microsteps.
+// Torque falls with speed, the return spring closes the throttle and the bearings rub against any motion.
+constexpr double const electricalCycle_InSteps = 128;
+constexpr double const holdingAcceleration_InStepsPerSecondPerSecond = 150000;
+constexpr double const noTorqueSpeed_InStepsPerSecond = 4000;
+constexpr double const springAcceleration_InStepsPerSecondPerSecond = 10000;
+constexpr double const frictionAcceleration_InStepsPerSecondPerSecond = 8000;
+// The field damps the rotor against its own motion, the step train is smoothed to get that
+constexpr double const dampingRate_InPerSecond = 80;
+constexpr double const fieldSpeedTimeConstant_InSeconds = 0.002;
+
+// Throttle sensor over the stroke, the identification needs it to follow
+constexpr double const throttleClosed_InMillivolts = 500;
+constexpr double const throttleSlope_InMillivoltsPerStep = 7;
+
+constexpr uint32_t const numberOfValidationMoves = 40;
+// Past the margin and the level that failed, the throttle body has to lose steps here
+constexpr float const overLimitFactor = 1.6F;
+
+namespace {
+
+/**
+ * Throttle body behind the stepper.
+ * A rotor that falls more than half a cycle behind the field slips into the next equilibrium, a whole cycle of steps is lost.
+ */
+class ThrottleBody {
+public:
+  [[nodiscard]] bool inHome() const {
+    return m_position_InSteps <= 0;
+  }
+
+  [[nodiscard]] uint32_t getThrottlePosition_InMillivolts() const {
+    return static_cast<uint32_t>(std::lround(throttleClosed_InMillivolts + m_position_InSteps * throttleSlope_InMillivoltsPerStep));
+  }
+
+  /**
+   * Whole cycles the rotor is off the commanded position, in steps
+   */
+  [[nodiscard]] int32_t getLostSteps(int32_t const commandedInSteps) const {
+    auto const cycles = std::lround((commandedInSteps - m_position_InSteps) / electricalCycle_InSteps);
+    return static_cast<int32_t>(cycles * electricalCycle_InSteps);
+  }
+
+public:
+  /**
+   * Homing drives the rotor against the stop, the counter starts from there
+   */
+  void home() {
+    m_position_InSteps = 0;
+    m_speed_InStepsPerSecond = 0;
+    m_commanded_InSteps = 0;
+    m_fieldSpeed_InStepsPerSecond = 0;
+  }
+
+  void advance(int32_t const commandedInSteps, double const timeInSeconds) {
+    auto const fieldSpeed_InStepsPerSecond = (commandedInSteps - m_commanded_InSteps) / timeInSeconds;
+    m_fieldSpeed_InStepsPerSecond += (fieldSpeed_InStepsPerSecond - m_fieldSpeed_InStepsPerSecond) * timeInSeconds / fieldSpeedTimeConstant_InSeconds;
+    m_commanded_InSteps = commandedInSteps;
+
+    auto const angle = 2 * std::numbers::pi * (commandedInSteps - m_position_InSteps) / electricalCycle_InSteps;
+    auto const torque = holdingAcceleration_InStepsPerSecondPerSecond * std::fmax(0, 1 - std::fabs(m_speed_InStepsPerSecond) / noTorqueSpeed_InStepsPerSecond);
+
+    // Damping comes from the same windings, it cannot push harder than the torque left at this speed
+    auto const fieldAcceleration = std::clamp(torque * std::sin(angle) - dampingRate_InPerSecond * (m_speed_InStepsPerSecond - m_fieldSpeed_InStepsPerSecond), -torque, torque);
+
+    auto acceleration = fieldAcceleration - springAcceleration_InStepsPerSecondPerSecond;
+    if (m_speed_InStepsPerSecond != 0) {
+      acceleration -= std::copysign(frictionAcceleration_InStepsPerSecondPerSecond, m_speed_InStepsPerSecond);
+    } else if (std::fabs(acceleration) <= frictionAcceleration_InStepsPerSecondPerSecond) {
+      acceleration = 0;
+    }
+
+    auto const speed_InStepsPerSecond = m_speed_InStepsPerSecond + acceleration * timeInSeconds;
+
+    // Friction stops the rotor, it does not turn it around
+    if (m_speed_InStepsPerSecond != 0 and std::signbit(speed_InStepsPerSecond) != std::signbit(m_speed_InStepsPerSecond)) {
+      m_speed_InStepsPerSecond = 0;
+    } else {
+      m_speed_InStepsPerSecond = speed_InStepsPerSecond;
+    }
+
+    m_position_InSteps += m_speed_InStepsPerSecond * timeInSeconds;
+
+    if (m_position_InSteps <= 0) {
+      m_position_InSteps = 0;
+      m_speed_InStepsPerSecond = std::fmax(0, m_speed_InStepsPerSecond);
+    }
+  }
+
+private:
+  double m_position_InSteps = 0;
+  double m_speed_InStepsPerSecond = 0;
+  int32_t m_commanded_InSteps = 0;
+  double m_fieldSpeed_InStepsPerSecond = 0;
+};
+
+struct Rig {
+  Rig() : clock(std::make_shared<VirtualClock>(1000000)), motorController(nullptr), motionIdentifier(nullptr), throttleBody() {
+    motor::host::setTimeFunction([clock = clock]() {
+      return clock->getTime_InUS();
+    });
+
+    motorController = std::make_shared<MotorController>(motorMinimalSpeed, motorMaximalSpeed, motorMaximalSteps, clock);
+    motorController->setSpeed(motorMaximalSpeed);
+    motorController->setAcceleration(motorMaximalAcceleration);
+    motorController->setDeceleration(motorMaximalAcceleration);
+
+    motionIdentifier = std::make_shared<MotionIdentifier>(motorController, clock);
+  }
+
+  ~Rig() {
+    gpio::host::releaseInputs();
+  }
+
+  /**
+   * One motion node period, the identifier runs at its own rate next to it
+   */
+  void tick() {
+    auto const positionBefore_InSteps = motorController->getPosition();
+
+    clock->advance(motorPeriod_InUS);
+    motorController->spinOnce();
+
+    if (clock->getTime_InUS() % identifierPeriod_InUS == 0) {
+      motionIdentifier->setThrottlePosition(isSensorConnected ? throttleBody.getThrottlePosition_InMillivolts() : 0);
+      motionIdentifier->spinOnce();
+    }
+
+    // Only homing moves the counter by more than a few steps at once
+    auto const position_InSteps = motorController->getPosition();
+    if (std::abs(position_InSteps - positionBefore_InSteps) > electricalCycle_InSteps / 2) {
+      throttleBody.home();
+    }
+
+    throttleBody.advance(position_InSteps, motorPeriod_InUS * 1e-6);
+    gpio::host::setInputLevel(Board::inHomePinNumber, throttleBody.inHome() ? gpio::PIN_LEVEL_LOW : gpio::PIN_LEVEL_HIGH);
+  }
+
+  bool identify() {
+    auto const startTime_InUS = clock->getTime_InUS();
+
+    motionIdentifier->start();
+    while (not motionIdentifier->isRunning()) {
+      tick();
+    }
+
+    while (motionIdentifier->isRunning() and clock->getTime_InUS() - startTime_InUS < identificationTimeout_InUS) {
+      tick();
+    }
+
+    identificationTime_InUS = clock->getTime_InUS() - startTime_InUS;
+
+    return not motionIdentifier->isRunning();
+  }
+
+  void moveTo(uint32_t const position_InPercentage) {
+    auto const startTime_InUS = clock->getTime_InUS();
+
+    motorController->setPosition(position_InPercentage);
+
+    while (motorController->getDistanceToTarget() != 0 and clock->getTime_InUS() - startTime_InUS < moveTimeout_InUS) {
+      tick();
+    }
+
+    auto const arrivalTime_InUS = clock->getTime_InUS();
+    while (clock->getTime_InUS() - arrivalTime_InUS < settleTime_InUS) {
+      tick();
+    }
+  }
+
+  /**
+   * Full stroke moves and random ones between them
+   * @return Moves after which the throttle body was off the counter
+   */
+  uint32_t countLossyMoves(MotionLimits const &motionLimits) {
+    Random random(7);
+    uint32_t numberOfLossyMoves = 0;
+
+    motorController->setMotionLimits(motionLimits);
+    motorController->moveToHome();
+    throttleBody.home();
+
+    for (uint32_t i = 0; i < numberOfValidationMoves; ++i) {
+      auto const target = i % 2 == 0 ? static_cast<uint32_t>(random.next() % 101) : 0;
+      moveTo(target);
+
+      if (throttleBody.getLostSteps(motorController->getPosition()) != 0) {
+        numberOfLossyMoves += 1;
+
+        motorController->moveToHome();
+        throttleBody.home();
+      }
+    }
+
+    return numberOfLossyMoves;
+  }
+
+  VirtualClockPtr clock;
+  std::shared_ptr<MotorController> motorController;
+  MotionIdentifierPtr motionIdentifier;
+  ThrottleBody throttleBody;
+  bool isSensorConnected = true;
+  uint64_t identificationTime_InUS = 0;
+};
+
+MotionLimits scale(MotionLimits const &motionLimits, float const factor) {
+  return {
+      .opening = {motionLimits.opening.speed_InStepsPerSecond * factor, motionLimits.opening.acceleration_InStepsPerSecondPerSecond * factor},
+      .closing = {motionLimits.closing.speed_InStepsPerSecond * factor, motionLimits.closing.acceleration_InStepsPerSecondPerSecond * factor},
+  };
+}
+
+/**
+ * The identified limits have to be safe on the throttle body and not far below what it really does
+ */
+void testIdentification() {
+  Rig rig;
+
+  bool isSucceeded = false;
+  rig.motionIdentifier->registerFinishCallback([&isSucceeded](bool const isStored) {
+    isSucceeded = isStored;
+  });
+
+  CHECK(rig.identify());
+  CHECK(isSucceeded);
+
+  // Read back the way the next boot does
+  Storage const storage("motion");
+  MotionLimits const limits = {
+      .opening = {static_cast<float>(storage.getValue("open_speed", 0)), static_cast<float>(storage.getValue("open_accel", 0))},
+      .closing = {static_cast<float>(storage.getValue("close_speed", 0)), static_cast<float>(storage.getValue("close_accel", 0))},
+  };
+
+  auto const numberOfLossyMoves = rig.countLossyMoves(limits);
+  auto const numberOfLossyMovesOverLimit = rig.countLossyMoves(scale(limits, overLimitFactor));
+
+  std::printf("identification: %.1f s, opening %.0f steps/s %.0f steps/s2, closing %.0f steps/s %.0f steps/s2\n", static_cast<double>(rig.identificationTime_InUS) * 1e-6,
+              limits.opening.speed_InStepsPerSecond, limits.opening.acceleration_InStepsPerSecondPerSecond, limits.closing.speed_InStepsPerSecond,
+              limits.closing.acceleration_InStepsPerSecondPerSecond);
+  std::printf("validation: %u of %u moves lost steps at the limits, %u at %.1f times them\n", numberOfLossyMoves, numberOfValidationMoves, numberOfLossyMovesOverLimit,
+              static_cast<double>(overLimitFactor));
+
+  // The spring holds the opening back, its speed ladder has to stop on the throttle body and not on the configuration
+  CHECK(limits.opening.speed_InStepsPerSecond > 0);
+  CHECK(limits.opening.speed_InStepsPerSecond < limits.closing.speed_InStepsPerSecond);
+  CHECK(numberOfLossyMoves == 0);
+  CHECK(numberOfLossyMovesOverLimit > 0);
+}
+
+/**
+ * Without a throttle sensor only the home switch would tell lost steps, the run fails and keeps the stored limits
+ */
+void testMissingSensor() {
+  Rig rig;
+  rig.isSensorConnected = false;
+
+  bool isStored = true;
+  rig.motionIdentifier->registerFinishCallback([&isStored](bool const isSucceeded) {
+    isStored = isSucceeded;
+  });
+
+  CHECK(rig.identify());
+  CHECK(not isStored);
+
+  Storage const storage("motion");
+  CHECK(storage.getValue("open_speed", 0) == 0);
+
+  std::printf("missing sensor: failed after %.1f s\n", static_cast<double>(rig.identificationTime_InUS) * 1e-6);
+}
+
+}// namespace
+
+int main() {
+  testMissingSensor();
+  testIdentification();
+
+  return test::finish();
+}
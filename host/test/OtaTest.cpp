@@ -0,0 +1,199 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include <vector>
+#include <cstdio>
+
+#include "Test.hpp"
+#include "Random.hpp"
+#include "ota/OtaReceiver.hpp"
+
+constexpr uint32_t const imageSize = 100000;
+
+namespace {
+
+/**
+ * Partition in memory, counts what the receiver asks of it
+ */
+class MemoryWriter : public IOtaWriter {
+public:
+  explicit MemoryWriter(std::vector<uint8_t> &image) : m_image(image) {
+  }
+
+public:
+  bool begin(uint32_t const size) override {
+    m_image.clear();
+    m_image.reserve(size);
+    return true;
+  }
+
+  bool write(uint8_t const *data, std::size_t const size) override {
+    m_image.insert(m_image.end(), data, data + size);
+    return true;
+  }
+
+  bool end() override {
+    return true;
+  }
+
+  void abort() override {
+    m_image.clear();
+  }
+
+private:
+  std::vector<uint8_t> &m_image;
+};
+
+std::vector<uint8_t> makeImage() {
+  Random random(7);
+
+  std::vector<uint8_t> image(imageSize);
+  for (auto &byte : image) {
+    byte = static_cast<uint8_t>(random.next());
+  }
+
+  return image;
+}
+
+OtaHash hashOf(std::vector<uint8_t> const &image) {
+  OtaHash hash = {};
+
+  mbedtls_sha256_context context = {};
+  mbedtls_sha256_init(&context);
+  mbedtls_sha256_starts(&context, 0);
+  mbedtls_sha256_update(&context, image.data(), image.size());
+  mbedtls_sha256_finish(&context, hash.data());
+  mbedtls_sha256_free(&context);
+
+  return hash;
+}
+
+/**
+ * Sends like the client does, only as many chunks as it holds credits, the writer task runs in between
+ * @return Final state of the receiver
+ */
+OtaState stream(OtaReceiver &receiver, std::vector<uint8_t> const &image, OtaHash const &hash, uint32_t const extraChunks = 0) {
+  uint32_t credits = 0;
+  receiver.registerCreditCallback([&credits](uint16_t const newCredits) { credits += newCredits; });
+
+  receiver.begin(image.size(), hash);
+  receiver.process();
+
+  std::size_t offset = 0;
+  uint16_t sequence = 0;
+
+  while (offset < image.size() and receiver.getState() == OTA_STATE_RECEIVING) {
+    auto numberOfChunks = credits + extraChunks;
+    credits = 0;
+
+    while (numberOfChunks > 0 and offset < image.size()) {
+      auto const size = std::min(otaChunkMaxSize, image.size() - offset);
+      receiver.receive(sequence++, image.data() + offset, size);
+      offset += size;
+      numberOfChunks -= 1;
+    }
+
+    receiver.process();
+  }
+
+  receiver.process();
+
+  return receiver.getState();
+}
+
+void testHash() {
+  std::vector<uint8_t> const message = {'a', 'b', 'c'};
+  OtaHash const expected = {0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea, 0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+                            0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c, 0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad};
+  CHECK(hashOf(message) == expected);
+
+  // Hashing in pieces that straddle blocks gives the same digest as in one go
+  auto const image = makeImage();
+  mbedtls_sha256_context context = {};
+  mbedtls_sha256_init(&context);
+  mbedtls_sha256_starts(&context, 0);
+  for (std::size_t offset = 0; offset < image.size(); offset += 37) {
+    mbedtls_sha256_update(&context, image.data() + offset, std::min<std::size_t>(37, image.size() - offset));
+  }
+  OtaHash hash = {};
+  mbedtls_sha256_finish(&context, hash.data());
+  CHECK(hash == hashOf(image));
+}
+
+void testImage() {
+  auto const image = makeImage();
+  std::vector<uint8_t> written;
+
+  OtaReceiver receiver(std::make_unique<MemoryWriter>(written));
+  CHECK(stream(receiver, image, hashOf(image)) == OTA_STATE_DONE);
+  CHECK(written == image);
+
+  // A second update after a finished one starts over
+  CHECK(stream(receiver, image, hashOf(image)) == OTA_STATE_DONE);
+  CHECK(written == image);
+}
+
+void testCorruptImage() {
+  auto const image = makeImage();
+  auto hash = hashOf(image);
+  hash[0] ^= 1;
+
+  std::vector<uint8_t> written;
+  OtaReceiver receiver(std::make_unique<MemoryWriter>(written));
+  CHECK(stream(receiver, image, hash) == OTA_STATE_FAILED);
+  CHECK(written.empty());
+}
+
+void testSequenceGap() {
+  auto const image = makeImage();
+  std::vector<uint8_t> written;
+
+  OtaReceiver receiver(std::make_unique<MemoryWriter>(written));
+  receiver.begin(image.size(), hashOf(image));
+  receiver.process();
+
+  CHECK(receiver.receive(0, image.data(), otaChunkMaxSize));
+  CHECK(not receiver.receive(2, image.data() + otaChunkMaxSize, otaChunkMaxSize));
+  receiver.process();
+  CHECK(receiver.getState() == OTA_STATE_FAILED);
+  CHECK(written.empty());
+}
+
+/**
+ * A sender ignoring its credits overruns the queue, the update fails instead of losing a chunk
+ */
+void testCreditOverrun() {
+  auto const image = makeImage();
+  std::vector<uint8_t> written;
+
+  OtaReceiver receiver(std::make_unique<MemoryWriter>(written));
+  CHECK(stream(receiver, image, hashOf(image), 1) == OTA_STATE_FAILED);
+  CHECK(written.empty());
+}
+
+}// namespace
+
+int main() {
+  testHash();
+  testImage();
+  testCorruptImage();
+  testSequenceGap();
+  testCreditOverrun();
+
+  return test::finish();
+}
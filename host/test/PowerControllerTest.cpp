@@ -0,0 +1,234 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include <cstdio>
+
+#include "Test.hpp"
+#include "clock/VirtualClock.hpp"
+#include "power/PowerController.hpp"
+
+constexpr uint32_t const pollPeriod_InUS = 50 * 1000;
+constexpr uint32_t const tickPeriod_InUS = 1000;
+
+constexpr uint32_t const parkDelay_InUS = 30 * 1000000;
+constexpr uint32_t const commandDelay_InUS = 2 * 1000;
+
+namespace {
+
+/**
+ * The controller on a virtual clock at the executor rate.
+ * Parked, the pedal poll stands in for the light sleep and moves the clock by one poll period before it answers.
+ */
+struct PowerRig {
+  VirtualClockPtr clock = std::make_shared<VirtualClock>();
+  PowerControllerPtr powerController = std::make_shared<PowerController>(pollPeriod_InUS, clock);
+
+  bool isAtRest = true;
+  uint64_t pedalMoveTime_InUS = UINT64_MAX;
+
+  uint32_t numberOfParks = 0;
+  uint32_t numberOfWakes = 0;
+  WakeSource wakeSource = WAKE_SOURCE_NONE;
+
+  PowerRig() {
+    powerController->registerPedalPollCallback([this]() {
+      clock->advance(pollPeriod_InUS);
+      return clock->getTime_InUS() >= pedalMoveTime_InUS;
+    });
+    powerController->registerParkPermissionCallback([this]() {
+      return isAtRest;
+    });
+    powerController->registerParkCallback([this]() {
+      numberOfParks += 1;
+    });
+    powerController->registerWakeCallback([this](WakeSource const source) {
+      numberOfWakes += 1;
+      wakeSource = source;
+    });
+  }
+
+  /**
+   * Awake every spin is one tick, parked the sleep inside the spin takes the time
+   */
+  void run(uint64_t const durationInUS) {
+    auto const endTime_InUS = clock->getTime_InUS() + durationInUS;
+
+    while (clock->getTime_InUS() < endTime_InUS) {
+      auto const isParked = powerController->getState() == POWER_STATE_PARKED;
+
+      powerController->spinOnce();
+
+      if (not isParked) {
+        clock->advance(tickPeriod_InUS);
+      }
+    }
+  }
+
+  void runUntilAwake() {
+    while (powerController->getState() == POWER_STATE_PARKED) {
+      powerController->spinOnce();
+    }
+  }
+
+  void park() {
+    run(parkDelay_InUS + pollPeriod_InUS);
+  }
+};
+
+void checkParking() {
+  {
+    PowerRig rig;
+    rig.run(parkDelay_InUS - tickPeriod_InUS);
+    CHECK(rig.powerController->getState() == POWER_STATE_ACTIVE);
+
+    rig.run(2 * tickPeriod_InUS);
+    CHECK(rig.powerController->getState() == POWER_STATE_PARKED);
+    CHECK(rig.numberOfParks == 1);
+
+    // Parked the poll keeps sleeping without another park
+    rig.run(10 * pollPeriod_InUS);
+    CHECK(rig.powerController->getState() == POWER_STATE_PARKED);
+    CHECK(rig.numberOfParks == 1);
+    CHECK(rig.numberOfWakes == 0);
+  }
+
+  // Riding with the engine running, a steady pedal or an open throttle never parks
+  {
+    PowerRig rig;
+    rig.powerController->setVehicleRPM(3000);
+    rig.run(2 * parkDelay_InUS);
+    CHECK(rig.numberOfParks == 0);
+  }
+  {
+    PowerRig rig;
+    rig.isAtRest = false;
+    rig.run(2 * parkDelay_InUS);
+    CHECK(rig.numberOfParks == 0);
+  }
+
+  // Without a permission callback the controller cannot know the throttle is closed
+  {
+    auto clock = std::make_shared<VirtualClock>();
+    PowerController powerController(pollPeriod_InUS, clock);
+
+    clock->advance(2 * parkDelay_InUS);
+    powerController.spinOnce();
+    CHECK(powerController.getState() == POWER_STATE_ACTIVE);
+  }
+
+  // Activity restarts the delay
+  {
+    PowerRig rig;
+    rig.run(parkDelay_InUS / 2);
+    rig.powerController->notifyCommand();
+    rig.run(parkDelay_InUS / 2 + pollPeriod_InUS);
+    CHECK(rig.powerController->getState() == POWER_STATE_ACTIVE);
+  }
+}
+
+void checkPedalWake() {
+  PowerRig rig;
+  rig.park();
+
+  // The pedal moves in the middle of a sleep, it is only seen at the poll that ends it
+  rig.pedalMoveTime_InUS = rig.clock->getTime_InUS() + pollPeriod_InUS / 2;
+  auto const sleepStartTime_InUS = rig.clock->getTime_InUS();
+
+  rig.runUntilAwake();
+  CHECK(rig.powerController->getState() == POWER_STATE_WAKING);
+  CHECK(rig.numberOfWakes == 1);
+  CHECK(rig.wakeSource == WAKE_SOURCE_PEDAL);
+  CHECK(rig.clock->getTime_InUS() == sleepStartTime_InUS + pollPeriod_InUS);
+
+  rig.clock->advance(commandDelay_InUS);
+  rig.powerController->notifyPedalActivity();
+  rig.powerController->notifyCommand();
+
+  auto const wakeLatency_InUS = rig.powerController->getWakeLatency_InUS();
+  auto const pedalToCommand_InUS = rig.clock->getTime_InUS() - rig.pedalMoveTime_InUS;
+
+  // Counted from the sleep entry the latency covers the time the pedal waited for the poll
+  CHECK(rig.powerController->getState() == POWER_STATE_ACTIVE);
+  CHECK(wakeLatency_InUS == pollPeriod_InUS + commandDelay_InUS);
+  CHECK(wakeLatency_InUS >= pedalToCommand_InUS);
+  CHECK(rig.powerController->getNumberOfLateWakes() == 0);
+
+  std::printf("pedal wake: moved %llu us before the command, measured %u us\n",
+              static_cast<unsigned long long>(pedalToCommand_InUS), wakeLatency_InUS);
+}
+
+void checkButtonWake() {
+  PowerRig rig;
+  rig.park();
+
+  // A button edge ends the sleep at once, the latency starts at the edge
+  rig.powerController->notifyButton();
+  CHECK(rig.powerController->getState() == POWER_STATE_WAKING);
+  CHECK(rig.wakeSource == WAKE_SOURCE_BUTTON);
+
+  rig.clock->advance(commandDelay_InUS);
+  rig.powerController->notifyCommand();
+  CHECK(rig.powerController->getWakeLatency_InUS() == commandDelay_InUS);
+
+  // A button that needs no motor move ends the wake on the timeout without a latency sample, then parks again
+  rig.park();
+  CHECK(rig.numberOfParks == 2);
+
+  rig.powerController->notifyButton();
+  rig.run(PowerPolicy{}.wakeTimeout_InUS + tickPeriod_InUS);
+  CHECK(rig.powerController->getState() == POWER_STATE_ACTIVE);
+  CHECK(rig.powerController->getWakeLatency_InUS() == commandDelay_InUS);
+
+  rig.park();
+  CHECK(rig.numberOfParks == 3);
+}
+
+void checkEngineWake() {
+  PowerRig rig;
+
+  PowerPolicy policy;
+  policy.maximalWakeLatency_InUS = 10 * 1000;
+  rig.powerController->setPolicy(policy);
+  rig.park();
+
+  rig.powerController->setVehicleRPM(1200);
+  rig.run(tickPeriod_InUS);
+  CHECK(rig.powerController->getState() == POWER_STATE_WAKING);
+  CHECK(rig.wakeSource == WAKE_SOURCE_ENGINE);
+
+  // A first command later than the policy allows is counted
+  rig.run(policy.maximalWakeLatency_InUS * 2);
+  rig.powerController->notifyCommand();
+  CHECK(rig.powerController->getNumberOfLateWakes() == 1);
+  CHECK(rig.powerController->getMaximalWakeLatency_InUS() > policy.maximalWakeLatency_InUS);
+
+  // The running engine keeps the unit awake
+  rig.run(2 * parkDelay_InUS);
+  CHECK(rig.numberOfParks == 1);
+}
+
+}// namespace
+
+int main() {
+  checkParking();
+  checkPedalWake();
+  checkButtonWake();
+  checkEngineWake();
+
+  return test::finish();
+}
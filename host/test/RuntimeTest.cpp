@@ -0,0 +1,208 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include <array>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cstdio>
+
+#include "Test.hpp"
+#include "runtime/Mailbox.hpp"
+#include "runtime/RingBuffer.hpp"
+#include "stepper/MotorBridge.hpp"
+
+constexpr uint32_t const numberOfMailboxWrites = 2000000;
+constexpr uint32_t const numberOfMailboxReaders = 3;
+
+constexpr uint32_t const numberOfProducers = 4;
+constexpr uint32_t const numberOfPushesPerProducer = 100000;
+constexpr std::size_t const ringBufferSize = 64;
+
+namespace {
+
+/**
+ * Every field is derived from one counter, a torn snapshot mixes two writes and breaks the relation
+ */
+MotorSetpoint makeSetpoint(uint32_t const counter) {
+  MotorSetpoint setpoint = {};
+  setpoint.position = counter;
+  setpoint.speed = static_cast<float>(counter % 1000);
+  setpoint.wakeRequest = ~counter;
+  setpoint.sleepRequest = counter * 3;
+  setpoint.trace.sequence = counter + 1;
+  setpoint.trace.time_InUS = static_cast<uint64_t>(counter) << 20;
+  return setpoint;
+}
+
+bool isConsistent(MotorSetpoint const &setpoint) {
+  auto const counter = setpoint.position;
+  return setpoint.speed == static_cast<float>(counter % 1000) and setpoint.wakeRequest == ~counter and setpoint.sleepRequest == counter * 3 and
+         setpoint.trace.sequence == counter + 1 and setpoint.trace.time_InUS == static_cast<uint64_t>(counter) << 20;
+}
+
+/**
+ * One writer publishing as fast as it can against readers on other threads.
+ * No reader may see a torn value or go back in time.
+ */
+void testMailbox() {
+  Mailbox<MotorSetpoint> mailbox(makeSetpoint(0));
+
+  std::atomic<bool> isWriting(true);
+  std::atomic<uint32_t> numberOfTornReads(0);
+  std::atomic<uint32_t> numberOfBackwardReads(0);
+  std::atomic<uint64_t> numberOfReads(0);
+
+  std::vector<std::thread> readers;
+  for (uint32_t i = 0; i < numberOfMailboxReaders; ++i) {
+    readers.emplace_back([&]() {
+      uint32_t lastCounter = 0;
+      uint32_t lastSequence = 0;
+      uint64_t reads = 0;
+
+      while (isWriting.load(std::memory_order_relaxed)) {
+        MotorSetpoint setpoint = {};
+        auto const sequence = mailbox.read(setpoint);
+        reads += 1;
+
+        if (not isConsistent(setpoint)) {
+          numberOfTornReads.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (setpoint.position < lastCounter or sequence < lastSequence) {
+          numberOfBackwardReads.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        lastCounter = setpoint.position;
+        lastSequence = sequence;
+      }
+
+      numberOfReads.fetch_add(reads, std::memory_order_relaxed);
+    });
+  }
+
+  for (uint32_t counter = 1; counter <= numberOfMailboxWrites; ++counter) {
+    mailbox.write(makeSetpoint(counter));
+  }
+  isWriting.store(false, std::memory_order_relaxed);
+
+  for (auto &reader : readers) {
+    reader.join();
+  }
+
+  MotorSetpoint last = {};
+  auto const lastSequence = mailbox.read(last);
+
+  std::printf("mailbox: %u writes, %lu reads, %u torn, %u backward\n", numberOfMailboxWrites, static_cast<unsigned long>(numberOfReads.load()),
+              numberOfTornReads.load(), numberOfBackwardReads.load());
+
+  CHECK(numberOfTornReads.load() == 0);
+  CHECK(numberOfBackwardReads.load() == 0);
+  CHECK(last.position == numberOfMailboxWrites);
+  CHECK(lastSequence == numberOfMailboxWrites + 1);
+}
+
+struct Item {
+  uint32_t producer;
+  uint32_t counter;
+};
+
+/**
+ * Producers on several threads against one consumer on a small buffer so it runs full.
+ * Every accepted value arrives exactly once and in order per producer, every rejected one is counted as dropped.
+ */
+void testRingBuffer() {
+  RingBuffer<Item, ringBufferSize> ringBuffer;
+
+  std::atomic<uint32_t> numberOfRunningProducers(numberOfProducers);
+  std::array<uint32_t, numberOfProducers> numberOfAccepted = {};
+
+  std::vector<std::thread> producers;
+  for (uint32_t producer = 0; producer < numberOfProducers; ++producer) {
+    producers.emplace_back([&, producer]() {
+      uint32_t accepted = 0;
+
+      for (uint32_t counter = 0; counter < numberOfPushesPerProducer; ++counter) {
+        if (ringBuffer.push({producer, counter})) {
+          accepted += 1;
+        } else {
+          // Dropped, give the consumer a chance so the run covers more than a buffer full
+          std::this_thread::yield();
+        }
+      }
+
+      numberOfAccepted[producer] = accepted;
+      numberOfRunningProducers.fetch_sub(1, std::memory_order_release);
+    });
+  }
+
+  std::array<uint32_t, numberOfProducers> numberOfPopped = {};
+  std::array<int64_t, numberOfProducers> lastCounter = {};
+  lastCounter.fill(-1);
+  uint32_t numberOfOutOfOrder = 0;
+  uint32_t numberOfUnknown = 0;
+
+  auto const consume = [&]() {
+    Item item = {};
+    while (ringBuffer.pop(item)) {
+      if (item.producer >= numberOfProducers) {
+        numberOfUnknown += 1;
+        continue;
+      }
+      if (item.counter <= lastCounter[item.producer]) {
+        numberOfOutOfOrder += 1;
+      }
+
+      lastCounter[item.producer] = item.counter;
+      numberOfPopped[item.producer] += 1;
+    }
+  };
+
+  while (numberOfRunningProducers.load(std::memory_order_acquire) > 0) {
+    consume();
+    std::this_thread::yield();
+  }
+  consume();
+
+  for (auto &producer : producers) {
+    producer.join();
+  }
+
+  uint32_t totalAccepted = 0;
+  uint32_t totalPopped = 0;
+  for (uint32_t producer = 0; producer < numberOfProducers; ++producer) {
+    CHECK(numberOfPopped[producer] == numberOfAccepted[producer]);
+    totalAccepted += numberOfAccepted[producer];
+    totalPopped += numberOfPopped[producer];
+  }
+
+  std::printf("ring buffer: %u pushes, %u accepted, %u popped, %u dropped\n", numberOfProducers * numberOfPushesPerProducer, totalAccepted, totalPopped,
+              ringBuffer.getNumberOfDropped());
+
+  CHECK(numberOfUnknown == 0);
+  CHECK(numberOfOutOfOrder == 0);
+  CHECK(totalAccepted + ringBuffer.getNumberOfDropped() == numberOfProducers * numberOfPushesPerProducer);
+}
+
+}// namespace
+
+int main() {
+  testMailbox();
+  testRingBuffer();
+
+  return test::finish();
+}
@@ -0,0 +1,265 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "Test.hpp"
+#include "Random.hpp"
+#include "clock/VirtualClock.hpp"
+#include "profile/RidingProfileSelector.hpp"
+#include "runtime/Mailbox.hpp"
+#include "stepper/MotorBridge.hpp"
+#include "stepper/MotorController.hpp"
+#include "stepper/SpeedBands.hpp"
+
+// Motor set up as in main.cpp
+constexpr uint32_t const motorMinimalSpeed = 500;
+constexpr uint32_t const motorMaximalSpeed = 4000;
+constexpr uint32_t const motorMaximalSteps = 500;
+
+constexpr uint32_t const motorPeriod_InUS = 20;
+constexpr uint32_t const bridgePeriod_InUS = 100;
+
+// The road cruise and the closing speed of the default motion limits sit inside these
+constexpr std::array<SpeedBand, 2> const forbiddenBands = {{{600, 900}, {1200, 1700}}};
+
+// A setpoint every so often, now and then with a mode switch that ramps the profile while the motor moves
+constexpr uint32_t const rideDuration_InMS = 20000;
+constexpr uint32_t const minimalHoldTime_InMS = 50;
+constexpr uint32_t const maximalHoldTime_InMS = 600;
+constexpr double const modeSwitchShare = 0.2;
+
+// The gentlest ramp of any profile crosses a band in its width over that ramp, the rest is step timing
+constexpr double const gentlestRamp_InStepsPerSecondPerSecond = 5000;
+constexpr uint32_t const crossingAllowance_InUS = 5000;
+
+// Speeds from step intervals on a 20 us grid, taken as inside a band only this far from its edges
+constexpr double const edgeTolerance = 0.05;
+// Longer than any step interval above the minimal speed, the motor stood in between
+constexpr uint64_t const standstillInterval_InUS = 4000;
+
+namespace {
+
+struct DwellResult {
+  uint64_t longestDwell_InUS;
+  float longestDwellBandLow_InStepsPerSecond;
+  uint64_t timeInBands_InUS;
+  uint32_t numberOfSteps;
+};
+
+/**
+ * Longest time the speed stayed inside one band without leaving it, the speed is taken between neighbouring step edges
+ */
+class DwellMeter {
+public:
+  void update(uint64_t const timeInUS, int32_t const positionInSteps) {
+    if (positionInSteps == m_lastPosition_InSteps) {
+      return;
+    }
+
+    auto const distance_InSteps = positionInSteps - m_lastPosition_InSteps;
+    auto const interval_InUS = timeInUS - m_lastEdgeTime_InUS;
+    auto const isSameDirection = (distance_InSteps > 0) == (m_lastDistance_InSteps > 0);
+
+    m_lastPosition_InSteps = positionInSteps;
+    m_lastEdgeTime_InUS = timeInUS;
+    m_lastDistance_InSteps = distance_InSteps;
+    m_result.numberOfSteps += 1;
+
+    if (not isSameDirection or interval_InUS >= standstillInterval_InUS) {
+      m_band = nullptr;
+      return;
+    }
+
+    auto const speed_InStepsPerSecond = static_cast<double>(std::abs(distance_InSteps)) * 1e6 / static_cast<double>(interval_InUS);
+
+    SpeedBand const *band = nullptr;
+    for (auto const &forbiddenBand : forbiddenBands) {
+      if (speed_InStepsPerSecond > forbiddenBand.low_InStepsPerSecond * (1 + edgeTolerance) and speed_InStepsPerSecond < forbiddenBand.high_InStepsPerSecond * (1 - edgeTolerance)) {
+        band = &forbiddenBand;
+      }
+    }
+
+    if (band == nullptr) {
+      m_band = nullptr;
+      return;
+    }
+
+    m_result.timeInBands_InUS += interval_InUS;
+
+    if (band != m_band) {
+      m_band = band;
+      m_entryTime_InUS = timeInUS - interval_InUS;
+    }
+
+    auto const dwell_InUS = timeInUS - m_entryTime_InUS;
+    if (dwell_InUS > m_result.longestDwell_InUS) {
+      m_result.longestDwell_InUS = dwell_InUS;
+      m_result.longestDwellBandLow_InStepsPerSecond = band->low_InStepsPerSecond;
+    }
+  }
+
+  [[nodiscard]] DwellResult const &getResult() const {
+    return m_result;
+  }
+
+private:
+  DwellResult m_result = {};
+  SpeedBand const *m_band = nullptr;
+  uint64_t m_entryTime_InUS = 0;
+  uint64_t m_lastEdgeTime_InUS = 0;
+  int32_t m_lastPosition_InSteps = 0;
+  int32_t m_lastDistance_InSteps = 0;
+};
+
+/**
+ * Random setpoints through the bridge as on the motion core, the profile selected and switched like the mode button does
+ */
+DwellResult ride(uint32_t const profileIndex, SpeedBands const &speedBands) {
+  auto clock = std::make_shared<VirtualClock>(1000000);
+  motor::host::setTimeFunction([clock]() {
+    return clock->getTime_InUS();
+  });
+
+  auto selector = std::make_shared<RidingProfileSelector>(defaultRidingProfiles, profileIndex);
+  auto motorController = std::make_shared<MotorController>(motorMinimalSpeed, motorMaximalSpeed, motorMaximalSteps, clock);
+  auto setpointMailbox = std::make_shared<Mailbox<MotorSetpoint>>();
+  auto statusMailbox = std::make_shared<Mailbox<MotorStatus>>();
+  auto motorBridge = std::make_shared<MotorBridge>(motorController, setpointMailbox, statusMailbox, clock);
+
+  motorController->setSpeedBands(speedBands);
+  motorBridge->setProfileSelector(selector);
+  motorController->moveToHome();
+
+  Random random(profileIndex + 1);
+  DwellMeter dwellMeter;
+  MotorSetpoint setpoint = {};
+
+  auto const endTime_InUS = clock->getTime_InUS() + static_cast<uint64_t>(rideDuration_InMS) * 1000;
+  while (clock->getTime_InUS() < endTime_InUS) {
+    setpoint.position = static_cast<uint32_t>(random.next() % 101);
+    setpointMailbox->write(setpoint);
+
+    if (random.uniform() < modeSwitchShare) {
+      selector->select(static_cast<uint32_t>(random.next() % ridingProfileCount));
+    }
+
+    auto const holdTime_InUS = static_cast<uint64_t>(random.uniform(minimalHoldTime_InMS, maximalHoldTime_InMS)) * 1000;
+    for (uint64_t time_InUS = 0; time_InUS < holdTime_InUS; time_InUS += motorPeriod_InUS) {
+      clock->advance(motorPeriod_InUS);
+
+      if (clock->getTime_InUS() % bridgePeriod_InUS == 0) {
+        motorBridge->spinOnce();
+      }
+      motorController->spinOnce();
+
+      dwellMeter.update(clock->getTime_InUS(), motorController->getPosition());
+    }
+  }
+
+  return dwellMeter.getResult();
+}
+
+void printResult(char const *name, uint32_t const profileIndex, DwellResult const &result) {
+  std::printf("%s profile %u: %u steps, %.1f ms in bands, longest dwell %.1f ms in the band from %.0f steps/s\n", name, profileIndex, result.numberOfSteps,
+              static_cast<double>(result.timeInBands_InUS) * 1e-3, static_cast<double>(result.longestDwell_InUS) * 1e-3,
+              static_cast<double>(result.longestDwellBandLow_InStepsPerSecond));
+}
+
+uint64_t getMaximalDwell_InUS() {
+  double widestBand_InStepsPerSecond = 0;
+  for (auto const &band : forbiddenBands) {
+    widestBand_InStepsPerSecond = std::max(widestBand_InStepsPerSecond, static_cast<double>(band.high_InStepsPerSecond - band.low_InStepsPerSecond));
+  }
+
+  return static_cast<uint64_t>(widestBand_InStepsPerSecond / gentlestRamp_InStepsPerSecondPerSecond * 1e6) + crossingAllowance_InUS;
+}
+
+/**
+ * Ramps cross the bands, no cruise settles in one, whatever profile is ridden and however often it changes
+ */
+void testBandsAvoided() {
+  SpeedBands speedBands;
+  for (auto const &band : forbiddenBands) {
+    speedBandsAdd(speedBands, band);
+  }
+
+  auto const maximalDwell_InUS = getMaximalDwell_InUS();
+
+  for (uint32_t profileIndex = 0; profileIndex < ridingProfileCount; ++profileIndex) {
+    auto const result = ride(profileIndex, speedBands);
+    printResult("avoided", profileIndex, result);
+
+    CHECK(result.numberOfSteps > 0);
+    CHECK(result.longestDwell_InUS <= maximalDwell_InUS);
+  }
+}
+
+/**
+ * Without bands the same rides cruise inside them, so the dwell measured above is the bands at work
+ */
+void testBandsIgnored() {
+  auto const maximalDwell_InUS = getMaximalDwell_InUS();
+  uint64_t longestDwell_InUS = 0;
+
+  for (uint32_t profileIndex = 0; profileIndex < ridingProfileCount; ++profileIndex) {
+    auto const result = ride(profileIndex, {});
+    printResult("ignored", profileIndex, result);
+
+    longestDwell_InUS = std::max(longestDwell_InUS, result.longestDwell_InUS);
+  }
+
+  CHECK(longestDwell_InUS > maximalDwell_InUS);
+}
+
+/**
+ * Every cruise speed asked for between the minimal and the maximal one is held at or below the request and outside the bands
+ */
+void testAvoidedSpeeds() {
+  SpeedBands speedBands;
+  for (auto const &band : forbiddenBands) {
+    speedBandsAdd(speedBands, band);
+  }
+
+  uint32_t numberOfInside = 0;
+  for (float speed_InStepsPerSecond = motorMinimalSpeed; speed_InStepsPerSecond <= motorMaximalSpeed; speed_InStepsPerSecond += 10) {
+    auto const avoided_InStepsPerSecond = speedBandsAvoid(speedBands, speed_InStepsPerSecond, motorMinimalSpeed, motorMaximalSpeed);
+
+    CHECK(avoided_InStepsPerSecond <= speed_InStepsPerSecond);
+    for (auto const &band : forbiddenBands) {
+      if (avoided_InStepsPerSecond > band.low_InStepsPerSecond and avoided_InStepsPerSecond < band.high_InStepsPerSecond) {
+        numberOfInside += 1;
+      }
+    }
+  }
+
+  CHECK(numberOfInside == 0);
+}
+
+}// namespace
+
+int main() {
+  testAvoidedSpeeds();
+  testBandsAvoided();
+  testBandsIgnored();
+
+  return test::finish();
+}
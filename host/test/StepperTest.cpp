@@ -0,0 +1,316 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include <limits>
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+#include "Test.hpp"
+#include "Random.hpp"
+#include "board/Board.hpp"
+#include "board/Gpio.hpp"
+#include "clock/VirtualClock.hpp"
+#include "stepper/MotorController.hpp"
+
+// Motor set up as in main.cpp
+constexpr uint32_t const motorMinimalSpeed = 500;
+constexpr uint32_t const motorMaximalSpeed = 4000;
+constexpr uint32_t const motorMaximalSteps = 500;
+constexpr uint32_t const motorDefaultSpeed = 1500;
+constexpr uint32_t const motorDefaultAcceleration = 15000;
+constexpr uint32_t const motorDefaultDeceleration = 30000;
+
+constexpr uint32_t const motorPeriod_InUS = 20;
+constexpr uint32_t const settleTime_InUS = 2000;
+constexpr uint32_t const moveTimeout_InUS = 2000000;
+
+// One electrical cycle of the DRV8825 in its finest microstep
+constexpr int32_t const translatorCycle_InSteps = 128;
+
+constexpr uint32_t const numberOfDriftMoves = 300;
+
+namespace {
+
+struct StepEdge {
+  uint64_t time_InUS;
+  int8_t direction;
+};
+
+/**
+ * DRV8825 indexer driven by the recorded pin writes.
+ * The phase counts 1/32 microsteps from the home state, a step moves it by the table increment of the mode pins.
+ */
+class Translator {
+public:
+  Translator() : m_levels(), m_phase_InSteps(0), m_numberOfResets(0), m_numberOfSteps(0), m_numberOfStepsSinceReset(0), m_numberOfMisalignedSteps(0), m_stepEdges() {
+    board::gpioRecordReset();
+    board::gpioRecordWrites(true);
+  }
+
+  ~Translator() {
+    board::gpioRecordWrites(false);
+  }
+
+public:
+  [[nodiscard]] int32_t getPhase() const {
+    return m_phase_InSteps;
+  }
+
+  [[nodiscard]] uint32_t getNumberOfResets() const {
+    return m_numberOfResets;
+  }
+
+  [[nodiscard]] uint32_t getNumberOfSteps() const {
+    return m_numberOfSteps;
+  }
+
+  [[nodiscard]] uint32_t getNumberOfStepsSinceReset() const {
+    return m_numberOfStepsSinceReset;
+  }
+
+  [[nodiscard]] uint32_t getNumberOfMisalignedSteps() const {
+    return m_numberOfMisalignedSteps;
+  }
+
+  [[nodiscard]] std::vector<StepEdge> const &getStepEdges() const {
+    return m_stepEdges;
+  }
+
+public:
+  /**
+   * Apply what was written since the last call, step edges are stamped with the given time
+   */
+  void consume(uint64_t const time_InUS) {
+    for (auto const &pattern : board::gpioRecordedWrites()) {
+      apply(pattern, time_InUS);
+    }
+
+    board::gpioRecordWrites(true);
+  }
+
+private:
+  [[nodiscard]] bool isHigh(uint8_t const pinNumber) const {
+    return ((m_levels[pinNumber / board::gpioBankSize] >> (pinNumber % board::gpioBankSize)) & 1) != 0;
+  }
+
+  [[nodiscard]] int32_t getStepSize() const {
+    auto const modeBits = (isHigh(Board::Mode0Pin::number) ? 1 : 0) | (isHigh(Board::Mode1Pin::number) ? 2 : 0) | (isHigh(Board::Mode2Pin::number) ? 4 : 0);
+    auto const microstep = modeBits >= 5 ? 32 : 1 << modeBits;
+
+    return 32 / microstep;
+  }
+
+  void apply(board::GpioPattern const &pattern, uint64_t const time_InUS) {
+    auto const wasStepHigh = isHigh(Board::StepPin::number);
+
+    for (uint8_t bank = 0; bank < board::gpioBankCount; ++bank) {
+      m_levels[bank] &= ~pattern.clearMask[bank];
+      m_levels[bank] |= pattern.setMask[bank];
+    }
+
+    // nRESET low holds the indexer in its home state
+    if (not isHigh(Board::ResetPin::number)) {
+      m_phase_InSteps = 0;
+      m_numberOfStepsSinceReset = 0;
+      m_numberOfResets += 1;
+      return;
+    }
+
+    if (wasStepHigh or not isHigh(Board::StepPin::number)) {
+      return;
+    }
+
+    // A mode switch away from the table of the current position, the indexer no longer walks full steps where the count expects them
+    auto const stepSize = getStepSize();
+    if (m_phase_InSteps % stepSize != 0) {
+      m_numberOfMisalignedSteps += 1;
+    }
+
+    auto const direction = isHigh(Board::DirectionPin::number) ? -1 : 1;
+
+    m_phase_InSteps += direction * stepSize;
+    m_numberOfSteps += 1;
+    m_numberOfStepsSinceReset += 1;
+    m_stepEdges.push_back({time_InUS, static_cast<int8_t>(direction)});
+  }
+
+private:
+  uint32_t m_levels[board::gpioBankCount];
+  int32_t m_phase_InSteps;
+  uint32_t m_numberOfResets;
+  uint32_t m_numberOfSteps;
+  uint32_t m_numberOfStepsSinceReset;
+  uint32_t m_numberOfMisalignedSteps;
+  std::vector<StepEdge> m_stepEdges;
+};
+
+struct Rig {
+  Rig() : clock(std::make_shared<VirtualClock>(1000000)), translator(), motorController(nullptr) {
+    motor::host::setTimeFunction([clock = clock]() {
+      return clock->getTime_InUS();
+    });
+
+    motorController = std::make_shared<MotorController>(motorMinimalSpeed, motorMaximalSpeed, motorMaximalSteps, clock);
+    motorController->setSpeed(motorDefaultSpeed);
+    motorController->setAcceleration(motorDefaultAcceleration);
+    motorController->setDeceleration(motorDefaultDeceleration);
+    translator.consume(clock->getTime_InUS());
+  }
+
+  /**
+   * Run the motion node until the motor stood on its target for a while
+   * @return Time it took to get there
+   */
+  uint64_t moveTo(uint32_t const position_InPercentage) {
+    auto const startTime_InUS = clock->getTime_InUS();
+    uint64_t arrivalTime_InUS = 0;
+
+    motorController->setPosition(position_InPercentage);
+    translator.consume(clock->getTime_InUS());
+
+    while (clock->getTime_InUS() - startTime_InUS < moveTimeout_InUS) {
+      clock->advance(motorPeriod_InUS);
+      motorController->spinOnce();
+      translator.consume(clock->getTime_InUS());
+
+      if (motorController->getDistanceToTarget() != 0) {
+        arrivalTime_InUS = 0;
+        continue;
+      }
+
+      if (arrivalTime_InUS == 0) {
+        arrivalTime_InUS = clock->getTime_InUS();
+      }
+      if (clock->getTime_InUS() - arrivalTime_InUS >= settleTime_InUS) {
+        break;
+      }
+    }
+
+    return arrivalTime_InUS - startTime_InUS;
+  }
+
+  VirtualClockPtr clock;
+  Translator translator;
+  std::shared_ptr<MotorController> motorController;
+};
+
+/**
+ * Zero has to be the position where the indexer reaches its home state by stepping, not one a reset put it in afterwards
+ */
+void testHomedPosition() {
+  Rig rig;
+
+  rig.motorController->moveToHome();
+  rig.translator.consume(rig.clock->getTime_InUS());
+
+  std::printf("homing: %u resets, %u steps after the last one, phase %d at position %d\n", rig.translator.getNumberOfResets(),
+              rig.translator.getNumberOfStepsSinceReset(), rig.translator.getPhase(), rig.motorController->getPosition());
+
+  CHECK(rig.translator.getNumberOfResets() >= 1);
+  CHECK(rig.translator.getNumberOfStepsSinceReset() >= motorMaximalSteps);
+  CHECK(rig.translator.getPhase() % translatorCycle_InSteps == 0);
+  CHECK(rig.motorController->getPosition() == 0);
+}
+
+/**
+ * Random moves mixing coarse slews and fine approaches, the step count and the indexer must never part
+ */
+void testDrift() {
+  Rig rig;
+  Random random(11);
+
+  rig.motorController->moveToHome();
+  rig.translator.consume(rig.clock->getTime_InUS());
+
+  auto const phaseAtZero = rig.translator.getPhase();
+  uint32_t numberOfDriftedMoves = 0;
+
+  for (uint32_t i = 0; i < numberOfDriftMoves; ++i) {
+    auto const target = static_cast<uint32_t>(random.next() % 101);
+    rig.moveTo(target);
+
+    if (rig.translator.getPhase() - phaseAtZero != rig.motorController->getPosition()) {
+      numberOfDriftedMoves += 1;
+    }
+  }
+
+  rig.moveTo(0);
+
+  std::printf("drift: %u moves, %u steps, %u misaligned, %u drifted, phase %d at position %d\n", numberOfDriftMoves, rig.translator.getNumberOfSteps(),
+              rig.translator.getNumberOfMisalignedSteps(), numberOfDriftedMoves, rig.translator.getPhase() - phaseAtZero, rig.motorController->getPosition());
+
+  CHECK(rig.translator.getNumberOfMisalignedSteps() == 0);
+  CHECK(numberOfDriftedMoves == 0);
+  CHECK(rig.motorController->getPosition() == 0);
+  CHECK(rig.translator.getPhase() == phaseAtZero);
+}
+
+/**
+ * A full range slew runs in coarse microsteps, faster than fine steps at the pulse rate allow, without exceeding the pulse rate
+ */
+void testSlew() {
+  Rig rig;
+
+  MotionLimits const motionLimits = {
+      .opening = {motorMaximalSpeed * 8.0F, 1000000},
+      .closing = {motorMaximalSpeed * 8.0F, 1000000},
+  };
+  rig.motorController->setMotionLimits(motionLimits);
+  rig.motorController->setSpeed(motorMaximalSpeed * 8.0F);
+  rig.motorController->setAcceleration(1000000);
+  rig.motorController->setDeceleration(1000000);
+
+  rig.motorController->moveToHome();
+  rig.translator.consume(rig.clock->getTime_InUS());
+
+  auto const numberOfHomingSteps = rig.translator.getStepEdges().size();
+  auto const slewTime_InUS = rig.moveTo(100);
+  auto const &stepEdges = rig.translator.getStepEdges();
+
+  // The coarse slew ends on the nearest full step and the fine approach may turn back from there, a new run starts at once
+  auto minimalInterval_InUS = std::numeric_limits<uint64_t>::max();
+  for (auto i = numberOfHomingSteps + 1; i < stepEdges.size(); ++i) {
+    if (stepEdges[i].direction == stepEdges[i - 1].direction) {
+      minimalInterval_InUS = std::min(minimalInterval_InUS, stepEdges[i].time_InUS - stepEdges[i - 1].time_InUS);
+    }
+  }
+
+  auto const numberOfSlewPulses = stepEdges.size() - numberOfHomingSteps;
+  auto const fineSlewTime_InUS = static_cast<uint64_t>(motorMaximalSteps) * 1000000 / motorMaximalSpeed;
+
+  std::printf("slew: %lu us for %u steps in %lu pulses, fine steps need %lu us, shortest pulse interval %lu us\n", static_cast<unsigned long>(slewTime_InUS),
+              motorMaximalSteps, static_cast<unsigned long>(numberOfSlewPulses), static_cast<unsigned long>(fineSlewTime_InUS),
+              static_cast<unsigned long>(minimalInterval_InUS));
+
+  CHECK(rig.motorController->getPosition() == static_cast<int32_t>(motorMaximalSteps));
+  CHECK(numberOfSlewPulses < motorMaximalSteps);
+  CHECK(slewTime_InUS < fineSlewTime_InUS);
+  CHECK(minimalInterval_InUS >= 1000000 / motorMaximalSpeed);
+}
+
+}// namespace
+
+int main() {
+  testHomedPosition();
+  testDrift();
+  testSlew();
+
+  return test::finish();
+}
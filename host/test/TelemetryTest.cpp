@@ -0,0 +1,199 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include <vector>
+#include <cstdio>
+#include <poll.h>
+
+#include "Test.hpp"
+#include "Pty.hpp"
+#include "Random.hpp"
+#include "TelemetryDecoder.hpp"
+#include "telemetry/PosixTransport.hpp"
+#include "telemetry/TelemetryLink.hpp"
+
+constexpr uint32_t const numberOfTicks = 200;
+constexpr uint32_t const maximalFramesPerTick = 6;
+constexpr std::size_t const maximalPayloadSize = 600;
+
+constexpr uint8_t const echoCommand = 5;
+constexpr uint8_t const unknownCommand = 7;
+constexpr std::size_t const echoArgumentsSize = 400;
+
+constexpr uint32_t const exchangeTimeout_InMS = 1000;
+
+namespace {
+
+using Frame = std::vector<uint8_t>;
+
+struct Received {
+  uint8_t channel;
+  Frame payload;
+};
+
+/**
+ * Payloads with zeros, runs of more than 254 non zero bytes and everything in between, the COBS edge cases
+ */
+Frame makePayload(Random &random) {
+  Frame payload(random.next() % (maximalPayloadSize + 1));
+
+  auto const isZeroFree = random.next() % 3 == 0;
+  for (auto &byte : payload) {
+    byte = static_cast<uint8_t>(random.next());
+    if (isZeroFree and byte == 0) {
+      byte = 0xFF;
+    }
+  }
+
+  return payload;
+}
+
+/**
+ * A pty hands the bytes on from a kernel worker, they show up on the other end a little later.
+ * Runs the device link and reads the master until the frames arrived or the timeout passed.
+ */
+std::vector<Received> exchange(Pty const &pty, TelemetryLink &deviceLink, TelemetryDecoder &decoder, std::size_t const numberOfFrames) {
+  std::vector<Received> received;
+  uint8_t chunk[512];
+
+  for (uint32_t i = 0; i < exchangeTimeout_InMS and received.size() < numberOfFrames; ++i) {
+    deviceLink.spinOnce();
+
+    pollfd master = {pty.getFileDescriptor(), POLLIN, 0};
+    poll(&master, 1, 1);
+
+    auto numberOfBytes = pty.read(chunk, sizeof(chunk));
+    while (numberOfBytes > 0) {
+      decoder.feed(chunk, numberOfBytes, [&received](uint8_t const channel, uint8_t const *payload, std::size_t const size) {
+        received.push_back({channel, Frame(payload, payload + size)});
+      });
+      numberOfBytes = pty.read(chunk, sizeof(chunk));
+    }
+  }
+
+  return received;
+}
+
+/**
+ * Ride log frames streamed tick by tick have to come out on the master whole, in order and without drops
+ */
+void testStream(Pty const &pty, TelemetryLink &deviceLink) {
+  Random random(45);
+  TelemetryDecoder decoder;
+
+  uint32_t numberOfSent = 0;
+  uint32_t numberOfIntact = 0;
+
+  for (uint32_t tick = 0; tick < numberOfTicks; ++tick) {
+    std::vector<Frame> sent;
+
+    auto const numberOfFrames = 1 + random.next() % maximalFramesPerTick;
+    for (uint32_t i = 0; i < numberOfFrames; ++i) {
+      sent.push_back(makePayload(random));
+      deviceLink.send(TELEMETRY_CHANNEL_RIDE_LOG, sent.back().data(), sent.back().size());
+    }
+
+    numberOfSent += sent.size();
+
+    auto const received = exchange(pty, deviceLink, decoder, sent.size());
+    for (std::size_t i = 0; i < received.size() and i < sent.size(); ++i) {
+      if (received[i].channel == TELEMETRY_CHANNEL_RIDE_LOG and received[i].payload == sent[i]) {
+        numberOfIntact += 1;
+      }
+    }
+  }
+
+  std::printf("stream: %u frames sent, %u intact, %u corrupted, %u dropped\n", numberOfSent, numberOfIntact, decoder.getNumberOfCorrupted(), deviceLink.getNumberOfDropped());
+
+  CHECK(numberOfIntact == numberOfSent);
+  CHECK(decoder.getNumberOfCorrupted() == 0);
+  CHECK(deviceLink.getNumberOfDropped() == 0);
+}
+
+/**
+ * Commands from the master reach their handler and are answered, garbage and an overlong frame in front of one are skipped
+ */
+void testCommands(Pty const &pty, TelemetryLink &deviceLink) {
+  Frame echoArguments;
+  deviceLink.registerCommand(echoCommand, [&echoArguments](uint8_t const *arguments, std::size_t const size) {
+    echoArguments.assign(arguments, arguments + size);
+    return TELEMETRY_COMMAND_STATUS_OK;
+  });
+
+  TelemetryLink hostLink(pty.createMasterTransport());
+  TelemetryDecoder decoder;
+
+  Frame command(1 + echoArgumentsSize);
+  command[0] = echoCommand;
+  for (std::size_t i = 1; i < command.size(); ++i) {
+    command[i] = static_cast<uint8_t>(i % 7 == 0 ? 0 : i);
+  }
+
+  hostLink.send(TELEMETRY_CHANNEL_COMMAND, command.data(), command.size());
+  hostLink.flush();
+
+  auto const echoResponse = exchange(pty, deviceLink, decoder, 1);
+  CHECK(echoResponse.size() == 1);
+  CHECK(not echoResponse.empty() and echoResponse[0].channel == TELEMETRY_CHANNEL_RESPONSE and echoResponse[0].payload == Frame({echoCommand, TELEMETRY_COMMAND_STATUS_OK}));
+  CHECK(echoArguments == Frame(command.begin() + 1, command.end()));
+
+  uint8_t const unknown[] = {unknownCommand};
+  hostLink.send(TELEMETRY_CHANNEL_COMMAND, unknown, sizeof(unknown));
+  hostLink.flush();
+
+  auto const unknownResponse = exchange(pty, deviceLink, decoder, 1);
+  CHECK(unknownResponse.size() == 1);
+  CHECK(not unknownResponse.empty() and unknownResponse[0].payload == Frame({unknownCommand, TELEMETRY_COMMAND_STATUS_UNKNOWN}));
+
+  // Line noise, then a frame longer than the receiver holds, then a good command in the same write
+  Frame garbage = {0x11, 0x22, 0x33, 0x44, 0x00};
+  garbage.insert(garbage.end(), telemetryMaximalFrameSize + 100, 0x55);
+  garbage.push_back(0x00);
+  pty.write(garbage.data(), garbage.size());
+
+  echoArguments.clear();
+  hostLink.send(TELEMETRY_CHANNEL_COMMAND, command.data(), command.size());
+  hostLink.flush();
+
+  auto const resynchronisedResponse = exchange(pty, deviceLink, decoder, 1);
+  CHECK(resynchronisedResponse.size() == 1);
+  CHECK(echoArguments.size() == echoArgumentsSize);
+
+  std::printf("commands: %u responses, the one after line noise %s\n", decoder.getNumberOfFrames(), echoArguments.empty() ? "lost" : "answered");
+}
+
+}// namespace
+
+int main() {
+  Pty pty;
+  if (not CHECK(pty.isOpen())) {
+    return test::finish();
+  }
+
+  auto transport = std::make_unique<PosixTransport>(pty.getSlavePath());
+  if (not CHECK(transport->isOpen())) {
+    return test::finish();
+  }
+
+  TelemetryLink deviceLink(std::move(transport));
+
+  testStream(pty, deviceLink);
+  testCommands(pty, deviceLink);
+
+  return test::finish();
+}
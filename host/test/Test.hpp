@@ -0,0 +1,58 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+
+/**
+ * Minimal checks for the host tests, a failed check is reported and the test goes on
+ */
+namespace test {
+
+inline uint32_t &numberOfFailures() {
+  static uint32_t failures = 0;
+  return failures;
+}
+
+inline bool check(bool const isPassed, char const *expression, char const *file, int const line) {
+  if (not isPassed) {
+    numberOfFailures() += 1;
+    std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+  }
+
+  return isPassed;
+}
+
+/**
+ * @return Exit code of the test program
+ */
+inline int finish() {
+  if (numberOfFailures() > 0) {
+    std::fprintf(stderr, "%u checks failed\n", numberOfFailures());
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+}// namespace test
+
+#define CHECK(expression) test::check((expression), #expression, __FILE__, __LINE__)
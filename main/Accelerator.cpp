@@ -19,13 +19,23 @@
 
 #include "Accelerator.hpp"
 
+#include <cstdlib>
+#include <cinttypes>
+#include <algorithm>
+
 #include <esp_log.h>
+
+#include "log/DeferredLog.hpp"
+
+#ifdef ESP_PLATFORM
 #include <esp_adc/adc_filter.h>
 #include <esp_adc/adc_continuous.h>
 #include <esp_adc/adc_cali_scheme.h>
+#endif
 
 constexpr char const *tag = "accelerator";
 
+#ifdef ESP_PLATFORM
 constexpr adc_unit_t adcUnitNum = ADC_UNIT_1;
 constexpr adc_channel_t adcChannelNum = ADC_CHANNEL_3;
 constexpr adc_atten_t adcAttenuation = ADC_ATTEN_DB_12;
@@ -33,22 +43,89 @@ constexpr adc_bitwidth_t adcBitWidth = ADC_BITWIDTH_12;
 constexpr adc_digi_convert_mode_t adcConvertMode = ADC_CONV_SINGLE_UNIT_1;
 constexpr adc_digi_output_format_t adcOutputFormat = ADC_DIGI_OUTPUT_FORMAT_TYPE2;
 constexpr adc_channel_t adcChannels[1] = {adcChannelNum};
-constexpr uint32_t frameSize = 256;
 
 constexpr adc_digi_iir_filter_coeff_t adcFilterCoefficient = ADC_DIGI_IIR_FILTER_COEFF_64;
+#else
+// Nominal full scale at 12 dB, the host has no eFuse curve to correct it
+constexpr uint32_t const adcFullScale_InMillivolts = 3100;
+#endif
+
+constexpr char const *storageNamespace = "accelerator";
+constexpr char const *minimalVoltageKey = "min_mv";
+constexpr char const *maximalVoltageKey = "max_mv";
+
+constexpr uint32_t const defaultMinimalVoltage_InMillivolts = 1000;
+constexpr uint32_t const defaultMaximalVoltage_InMillivolts = 2500;
 
+constexpr uint32_t const calibrationMinimalRange_InMillivolts = 500;
+constexpr uint32_t const calibrationMargin_InMillivolts = 20;
+
+constexpr uint32_t const restWindow_InMillivolts = calibrationMargin_InMillivolts;
+constexpr uint32_t const restMaximalDrift_InMillivolts = 100;
+constexpr uint32_t const restAdaptationShift = 16;
+
+constexpr uint32_t const pollReadTimeout_InMS = 5;
+
+#ifdef ESP_PLATFORM
 adc_continuous_handle_t adcHandle = nullptr;
 adc_cali_handle_t calibrationHandle = nullptr;
 adc_iir_filter_handle_t filterHandle = nullptr;
+#endif
+
+namespace {
 
-Accelerator::Accelerator() : m_minimalVoltage_InMillivolts(1000),
-                             m_maximalVoltage_InMillivolts(2500),
+uint32_t convertRawToVoltage(uint32_t const rawData) {
+#ifdef ESP_PLATFORM
+  int voltage_InMillivolts = 0;
+  ESP_ERROR_CHECK(adc_cali_raw_to_voltage(calibrationHandle, static_cast<int>(rawData), &voltage_InMillivolts));
+  return static_cast<uint32_t>(std::max(voltage_InMillivolts, 0));
+#else
+  return rawData * adcFullScale_InMillivolts / adcResultDataMask;
+#endif
+}
+
+uint32_t getVoltageDifference(uint32_t const voltage1_InMillivolts, uint32_t const voltage2_InMillivolts) {
+  return voltage1_InMillivolts > voltage2_InMillivolts ? voltage1_InMillivolts - voltage2_InMillivolts : voltage2_InMillivolts - voltage1_InMillivolts;
+}
+
+}// namespace
+
+Accelerator::Accelerator(uint32_t const controlFrequencyInHertz, uint32_t const oversamplingRatio, IClockPtr clock) : m_minimalVoltage_InMillivolts(defaultMinimalVoltage_InMillivolts),
+                             m_maximalVoltage_InMillivolts(defaultMaximalVoltage_InMillivolts),
+                             m_percentagePerMillivoltQ16(0),
                              m_trashholdVoltage_InMillivolts(10),
+                             m_clock(std::move(clock)),
+                             m_storage(std::make_unique<Storage>(storageNamespace)),
+                             m_decimation(adcDecimationConfigure(controlFrequencyInHertz, oversamplingRatio)),
+                             m_frame(),
+                             m_frameSequence(0),
                              m_changeValueCallbackFunction(nullptr),
-                             m_lastValue_InMillivolts(0) {
+                             m_frameCallbackFunction(nullptr),
+                             m_activityCallbackFunction(nullptr),
+                             m_filters(),
+                             m_filter(nullptr),
+                             m_lastValue_InMillivolts(0),
+                             m_isSuspended(false),
+                             m_isCalibrating(false),
+                             m_calibratedMinimalVoltage_InMillivolts(0),
+                             m_calibrationMinimalVoltage_InMillivolts(0),
+                             m_calibrationMaximalVoltage_InMillivolts(0),
+                             m_calibrationHistory_InMillivolts{0, 0, 0},
+                             m_restVoltage_InMillivoltsQ16(0) {
+  auto const minimalVoltage_InMillivolts = m_storage->getValue(minimalVoltageKey, defaultMinimalVoltage_InMillivolts);
+  auto const maximalVoltage_InMillivolts = m_storage->getValue(maximalVoltageKey, defaultMaximalVoltage_InMillivolts);
+
+  applyCalibration(minimalVoltage_InMillivolts, maximalVoltage_InMillivolts);
+
+  m_calibratedMinimalVoltage_InMillivolts = m_minimalVoltage_InMillivolts;
+  m_restVoltage_InMillivoltsQ16 = (m_minimalVoltage_InMillivolts - calibrationMargin_InMillivolts) << 16;
+
+#ifdef ESP_PLATFORM
+  ESP_LOGI(tag, "Sampling at %" PRIu32 " Hz, %" PRIu32 " results per frame", m_decimation.sampleFrequency_InHertz, m_decimation.frameSize_InBytes / adcResultSize_InBytes);
+
   adc_continuous_handle_cfg_t adcHandleConfiguration = {
-      .max_store_buf_size = 1024,
-      .conv_frame_size = frameSize,
+      .max_store_buf_size = 4 * m_decimation.frameSize_InBytes,
+      .conv_frame_size = m_decimation.frameSize_InBytes,
   };
   ESP_ERROR_CHECK(adc_continuous_new_handle(&adcHandleConfiguration, &adcHandle));
 
@@ -65,7 +142,7 @@ Accelerator::Accelerator() : m_minimalVoltage_InMillivolts(1000),
   adc_continuous_config_t adcContinuousConfiguration = {
       .pattern_num = numberOfChannelsUsed,
       .adc_pattern = adcDigitalPatternConfiguration,
-      .sample_freq_hz = 80 * 1000,
+      .sample_freq_hz = m_decimation.sampleFrequency_InHertz,
       .conv_mode = adcConvertMode,
       .format = adcOutputFormat
   };
@@ -88,9 +165,14 @@ Accelerator::Accelerator() : m_minimalVoltage_InMillivolts(1000),
   ESP_ERROR_CHECK(adc_continuous_iir_filter_enable(filterHandle));
 
   ESP_ERROR_CHECK(adc_continuous_start(adcHandle));
+#endif
 }
 
 Accelerator::~Accelerator() {
+  resume();
+
+#ifdef ESP_PLATFORM
+
   ESP_ERROR_CHECK(adc_continuous_stop(adcHandle));
 
   ESP_ERROR_CHECK(adc_continuous_iir_filter_disable(filterHandle));
@@ -99,62 +181,244 @@ Accelerator::~Accelerator() {
   ESP_ERROR_CHECK(adc_cali_delete_scheme_curve_fitting(calibrationHandle));
 
   ESP_ERROR_CHECK(adc_continuous_deinit(adcHandle));
+#endif
 }
 
 void Accelerator::registerChangeAccelerateCallback(AcceleratorChangeValueCallbackFunction const &changeValueCallbackFunction) {
   m_changeValueCallbackFunction = changeValueCallbackFunction;
 }
 
+void Accelerator::registerFrameCallback(AcceleratorFrameCallbackFunction const &frameCallbackFunction) {
+  m_frameCallbackFunction = frameCallbackFunction;
+}
+
+void Accelerator::registerActivityCallback(AcceleratorActivityCallbackFunction const &activityCallbackFunction) {
+  m_activityCallbackFunction = activityCallbackFunction;
+}
+
+void Accelerator::setFilter(IFilterPtr filter) {
+  std::vector<IFilterPtr> filters;
+
+  if (filter) {
+    filters.push_back(std::move(filter));
+  }
+
+  setFilters(std::move(filters));
+}
+
+void Accelerator::setFilters(std::vector<IFilterPtr> filters) {
+  m_filters = std::move(filters);
+  m_filter = nullptr;
+
+  selectFilter(0);
+}
+
+void Accelerator::selectFilter(uint32_t const filterIndex) {
+  if (filterIndex >= m_filters.size()) {
+    return;
+  }
+
+  m_filter = m_filters[filterIndex].get();
+  m_filter->reset(static_cast<int32_t>(m_lastValue_InMillivolts));
+
+  auto const groupDelay_InUS = m_filter->getGroupDelay() * static_cast<float>(getFramePeriod_InUS());
+
+  deferredLog(LOG_ACCELERATOR_FILTER, static_cast<int32_t>(filterIndex), static_cast<int32_t>(groupDelay_InUS));
+}
+
+uint32_t Accelerator::getFramePeriod_InUS() const {
+  return adcDecimationFramePeriod_InUS(m_decimation);
+}
+
+bool Accelerator::isCalibrating() const {
+  return m_isCalibrating;
+}
+
+bool Accelerator::calibrationStart() {
+  if (m_lastValue_InMillivolts > m_minimalVoltage_InMillivolts + restWindow_InMillivolts) {
+    ESP_LOGW(tag, "Calibration refused, release the pedal first");
+    return false;
+  }
+
+  m_isCalibrating = true;
+  m_calibrationMinimalVoltage_InMillivolts = UINT32_MAX;
+  m_calibrationMaximalVoltage_InMillivolts = 0;
+
+  for (auto &voltage_InMillivolts : m_calibrationHistory_InMillivolts) {
+    voltage_InMillivolts = m_lastValue_InMillivolts;
+  }
+
+  ESP_LOGI(tag, "Calibration started, sweep the pedal over its full travel");
+
+  return true;
+}
+
+void Accelerator::calibrationStop() {
+  if (not m_isCalibrating) {
+    return;
+  }
+
+  m_isCalibrating = false;
+
+  auto const restVoltage_InMillivolts = m_calibrationMinimalVoltage_InMillivolts;
+  auto const fullVoltage_InMillivolts = m_calibrationMaximalVoltage_InMillivolts;
+
+  if (restVoltage_InMillivolts > fullVoltage_InMillivolts or fullVoltage_InMillivolts - restVoltage_InMillivolts < calibrationMinimalRange_InMillivolts) {
+    ESP_LOGW(tag, "Calibration rejected, pedal travel %" PRIu32 "..%" PRIu32 " mV is too short", restVoltage_InMillivolts, fullVoltage_InMillivolts);
+    return;
+  }
+
+  applyCalibration(restVoltage_InMillivolts + calibrationMargin_InMillivolts, fullVoltage_InMillivolts - calibrationMargin_InMillivolts);
+
+  m_calibratedMinimalVoltage_InMillivolts = m_minimalVoltage_InMillivolts;
+  m_restVoltage_InMillivoltsQ16 = restVoltage_InMillivolts << 16;
+
+  m_storage->setValue(minimalVoltageKey, m_minimalVoltage_InMillivolts);
+  m_storage->setValue(maximalVoltageKey, m_maximalVoltage_InMillivolts);
+  m_storage->commit();
+
+  ESP_LOGI(tag, "Calibration done, pedal range %" PRIu32 "..%" PRIu32 " mV", m_minimalVoltage_InMillivolts, m_maximalVoltage_InMillivolts);
+}
+
+void Accelerator::suspend() {
+  if (m_isSuspended) {
+    return;
+  }
+
+#ifdef ESP_PLATFORM
+  ESP_ERROR_CHECK(adc_continuous_stop(adcHandle));
+
+  // The hardware filter would start from a stale state on every poll and report a move
+  ESP_ERROR_CHECK(adc_continuous_iir_filter_disable(filterHandle));
+#endif
+
+  m_isSuspended = true;
+}
+
+void Accelerator::resume() {
+  if (not m_isSuspended) {
+    return;
+  }
+
+#ifdef ESP_PLATFORM
+  ESP_ERROR_CHECK(adc_continuous_iir_filter_enable(filterHandle));
+  ESP_ERROR_CHECK(adc_continuous_flush_pool(adcHandle));
+  ESP_ERROR_CHECK(adc_continuous_start(adcHandle));
+#endif
+
+  m_isSuspended = false;
+}
+
+bool Accelerator::pollActivity(uint32_t const thresholdInMillivolts) {
+  if (not m_isSuspended) {
+    return false;
+  }
+
+#ifdef ESP_PLATFORM
+  uint32_t numberOfValuesInFrame = 0;
+
+  ESP_ERROR_CHECK(adc_continuous_flush_pool(adcHandle));
+  ESP_ERROR_CHECK(adc_continuous_start(adcHandle));
+  esp_err_t returnCode = adc_continuous_read(adcHandle, m_frame.data(), m_decimation.frameSize_InBytes, &numberOfValuesInFrame, pollReadTimeout_InMS);
+  ESP_ERROR_CHECK(adc_continuous_stop(adcHandle));
+
+  if (returnCode != ESP_OK) {
+    return false;
+  }
+
+  auto const frameSum = adcReduceFrame(m_frame.data(), numberOfValuesInFrame);
+  if (frameSum.numberOfValues == 0) {
+    return false;
+  }
+
+  auto const voltage_InMillivolts = convertRawToVoltage(frameSum.sum / frameSum.numberOfValues);
+
+  return getVoltageDifference(voltage_InMillivolts, m_lastValue_InMillivolts) > thresholdInMillivolts;
+#else
+  // No conversion stream on the host, frames only come in through processFrame()
+  static_cast<void>(thresholdInMillivolts);
+  return false;
+#endif
+}
+
 void Accelerator::process() {
   if (not m_changeValueCallbackFunction) {
     return;
   }
 
-  uint8_t frame[frameSize] = {0};
+  if (m_isSuspended) {
+    return;
+  }
+
+#ifdef ESP_PLATFORM
   uint32_t numberOfValuesInFrame = 0;
 
-  esp_err_t returnCode = adc_continuous_read(adcHandle, frame, frameSize, &numberOfValuesInFrame, 0);
+  esp_err_t returnCode = adc_continuous_read(adcHandle, m_frame.data(), m_decimation.frameSize_InBytes, &numberOfValuesInFrame, 0);
   if (returnCode != ESP_OK) {
     return;
   }
 
-  uint32_t valueCount = 0;
-  uint32_t sumOfRawDataPerFrame = 0;
-
-  for (auto i = 0; i < numberOfValuesInFrame; i += SOC_ADC_DIGI_RESULT_BYTES) {
-    auto *adcDigitalOutputData = (adc_digi_output_data_t *) &frame[i];
-    uint32_t const data = adcDigitalOutputData->type2.data;
+  // Zero is left for untraced values
+  m_frameSequence = m_frameSequence + 1 == 0 ? 1 : m_frameSequence + 1;
+  TraceTag const traceTag = {m_frameSequence, m_clock->getTime_InUS()};
 
-    valueCount += 1;
-    sumOfRawDataPerFrame += data;
+  if (m_frameCallbackFunction) {
+    m_frameCallbackFunction(m_frame.data(), numberOfValuesInFrame);
   }
 
-  auto const rawAverageData = sumOfRawDataPerFrame / valueCount;
+  processFrame(m_frame.data(), numberOfValuesInFrame, traceTag);
+#endif
+}
 
-  int voltage_InMillivolts = 0;
+void Accelerator::processFrame(uint8_t const *frame, uint32_t const numberOfValuesInFrame, TraceTag const traceTag) {
+  if (not m_changeValueCallbackFunction) {
+    return;
+  }
 
-  ESP_ERROR_CHECK(adc_cali_raw_to_voltage(calibrationHandle, rawAverageData, &voltage_InMillivolts));
+#ifdef ESP_PLATFORM
+  static_assert(adcResultSize_InBytes == SOC_ADC_DIGI_RESULT_BYTES, "Reduction expects TYPE2 results");
+#endif
 
-  uint32_t voltageDifference_InMillivolts = 0;
+  auto const frameSum = adcReduceFrame(frame, numberOfValuesInFrame);
 
-  if (voltage_InMillivolts == m_lastValue_InMillivolts) {
+  // A short read can come back empty
+  if (frameSum.numberOfValues == 0) {
     return;
   }
 
-  if (voltage_InMillivolts > m_lastValue_InMillivolts) {
-    voltageDifference_InMillivolts = voltage_InMillivolts - m_lastValue_InMillivolts;
+  auto const rawAverageData = frameSum.sum / frameSum.numberOfValues;
+
+  auto voltage_InMillivolts = convertRawToVoltage(rawAverageData);
+
+  // Raw movement is reported ahead of the filter delay so the motor driver can wake up early
+  if (m_activityCallbackFunction and getVoltageDifference(voltage_InMillivolts, m_lastValue_InMillivolts) > m_trashholdVoltage_InMillivolts) {
+    m_activityCallbackFunction();
+  }
+
+  if (m_filter) {
+    int32_t filteredVoltage_InMillivolts = 0;
+
+    if (not m_filter->process(static_cast<int32_t>(voltage_InMillivolts), filteredVoltage_InMillivolts)) {
+      return;
+    }
+
+    voltage_InMillivolts = static_cast<uint32_t>(std::max<int32_t>(filteredVoltage_InMillivolts, 0));
   }
 
-  if (voltage_InMillivolts < m_lastValue_InMillivolts) {
-    voltageDifference_InMillivolts = m_lastValue_InMillivolts - voltage_InMillivolts;
+  if (m_isCalibrating) {
+    return processCalibration(voltage_InMillivolts);
   }
 
+  processRestAdaptation(voltage_InMillivolts);
+
+  auto const voltageDifference_InMillivolts = getVoltageDifference(voltage_InMillivolts, m_lastValue_InMillivolts);
+
   if (voltageDifference_InMillivolts > m_trashholdVoltage_InMillivolts) {
     m_lastValue_InMillivolts = voltage_InMillivolts;
 
     auto const percentage = convertVoltageToPercentage(voltage_InMillivolts);
 
-    m_changeValueCallbackFunction(percentage);
+    m_changeValueCallbackFunction(percentage, traceTag);
   }
 }
 
@@ -169,5 +433,70 @@ uint32_t Accelerator::convertVoltageToPercentage(uint32_t const voltageInMillivo
     currentVoltage_InMillivolts = m_maximalVoltage_InMillivolts;
   }
 
-  return (currentVoltage_InMillivolts - m_minimalVoltage_InMillivolts) * 100 / (m_maximalVoltage_InMillivolts - m_minimalVoltage_InMillivolts);
+  auto const percentage = ((currentVoltage_InMillivolts - m_minimalVoltage_InMillivolts) * m_percentagePerMillivoltQ16) >> 16;
+  if (percentage > 100) {
+    return 100;
+  }
+
+  return percentage;
+}
+
+void Accelerator::applyCalibration(uint32_t const minimalVoltageInMillivolts, uint32_t const maximalVoltageInMillivolts) {
+  if (minimalVoltageInMillivolts >= maximalVoltageInMillivolts) {
+    return;
+  }
+
+  m_minimalVoltage_InMillivolts = minimalVoltageInMillivolts;
+  m_maximalVoltage_InMillivolts = maximalVoltageInMillivolts;
+
+  // The division is done once here so the conversion per sample is a multiply and a shift
+  auto const range_InMillivolts = m_maximalVoltage_InMillivolts - m_minimalVoltage_InMillivolts;
+  m_percentagePerMillivoltQ16 = ((100 << 16) + range_InMillivolts - 1) / range_InMillivolts;
+}
+
+void Accelerator::processCalibration(uint32_t const voltageInMillivolts) {
+  m_calibrationHistory_InMillivolts[0] = m_calibrationHistory_InMillivolts[1];
+  m_calibrationHistory_InMillivolts[1] = m_calibrationHistory_InMillivolts[2];
+  m_calibrationHistory_InMillivolts[2] = voltageInMillivolts;
+
+  auto const a = m_calibrationHistory_InMillivolts[0];
+  auto const b = m_calibrationHistory_InMillivolts[1];
+  auto const c = m_calibrationHistory_InMillivolts[2];
+
+  // Median of the last three values, a single spike never reaches the bounds
+  auto const voltage_InMillivolts = std::max(std::min(a, b), std::min(std::max(a, b), c));
+
+  if (voltage_InMillivolts < m_calibrationMinimalVoltage_InMillivolts) {
+    m_calibrationMinimalVoltage_InMillivolts = voltage_InMillivolts;
+  }
+
+  if (voltage_InMillivolts > m_calibrationMaximalVoltage_InMillivolts) {
+    m_calibrationMaximalVoltage_InMillivolts = voltage_InMillivolts;
+  }
+}
+
+void Accelerator::processRestAdaptation(uint32_t const voltageInMillivolts) {
+  if (voltageInMillivolts > m_minimalVoltage_InMillivolts + restWindow_InMillivolts) {
+    return;
+  }
+
+  // Slow follower of the rest position, compensates sensor drift without reacting to the rider
+  auto const voltage_InMillivoltsQ16 = static_cast<int32_t>(voltageInMillivolts << 16);
+  m_restVoltage_InMillivoltsQ16 += (voltage_InMillivoltsQ16 - static_cast<int32_t>(m_restVoltage_InMillivoltsQ16)) >> restAdaptationShift;
+
+  auto minimalVoltage_InMillivolts = (m_restVoltage_InMillivoltsQ16 >> 16) + calibrationMargin_InMillivolts;
+
+  if (minimalVoltage_InMillivolts + restMaximalDrift_InMillivolts < m_calibratedMinimalVoltage_InMillivolts) {
+    minimalVoltage_InMillivolts = m_calibratedMinimalVoltage_InMillivolts - restMaximalDrift_InMillivolts;
+  }
+
+  if (minimalVoltage_InMillivolts > m_calibratedMinimalVoltage_InMillivolts + restMaximalDrift_InMillivolts) {
+    minimalVoltage_InMillivolts = m_calibratedMinimalVoltage_InMillivolts + restMaximalDrift_InMillivolts;
+  }
+
+  if (minimalVoltage_InMillivolts == m_minimalVoltage_InMillivolts) {
+    return;
+  }
+
+  applyCalibration(minimalVoltage_InMillivolts, m_maximalVoltage_InMillivolts);
 }
@@ -18,34 +18,139 @@
 
 #pragma once
 
+#include <array>
+#include <vector>
 #include <functional>
 
+#include "Storage.hpp"
+#include "adc/AdcFrameReduction.hpp"
 #include "executor/Node.hpp"
+#include "clock/SystemClock.hpp"
+#include "trace/TraceTag.hpp"
+#include "filter/interface/IFilter.hpp"
 
-using AcceleratorChangeValueCallbackFunction = std::function<void(uint32_t)>;
+using AcceleratorChangeValueCallbackFunction = std::function<void(uint32_t, TraceTag)>;
+using AcceleratorFrameCallbackFunction = std::function<void(uint8_t const *, uint32_t)>;
+using AcceleratorActivityCallbackFunction = std::function<void()>;
 
 class Accelerator : public executor::Node {
 public:
-  Accelerator();
+  /**
+   * @param controlFrequencyInHertz Rate the node is added to the executor with
+   * @param oversamplingRatio ADC results averaged into one value per tick, the sample clock follows from both
+   */
+  explicit Accelerator(uint32_t controlFrequencyInHertz = 1000, uint32_t oversamplingRatio = 64, IClockPtr clock = getSystemClock());
   ~Accelerator() override;
 
 public:
   void registerChangeAccelerateCallback(AcceleratorChangeValueCallbackFunction const &changeValueCallbackFunction);
+  void registerFrameCallback(AcceleratorFrameCallbackFunction const &frameCallbackFunction);
+  void registerActivityCallback(AcceleratorActivityCallbackFunction const &activityCallbackFunction);
+
+public:
+  /**
+   * Use a single filter, replaces any filters set before
+   */
+  void setFilter(IFilterPtr filter);
+
+  /**
+   * Filters to choose from later, one per riding profile, the first one is selected.
+   * Allocates, call it while setting up.
+   */
+  void setFilters(std::vector<IFilterPtr> filters);
+
+  /**
+   * Switch to one of the filters set before, restarted at the last pedal value.
+   * Neither allocates nor blocks on the log, usable from the control loop.
+   */
+  void selectFilter(uint32_t filterIndex);
+
+public:
+  /**
+   * Period of the values the filter sees, one per frame
+   */
+  [[nodiscard]] uint32_t getFramePeriod_InUS() const;
+
+public:
+  [[nodiscard]] bool isCalibrating() const;
+
+public:
+  /**
+   * No value is handed on while calibrating, the owner only starts it with the engine stopped
+   * @return False when the pedal is not at rest, the sweep has to start from the rest position
+   */
+  bool calibrationStart();
+  void calibrationStop();
+
+public:
+  /**
+   * Stop the conversion stream, process() does nothing until resumed
+   */
+  void suspend();
+  void resume();
+
+  /**
+   * Convert a single frame while suspended
+   * @return True when the pedal is more than the threshold away from the last reported position
+   */
+  bool pollActivity(uint32_t thresholdInMillivolts);
+
+public:
+  /**
+   * Reduce one conversion frame, used by process() and to replay recorded frames
+   * @param traceTag Handed to the change callback when the frame changes the value
+   */
+  void processFrame(uint8_t const *frame, uint32_t numberOfValuesInFrame, TraceTag traceTag = {});
+
+public:
+  /**
+   * Pedal position in percent for a voltage under the current calibration
+   */
+  [[nodiscard]] uint32_t convertVoltageToPercentage(uint32_t voltageInMillivolts) const;
 
 protected:
   void process() override;
 
 private:
-  [[nodiscard]] uint32_t convertVoltageToPercentage(uint32_t voltageInMillivolts) const;
+  void applyCalibration(uint32_t minimalVoltageInMillivolts, uint32_t maximalVoltageInMillivolts);
+  void processCalibration(uint32_t voltageInMillivolts);
+  void processRestAdaptation(uint32_t voltageInMillivolts);
 
 private:
-  uint32_t const m_minimalVoltage_InMillivolts;
-  uint32_t const m_maximalVoltage_InMillivolts;
+  uint32_t m_minimalVoltage_InMillivolts;
+  uint32_t m_maximalVoltage_InMillivolts;
+  uint32_t m_percentagePerMillivoltQ16;
   uint32_t const m_trashholdVoltage_InMillivolts;
 
+private:
+  IClockPtr m_clock;
+  StoragePtr m_storage;
+
+private:
+  AdcDecimation const m_decimation;
+  alignas(16) std::array<uint8_t, adcMaximalFrameSize_InBytes> m_frame;
+  uint32_t m_frameSequence;
+
 private:
   AcceleratorChangeValueCallbackFunction m_changeValueCallbackFunction;
+  AcceleratorFrameCallbackFunction m_frameCallbackFunction;
+  AcceleratorActivityCallbackFunction m_activityCallbackFunction;
+
+private:
+  std::vector<IFilterPtr> m_filters;
+  IFilter *m_filter;
 
 private:
   uint32_t m_lastValue_InMillivolts = 0;
+
+private:
+  bool m_isSuspended;
+
+private:
+  bool m_isCalibrating;
+  uint32_t m_calibratedMinimalVoltage_InMillivolts;
+  uint32_t m_calibrationMinimalVoltage_InMillivolts;
+  uint32_t m_calibrationMaximalVoltage_InMillivolts;
+  uint32_t m_calibrationHistory_InMillivolts[3];
+  uint32_t m_restVoltage_InMillivoltsQ16;
 };
@@ -0,0 +1,199 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include "Blipper.hpp"
+
+#include <algorithm>
+
+Blipper::Blipper(BlipperConfiguration const &configuration) : m_configuration(configuration),
+                                                              m_slopeSamples(),
+                                                              m_lastSlopeSample(),
+                                                              m_slopeSampleIndex(0),
+                                                              m_numberOfSlopeSamples(0),
+                                                              m_phase(BLIPPER_PHASE_IDLE),
+                                                              m_gear(0),
+                                                              m_targetRevolutions_InRPM(0),
+                                                              m_opening_InPercentage(0),
+                                                              m_fallOpening_InPercentage(0),
+                                                              m_holdTime_InUS(0),
+                                                              m_phaseStartTime_InUS(0) {
+}
+
+void Blipper::setConfiguration(BlipperConfiguration const &configuration) {
+  m_configuration = configuration;
+}
+
+bool Blipper::isActive() const {
+  return m_phase != BLIPPER_PHASE_IDLE;
+}
+
+uint32_t Blipper::getGear() const {
+  return m_gear;
+}
+
+uint32_t Blipper::getTargetRevolutions_InRPM() const {
+  return m_targetRevolutions_InRPM;
+}
+
+void Blipper::observe(uint64_t const timeInUS, uint32_t const revolutionsInRPM, uint32_t const speedInKilometersPerHour) {
+  m_lastSlopeSample = {timeInUS, revolutionsInRPM, speedInKilometersPerHour};
+
+  // The window is held as a few evenly spaced samples, the oldest one is about a window back
+  auto const samplePeriod_InUS = m_configuration.decelerationWindow_InUS / blipperNumberOfSlopeSamples;
+  auto const &newestSample = m_slopeSamples[(m_slopeSampleIndex + blipperNumberOfSlopeSamples - 1) % blipperNumberOfSlopeSamples];
+
+  if (m_numberOfSlopeSamples > 0 and timeInUS - newestSample.time_InUS < samplePeriod_InUS) {
+    return;
+  }
+
+  m_slopeSamples[m_slopeSampleIndex] = m_lastSlopeSample;
+  m_slopeSampleIndex = (m_slopeSampleIndex + 1) % blipperNumberOfSlopeSamples;
+  m_numberOfSlopeSamples = std::min(m_numberOfSlopeSamples + 1, blipperNumberOfSlopeSamples);
+}
+
+bool Blipper::isDecelerating() const {
+  if (m_numberOfSlopeSamples < blipperNumberOfSlopeSamples) {
+    return false;
+  }
+
+  auto const &oldestSample = m_slopeSamples[m_slopeSampleIndex];
+
+  // A gap in the data, the samples say nothing about the last window
+  if (m_lastSlopeSample.time_InUS - oldestSample.time_InUS > 2 * static_cast<uint64_t>(m_configuration.decelerationWindow_InUS)) {
+    return false;
+  }
+
+  auto const isSpeedFalling = m_lastSlopeSample.speed_InKilometersPerHour + m_configuration.minimumSpeedDrop_InKilometersPerHour <= oldestSample.speed_InKilometersPerHour;
+  auto const isRevolutionsFalling = m_lastSlopeSample.revolutions_InRPM + m_configuration.minimumRevolutionsDrop_InRPM <= oldestSample.revolutions_InRPM;
+
+  return isSpeedFalling or isRevolutionsFalling;
+}
+
+bool Blipper::start(uint64_t const timeInUS, uint32_t const revolutionsInRPM, uint32_t const speedInKilometersPerHour, uint32_t const acceleratorInPercentage) {
+  stop();
+
+  // Only a closed throttle at speed is a downshift, with the throttle open the rider is shifting up
+  if (acceleratorInPercentage > m_configuration.closedThrottle_InPercentage) {
+    return false;
+  }
+
+  if (speedInKilometersPerHour < m_configuration.minimumSpeed_InKilometersPerHour) {
+    return false;
+  }
+
+  if (not isDecelerating()) {
+    return false;
+  }
+
+  auto const gear = findGear(revolutionsInRPM, speedInKilometersPerHour);
+  if (gear <= 1) {
+    return false;
+  }
+
+  auto const lowerGearRatio = m_configuration.gearRatios_InRPMPerKPH[gear - 2];
+  auto const targetRevolutions_InRPM = std::min(speedInKilometersPerHour * lowerGearRatio, m_configuration.maximumRevolutions_InRPM);
+
+  if (targetRevolutions_InRPM < revolutionsInRPM + m_configuration.minimumRevolutionsGap_InRPM) {
+    return false;
+  }
+
+  auto const revolutionsGap_InRPM = targetRevolutions_InRPM - revolutionsInRPM;
+
+  m_gear = gear;
+  m_targetRevolutions_InRPM = targetRevolutions_InRPM;
+  m_opening_InPercentage = std::min(revolutionsGap_InRPM * m_configuration.openingPerThousandRevolutions_InPercentage / 1000, m_configuration.maximumOpening_InPercentage);
+  m_holdTime_InUS = std::min(revolutionsGap_InRPM * m_configuration.holdTimePerThousandRevolutions_InUS / 1000, m_configuration.maximumHoldTime_InUS);
+  m_phase = BLIPPER_PHASE_RISE;
+  m_phaseStartTime_InUS = timeInUS;
+
+  return true;
+}
+
+void Blipper::stop() {
+  m_phase = BLIPPER_PHASE_IDLE;
+}
+
+uint32_t Blipper::update(uint64_t const timeInUS, uint32_t const revolutionsInRPM) {
+  auto const isOnTarget = revolutionsInRPM + m_configuration.targetTolerance_InRPM >= m_targetRevolutions_InRPM;
+
+  if (m_phase == BLIPPER_PHASE_RISE) {
+    auto const elapsedTime_InUS = timeInUS - m_phaseStartTime_InUS;
+
+    if (elapsedTime_InUS >= m_configuration.riseTime_InUS) {
+      m_phase = BLIPPER_PHASE_HOLD;
+      m_phaseStartTime_InUS = timeInUS;
+    } else {
+      auto const opening_InPercentage = static_cast<uint32_t>(m_opening_InPercentage * elapsedTime_InUS / m_configuration.riseTime_InUS);
+      if (not isOnTarget) {
+        return opening_InPercentage;
+      }
+
+      m_phase = BLIPPER_PHASE_FALL;
+      m_phaseStartTime_InUS = timeInUS;
+      m_fallOpening_InPercentage = opening_InPercentage;
+    }
+  }
+
+  if (m_phase == BLIPPER_PHASE_HOLD) {
+    auto const elapsedTime_InUS = timeInUS - m_phaseStartTime_InUS;
+
+    if (elapsedTime_InUS < m_holdTime_InUS and not isOnTarget) {
+      return m_opening_InPercentage;
+    }
+
+    // The engine spins up with a lag, start closing as soon as it is on target
+    m_phase = BLIPPER_PHASE_FALL;
+    m_phaseStartTime_InUS = timeInUS;
+    m_fallOpening_InPercentage = m_opening_InPercentage;
+  }
+
+  if (m_phase == BLIPPER_PHASE_FALL) {
+    auto const elapsedTime_InUS = timeInUS - m_phaseStartTime_InUS;
+
+    if (elapsedTime_InUS < m_configuration.fallTime_InUS) {
+      return static_cast<uint32_t>(m_fallOpening_InPercentage * (m_configuration.fallTime_InUS - elapsedTime_InUS) / m_configuration.fallTime_InUS);
+    }
+
+    m_phase = BLIPPER_PHASE_IDLE;
+  }
+
+  return 0;
+}
+
+uint32_t Blipper::findGear(uint32_t const revolutionsInRPM, uint32_t const speedInKilometersPerHour) const {
+  if (speedInKilometersPerHour == 0) {
+    return 0;
+  }
+
+  auto const ratio = revolutionsInRPM / speedInKilometersPerHour;
+
+  uint32_t gear = 0;
+  uint32_t smallestError = UINT32_MAX;
+
+  for (uint32_t index = 0; index < blipperNumberOfGears; ++index) {
+    auto const gearRatio = m_configuration.gearRatios_InRPMPerKPH[index];
+    auto const error = ratio > gearRatio ? ratio - gearRatio : gearRatio - ratio;
+
+    if (error < smallestError) {
+      smallestError = error;
+      gear = index + 1;
+    }
+  }
+
+  return gear;
+}
@@ -0,0 +1,133 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+constexpr uint32_t const blipperNumberOfGears = 6;
+constexpr uint32_t const blipperNumberOfSlopeSamples = 8;
+
+enum BlipperPhase {
+  BLIPPER_PHASE_IDLE = 0,
+  BLIPPER_PHASE_RISE,
+  BLIPPER_PHASE_HOLD,
+  BLIPPER_PHASE_FALL
+};
+
+struct BlipperConfiguration {
+  // Engine revolutions per km/h in each gear, first gear first. Rough values, refine them from logged rides
+  std::array<uint16_t, blipperNumberOfGears> gearRatios_InRPMPerKPH = {125, 90, 72, 61, 54, 49};
+
+  uint32_t minimumSpeed_InKilometersPerHour = 15;
+  uint32_t closedThrottle_InPercentage = 3;
+  uint32_t maximumRevolutions_InRPM = 7500;
+  uint32_t minimumRevolutionsGap_InRPM = 300;
+  uint32_t targetTolerance_InRPM = 150;
+
+  // The bike has to be slowing down over this window, a steady closed throttle coast is not a downshift
+  uint32_t decelerationWindow_InUS = 400 * 1000;
+  uint32_t minimumSpeedDrop_InKilometersPerHour = 1;
+  uint32_t minimumRevolutionsDrop_InRPM = 80;
+
+  uint32_t openingPerThousandRevolutions_InPercentage = 12;
+  uint32_t maximumOpening_InPercentage = 40;
+
+  uint32_t riseTime_InUS = 15 * 1000;
+  uint32_t holdTimePerThousandRevolutions_InUS = 40 * 1000;
+  uint32_t maximumHoldTime_InUS = 150 * 1000;
+  uint32_t fallTime_InUS = 60 * 1000;
+};
+
+struct BlipperSlopeSample {
+  uint64_t time_InUS;
+  uint32_t revolutions_InRPM;
+  uint32_t speed_InKilometersPerHour;
+};
+
+/**
+ * Throttle blip for clutch-in downshifts.
+ * Arms only while the bike decelerates, RPM or speed have to fall over the deceleration window.
+ * On the clutch edge it guesses the engaged gear from the RPM to speed ratio,
+ * targets the RPM of the next lower gear at the current speed and shapes a
+ * rise, hold, fall opening sized by the RPM gap. The hold ends early once the
+ * engine reaches the target. Knows nothing about the motor, the owner merges the opening.
+ */
+class Blipper {
+public:
+  explicit Blipper(BlipperConfiguration const &configuration = {});
+  ~Blipper() = default;
+
+public:
+  void setConfiguration(BlipperConfiguration const &configuration);
+
+public:
+  [[nodiscard]] bool isActive() const;
+  [[nodiscard]] uint32_t getGear() const;
+  [[nodiscard]] uint32_t getTargetRevolutions_InRPM() const;
+
+public:
+  /**
+   * Gear guessed from the RPM to speed ratio, zero when stationary
+   */
+  [[nodiscard]] uint32_t findGear(uint32_t revolutionsInRPM, uint32_t speedInKilometersPerHour) const;
+
+public:
+  /**
+   * Feed RPM and speed while the clutch is engaged, the deceleration check works on these
+   */
+  void observe(uint64_t timeInUS, uint32_t revolutionsInRPM, uint32_t speedInKilometersPerHour);
+
+  /**
+   * True when RPM or speed fell by the configured drop over the deceleration window
+   */
+  [[nodiscard]] bool isDecelerating() const;
+
+public:
+  /**
+   * Call on the clutch-in edge with the last values seen while the clutch was still engaged
+   * @return True when a blip was started
+   */
+  bool start(uint64_t timeInUS, uint32_t revolutionsInRPM, uint32_t speedInKilometersPerHour, uint32_t acceleratorInPercentage);
+  void stop();
+
+public:
+  /**
+   * @return Throttle opening in percent, zero once the blip is over
+   */
+  uint32_t update(uint64_t timeInUS, uint32_t revolutionsInRPM);
+
+private:
+  BlipperConfiguration m_configuration;
+
+private:
+  std::array<BlipperSlopeSample, blipperNumberOfSlopeSamples> m_slopeSamples;
+  BlipperSlopeSample m_lastSlopeSample;
+  uint32_t m_slopeSampleIndex;
+  uint32_t m_numberOfSlopeSamples;
+
+private:
+  BlipperPhase m_phase;
+  uint32_t m_gear;
+  uint32_t m_targetRevolutions_InRPM;
+  uint32_t m_opening_InPercentage;
+  uint32_t m_fallOpening_InPercentage;
+  uint32_t m_holdTime_InUS;
+  uint64_t m_phaseStartTime_InUS;
+};
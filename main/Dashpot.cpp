@@ -0,0 +1,84 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include "Dashpot.hpp"
+
+#include <algorithm>
+
+// Longer gaps come from a stalled input, they must not let the throttle drop in one step
+constexpr uint64_t const maximumTimeStep_InUS = 50 * 1000;
+
+constexpr uint32_t const revolutionFractionMask = (1 << dashpotRevolutionShift) - 1;
+
+Dashpot::Dashpot(DashpotConfiguration const &configuration) : m_configuration(configuration),
+                                                              m_lastUpdateTime_InUS(0),
+                                                              m_opening_InMilliPercentage(0),
+                                                              m_target_InMilliPercentage(0) {
+}
+
+void Dashpot::setConfiguration(DashpotConfiguration const &configuration) {
+  m_configuration = configuration;
+}
+
+bool Dashpot::isActive() const {
+  return m_opening_InMilliPercentage > m_target_InMilliPercentage;
+}
+
+uint32_t Dashpot::update(uint64_t const timeInUS, uint32_t const revolutionsInRPM, uint32_t const gear, uint32_t const openingInPercentage) {
+  auto const isClosing = isActive();
+
+  // The owner does not run while nothing changes, a closing is timed from the tick it started on
+  auto const timeStep_InUS = isClosing ? std::min(timeInUS - m_lastUpdateTime_InUS, maximumTimeStep_InUS) : 0;
+  m_lastUpdateTime_InUS = timeInUS;
+
+  m_target_InMilliPercentage = openingInPercentage * 1000;
+
+  if (m_target_InMilliPercentage >= m_opening_InMilliPercentage or revolutionsInRPM < m_configuration.runningRevolutions_InRPM) {
+    m_opening_InMilliPercentage = m_target_InMilliPercentage;
+    return openingInPercentage;
+  }
+
+  if (not isClosing) {
+    auto const catchOpening_InMilliPercentage = lookup(m_configuration.catchOpening_InPercentage, revolutionsInRPM, gear) * 1000;
+    m_opening_InMilliPercentage = std::min(m_opening_InMilliPercentage, std::max(catchOpening_InMilliPercentage, m_target_InMilliPercentage));
+  }
+
+  // Percent per second times microseconds is millionths of a percent
+  auto const closingRate_InPercentagePerSecond = lookup(m_configuration.closingRate_InPercentagePerSecond, revolutionsInRPM, gear);
+  auto const closingStep_InMilliPercentage = static_cast<uint32_t>(closingRate_InPercentagePerSecond * timeStep_InUS / 1000);
+
+  m_opening_InMilliPercentage -= std::min(closingStep_InMilliPercentage, m_opening_InMilliPercentage - m_target_InMilliPercentage);
+
+  // Rounded up, the output only reaches the request once the shaper has
+  return (m_opening_InMilliPercentage + 999) / 1000;
+}
+
+uint32_t Dashpot::lookup(DashpotTable const &table, uint32_t const revolutionsInRPM, uint32_t const gear) const {
+  auto const &row = table[std::min(gear, dashpotNumberOfGearRows - 1)];
+
+  auto const index = revolutionsInRPM >> dashpotRevolutionShift;
+  if (index >= dashpotNumberOfRevolutionPoints - 1) {
+    return row[dashpotNumberOfRevolutionPoints - 1];
+  }
+
+  auto const fraction = static_cast<int32_t>(revolutionsInRPM & revolutionFractionMask);
+  auto const low = static_cast<int32_t>(row[index]);
+  auto const high = static_cast<int32_t>(row[index + 1]);
+
+  return static_cast<uint32_t>(low + (((high - low) * fraction) >> dashpotRevolutionShift));
+}
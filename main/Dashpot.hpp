@@ -0,0 +1,104 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "Blipper.hpp"
+
+// Breakpoints every 1024 RPM from zero, the lookup is a shift and a mask
+constexpr uint32_t const dashpotRevolutionShift = 10;
+constexpr uint32_t const dashpotNumberOfRevolutionPoints = 8;
+
+// Neutral or clutch in first, then the gears as the blipper numbers them
+constexpr uint32_t const dashpotNumberOfGearRows = blipperNumberOfGears + 1;
+
+using DashpotRow = std::array<uint16_t, dashpotNumberOfRevolutionPoints>;
+using DashpotTable = std::array<DashpotRow, dashpotNumberOfGearRows>;
+
+struct DashpotConfiguration {
+  // Below this the engine is stopped or the ECU is silent, closing is not restricted
+  uint32_t runningRevolutions_InRPM = 500;
+
+  // Tables at 0, 1024 ... 7168 RPM, linear in between and held above
+
+  // Opening the throttle drops to at once when the rider closes, looked up on that tick
+  DashpotTable catchOpening_InPercentage = {{
+      {0, 0, 6, 6, 6, 6, 6, 6},
+      {0, 0, 5, 5, 5, 5, 4, 4},
+      {0, 0, 4, 4, 4, 4, 3, 3},
+      {0, 0, 4, 4, 3, 3, 3, 3},
+      {0, 0, 3, 3, 3, 3, 2, 2},
+      {0, 0, 3, 3, 2, 2, 2, 2},
+      {0, 0, 2, 2, 2, 2, 2, 2},
+  }};
+
+  // Fastest closing below the catch in percent per second, looked up every tick.
+  // Slowest near idle and in low gears, where a snap shut stalls the engine or shunts the driveline
+  DashpotTable closingRate_InPercentagePerSecond = {{
+      {1, 1, 2, 4, 8, 12, 16, 20},
+      {1, 1, 2, 4, 6, 8, 10, 10},
+      {1, 1, 3, 5, 8, 10, 12, 12},
+      {1, 1, 4, 6, 10, 12, 15, 15},
+      {1, 1, 5, 8, 12, 15, 20, 20},
+      {1, 1, 6, 10, 15, 20, 25, 25},
+      {1, 1, 8, 12, 20, 25, 30, 30},
+  }};
+};
+
+/**
+ * Electronic dashpot.
+ * Lets the throttle open as fast as asked. When the rider closes it drops at once to a small catch opening
+ * and bleeds off from there at a rate looked up from RPM and gear, so the engine settles into idle instead
+ * of stalling and the driveline takes up the overrun load gently.
+ * Knows nothing about the motor, the owner feeds the rider's opening through and uses the result.
+ */
+class Dashpot {
+public:
+  explicit Dashpot(DashpotConfiguration const &configuration = {});
+  ~Dashpot() = default;
+
+public:
+  void setConfiguration(DashpotConfiguration const &configuration);
+
+public:
+  /**
+   * Still closing towards the last requested opening, the shaper needs an update every tick
+   */
+  [[nodiscard]] bool isActive() const;
+
+public:
+  /**
+   * @param gear Zero in neutral or with the clutch in
+   * @return Throttle opening in percent, never below the requested one
+   */
+  uint32_t update(uint64_t timeInUS, uint32_t revolutionsInRPM, uint32_t gear, uint32_t openingInPercentage);
+
+private:
+  [[nodiscard]] uint32_t lookup(DashpotTable const &table, uint32_t revolutionsInRPM, uint32_t gear) const;
+
+private:
+  DashpotConfiguration m_configuration;
+
+private:
+  uint64_t m_lastUpdateTime_InUS;
+  uint32_t m_opening_InMilliPercentage;
+  uint32_t m_target_InMilliPercentage;
+};
@@ -18,14 +18,25 @@
 
 #include "EtcController.hpp"
 
+#include <cstdint>
+
 #include <esp_log.h>
 
+#include "log/DeferredLog.hpp"
+
 constexpr char const *tag = "etc_controller";
 
-EtcController::EtcController() :
+EtcController::EtcController(IClockPtr clock) :
     m_changeMotorPositionCallbackFunction(nullptr),
+    m_clock(std::move(clock)),
+    m_blipStartTime_InUS(0),
+    m_launchControlState(LAUNCH_CONTROL_STATE_DISABLED),
+    m_profileRamp(nullptr),
+    m_isDirty(true),
+    m_lastOutputValue(UINT32_MAX),
     m_clutchIsEnabled(true),
     m_acceleratorCurrentValue(0),
+    m_acceleratorTraceTag(),
     m_acceleratorMinimalValue(0),
     m_vehicleTPS_InMillivolts(0),
     m_vehicleSpeed_InKilometersPerHour(0),
@@ -38,29 +49,111 @@ void EtcController::registerChangeValueCallback(EtcControllerChangeValueCallback
 }
 
 void EtcController::setVehicleRPM(uint32_t revolutions) {
+  // Every report counts for the deceleration check, a steady value is part of the slope too
+  if (m_clutchIsEnabled) {
+    m_blipper.observe(m_clock->getTime_InUS(), revolutions, m_vehicleSpeed_InKilometersPerHour);
+  }
+
+  if (revolutions == m_vehicleRevolutions_InRevolutionsPerMinute) {
+    return;
+  }
+
   m_vehicleRevolutions_InRevolutionsPerMinute = revolutions;
+  m_isDirty = true;
 }
 
 void EtcController::setVehicleSpeed(uint32_t speed) {
+  if (m_clutchIsEnabled) {
+    m_blipper.observe(m_clock->getTime_InUS(), m_vehicleRevolutions_InRevolutionsPerMinute, speed);
+  }
+
+  if (speed == m_vehicleSpeed_InKilometersPerHour) {
+    return;
+  }
+
   m_vehicleSpeed_InKilometersPerHour = speed;
+  m_isDirty = true;
 }
 
 void EtcController::setVehicleClutchState(bool clutchIsEnabled) {
+  if (clutchIsEnabled == m_clutchIsEnabled) {
+    return;
+  }
+
   m_clutchIsEnabled = clutchIsEnabled;
+  m_isDirty = true;
+
+  if (clutchIsEnabled) {
+    m_blipper.stop();
+    return;
+  }
+
+  // Started right on the edge, RPM and speed are still the last values seen with the clutch engaged
+  m_blipStartTime_InUS = m_clock->getTime_InUS();
+  m_blipper.observe(m_blipStartTime_InUS, m_vehicleRevolutions_InRevolutionsPerMinute, m_vehicleSpeed_InKilometersPerHour);
+  if (m_blipper.start(m_blipStartTime_InUS, m_vehicleRevolutions_InRevolutionsPerMinute, m_vehicleSpeed_InKilometersPerHour, m_acceleratorCurrentValue)) {
+    deferredLog(LOG_ETC_CONTROLLER_BLIP_START, m_blipper.getGear(), m_blipper.getTargetRevolutions_InRPM());
+  }
+}
+
+uint32_t EtcController::getVehicleRPM() const {
+  return m_vehicleRevolutions_InRevolutionsPerMinute;
+}
+
+uint32_t EtcController::getVehicleSpeed() const {
+  return m_vehicleSpeed_InKilometersPerHour;
 }
 
-void EtcController::setAcceleratorValue(uint32_t acceleratorValue) {
+void EtcController::setAcceleratorValue(uint32_t acceleratorValue, TraceTag traceTag) {
+  if (acceleratorValue == m_acceleratorCurrentValue) {
+    return;
+  }
+
   m_acceleratorCurrentValue = acceleratorValue;
+  m_acceleratorTraceTag = traceTag;
+  m_isDirty = true;
 }
 
 void EtcController::modeEnable() {
   m_acceleratorMinimalValue = m_acceleratorCurrentValue;
   m_cruiseSpeed_InKilometersPerHour = m_vehicleSpeed_InKilometersPerHour;
+  m_isDirty = true;
 }
 
 void EtcController::modeDisable() {
   m_acceleratorMinimalValue = 0;
   m_cruiseSpeed_InKilometersPerHour = 0;
+  m_isDirty = true;
+}
+
+void EtcController::launchEnable() {
+  m_launchControl.enable();
+  m_isDirty = true;
+}
+
+void EtcController::launchDisable() {
+  m_launchControl.disable();
+  m_isDirty = true;
+}
+
+void EtcController::setProfileSelector(RidingProfileSelectorPtr profileSelector) {
+  m_profileRamp = std::make_unique<RidingProfileRamp>(std::move(profileSelector));
+  m_isDirty = true;
+}
+
+EtcControllerParameters const &EtcController::getParameters() const {
+  return m_parameters;
+}
+
+void EtcController::setParameters(EtcControllerParameters const &parameters) {
+  m_parameters = parameters;
+
+  m_blipper.setConfiguration(m_parameters.blipper);
+  m_launchControl.setConfiguration(m_parameters.launchControl);
+  m_idleControl.setConfiguration(m_parameters.idleControl);
+  m_dashpot.setConfiguration(m_parameters.dashpot);
+
+  m_isDirty = true;
 }
 
 void EtcController::process() {
@@ -68,27 +161,93 @@ void EtcController::process() {
     return;
   }
 
+  // The profile pointer is read once per tick, the whole tick runs on one profile
+  if (m_profileRamp and m_profileRamp->update(m_clock->getTime_InUS())) {
+    m_isDirty = true;
+  }
+
+  auto const &profile = m_profileRamp ? m_profileRamp->getProfile() : m_parameters.profile;
+
+  // Cruise, launch and idle control, blips and the dashpot are time driven and run every tick, everything else only after an input changed
+  auto const isTimeDriven = m_cruiseSpeed_InKilometersPerHour > 0 or m_launchControl.isActive() or m_idleControl.isActive() or m_blipper.isActive() or m_dashpot.isActive();
+  if (not m_isDirty and not isTimeDriven) {
+    return;
+  }
+
+  m_isDirty = false;
+
+  // Only the first output after a pedal change is caused by it, time driven outputs stay untraced
+  auto const traceTag = m_acceleratorTraceTag;
+  m_acceleratorTraceTag = {};
+
   auto acceleratorValue = m_acceleratorCurrentValue;
   if (acceleratorValue < m_acceleratorMinimalValue) {
     acceleratorValue = m_acceleratorMinimalValue;
   }
 
+  acceleratorValue = ridingProfileMapThrottle(profile, acceleratorValue);
+
+  // The rider takes over as soon as the pedal asks for more than the idle trim
+  auto const idleOffset_InMilliPercentage = m_idleControl.update(m_clock->getTime_InUS(), m_vehicleRevolutions_InRevolutionsPerMinute, acceleratorValue);
+  auto const idleOffset = (idleOffset_InMilliPercentage + 500) / 1000;
+  if (idleOffset > acceleratorValue) {
+    acceleratorValue = idleOffset;
+  }
+
   if (m_cruiseSpeed_InKilometersPerHour > 0) {
     if (m_vehicleSpeed_InKilometersPerHour < m_cruiseSpeed_InKilometersPerHour) {
-      acceleratorValue += 10;
+      acceleratorValue += profile.cruiseStep_InPercentage;
     }
     if (m_vehicleSpeed_InKilometersPerHour > m_cruiseSpeed_InKilometersPerHour) {
-      acceleratorValue -= 10;
+      acceleratorValue = acceleratorValue > profile.cruiseStep_InPercentage ? acceleratorValue - profile.cruiseStep_InPercentage : 0;
     }
 
-    if (m_vehicleRevolutions_InRevolutionsPerMinute < 2500 or m_vehicleRevolutions_InRevolutionsPerMinute > 6000 or not m_clutchIsEnabled) {
+    if (m_vehicleRevolutions_InRevolutionsPerMinute < profile.cruiseMinimalRevolutions_InRPM or m_vehicleRevolutions_InRevolutionsPerMinute > profile.cruiseMaximalRevolutions_InRPM or not m_clutchIsEnabled) {
       m_cruiseSpeed_InKilometersPerHour = 0;
     }
   }
 
-  if (m_vehicleRevolutions_InRevolutionsPerMinute > 6000) {
+  // Only the rider's closing is shaped, the launch limit below must still cut at once and a blip shapes its own fall
+  auto const gear = m_clutchIsEnabled ? m_blipper.findGear(m_vehicleRevolutions_InRevolutionsPerMinute, m_vehicleSpeed_InKilometersPerHour) : 0;
+  acceleratorValue = m_dashpot.update(m_clock->getTime_InUS(), m_vehicleRevolutions_InRevolutionsPerMinute, gear, acceleratorValue);
+
+  if (m_vehicleRevolutions_InRevolutionsPerMinute > profile.revolutionLimit_InRPM) {
     m_acceleratorMinimalValue = 0;
   }
 
-  m_changeMotorPositionCallbackFunction(acceleratorValue);
+  if (m_launchControl.getState() != LAUNCH_CONTROL_STATE_DISABLED) {
+    auto const launchLimit = m_launchControl.update(m_clock->getTime_InUS(), m_vehicleRevolutions_InRevolutionsPerMinute, m_vehicleSpeed_InKilometersPerHour, m_clutchIsEnabled, acceleratorValue);
+    if (acceleratorValue > launchLimit) {
+      acceleratorValue = launchLimit;
+    }
+  }
+
+  if (m_launchControl.getState() != m_launchControlState) {
+    m_launchControlState = m_launchControl.getState();
+    deferredLog(LOG_ETC_CONTROLLER_LAUNCH_STATE, m_launchControlState);
+  }
+
+  if (m_blipper.isActive()) {
+    auto const currentTime_InUS = m_clock->getTime_InUS();
+    auto const blipValue = m_blipper.update(currentTime_InUS, m_vehicleRevolutions_InRevolutionsPerMinute);
+
+    // The rider keeps the last word, the blip only ever opens further
+    if (blipValue > acceleratorValue) {
+      acceleratorValue = blipValue;
+    }
+
+    if (not m_blipper.isActive()) {
+      auto const blipTime_InMS = static_cast<int32_t>((currentTime_InUS - m_blipStartTime_InUS) / 1000);
+      auto const revolutionsError_InRPM = static_cast<int32_t>(m_vehicleRevolutions_InRevolutionsPerMinute) - static_cast<int32_t>(m_blipper.getTargetRevolutions_InRPM());
+      deferredLog(LOG_ETC_CONTROLLER_BLIP_END, blipTime_InMS, revolutionsError_InRPM);
+    }
+  }
+
+  if (acceleratorValue == m_lastOutputValue) {
+    return;
+  }
+
+  m_lastOutputValue = acceleratorValue;
+
+  m_changeMotorPositionCallbackFunction(acceleratorValue, traceTag);
 }
@@ -22,11 +22,31 @@
 #include <cstdlib>
 #include <functional>
 
-using EtcControllerChangeValueCallbackFunction = std::function<void(uint32_t)>;
+#include "Blipper.hpp"
+#include "Dashpot.hpp"
+#include "IdleControl.hpp"
+#include "LaunchControl.hpp"
+#include "clock/SystemClock.hpp"
+#include "trace/TraceTag.hpp"
+#include "profile/RidingProfileRamp.hpp"
+
+using EtcControllerChangeValueCallbackFunction = std::function<void(uint32_t, TraceTag)>;
+
+/**
+ * Every tunable of the controller in one value, so a candidate set can be applied, stored or compared at once.
+ * The profile is used while no profile selector is attached.
+ */
+struct EtcControllerParameters {
+  RidingProfile profile = defaultRidingProfile;
+  BlipperConfiguration blipper = {};
+  LaunchControlConfiguration launchControl = {};
+  IdleControlConfiguration idleControl = {};
+  DashpotConfiguration dashpot = {};
+};
 
 class EtcController : public executor::Node {
 public:
-  EtcController();
+  explicit EtcController(IClockPtr clock = getSystemClock());
 
   ~EtcController() override = default;
 
@@ -39,20 +59,58 @@ public:
   void setVehicleClutchState(bool clutchIsEnabled);
 
 public:
-  void setAcceleratorValue(uint32_t acceleratorValue);
+  [[nodiscard]] uint32_t getVehicleRPM() const;
+  [[nodiscard]] uint32_t getVehicleSpeed() const;
+
+public:
+  /**
+   * @param traceTag Tag of the frame the value came from, handed on with the output it changes
+   */
+  void setAcceleratorValue(uint32_t acceleratorValue, TraceTag traceTag = {});
 
 public:
   void modeEnable();
   void modeDisable();
 
+public:
+  void launchEnable();
+  void launchDisable();
+
+public:
+  void setProfileSelector(RidingProfileSelectorPtr profileSelector);
+
+public:
+  [[nodiscard]] EtcControllerParameters const &getParameters() const;
+
+public:
+  void setParameters(EtcControllerParameters const &parameters);
+
 private:
   EtcControllerChangeValueCallbackFunction m_changeMotorPositionCallbackFunction;
 
+private:
+  EtcControllerParameters m_parameters;
+
+private:
+  IClockPtr m_clock;
+  Blipper m_blipper;
+  uint64_t m_blipStartTime_InUS;
+  LaunchControl m_launchControl;
+  LaunchControlState m_launchControlState;
+  RidingProfileRampPtr m_profileRamp;
+  IdleControl m_idleControl;
+  Dashpot m_dashpot;
+
+private:
+  bool m_isDirty;
+  uint32_t m_lastOutputValue;
+
 private:
   bool m_clutchIsEnabled;
 
 private:
   uint32_t m_acceleratorCurrentValue;
+  TraceTag m_acceleratorTraceTag;
   uint32_t m_acceleratorMinimalValue;
 
 private:
@@ -0,0 +1,65 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include "IdleControl.hpp"
+
+#include <algorithm>
+
+// Longer gaps come from a stalled input, they must not wind the integral up
+constexpr uint64_t const maximumTimeStep_InUS = 50 * 1000;
+
+IdleControl::IdleControl(IdleControlConfiguration const &configuration) : m_configuration(configuration),
+                                                                          m_isActive(false),
+                                                                          m_lastUpdateTime_InUS(0),
+                                                                          m_integral_InMicroPercentage(0) {
+}
+
+void IdleControl::setConfiguration(IdleControlConfiguration const &configuration) {
+  m_configuration = configuration;
+}
+
+bool IdleControl::isActive() const {
+  return m_isActive;
+}
+
+uint32_t IdleControl::update(uint64_t const timeInUS, uint32_t const revolutionsInRPM, uint32_t const pedalInPercentage) {
+  auto const timeStep_InUS = std::min(timeInUS - m_lastUpdateTime_InUS, maximumTimeStep_InUS);
+  m_lastUpdateTime_InUS = timeInUS;
+
+  auto const maximalOffset_InMilliPercentage = static_cast<int32_t>(m_configuration.maximalOffset_InPercentage) * 1000;
+
+  if (revolutionsInRPM < m_configuration.runningRevolutions_InRPM) {
+    m_isActive = false;
+    m_integral_InMicroPercentage = 0;
+    return 0;
+  }
+
+  m_isActive = pedalInPercentage <= m_configuration.pedalRest_InPercentage;
+
+  auto const error_InRPM = static_cast<int32_t>(m_configuration.targetRevolutions_InRPM) - static_cast<int32_t>(revolutionsInRPM);
+
+  // Integrated in millionths of a percent, a small error over one tick still counts
+  if (m_isActive) {
+    m_integral_InMicroPercentage += static_cast<int32_t>(static_cast<int64_t>(error_InRPM) * m_configuration.integralGain * static_cast<int64_t>(timeStep_InUS) / 1000);
+    m_integral_InMicroPercentage = std::clamp(m_integral_InMicroPercentage, 0, maximalOffset_InMilliPercentage * 1000);
+  }
+
+  auto const offset_InMilliPercentage = std::clamp(m_integral_InMicroPercentage / 1000 + error_InRPM * m_configuration.proportionalGain, 0, maximalOffset_InMilliPercentage);
+
+  return static_cast<uint32_t>(offset_InMilliPercentage);
+}
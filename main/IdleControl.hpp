@@ -0,0 +1,70 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <cstdint>
+
+struct IdleControlConfiguration {
+  uint32_t targetRevolutions_InRPM = 1200;
+
+  // Below this the engine is stopped or stalling, the throttle is left closed
+  uint32_t runningRevolutions_InRPM = 500;
+
+  // Offset gains in thousandths of a percent, per RPM of error and per RPM of error and second
+  int32_t proportionalGain = 4;
+  int32_t integralGain = 8;
+
+  uint32_t pedalRest_InPercentage = 1;
+  uint32_t maximalOffset_InPercentage = 8;
+};
+
+/**
+ * Idle speed as a small throttle offset.
+ * With the pedal at rest a PI loop trims the opening to hold the target RPM against load and temperature sag.
+ * While the rider asks for more than the offset the integral is frozen, so letting go resumes from the same trim.
+ * Knows nothing about the motor, the owner takes the larger of the offset and the rider's opening.
+ */
+class IdleControl {
+public:
+  explicit IdleControl(IdleControlConfiguration const &configuration = {});
+  ~IdleControl() = default;
+
+public:
+  void setConfiguration(IdleControlConfiguration const &configuration);
+
+public:
+  /**
+   * Engine running with the pedal at rest, the loop needs an update every tick
+   */
+  [[nodiscard]] bool isActive() const;
+
+public:
+  /**
+   * @return Throttle offset in thousandths of a percent
+   */
+  uint32_t update(uint64_t timeInUS, uint32_t revolutionsInRPM, uint32_t pedalInPercentage);
+
+private:
+  IdleControlConfiguration m_configuration;
+
+private:
+  bool m_isActive;
+  uint64_t m_lastUpdateTime_InUS;
+  int32_t m_integral_InMicroPercentage;
+};
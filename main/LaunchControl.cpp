@@ -0,0 +1,131 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include "LaunchControl.hpp"
+
+#include <algorithm>
+
+constexpr uint32_t const fullOpening_InPercentage = 100;
+constexpr int32_t const fullOpening_InMilliPercentage = fullOpening_InPercentage * 1000;
+
+// Longer gaps come from a stalled input, they must not wind the integral up
+constexpr uint64_t const maximumTimeStep_InUS = 50 * 1000;
+
+LaunchControl::LaunchControl(LaunchControlConfiguration const &configuration) : m_configuration(configuration),
+                                                                                m_state(LAUNCH_CONTROL_STATE_DISABLED),
+                                                                                m_lastUpdateTime_InUS(0),
+                                                                                m_integral_InMicroPercentage(0),
+                                                                                m_holdLimit_InPercentage(fullOpening_InPercentage) {
+}
+
+void LaunchControl::setConfiguration(LaunchControlConfiguration const &configuration) {
+  m_configuration = configuration;
+}
+
+void LaunchControl::enable() {
+  if (m_state != LAUNCH_CONTROL_STATE_DISABLED) {
+    return;
+  }
+
+  m_state = LAUNCH_CONTROL_STATE_ARMED;
+}
+
+void LaunchControl::disable() {
+  m_state = LAUNCH_CONTROL_STATE_DISABLED;
+}
+
+bool LaunchControl::isActive() const {
+  return m_state == LAUNCH_CONTROL_STATE_HOLDING or m_state == LAUNCH_CONTROL_STATE_RAMPING;
+}
+
+LaunchControlState LaunchControl::getState() const {
+  return m_state;
+}
+
+uint32_t LaunchControl::update(uint64_t const timeInUS, uint32_t const revolutionsInRPM, uint32_t const speedInKilometersPerHour, bool const clutchIsEnabled,
+                              uint32_t const openingInPercentage) {
+  auto const isStationary = speedInKilometersPerHour <= m_configuration.stationarySpeed_InKilometersPerHour;
+
+  if (m_state == LAUNCH_CONTROL_STATE_ARMED and isStationary and not clutchIsEnabled) {
+    m_state = LAUNCH_CONTROL_STATE_HOLDING;
+    m_lastUpdateTime_InUS = timeInUS;
+    m_integral_InMicroPercentage = static_cast<int32_t>(m_configuration.initialLimit_InPercentage) * 1000000;
+    m_holdLimit_InPercentage = m_configuration.initialLimit_InPercentage;
+  }
+
+  if (m_state == LAUNCH_CONTROL_STATE_HOLDING and clutchIsEnabled) {
+    // Either the launch or the rider let the clutch out standing still, both are a launch
+    m_state = LAUNCH_CONTROL_STATE_RAMPING;
+  }
+
+  // One launch per arming, the rider arms again for the next one instead of being held at the next stop unasked
+  if (m_state == LAUNCH_CONTROL_STATE_RAMPING) {
+    if (speedInKilometersPerHour >= m_configuration.releaseSpeed_InKilometersPerHour or (isStationary and not clutchIsEnabled)) {
+      m_state = LAUNCH_CONTROL_STATE_DISABLED;
+    }
+  }
+
+  if (m_state == LAUNCH_CONTROL_STATE_HOLDING) {
+    return updateHolding(timeInUS, revolutionsInRPM, openingInPercentage);
+  }
+
+  if (m_state == LAUNCH_CONTROL_STATE_RAMPING) {
+    return updateRamping(speedInKilometersPerHour);
+  }
+
+  return fullOpening_InPercentage;
+}
+
+uint32_t LaunchControl::updateHolding(uint64_t const timeInUS, uint32_t const revolutionsInRPM, uint32_t const openingInPercentage) {
+  auto const timeStep_InUS = std::min(timeInUS - m_lastUpdateTime_InUS, maximumTimeStep_InUS);
+  m_lastUpdateTime_InUS = timeInUS;
+
+  auto const error_InRPM = static_cast<int32_t>(m_configuration.targetRevolutions_InRPM) - static_cast<int32_t>(revolutionsInRPM);
+
+  // Below the limit the rider sets the RPM, not the loop, an error then only says the rider is not asking for the target.
+  // Integrating it would wind the limit up to fully open and let the next snap overshoot, the integral tracks the opening instead.
+  auto const opening_InMilliPercentage = static_cast<int32_t>(std::min(openingInPercentage, fullOpening_InPercentage)) * 1000;
+  auto const currentLimit_InMilliPercentage = std::clamp(m_integral_InMicroPercentage / 1000 + error_InRPM * m_configuration.proportionalGain, 0, fullOpening_InMilliPercentage);
+  auto const isLimiting = opening_InMilliPercentage >= currentLimit_InMilliPercentage;
+
+  // Integrated in millionths of a percent, a small error over one tick still counts
+  if (isLimiting or error_InRPM < 0) {
+    m_integral_InMicroPercentage += static_cast<int32_t>(static_cast<int64_t>(error_InRPM) * m_configuration.integralGain * static_cast<int64_t>(timeStep_InUS) / 1000);
+    m_integral_InMicroPercentage = std::clamp(m_integral_InMicroPercentage, 0, fullOpening_InMilliPercentage * 1000);
+  } else {
+    m_integral_InMicroPercentage = std::min(m_integral_InMicroPercentage, opening_InMilliPercentage * 1000);
+  }
+
+  auto const limit_InMilliPercentage = std::clamp(m_integral_InMicroPercentage / 1000 + error_InRPM * m_configuration.proportionalGain, 0, fullOpening_InMilliPercentage);
+
+  m_holdLimit_InPercentage = static_cast<uint32_t>(limit_InMilliPercentage / 1000);
+
+  return m_holdLimit_InPercentage;
+}
+
+uint32_t LaunchControl::updateRamping(uint32_t const speedInKilometersPerHour) {
+  // The ramp starts from whatever held the RPM, the launch never sees a step in the limit
+  auto const rampStart_InPercentage = m_holdLimit_InPercentage;
+  auto const speed_InKilometersPerHour = std::min(speedInKilometersPerHour, m_configuration.releaseSpeed_InKilometersPerHour);
+
+  if (rampStart_InPercentage >= fullOpening_InPercentage) {
+    return fullOpening_InPercentage;
+  }
+
+  return rampStart_InPercentage + (fullOpening_InPercentage - rampStart_InPercentage) * speed_InKilometersPerHour / m_configuration.releaseSpeed_InKilometersPerHour;
+}
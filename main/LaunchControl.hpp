@@ -0,0 +1,86 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <cstdint>
+
+enum LaunchControlState {
+  LAUNCH_CONTROL_STATE_DISABLED = 0,
+  LAUNCH_CONTROL_STATE_ARMED,
+  LAUNCH_CONTROL_STATE_HOLDING,
+  LAUNCH_CONTROL_STATE_RAMPING
+};
+
+struct LaunchControlConfiguration {
+  uint32_t targetRevolutions_InRPM = 4500;
+
+  // Limit gains in thousandths of a percent, per RPM of error and per RPM of error and second
+  int32_t proportionalGain = 20;
+  int32_t integralGain = 40;
+
+  uint32_t stationarySpeed_InKilometersPerHour = 3;
+  uint32_t releaseSpeed_InKilometersPerHour = 60;
+  uint32_t initialLimit_InPercentage = 45;
+};
+
+/**
+ * Launch control as a throttle limit.
+ * Stationary with the clutch in, a PI loop limits the opening to hold the engine at the target RPM.
+ * While the rider opens less than the limit the integral never winds up, it follows the rider's opening down instead.
+ * A snap to full throttle then starts from the opening the engine ran on, not from a limit grown while nothing was limited.
+ * Once the clutch engages the limit ramps with speed from the held opening to fully open at the release speed.
+ * Arming covers one launch, reaching the release speed or coming to a stop again disarms it.
+ * Knows nothing about the motor, the owner applies the limit to the rider's input.
+ */
+class LaunchControl {
+public:
+  explicit LaunchControl(LaunchControlConfiguration const &configuration = {});
+  ~LaunchControl() = default;
+
+public:
+  void setConfiguration(LaunchControlConfiguration const &configuration);
+
+public:
+  void enable();
+  void disable();
+
+public:
+  [[nodiscard]] bool isActive() const;
+  [[nodiscard]] LaunchControlState getState() const;
+
+public:
+  /**
+   * @param openingInPercentage Opening the rider asks for, before the limit
+   * @return Upper limit of the throttle opening in percent
+   */
+  uint32_t update(uint64_t timeInUS, uint32_t revolutionsInRPM, uint32_t speedInKilometersPerHour, bool clutchIsEnabled, uint32_t openingInPercentage);
+
+private:
+  uint32_t updateHolding(uint64_t timeInUS, uint32_t revolutionsInRPM, uint32_t openingInPercentage);
+  uint32_t updateRamping(uint32_t speedInKilometersPerHour);
+
+private:
+  LaunchControlConfiguration m_configuration;
+
+private:
+  LaunchControlState m_state;
+  uint64_t m_lastUpdateTime_InUS;
+  int32_t m_integral_InMicroPercentage;
+  uint32_t m_holdLimit_InPercentage;
+};
@@ -18,11 +18,8 @@
 
 #include "ModeButton.hpp"
 
-#include <esp_log.h>
-
 #include "gpio/InputPin.hpp"
-
-constexpr char const *tag = "mode_button";
+#include "log/DeferredLog.hpp"
 
 ModeButton::ModeButton(uint8_t const numberOfModeButton1Pin, uint8_t const numberOfModeButton2Pin) :
     m_modeButtonState(MODE_BUTTON_STATE_UNKNOWN),
@@ -62,7 +59,7 @@ void ModeButton::process() {
 
   m_changeStateCallbackFunction(modeButtonState);
 
-  ESP_LOGI(tag, "Mode %d", modeButtonState);
+  deferredLog(LOG_MODE_BUTTON_MODE, modeButtonState);
 
   m_modeButtonState = modeButtonState;
 }
@@ -18,19 +18,18 @@
 
 #include "SetupButton.hpp"
 
-#include <esp_log.h>
-#include <esp_timer.h>
-
 #include "gpio/InputPin.hpp"
+#include "log/DeferredLog.hpp"
 
-constexpr char const * tag = "setup_button";
-
-SetupButton::SetupButton(uint8_t const numberOfSetupButtonPin, uint32_t const holdTimeInUS, uint32_t const thresholdInUS) :
+SetupButton::SetupButton(uint8_t const numberOfSetupButtonPin, uint32_t const holdTimeInUS, uint32_t const thresholdInUS, uint32_t const longHoldTimeInUS, IClockPtr clock) :
     m_changeStateCallbackFunction(nullptr),
+    m_clock(std::move(clock)),
     m_setupButton(std::make_unique<gpio::InputPin>(numberOfSetupButtonPin, gpio::PIN_LEVEL_HIGH)),
     m_holdTime_InUS(holdTimeInUS),
     m_threshold_InUS(thresholdInUS),
+    m_longHoldTime_InUS(longHoldTimeInUS),
     m_isHeld(false),
+    m_isLongHeld(false),
     m_isPressed(false),
     m_pressTime_InUS(0),
     m_releaseTime_InUS(0) {
@@ -65,13 +64,14 @@ void SetupButton::processButtonReleased() {
     return;
   }
 
-  m_releaseTime_InUS = esp_timer_get_time();
+  m_releaseTime_InUS = m_clock->getTime_InUS();
   m_isHeld = false;
+  m_isLongHeld = false;
   m_isPressed = false;
 
   m_changeStateCallbackFunction(SETUP_BUTTON_RELEASED);
 
-  ESP_LOGI(tag, "Released");
+  deferredLog(LOG_SETUP_BUTTON_RELEASED);
 }
 
 void SetupButton::processButtonPressed() {
@@ -79,11 +79,11 @@ void SetupButton::processButtonPressed() {
     return;
   }
 
-  if (m_isHeld) {
+  if (m_isLongHeld) {
     return;
   }
 
-  auto const currentTime_InUS = esp_timer_get_time();
+  auto const currentTime_InUS = m_clock->getTime_InUS();
 
   auto const idleTime_InUS = currentTime_InUS - m_releaseTime_InUS;
   if (idleTime_InUS < m_threshold_InUS) {
@@ -92,12 +92,20 @@ void SetupButton::processButtonPressed() {
 
   if (m_isPressed) {
     auto const holdTime_InUS = currentTime_InUS - m_pressTime_InUS;
-    if (holdTime_InUS > m_holdTime_InUS) {
+    if (m_isHeld and holdTime_InUS > m_longHoldTime_InUS) {
+      m_isLongHeld = true;
+
+      m_changeStateCallbackFunction(SETUP_BUTTON_LONG_HELD);
+
+      deferredLog(LOG_SETUP_BUTTON_LONG_HELD);
+    }
+
+    if (not m_isHeld and holdTime_InUS > m_holdTime_InUS) {
       m_isHeld = true;
 
       m_changeStateCallbackFunction(SETUP_BUTTON_HELD);
 
-      ESP_LOGI(tag, "Held");
+      deferredLog(LOG_SETUP_BUTTON_HELD);
     }
   }
 
@@ -108,6 +116,6 @@ void SetupButton::processButtonPressed() {
 
     m_changeStateCallbackFunction(SETUP_BUTTON_PRESSED);
 
-    ESP_LOGI(tag, "Pressed");
+    deferredLog(LOG_SETUP_BUTTON_PRESSED);
   }
 }
@@ -24,11 +24,13 @@
 #include "gpio/PinLevel.hpp"
 #include "gpio/interface/IInputPin.hpp"
 #include "executor/Node.hpp"
+#include "clock/SystemClock.hpp"
 
 enum SetupButtonState {
   SETUP_BUTTON_RELEASED = 0,
   SETUP_BUTTON_PRESSED,
-  SETUP_BUTTON_HELD
+  SETUP_BUTTON_HELD,
+  SETUP_BUTTON_LONG_HELD
 };
 
 using PinLevel = gpio::PinLevel;
@@ -36,7 +38,7 @@ using SetupButtonChangeStateCallbackFunction = std::function<void(SetupButtonSta
 
 class SetupButton : public executor::Node {
 public:
-  explicit SetupButton(uint8_t numberOfSetupButtonPin = 5, uint32_t holdTimeInUS = 1000000, uint32_t thresholdInUS = 100000);
+  explicit SetupButton(uint8_t numberOfSetupButtonPin = 5, uint32_t holdTimeInUS = 1000000, uint32_t thresholdInUS = 100000, uint32_t longHoldTimeInUS = 5000000, IClockPtr clock = getSystemClock());
   ~SetupButton() override = default;
 
 public:
@@ -53,17 +55,20 @@ private:
   SetupButtonChangeStateCallbackFunction m_changeStateCallbackFunction;
 
 private:
+  IClockPtr m_clock;
   IInputPinPtr<PinLevel> m_setupButton;
 
 private:
   uint32_t const m_holdTime_InUS;
   uint32_t const m_threshold_InUS;
+  uint32_t const m_longHoldTime_InUS;
 
 private:
   bool m_isHeld;
+  bool m_isLongHeld;
   bool m_isPressed;
 
 private:
-  uint32_t m_pressTime_InUS;
-  uint32_t m_releaseTime_InUS;
+  uint64_t m_pressTime_InUS;
+  uint64_t m_releaseTime_InUS;
 };
@@ -0,0 +1,64 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include "Storage.hpp"
+
+#include <esp_log.h>
+#include <nvs_flash.h>
+
+constexpr char const *tag = "storage";
+
+Storage::Storage(char const *nameSpace) : m_handle(0) {
+  auto returnCode = nvs_flash_init();
+  if (returnCode == ESP_ERR_NVS_NO_FREE_PAGES or returnCode == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+    ESP_ERROR_CHECK(nvs_flash_erase());
+    returnCode = nvs_flash_init();
+  }
+  ESP_ERROR_CHECK(returnCode);
+
+  ESP_ERROR_CHECK(nvs_open(nameSpace, NVS_READWRITE, &m_handle));
+}
+
+Storage::~Storage() {
+  nvs_close(m_handle);
+}
+
+uint32_t Storage::getValue(char const *key, uint32_t const defaultValue) const {
+  uint32_t value = defaultValue;
+
+  auto const returnCode = nvs_get_u32(m_handle, key, &value);
+  if (returnCode != ESP_OK) {
+    return defaultValue;
+  }
+
+  return value;
+}
+
+void Storage::setValue(char const *key, uint32_t const value) {
+  auto const returnCode = nvs_set_u32(m_handle, key, value);
+  if (returnCode != ESP_OK) {
+    ESP_LOGE(tag, "Failed to store %s: %s", key, esp_err_to_name(returnCode));
+  }
+}
+
+void Storage::commit() {
+  auto const returnCode = nvs_commit(m_handle);
+  if (returnCode != ESP_OK) {
+    ESP_LOGE(tag, "Failed to commit: %s", esp_err_to_name(returnCode));
+  }
+}
@@ -0,0 +1,103 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include "AdcFrameReduction.hpp"
+
+#include <cstring>
+
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#endif
+
+#if defined(CONFIG_IDF_TARGET_ESP32S3)
+#define ADC_FRAME_REDUCTION_PIE 1
+#else
+#define ADC_FRAME_REDUCTION_PIE 0
+#endif
+
+constexpr uint32_t const vectorSize_InBytes = 16;
+
+AdcFrameSum adcReduceFramePortable(uint8_t const *frame, uint32_t const sizeInBytes) {
+  AdcFrameSum result = {0, 0};
+
+  for (uint32_t offset = 0; offset + adcResultSize_InBytes <= sizeInBytes; offset += adcResultSize_InBytes) {
+    uint32_t word = 0;
+    std::memcpy(&word, frame + offset, sizeof(word));
+
+    result.sum += word & adcResultDataMask;
+    result.numberOfValues += 1;
+  }
+
+  return result;
+}
+
+namespace {
+
+#if ADC_FRAME_REDUCTION_PIE
+
+uint32_t reduceBlocks(uint8_t const *frame, uint32_t const numberOfBlocks) {
+  alignas(16) uint32_t lanes[4] = {0, 0, 0, 0};
+  static uint32_t const dataMask = adcResultDataMask;
+
+  if (numberOfBlocks > 0) {
+    auto const *position = frame;
+
+    // q0 accumulates four lanes, q2 holds the mask, 256 results of 12 bit can not saturate a lane
+    asm volatile(
+        "ee.zero.q q0\n"
+        "ee.vldbc.32 q2, %[mask]\n"
+        "loopnez %[blocks], 0f\n"
+        "ee.vld.128.ip q1, %[position], 16\n"
+        "ee.andq q1, q1, q2\n"
+        "ee.vadds.s32 q0, q0, q1\n"
+        "0:\n"
+        "ee.vst.128.ip q0, %[lanes], 0\n"
+        : [position] "+r"(position)
+        : [blocks] "r"(numberOfBlocks), [mask] "r"(&dataMask), [lanes] "r"(lanes)
+        : "memory");
+  }
+
+  return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+#else
+
+// The plain loop over the same blocks, compilers vectorize it where the target has a vector unit
+uint32_t reduceBlocks(uint8_t const *frame, uint32_t const numberOfBlocks) {
+  return adcReduceFramePortable(frame, numberOfBlocks * vectorSize_InBytes).sum;
+}
+
+#endif
+
+}// namespace
+
+AdcFrameSum adcReduceFrame(uint8_t const *frame, uint32_t const sizeInBytes) {
+  if ((reinterpret_cast<uintptr_t>(frame) % vectorSize_InBytes) != 0) {
+    return adcReduceFramePortable(frame, sizeInBytes);
+  }
+
+  auto const numberOfBlocks = sizeInBytes / vectorSize_InBytes;
+  auto const vectorSize = numberOfBlocks * vectorSize_InBytes;
+
+  auto result = adcReduceFramePortable(frame + vectorSize, sizeInBytes - vectorSize);
+
+  result.sum += reduceBlocks(frame, numberOfBlocks);
+  result.numberOfValues += vectorSize / adcResultSize_InBytes;
+
+  return result;
+}
@@ -0,0 +1,96 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <cstdint>
+
+// TYPE2 conversion results are 32 bit words with the 12 bit value in the low bits
+constexpr uint32_t const adcResultSize_InBytes = 4;
+constexpr uint32_t const adcResultDataMask = 0x0FFF;
+
+// Limits of the digital controller sample clock
+constexpr uint32_t const adcMinimalSampleFrequency_InHertz = 611;
+constexpr uint32_t const adcMaximalSampleFrequency_InHertz = 83333;
+
+constexpr uint32_t const adcMaximalOversamplingRatio = 256;
+constexpr uint32_t const adcMaximalFrameSize_InBytes = adcMaximalOversamplingRatio * adcResultSize_InBytes;
+
+struct AdcDecimation {
+  uint32_t sampleFrequency_InHertz;
+  uint32_t frameSize_InBytes;
+};
+
+struct AdcFrameSum {
+  uint32_t sum;
+  uint32_t numberOfValues;
+};
+
+/**
+ * Sample clock and frame size that give one frame of oversamplingRatio results per control tick.
+ * The ratio is adjusted so the sample clock stays inside the controller limits.
+ */
+constexpr AdcDecimation adcDecimationConfigure(uint32_t const controlFrequencyInHertz, uint32_t const oversamplingRatio) {
+  auto ratio = oversamplingRatio;
+
+  if (ratio < 1) {
+    ratio = 1;
+  }
+  if (ratio > adcMaximalOversamplingRatio) {
+    ratio = adcMaximalOversamplingRatio;
+  }
+  while (ratio > 1 and controlFrequencyInHertz * ratio > adcMaximalSampleFrequency_InHertz) {
+    ratio -= 1;
+  }
+  while (ratio < adcMaximalOversamplingRatio and controlFrequencyInHertz * ratio < adcMinimalSampleFrequency_InHertz) {
+    ratio += 1;
+  }
+
+  auto sampleFrequency_InHertz = controlFrequencyInHertz * ratio;
+  if (sampleFrequency_InHertz < adcMinimalSampleFrequency_InHertz) {
+    sampleFrequency_InHertz = adcMinimalSampleFrequency_InHertz;
+  }
+  if (sampleFrequency_InHertz > adcMaximalSampleFrequency_InHertz) {
+    sampleFrequency_InHertz = adcMaximalSampleFrequency_InHertz;
+  }
+
+  return {
+      .sampleFrequency_InHertz = sampleFrequency_InHertz,
+      .frameSize_InBytes = ratio * adcResultSize_InBytes,
+  };
+}
+
+/**
+ * Time between two frames, the period of the values the reduction hands on
+ */
+constexpr uint32_t adcDecimationFramePeriod_InUS(AdcDecimation const &decimation) {
+  auto const numberOfResults = decimation.frameSize_InBytes / adcResultSize_InBytes;
+  return static_cast<uint32_t>(static_cast<uint64_t>(numberOfResults) * 1000000 / decimation.sampleFrequency_InHertz);
+}
+
+/**
+ * Sum of the data fields of a frame of conversion results.
+ * On the ESP32-S3 the bulk of a 16 byte aligned frame goes through the PIE vector unit, four results per instruction.
+ * Only the sum of the 16 byte blocks is target specific, the split, the alignment fallback and the tail run on the host too.
+ */
+AdcFrameSum adcReduceFrame(uint8_t const *frame, uint32_t sizeInBytes);
+
+/**
+ * Plain C++ reduction, the reference for the vector kernel and the implementation everywhere else
+ */
+AdcFrameSum adcReduceFramePortable(uint8_t const *frame, uint32_t sizeInBytes);
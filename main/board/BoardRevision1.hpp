@@ -0,0 +1,46 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include "board/Pin.hpp"
+
+/**
+ * First production board, DRV8825 driver
+ */
+struct BoardRevision1 {
+  using StepPin = board::Pin<11>;
+  using DirectionPin = board::Pin<13>;
+  using DecayPin = board::Pin<14>;
+  using Mode0Pin = board::Pin<10>;
+  using Mode1Pin = board::Pin<9>;
+  using Mode2Pin = board::Pin<20>;
+  using ResetPin = board::Pin<48, board::PIN_ACTIVE_LOW>;
+  using SleepPin = board::Pin<47, board::PIN_ACTIVE_LOW>;
+  using EnablePin = board::Pin<12, board::PIN_ACTIVE_LOW>;
+
+  using ModePins = board::PinGroup<Mode0Pin, Mode1Pin, Mode2Pin>;
+  using DriverOutputPins = board::PinGroup<StepPin, DirectionPin, DecayPin, Mode0Pin, Mode1Pin, Mode2Pin, ResetPin, SleepPin, EnablePin>;
+
+  // VREF comes from the trimmer on this revision, the driver always regulates to the run current
+  static constexpr int8_t currentReferencePinNumber = -1;
+  static constexpr uint32_t currentReferenceFullScale_InMillivolts = 0;
+
+  static constexpr uint8_t inHomePinNumber = 19;
+  static constexpr uint8_t faultPinNumber = 21;
+};
@@ -0,0 +1,85 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include "Gpio.hpp"
+
+#ifdef ESP_PLATFORM
+#include <driver/gpio.h>
+#endif
+
+namespace board {
+
+#ifdef ESP_PLATFORM
+
+void gpioConfigureOutputs(uint64_t const pinMask) {
+  gpio_config_t const configuration = {
+      .pin_bit_mask = pinMask,
+      .mode = GPIO_MODE_OUTPUT,
+      .pull_up_en = GPIO_PULLUP_DISABLE,
+      .pull_down_en = GPIO_PULLDOWN_DISABLE,
+      .intr_type = GPIO_INTR_DISABLE,
+  };
+  ESP_ERROR_CHECK(gpio_config(&configuration));
+}
+
+#else
+
+// Per thread, simulations running side by side each see their own pins
+static thread_local bool isRecordingWrites = false;
+static thread_local std::vector<GpioPattern> recordedWrites;
+static thread_local uint32_t recordedLevels[gpioBankCount] = {};
+
+void gpioConfigureOutputs(uint64_t const pinMask) {
+  (void) pinMask;
+}
+
+void gpioRecord(GpioPattern const &pattern) {
+  if (isRecordingWrites) {
+    recordedWrites.push_back(pattern);
+  }
+
+  for (uint8_t bank = 0; bank < gpioBankCount; ++bank) {
+    recordedLevels[bank] &= ~pattern.clearMask[bank];
+    recordedLevels[bank] |= pattern.setMask[bank];
+  }
+}
+
+void gpioRecordWrites(bool const isEnabled) {
+  isRecordingWrites = isEnabled;
+  recordedWrites.clear();
+}
+
+std::vector<GpioPattern> const &gpioRecordedWrites() {
+  return recordedWrites;
+}
+
+bool gpioRecordedLevel(uint8_t const pinNumber) {
+  return ((recordedLevels[pinNumber / gpioBankSize] >> (pinNumber % gpioBankSize)) & 1) != 0;
+}
+
+void gpioRecordReset() {
+  recordedWrites.clear();
+
+  for (auto &level : recordedLevels) {
+    level = 0;
+  }
+}
+
+#endif
+
+}// namespace board
@@ -0,0 +1,90 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <vector>
+
+#include "board/Pin.hpp"
+
+#ifdef ESP_PLATFORM
+#include <soc/gpio_struct.h>
+#endif
+
+namespace board {
+
+/**
+ * Configure every pin of the mask as a push-pull output
+ */
+void gpioConfigureOutputs(uint64_t pinMask);
+
+#ifndef ESP_PLATFORM
+void gpioRecord(GpioPattern const &pattern);
+#endif
+
+/**
+ * One write per non-empty mask straight to the W1TS/W1TC registers.
+ * There is no read-modify-write, so it cannot race with other cores touching other pins.
+ */
+inline void gpioApply(GpioPattern const &pattern) {
+#ifdef ESP_PLATFORM
+  if (pattern.clearMask[0] != 0) {
+    GPIO.out_w1tc = pattern.clearMask[0];
+  }
+  if (pattern.setMask[0] != 0) {
+    GPIO.out_w1ts = pattern.setMask[0];
+  }
+  if (pattern.clearMask[1] != 0) {
+    GPIO.out1_w1tc.val = pattern.clearMask[1];
+  }
+  if (pattern.setMask[1] != 0) {
+    GPIO.out1_w1ts.val = pattern.setMask[1];
+  }
+#else
+  gpioRecord(pattern);
+#endif
+}
+
+template<typename Pin>
+inline void gpioWrite(bool const isActive) {
+  if (isActive) {
+    constexpr auto pattern = PinGroup<Pin>::pattern(1);
+    gpioApply(pattern);
+  } else {
+    constexpr auto pattern = PinGroup<Pin>::pattern(0);
+    gpioApply(pattern);
+  }
+}
+
+template<typename Group>
+inline void gpioWriteGroup(uint32_t const activeBits) {
+  gpioApply(Group::pattern(activeBits));
+}
+
+#ifndef ESP_PLATFORM
+/**
+ * Host backend, the pin levels are tracked instead of touching hardware.
+ * The applied patterns themselves are only kept while recording is turned on, a long simulation would pile them up.
+ */
+void gpioRecordWrites(bool isEnabled);
+std::vector<GpioPattern> const &gpioRecordedWrites();
+bool gpioRecordedLevel(uint8_t pinNumber);
+void gpioRecordReset();
+#endif
+
+}// namespace board
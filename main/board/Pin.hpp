@@ -0,0 +1,88 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <cstdint>
+
+namespace board {
+
+constexpr uint8_t const gpioBankSize = 32;
+constexpr uint8_t const gpioBankCount = 2;
+
+enum PinPolarity : uint8_t {
+  PIN_ACTIVE_HIGH = 0,
+  PIN_ACTIVE_LOW = 1,
+};
+
+/**
+ * Set and clear masks per GPIO bank, applied without reading the output register back
+ */
+struct GpioPattern {
+  uint32_t setMask[gpioBankCount];
+  uint32_t clearMask[gpioBankCount];
+};
+
+/**
+ * Output pin known at compile time
+ */
+template<uint8_t Number, PinPolarity Polarity = PIN_ACTIVE_HIGH>
+struct Pin {
+  static_assert(Number < gpioBankSize * gpioBankCount, "Pin number out of range");
+
+  static constexpr uint8_t number = Number;
+  static constexpr PinPolarity polarity = Polarity;
+  static constexpr uint8_t bank = Number / gpioBankSize;
+  static constexpr uint32_t mask = 1UL << (Number % gpioBankSize);
+};
+
+/**
+ * Pins written together, bit N of the value is the active state of the N-th pin
+ */
+template<typename... Pins>
+struct PinGroup {
+  static_assert(sizeof...(Pins) > 0 and sizeof...(Pins) <= 32, "Pin group must hold 1 to 32 pins");
+
+  static constexpr GpioPattern pattern(uint32_t const activeBits) {
+    constexpr uint8_t numbers[] = {Pins::number...};
+    constexpr PinPolarity polarities[] = {Pins::polarity...};
+
+    GpioPattern result = {};
+
+    for (uint32_t index = 0; index < sizeof...(Pins); ++index) {
+      auto const isActive = ((activeBits >> index) & 1) != 0;
+      auto const isHigh = isActive != (polarities[index] == PIN_ACTIVE_LOW);
+      auto const bank = numbers[index] / gpioBankSize;
+      auto const mask = 1UL << (numbers[index] % gpioBankSize);
+
+      if (isHigh) {
+        result.setMask[bank] |= mask;
+      } else {
+        result.clearMask[bank] |= mask;
+      }
+    }
+
+    return result;
+  }
+
+  static constexpr uint64_t mask() {
+    return ((uint64_t(1) << Pins::number) | ...);
+  }
+};
+
+}// namespace board
@@ -0,0 +1,39 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include "SystemClock.hpp"
+
+#ifdef ESP_PLATFORM
+#include <esp_timer.h>
+#else
+#include <chrono>
+#endif
+
+uint64_t SystemClock::getTime_InUS() const {
+#ifdef ESP_PLATFORM
+  return static_cast<uint64_t>(esp_timer_get_time());
+#else
+  auto const timeSinceEpoch = std::chrono::steady_clock::now().time_since_epoch();
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(timeSinceEpoch).count());
+#endif
+}
+
+IClockPtr getSystemClock() {
+  static auto const systemClock = std::make_shared<SystemClock>();
+  return systemClock;
+}
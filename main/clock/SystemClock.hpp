@@ -0,0 +1,38 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include "clock/interface/IClock.hpp"
+
+/**
+ * Hardware time, esp_timer on the device and the steady clock on the host
+ */
+class SystemClock : public IClock {
+public:
+  SystemClock() = default;
+  ~SystemClock() override = default;
+
+public:
+  [[nodiscard]] uint64_t getTime_InUS() const override;
+};
+
+/**
+ * Process wide hardware clock, the default of every node
+ */
+IClockPtr getSystemClock();
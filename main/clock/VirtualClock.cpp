@@ -0,0 +1,38 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include "VirtualClock.hpp"
+
+VirtualClock::VirtualClock(uint64_t const startTimeInUS) : m_time_InUS(startTimeInUS) {
+}
+
+uint64_t VirtualClock::getTime_InUS() const {
+  return m_time_InUS.load(std::memory_order_relaxed);
+}
+
+void VirtualClock::setTime(uint64_t const timeInUS) {
+  auto currentTime_InUS = m_time_InUS.load(std::memory_order_relaxed);
+
+  // Time never runs backwards, not even in a simulation
+  while (timeInUS > currentTime_InUS and not m_time_InUS.compare_exchange_weak(currentTime_InUS, timeInUS, std::memory_order_relaxed)) {
+  }
+}
+
+void VirtualClock::advance(uint64_t const durationInUS) {
+  m_time_InUS.fetch_add(durationInUS, std::memory_order_relaxed);
+}
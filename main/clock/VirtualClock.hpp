@@ -0,0 +1,45 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <atomic>
+
+#include "clock/interface/IClock.hpp"
+
+/**
+ * Simulated time, only moves when told to.
+ * Lets a simulation skip idle periods instantly and start at any uptime.
+ */
+class VirtualClock : public IClock {
+public:
+  explicit VirtualClock(uint64_t startTimeInUS = 0);
+  ~VirtualClock() override = default;
+
+public:
+  [[nodiscard]] uint64_t getTime_InUS() const override;
+
+public:
+  void setTime(uint64_t timeInUS);
+  void advance(uint64_t durationInUS);
+
+private:
+  std::atomic<uint64_t> m_time_InUS;
+};
+
+using VirtualClockPtr = std::shared_ptr<VirtualClock>;
@@ -0,0 +1,35 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <memory>
+#include <cstdint>
+
+/**
+ * Monotonic time source shared by all nodes, 64 bit microseconds never wrap in practice
+ */
+class IClock {
+public:
+  virtual ~IClock() = default;
+
+public:
+  [[nodiscard]] virtual uint64_t getTime_InUS() const = 0;
+};
+
+using IClockPtr = std::shared_ptr<IClock>;
@@ -0,0 +1,69 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include "AdaptiveFilter.hpp"
+
+#include <cstdlib>
+
+constexpr int32_t const fractionBits = 8;
+constexpr int64_t const smoothingFactorOne = 1 << 16;
+constexpr uint32_t const derivativeCutoff_InMilliHertz = 1000;
+
+AdaptiveFilter::AdaptiveFilter(uint32_t const samplePeriodInUS, uint32_t const minCutoffInMilliHertz, uint32_t const beta) :
+    m_samplePeriod_InUS(samplePeriodInUS),
+    m_minCutoff_InMilliHertz(minCutoffInMilliHertz),
+    m_beta(beta),
+    m_derivativeSmoothingFactor(calculateSmoothingFactor(derivativeCutoff_InMilliHertz)),
+    m_value(0),
+    m_derivative(0) {
+}
+
+float AdaptiveFilter::getGroupDelay() const {
+  // Worst case delay of a first order low pass at the minimal cutoff
+  auto const smoothingFactor = static_cast<float>(calculateSmoothingFactor(m_minCutoff_InMilliHertz)) / smoothingFactorOne;
+  return (1 - smoothingFactor) / smoothingFactor;
+}
+
+bool AdaptiveFilter::process(int32_t const sample, int32_t &output) {
+  auto const value = sample << fractionBits;
+
+  // Pedal speed in millivolts per second, Q8
+  auto const derivative = static_cast<int64_t>(value - m_value) * 1000000 / m_samplePeriod_InUS;
+  m_derivative += static_cast<int32_t>((derivative - m_derivative) * m_derivativeSmoothingFactor / smoothingFactorOne);
+
+  auto const speed_InMillivoltsPerSecond = static_cast<uint32_t>(std::abs(m_derivative) >> fractionBits);
+  auto const cutoff_InMilliHertz = m_minCutoff_InMilliHertz + m_beta * speed_InMillivoltsPerSecond;
+
+  auto const smoothingFactor = calculateSmoothingFactor(cutoff_InMilliHertz);
+  m_value += static_cast<int32_t>(static_cast<int64_t>(value - m_value) * smoothingFactor / smoothingFactorOne);
+
+  output = m_value >> fractionBits;
+
+  return true;
+}
+
+void AdaptiveFilter::reset(int32_t const value) {
+  m_value = value << fractionBits;
+  m_derivative = 0;
+}
+
+int32_t AdaptiveFilter::calculateSmoothingFactor(uint32_t const cutoffInMilliHertz) const {
+  // alpha = w / (1 + w), w = 2 * pi * cutoff * period, Q16
+  auto const w = static_cast<int64_t>(cutoffInMilliHertz) * m_samplePeriod_InUS * 411775 / 1000000000;
+  return static_cast<int32_t>((w << 16) / (smoothingFactorOne + w));
+}
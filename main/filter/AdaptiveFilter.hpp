@@ -0,0 +1,54 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include "filter/interface/IFilter.hpp"
+
+/**
+ * One euro filter in fixed point.
+ * Low cutoff while the pedal rests to hide noise, the cutoff rises with pedal speed to keep lag small on fast moves.
+ */
+class AdaptiveFilter : public IFilter {
+public:
+  /**
+   * @param samplePeriodInUS Period of the input values, take it from the producer, see Accelerator::getFramePeriod_InUS()
+   */
+  explicit AdaptiveFilter(uint32_t samplePeriodInUS = 1000, uint32_t minCutoffInMilliHertz = 1000, uint32_t beta = 20);
+  ~AdaptiveFilter() override = default;
+
+public:
+  [[nodiscard]] float getGroupDelay() const override;
+
+public:
+  bool process(int32_t sample, int32_t &output) override;
+  void reset(int32_t value) override;
+
+private:
+  [[nodiscard]] int32_t calculateSmoothingFactor(uint32_t cutoffInMilliHertz) const;
+
+private:
+  uint32_t const m_samplePeriod_InUS;
+  uint32_t const m_minCutoff_InMilliHertz;
+  uint32_t const m_beta;
+  int32_t const m_derivativeSmoothingFactor;
+
+private:
+  int32_t m_value;
+  int32_t m_derivative;
+};
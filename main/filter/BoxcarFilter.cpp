@@ -0,0 +1,49 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include "BoxcarFilter.hpp"
+
+BoxcarFilter::BoxcarFilter(uint32_t const length) : m_length(length > 0 ? length : 1),
+                                                    m_sum(0),
+                                                    m_count(0) {
+}
+
+float BoxcarFilter::getGroupDelay() const {
+  return static_cast<float>(m_length - 1) / 2;
+}
+
+bool BoxcarFilter::process(int32_t const sample, int32_t &output) {
+  m_sum += sample;
+  m_count += 1;
+
+  if (m_count < m_length) {
+    return false;
+  }
+
+  output = m_sum / static_cast<int32_t>(m_length);
+
+  m_sum = 0;
+  m_count = 0;
+
+  return true;
+}
+
+void BoxcarFilter::reset([[maybe_unused]] int32_t const value) {
+  m_sum = 0;
+  m_count = 0;
+}
@@ -0,0 +1,44 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include "filter/interface/IFilter.hpp"
+
+/**
+ * Boxcar average with decimation, one output per `length` input samples
+ */
+class BoxcarFilter : public IFilter {
+public:
+  explicit BoxcarFilter(uint32_t length = 4);
+  ~BoxcarFilter() override = default;
+
+public:
+  [[nodiscard]] float getGroupDelay() const override;
+
+public:
+  bool process(int32_t sample, int32_t &output) override;
+  void reset(int32_t value) override;
+
+private:
+  uint32_t const m_length;
+
+private:
+  int32_t m_sum;
+  uint32_t m_count;
+};
@@ -0,0 +1,61 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include "KalmanFilter.hpp"
+
+#include <cmath>
+
+constexpr int32_t const fractionBits = 8;
+constexpr int64_t const gainOne = 1 << 16;
+
+KalmanFilter::KalmanFilter(float const processNoise, float const measurementNoise) :
+    m_positionGain(0),
+    m_velocityGain(0),
+    m_position(0),
+    m_velocity(0) {
+  // Steady state gains of the alpha-beta tracker from the tracking index
+  auto const trackingIndex = processNoise / measurementNoise;
+  auto const r = (4 + trackingIndex - std::sqrt(8 * trackingIndex + trackingIndex * trackingIndex)) / 4;
+  auto const alpha = 1 - r * r;
+  auto const beta = 2 * (2 - alpha) - 4 * std::sqrt(1 - alpha);
+
+  m_positionGain = static_cast<int32_t>(alpha * gainOne);
+  m_velocityGain = static_cast<int32_t>(beta * gainOne);
+}
+
+float KalmanFilter::getGroupDelay() const {
+  // The velocity state tracks constant rate pedal travel without lag
+  return 0;
+}
+
+bool KalmanFilter::process(int32_t const sample, int32_t &output) {
+  auto const predictedPosition = m_position + m_velocity;
+  auto const residual = static_cast<int64_t>((sample << fractionBits) - predictedPosition);
+
+  m_position = predictedPosition + static_cast<int32_t>(residual * m_positionGain / gainOne);
+  m_velocity = m_velocity + static_cast<int32_t>(residual * m_velocityGain / gainOne);
+
+  output = m_position >> fractionBits;
+
+  return true;
+}
+
+void KalmanFilter::reset(int32_t const value) {
+  m_position = value << fractionBits;
+  m_velocity = 0;
+}
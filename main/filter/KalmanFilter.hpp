@@ -0,0 +1,46 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include "filter/interface/IFilter.hpp"
+
+/**
+ * Steady state Kalman filter for a position and velocity model of the pedal.
+ * The gains are solved once from the noise figures, per sample update is integer only.
+ */
+class KalmanFilter : public IFilter {
+public:
+  explicit KalmanFilter(float processNoise = 0.05, float measurementNoise = 4.0);
+  ~KalmanFilter() override = default;
+
+public:
+  [[nodiscard]] float getGroupDelay() const override;
+
+public:
+  bool process(int32_t sample, int32_t &output) override;
+  void reset(int32_t value) override;
+
+private:
+  int32_t m_positionGain;
+  int32_t m_velocityGain;
+
+private:
+  int32_t m_position;
+  int32_t m_velocity;
+};
@@ -0,0 +1,87 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include "MedianFilter.hpp"
+
+#include <utility>
+
+namespace {
+
+uint32_t limitLength(uint32_t const length) {
+  if (length < 1) {
+    return 1;
+  }
+
+  if (length > medianFilterMaxLength) {
+    return medianFilterMaxLength;
+  }
+
+  return length;
+}
+
+}// namespace
+
+MedianFilter::MedianFilter(uint32_t const length) : m_length(limitLength(length)),
+                                                    m_history(),
+                                                    m_sorted(),
+                                                    m_index(0) {
+  MedianFilter::reset(0);
+}
+
+float MedianFilter::getGroupDelay() const {
+  return static_cast<float>(m_length - 1) / 2;
+}
+
+bool MedianFilter::process(int32_t const sample, int32_t &output) {
+  auto const oldestSample = m_history[m_index];
+
+  m_history[m_index] = sample;
+  m_index += 1;
+
+  if (m_index >= m_length) {
+    m_index = 0;
+  }
+
+  // The sorted window differs from the previous one by a single value, so replace it in place and bubble it into order
+  uint32_t position = 0;
+  while (m_sorted[position] != oldestSample) {
+    position += 1;
+  }
+
+  m_sorted[position] = sample;
+
+  while (position > 0 and m_sorted[position - 1] > m_sorted[position]) {
+    std::swap(m_sorted[position - 1], m_sorted[position]);
+    position -= 1;
+  }
+
+  while (position + 1 < m_length and m_sorted[position + 1] < m_sorted[position]) {
+    std::swap(m_sorted[position + 1], m_sorted[position]);
+    position += 1;
+  }
+
+  output = m_sorted[m_length / 2];
+
+  return true;
+}
+
+void MedianFilter::reset(int32_t const value) {
+  m_history.fill(value);
+  m_sorted.fill(value);
+  m_index = 0;
+}
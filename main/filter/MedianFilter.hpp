@@ -0,0 +1,49 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <array>
+
+#include "filter/interface/IFilter.hpp"
+
+constexpr uint32_t const medianFilterMaxLength = 9;
+
+/**
+ * Running median over the last `length` samples, rejects single sample spikes
+ */
+class MedianFilter : public IFilter {
+public:
+  explicit MedianFilter(uint32_t length = 5);
+  ~MedianFilter() override = default;
+
+public:
+  [[nodiscard]] float getGroupDelay() const override;
+
+public:
+  bool process(int32_t sample, int32_t &output) override;
+  void reset(int32_t value) override;
+
+private:
+  uint32_t const m_length;
+
+private:
+  std::array<int32_t, medianFilterMaxLength> m_history;
+  std::array<int32_t, medianFilterMaxLength> m_sorted;
+  uint32_t m_index;
+};
@@ -0,0 +1,53 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <memory>
+#include <cstdint>
+
+/**
+ * Software filter stage for the pedal signal.
+ * Samples and outputs are fixed point millivolts, one output may be produced per one or more input samples.
+ */
+class IFilter {
+public:
+  virtual ~IFilter() = default;
+
+public:
+  /**
+   * Group delay of the filter in input samples
+   */
+  [[nodiscard]] virtual float getGroupDelay() const = 0;
+
+public:
+  /**
+   * Push a new sample into the filter
+   * @param sample Input value in millivolts
+   * @param output Filtered value, valid only when true is returned
+   * @return true when a new output value is available
+   */
+  virtual bool process(int32_t sample, int32_t &output) = 0;
+
+  /**
+   * Drop the filter history and restart from the given value
+   */
+  virtual void reset(int32_t value) = 0;
+};
+
+using IFilterPtr = std::unique_ptr<IFilter>;
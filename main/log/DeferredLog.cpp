@@ -0,0 +1,126 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include "DeferredLog.hpp"
+
+#include <cstdio>
+#include <chrono>
+#include <thread>
+
+#include "runtime/Task.hpp"
+#include "runtime/RingBuffer.hpp"
+
+#ifdef ESP_PLATFORM
+#include <esp_log.h>
+#include <esp_timer.h>
+#endif
+
+constexpr std::size_t const logBufferSize = 256;
+constexpr std::size_t const logLineSize = 128;
+
+namespace {
+
+RingBuffer<LogRecord, logBufferSize> logBuffer;
+
+uint32_t getTimestamp_InMS() {
+#ifdef ESP_PLATFORM
+  return static_cast<uint32_t>(esp_timer_get_time() / 1000);
+#else
+  auto const timeSinceEpoch = std::chrono::steady_clock::now().time_since_epoch();
+  return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(timeSinceEpoch).count());
+#endif
+}
+
+}// namespace
+
+void deferredLog(LogMessageId const messageId, int32_t const argument0, int32_t const argument1) {
+  logBuffer.push({
+      .timestamp_InMS = getTimestamp_InMS(),
+      .messageId = messageId,
+      .reserved = 0,
+      .arguments = {argument0, argument1},
+  });
+}
+
+uint32_t deferredLogFlush() {
+  uint32_t numberOfMessages = 0;
+
+  LogRecord record = {};
+  char line[logLineSize] = {0};
+
+  while (logBuffer.pop(record)) {
+    deferredLogFormat(record, line, sizeof(line));
+    numberOfMessages += 1;
+
+#ifdef ESP_PLATFORM
+    auto const tag = record.messageId < LOG_MESSAGE_COUNT ? logMessageFormats[record.messageId].tag : "log";
+    ESP_LOGI(tag, "(%lu) %s", record.timestamp_InMS, line);
+#else
+    std::printf("%s\n", line);
+#endif
+  }
+
+  return numberOfMessages;
+}
+
+std::size_t deferredLogDrain(LogRecord *records, std::size_t const maxNumberOfRecords) {
+  std::size_t numberOfRecords = 0;
+
+  while (numberOfRecords < maxNumberOfRecords and logBuffer.pop(records[numberOfRecords])) {
+    numberOfRecords += 1;
+  }
+
+  return numberOfRecords;
+}
+
+void deferredLogStartTask(uint32_t const flushPeriodInMS) {
+  runtime::startPinnedTask("log", runtime::controlCore, 1, 4096, [flushPeriodInMS]() {
+    while (true) {
+      deferredLogFlush();
+      std::this_thread::sleep_for(std::chrono::milliseconds(flushPeriodInMS));
+    }
+  });
+}
+
+std::size_t deferredLogFormat(LogRecord const &record, char *buffer, std::size_t const bufferSize) {
+  if (record.messageId >= LOG_MESSAGE_COUNT) {
+    return std::snprintf(buffer, bufferSize, "Unknown message %u", record.messageId);
+  }
+
+  auto const &[tag, format] = logMessageFormats[record.messageId];
+
+  auto const argument0 = static_cast<long>(record.arguments[0]);
+  auto const argument1 = static_cast<long>(record.arguments[1]);
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-nonliteral"
+#pragma GCC diagnostic ignored "-Wformat-security"
+  auto const length = std::snprintf(buffer, bufferSize, format, argument0, argument1);
+#pragma GCC diagnostic pop
+
+  if (length < 0) {
+    buffer[0] = '\0';
+    return 0;
+  }
+
+  if (static_cast<std::size_t>(length) >= bufferSize) {
+    return bufferSize - 1;
+  }
+
+  return static_cast<std::size_t>(length);
+}
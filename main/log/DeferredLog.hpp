@@ -0,0 +1,113 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Identifiers of deferred log messages, index into logMessageFormats
+ */
+enum LogMessageId : uint16_t {
+  LOG_MODE_BUTTON_MODE = 0,
+  LOG_SETUP_BUTTON_PRESSED,
+  LOG_SETUP_BUTTON_HELD,
+  LOG_SETUP_BUTTON_LONG_HELD,
+  LOG_SETUP_BUTTON_RELEASED,
+  LOG_MOTOR_CONTROLLER_MOVING_HOME,
+  LOG_ETC_CONTROLLER_BLIP_START,
+  LOG_ETC_CONTROLLER_BLIP_END,
+  LOG_ETC_CONTROLLER_LAUNCH_STATE,
+  LOG_POWER_CONTROLLER_STATE,
+  LOG_POWER_CONTROLLER_WAKE_LATENCY,
+  LOG_MOTION_IDENTIFIER_STARTED,
+  LOG_MOTION_IDENTIFIER_FINISHED,
+  LOG_MOTION_IDENTIFIER_SPEED,
+  LOG_MOTION_IDENTIFIER_ACCELERATION,
+  LOG_MOTION_IDENTIFIER_SPEED_BAND,
+  LOG_LATENCY_REPORTER_PERCENTILES,
+  LOG_LATENCY_REPORTER_MAXIMUM,
+  LOG_ACCELERATOR_FILTER,
+  LOG_MESSAGE_COUNT
+};
+
+struct LogMessageFormat {
+  char const *tag;
+  char const *format;
+};
+
+/**
+ * Arguments are passed to the format as long, use %ld and %lu only
+ */
+constexpr LogMessageFormat const logMessageFormats[LOG_MESSAGE_COUNT] = {
+    {"mode_button", "Mode %ld"},
+    {"setup_button", "Pressed"},
+    {"setup_button", "Held"},
+    {"setup_button", "Long held"},
+    {"setup_button", "Released"},
+    {"motor_controller", "Moving relative %ld steps"},
+    {"etc_controller", "Blip from gear %ld to %ld rpm"},
+    {"etc_controller", "Blip over after %ld ms, %ld rpm off target"},
+    {"etc_controller", "Launch control state %ld"},
+    {"power_controller", "Power state %ld, wake source %ld"},
+    {"power_controller", "First command %lu us after wake, %lu late wakes"},
+    {"motion_identifier", "Routine %ld started"},
+    {"motion_identifier", "Routine %ld finished, succeeded %ld"},
+    {"motion_identifier", "Direction %ld speed limit %lu steps/s"},
+    {"motion_identifier", "Direction %ld acceleration limit %lu steps/s2"},
+    {"motion_identifier", "Forbidden speed band %lu..%lu steps/s"},
+    {"latency_reporter", "Pedal to step p50 %lu us, p99 %lu us"},
+    {"latency_reporter", "Pedal to step max %lu us over %lu samples"},
+    {"accelerator", "Filter %ld selected, group delay %lu us"},
+};
+
+struct LogRecord {
+  uint32_t timestamp_InMS;
+  uint16_t messageId;
+  uint16_t reserved;
+  int32_t arguments[2];
+};
+
+/**
+ * Queue a message for later formatting, safe from any task and core, never blocks
+ */
+void deferredLog(LogMessageId messageId, int32_t argument0 = 0, int32_t argument1 = 0);
+
+/**
+ * Format all queued messages through the regular log output
+ * @return Number of formatted messages
+ */
+uint32_t deferredLogFlush();
+
+/**
+ * Move queued records out without formatting them, to dump them raw and decode them elsewhere
+ * @return Number of records written, at most maxNumberOfRecords
+ */
+std::size_t deferredLogDrain(LogRecord *records, std::size_t maxNumberOfRecords);
+
+/**
+ * Start a low priority task that flushes the queue periodically
+ */
+void deferredLogStartTask(uint32_t flushPeriodInMS = 100);
+
+/**
+ * Render a record into text, usable on the host to decode dumped records
+ * @return Number of characters written, excluding the terminator
+ */
+std::size_t deferredLogFormat(LogRecord const &record, char *buffer, std::size_t bufferSize);
@@ -25,43 +25,207 @@
 //#include "ModeButton.hpp"
 //#include "SetupButton.hpp"
 //#include "EtcController.hpp"
+//#include "filter/AdaptiveFilter.hpp"
+//#include "profile/RidingProfileSelector.hpp"
+//#include "stepper/MotorBridge.hpp"
 //#include "stepper/MotorController.hpp"
+//#include "stepper/MotionIdentifier.hpp"
+//#include "runtime/Task.hpp"
+//#include "log/DeferredLog.hpp"
+//#include "ota/OtaService.hpp"
+//#include "ota/OtaImageValidator.hpp"
+//#include "monitor/ResourceMonitor.hpp"
+//#include "monitor/ResourceService.hpp"
+//#include "replay/RideLogWriter.hpp"
+//#include "telemetry/TelemetryLink.hpp"
+//#include "telemetry/UsbCdcTransport.hpp"
+//#include "power/PowerController.hpp"
+//#include "trace/LatencyReporter.hpp"
 
+constexpr uint32_t const motorMaximalSpeed = 4000;
 constexpr uint32_t const motorDefaultSpeed = 1500;
 constexpr uint32_t const motorDefaultAcceleration = 15000;
 constexpr uint32_t const motorDefaultDeceleration = 30000;
 
+constexpr uint32_t const pedalWakeThreshold_InMillivolts = 50;
+
+// Launch control has a switch of its own, the mode button only selects the riding profile
+constexpr uint8_t const launchButtonPinNumber = 17;
+
 extern "C" void app_main(void) {
     NimBLEDevice::init("ETCU");
     NimBLEDevice::setMTU(517);
+//  auto otaService = std::make_unique<OtaService>(NimBLEDevice::createServer());
+//  auto resourceService = std::make_unique<ResourceService>(NimBLEDevice::createServer());
     NimBLEDevice::startAdvertising();
 
-//  auto motorController = std::make_shared<MotorController>(500, motorDefaultSpeed, 500);
+//  deferredLogStartTask();
+//
+//  auto motorController = std::make_shared<MotorController>(500, motorMaximalSpeed, 500);
 //  motorController->setSpeed(motorDefaultSpeed);
 //  motorController->setAcceleration(motorDefaultAcceleration);
 //  motorController->setDeceleration(motorDefaultDeceleration);
 //  motorController->moveToHome();
 //
+//  auto latencyHistogram = std::make_shared<LatencyHistogram>();
+//  motorController->setLatencyHistogram(latencyHistogram);
+//
+//  auto profileSelector = std::make_shared<RidingProfileSelector>();
+//
+//  auto motorSetpointMailbox = std::make_shared<Mailbox<MotorSetpoint>>();
+//  auto motorStatusMailbox = std::make_shared<Mailbox<MotorStatus>>();
+//  auto motorBridge = std::make_shared<MotorBridge>(motorController, motorSetpointMailbox, motorStatusMailbox);
+//  motorBridge->setProfileSelector(profileSelector);
+//
+//  auto motionIdentifier = std::make_shared<MotionIdentifier>(motorController);
+//  motionIdentifier->registerStartCallback(
+//      [&]() {
+//        motorBridge->suspend();
+//      });
+//  motionIdentifier->registerFinishCallback(
+//      [&](bool const) {
+//        motorBridge->resume();
+//      });
+//
+//  MotorSetpoint motorSetpoint = {
+//      .position = 0,
+//      .speed = motorDefaultSpeed,
+//      .wakeRequest = 0,
+//      .sleepRequest = 0,
+//      .trace = {},
+//  };
+//
+//  auto powerController = std::make_shared<PowerController>();
+//
+//  auto telemetryLink = std::make_shared<TelemetryLink>(std::make_unique<UsbCdcTransport>());
+//  auto rideLogWriter = std::make_shared<RideLogWriter>(
+//      [&](uint8_t const *data, std::size_t const size) {
+//        telemetryLink->send(TELEMETRY_CHANNEL_RIDE_LOG, data, size);
+//      });
+//
+//  // Every input the control chain sees and every command it gives is recorded for a replay on the host
+//  RideLogButtons rideLogButtons = {
+//      .modeButtonState = MODE_BUTTON_STATE_UNKNOWN,
+//      .setupButtonState = SETUP_BUTTON_RELEASED,
+//      .launchButtonState = SETUP_BUTTON_RELEASED,
+//  };
+//
 //  auto etcController = std::make_shared<EtcController>();
+//  etcController->setProfileSelector(profileSelector);
 //  etcController->registerChangeValueCallback(
-//      [&](uint32_t const motorPosition) {
-//        motorController->setPosition(static_cast<int32_t>(motorPosition));
+//      [&](uint32_t const motorPosition, TraceTag const traceTag) {
+//        motorSetpoint.position = motorPosition;
+//        motorSetpoint.trace = traceTag;
+//        motorSetpointMailbox->write(motorSetpoint);
+//        powerController->notifyCommand();
+//
+//        MotorStatus motorStatus = {};
+//        motorStatusMailbox->read(motorStatus);
+//        rideLogWriter->writeOutput(getSystemClock()->getTime_InUS(), {.command = motorPosition, .motorPosition = motorStatus.position});
+//      });
+//
+//  auto const updateVehicle =
+//      [&](RideLogVehicle const &vehicle) {
+//        etcController->setVehicleRPM(vehicle.revolutionPerMinute);
+//        etcController->setVehicleSpeed(vehicle.speed_InKilometersPerHour);
+//        etcController->setVehicleClutchState(vehicle.clutchIsEnabled != 0);
+//        powerController->setVehicleRPM(vehicle.revolutionPerMinute);
+//        rideLogWriter->writeVehicle(getSystemClock()->getTime_InUS(), vehicle);
+//      };
+//
+//  otaService->registerUpdatePermissionCallback(
+//      [&]() {
+//        MotorStatus motorStatus = {};
+//        motorStatusMailbox->read(motorStatus);
+//
+//        return etcController->getVehicleRPM() == 0 and etcController->getVehicleSpeed() == 0 and motorStatus.position == 0;
+//      });
+//
+//  telemetryLink->registerCommand(
+//      0x01,
+//      [&](uint8_t const *arguments, std::size_t const size) {
+//        if (size != sizeof(uint16_t)) {
+//          return TELEMETRY_COMMAND_STATUS_INVALID;
+//        }
+//
+//        auto parameters = etcController->getParameters();
+//        parameters.idleControl.targetRevolutions_InRPM = arguments[0] | (arguments[1] << 8);
+//        etcController->setParameters(parameters);
+//
+//        return TELEMETRY_COMMAND_STATUS_OK;
+//      });
+//  telemetryLink->registerCommand(
+//      0x02,
+//      [&](uint8_t const *, std::size_t const) {
+//        if (etcController->getVehicleRPM() != 0) {
+//          return TELEMETRY_COMMAND_STATUS_INVALID;
+//        }
+//
+//        motionIdentifier->startSweep();
+//
+//        return TELEMETRY_COMMAND_STATUS_OK;
 //      });
 //
 //  auto accelerator = std::make_shared<Accelerator>();
+//  // One filter per profile up front, a mode change only switches between them
+//  std::vector<IFilterPtr> pedalFilters;
+//  for (auto const &profile : defaultRidingProfiles) {
+//    pedalFilters.push_back(std::make_unique<AdaptiveFilter>(accelerator->getFramePeriod_InUS(), profile.filterMinCutoff_InMilliHertz, profile.filterBeta));
+//  }
+//  accelerator->setFilters(std::move(pedalFilters));
+//  accelerator->selectFilter(ridingProfileCount - 1);
+//  accelerator->registerFrameCallback(
+//      [&](uint8_t const *frame, uint32_t const size) {
+//        rideLogWriter->writeFrame(getSystemClock()->getTime_InUS(), frame, size);
+//      });
+//  accelerator->registerActivityCallback(
+//      [&]() {
+//        motorSetpoint.wakeRequest += 1;
+//        motorSetpointMailbox->write(motorSetpoint);
+//        powerController->notifyPedalActivity();
+//      });
+//  uint32_t pedalValue_InPercentage = 0;
 //  accelerator->registerChangeAccelerateCallback(
-//      [&](uint32_t const acceleratorValue_InPercentage) {
-//        etcController->setAcceleratorValue(acceleratorValue_InPercentage);
+//      [&](uint32_t const acceleratorValue_InPercentage, TraceTag const traceTag) {
+//        pedalValue_InPercentage = acceleratorValue_InPercentage;
+//        etcController->setAcceleratorValue(acceleratorValue_InPercentage, traceTag);
 //        throttlePositionCharacteristic->setValue(acceleratorValue_InPercentage);
 //      });
 //
+//  bool isIdentificationArmed = false;
 //  auto setupButton = std::make_shared<SetupButton>();
 //  setupButton->registerChangeValueCallback(
 //      [&](SetupButtonState const setupButtonState) {
+//        powerController->notifyButton();
+//
+//        rideLogButtons.setupButtonState = setupButtonState;
+//        rideLogWriter->writeButtons(getSystemClock()->getTime_InUS(), rideLogButtons);
+//
+//        // Held at standstill and let go before the long hold, the long hold is pedal calibration
+//        if (setupButtonState == SETUP_BUTTON_HELD and etcController->getVehicleRPM() == 0) {
+//          isIdentificationArmed = true;
+//          return;
+//        }
+//        if (setupButtonState == SETUP_BUTTON_RELEASED and isIdentificationArmed) {
+//          isIdentificationArmed = false;
+//          motionIdentifier->start();
+//        }
 //        if (setupButtonState == SETUP_BUTTON_HELD) {
 //          etcController->modeEnable();
 //        }
+//        // The pedal is not forwarded while calibrating, only with the engine stopped
+//        if (setupButtonState == SETUP_BUTTON_LONG_HELD and etcController->getVehicleRPM() == 0) {
+//          isIdentificationArmed = false;
+//          etcController->modeDisable();
+//          accelerator->calibrationStart();
+//        }
+//        if (setupButtonState == SETUP_BUTTON_PRESSED and motionIdentifier->isRunning()) {
+//          motionIdentifier->stop();
+//        }
 //        if (setupButtonState == SETUP_BUTTON_PRESSED) {
+//          if (accelerator->isCalibrating()) {
+//            accelerator->calibrationStop();
+//          }
 //          etcController->modeDisable();
 //        }
 //      });
@@ -69,35 +233,119 @@ extern "C" void app_main(void) {
 //  auto modeButton = std::make_shared<ModeButton>();
 //  modeButton->registerChangeValueCallback(
 //      [&](ModeButtonState const modeButtonState) {
-//        float speedRate = 1.0;
+//        powerController->notifyButton();
 //
-//        if (modeButtonState == MODE_BUTTON_STATE_MODE_1) {
-//          speedRate = 0.3;
-//        }
+//        rideLogButtons.modeButtonState = modeButtonState;
+//        rideLogWriter->writeButtons(getSystemClock()->getTime_InUS(), rideLogButtons);
 //
-//        if (modeButtonState == MODE_BUTTON_STATE_MODE_2) {
-//          speedRate = 0.5;
+//        if (modeButtonState == MODE_BUTTON_STATE_UNKNOWN) {
+//          return;
 //        }
 //
-//        if (modeButtonState == MODE_BUTTON_STATE_MODE_3) {
-//          speedRate = 1.0;
+//        auto const profileIndex = static_cast<uint32_t>(modeButtonState - MODE_BUTTON_STATE_MODE_1);
+//        profileSelector->select(profileIndex);
+//        accelerator->selectFilter(profileIndex);
+//      });
+//
+//  // Held at standstill arms launch control for one launch, a press disarms it
+//  auto launchButton = std::make_shared<SetupButton>(launchButtonPinNumber);
+//  launchButton->registerChangeValueCallback(
+//      [&](SetupButtonState const launchButtonState) {
+//        powerController->notifyButton();
+//
+//        rideLogButtons.launchButtonState = launchButtonState;
+//        rideLogWriter->writeButtons(getSystemClock()->getTime_InUS(), rideLogButtons);
+//
+//        if (launchButtonState == SETUP_BUTTON_HELD and etcController->getVehicleSpeed() == 0) {
+//          etcController->launchEnable();
 //        }
+//        if (launchButtonState == SETUP_BUTTON_PRESSED) {
+//          etcController->launchDisable();
+//        }
+//      });
 //
-//        auto const speed = motorDefaultSpeed * speedRate;
+//  powerController->addWakeButton(5);
+//  powerController->addWakeButton(6);
+//  powerController->addWakeButton(7);
+//  powerController->addWakeButton(launchButtonPinNumber);
+//  powerController->registerPedalPollCallback(
+//      [&]() {
+//        return accelerator->pollActivity(pedalWakeThreshold_InMillivolts);
+//      });
+//  powerController->registerParkPermissionCallback(
+//      [&]() {
+//        MotorStatus motorStatus = {};
+//        motorStatusMailbox->read(motorStatus);
 //
-//        motorController->setSpeed(speed);
+//        return pedalValue_InPercentage == 0 and motorStatus.position == 0;
+//      });
+//  powerController->registerParkCallback(
+//      [&]() {
+//        accelerator->suspend();
+//        motorSetpoint.sleepRequest += 1;
+//        motorSetpointMailbox->write(motorSetpoint);
+//      });
+//  powerController->registerWakeCallback(
+//      [&](WakeSource const) {
+//        accelerator->resume();
+//        motorSetpoint.wakeRequest += 1;
+//        motorSetpointMailbox->write(motorSetpoint);
 //      });
 
 //  auto uart = std::make_unique<ECU::UartNetworkConnector>(3, 1, 2);
 //  auto kLine = std::make_unique<ECU::KLineNetworkConnector>(1, std::move(uart));
 //  auto ecu = std::make_shared<ECU::HondaECU>(std::move(kLine));
+//  ecu->registerEngineDataCallback(
+//      [&](ECU::EngineData const &engineData) {
+//        updateVehicle({
+//            .revolutionPerMinute = static_cast<uint16_t>(engineData.revolutionPerMinute),
+//            .speed_InKilometersPerHour = static_cast<uint8_t>(engineData.speed_InKilometersPerHour),
+//            .clutchIsEnabled = static_cast<uint8_t>(engineData.clutchIsEnabled),
+//        });
+//
+//        // The throttle body sensor is how the identification tells lost steps, it fails without a reading
+//        motionIdentifier->setThrottlePosition(engineData.throttlePosition_InMillivolts);
+//      });
 
+//  auto latencyReporter = std::make_shared<LatencyReporter>(latencyHistogram);
+//  latencyReporter->registerReportCallback(
+//      [&](LatencySummary const &latencySummary) {
+//        telemetryLink->send(TELEMETRY_CHANNEL_LATENCY, reinterpret_cast<uint8_t const *>(&latencySummary), sizeof(latencySummary));
+//      });
+//
+//  auto motionLoopCounter = std::make_shared<LoopCounter>("motion");
+//  auto controlLoopCounter = std::make_shared<LoopCounter>("control");
+//
+//  // Until the loops prove the image, a reset goes back to the previous one
+//  auto otaImageValidator = std::make_shared<OtaImageValidator>();
+//
+//  auto resourceMonitor = std::make_shared<ResourceMonitor>();
+//  resourceMonitor->addLoopCounter(motionLoopCounter, 300000);
+//  resourceMonitor->addLoopCounter(controlLoopCounter, 1000);
+//  resourceMonitor->registerReportCallback(
+//      [&](ResourceReport const &resourceReport) {
+//        resourceService->publish(resourceReport);
+//        otaImageValidator->processReport(resourceReport);
+//      });
+//
+//  auto motionExecutor = std::make_unique<executor::Executor>();
+//  motionExecutor->addNode(motorController, 300000);
+//  motionExecutor->addNode(motorBridge, 10000);
+//  motionExecutor->addNode(motionIdentifier, 1000);
+//  motionExecutor->addNode(motionLoopCounter, 300000);
+//  runtime::startPinnedTask("motion", runtime::motionCore, configMAX_PRIORITIES - 1, 4096, [&]() { motionExecutor->spin(); });
+//
 //  auto executor = std::make_unique<executor::Executor>();
-//  executor->addNode(motorController, 300000);
 //  executor->addNode(etcController, 1000);
 //  executor->addNode(accelerator, 1000);
 //  executor->addNode(setupButton, 1000);
+//  executor->addNode(launchButton, 1000);
 //  executor->addNode(modeButton, 1000);
+//  executor->addNode(controlLoopCounter, 1000);
+//  executor->addNode(telemetryLink, 1000);
+//  executor->addNode(powerController, 1000);
+//  executor->addNode(resourceMonitor, 1);
+//  executor->addNode(latencyReporter, 1);
 ////  executor->addNode(ecu);
 //  executor->spin();
 }
\ No newline at end of file
@@ -0,0 +1,36 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include "LoopCounter.hpp"
+
+LoopCounter::LoopCounter(char const *name) : m_name(name),
+                                             m_numberOfLoops(0) {
+}
+
+char const *LoopCounter::getName() const {
+  return m_name;
+}
+
+uint32_t LoopCounter::getNumberOfLoops() const {
+  return m_numberOfLoops.load(std::memory_order_relaxed);
+}
+
+void LoopCounter::process() {
+  // Only the executor thread writes, a plain load and store is enough
+  m_numberOfLoops.store(m_numberOfLoops.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
@@ -0,0 +1,47 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <cstdint>
+
+#include "executor/Node.hpp"
+
+/**
+ * Added to an executor next to the nodes it watches, counts how often the executor really gets to it
+ */
+class LoopCounter : public executor::Node {
+public:
+  explicit LoopCounter(char const *name);
+  ~LoopCounter() override = default;
+
+public:
+  [[nodiscard]] char const *getName() const;
+  [[nodiscard]] uint32_t getNumberOfLoops() const;
+
+private:
+  void process() override;
+
+private:
+  char const *m_name;
+  std::atomic<uint32_t> m_numberOfLoops;
+};
+
+using LoopCounterPtr = std::shared_ptr<LoopCounter>;
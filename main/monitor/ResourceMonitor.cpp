@@ -0,0 +1,328 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include "ResourceMonitor.hpp"
+
+#include <cstdio>
+#include <algorithm>
+#include <cstring>
+
+#ifdef ESP_PLATFORM
+#include <esp_log.h>
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#else
+#include <chrono>
+#include <dirent.h>
+#include <unistd.h>
+#define ESP_LOGI(tag, format, ...) std::printf("I %s: " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) std::printf("D %s: " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) std::printf("W %s: " format "\n", tag, ##__VA_ARGS__)
+#endif
+
+constexpr char const *tag = "resource_monitor";
+
+#ifdef ESP_PLATFORM
+// Too big for the executor stack, there is only one monitor
+static TaskStatus_t taskStatuses[resourceMaximumTasks];
+#endif
+
+ResourceMonitor::ResourceMonitor(ResourceThresholds const &thresholds, IClockPtr clock) : m_reportCallbackFunction(nullptr),
+                                                                                          m_warningCallbackFunction(nullptr),
+                                                                                          m_thresholds(thresholds),
+                                                                                          m_clock(std::move(clock)),
+                                                                                          m_report(),
+                                                                                          m_lastSampleTime_InUS(m_clock->getTime_InUS()),
+                                                                                          m_isWarmedUp(false),
+                                                                                          m_lastTotalRunTime_InUS(0),
+                                                                                          m_taskSampleIndex(0),
+                                                                                          m_numberOfTaskSamples{0, 0},
+                                                                                          m_taskSamples(),
+                                                                                          m_numberOfLoopSamples(0),
+                                                                                          m_loopSamples() {
+}
+
+void ResourceMonitor::registerReportCallback(ResourceReportCallbackFunction const &reportCallbackFunction) {
+  m_reportCallbackFunction = reportCallbackFunction;
+}
+
+void ResourceMonitor::registerWarningCallback(ResourceWarningCallbackFunction const &warningCallbackFunction) {
+  m_warningCallbackFunction = warningCallbackFunction;
+}
+
+void ResourceMonitor::addLoopCounter(LoopCounterPtr loopCounter, uint32_t const expectedFrequencyInHertz) {
+  if (m_numberOfLoopSamples >= resourceMaximumLoops) {
+    ESP_LOGW(tag, "Loop counter %s ignored, too many loops", loopCounter->getName());
+    return;
+  }
+
+  auto const numberOfLoops = loopCounter->getNumberOfLoops();
+
+  m_loopSamples[m_numberOfLoopSamples] = {
+      .loopCounter = std::move(loopCounter),
+      .expectedFrequency_InHertz = expectedFrequencyInHertz,
+      .numberOfLoops = numberOfLoops,
+  };
+  m_numberOfLoopSamples += 1;
+}
+
+void ResourceMonitor::process() {
+  auto const currentTime_InUS = m_clock->getTime_InUS();
+  auto const elapsedTime_InUS = currentTime_InUS - m_lastSampleTime_InUS;
+  m_lastSampleTime_InUS = currentTime_InUS;
+
+  sampleHeap();
+  sampleTasks();
+  sampleLoops(elapsedTime_InUS);
+
+  // The first rates cover an unknown start up period, they are reported but never warned about
+  if (m_isWarmedUp) {
+    checkThresholds();
+  }
+  m_isWarmedUp = true;
+
+  logReport();
+
+  if (m_reportCallbackFunction) {
+    m_reportCallbackFunction(m_report);
+  }
+}
+
+#ifdef ESP_PLATFORM
+
+uint32_t ResourceMonitor::readTasks(TaskSample *samples, uint32_t &totalRunTimeInUS) {
+  configRUN_TIME_COUNTER_TYPE totalRunTime = 0;
+
+  auto const numberOfTasks = uxTaskGetSystemState(taskStatuses, resourceMaximumTasks, &totalRunTime);
+  if (numberOfTasks == 0) {
+    ESP_LOGW(tag, "More than %lu tasks, task usage is not sampled", resourceMaximumTasks);
+  }
+
+  for (uint32_t index = 0; index < numberOfTasks; ++index) {
+    auto const &taskStatus = taskStatuses[index];
+    auto &sample = samples[index];
+
+    sample.id = taskStatus.xTaskNumber;
+    sample.runTime_InUS = static_cast<uint32_t>(taskStatus.ulRunTimeCounter);
+    // StackType_t is a byte on this port, the mark is already in bytes
+    sample.stackHighWaterMark_InBytes = taskStatus.usStackHighWaterMark;
+    std::strncpy(sample.name, taskStatus.pcTaskName, resourceNameSize - 1);
+    sample.name[resourceNameSize - 1] = '\0';
+  }
+
+  totalRunTimeInUS = static_cast<uint32_t>(totalRunTime);
+
+  return numberOfTasks;
+}
+
+void ResourceMonitor::readHeap(uint32_t &freeHeapInBytes, uint32_t &minimumFreeHeapInBytes) {
+  freeHeapInBytes = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+  minimumFreeHeapInBytes = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+}
+
+#else
+
+uint32_t ResourceMonitor::readTasks(TaskSample *samples, uint32_t &totalRunTimeInUS) {
+  auto const ticksPerSecond = static_cast<uint64_t>(sysconf(_SC_CLK_TCK));
+  auto const timeSinceEpoch = std::chrono::steady_clock::now().time_since_epoch();
+
+  totalRunTimeInUS = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(timeSinceEpoch).count());
+
+  auto *const directory = opendir("/proc/self/task");
+  if (directory == nullptr) {
+    return 0;
+  }
+
+  uint32_t numberOfTasks = 0;
+
+  for (auto *entry = readdir(directory); entry != nullptr and numberOfTasks < resourceMaximumTasks; entry = readdir(directory)) {
+    if (entry->d_name[0] == '.') {
+      continue;
+    }
+
+    char path[288] = {0};
+    char line[512] = {0};
+
+    std::snprintf(path, sizeof(path), "/proc/self/task/%s/stat", entry->d_name);
+
+    auto *const file = std::fopen(path, "r");
+    if (file == nullptr) {
+      continue;
+    }
+
+    auto const isRead = std::fgets(line, sizeof(line), file) != nullptr;
+    std::fclose(file);
+
+    // "tid (name) state ppid ... utime stime", the name may contain spaces
+    auto const *const nameBegin = std::strchr(line, '(');
+    auto const *const nameEnd = std::strrchr(line, ')');
+    if (not isRead or nameBegin == nullptr or nameEnd == nullptr) {
+      continue;
+    }
+
+    unsigned long userTicks = 0;
+    unsigned long systemTicks = 0;
+    auto const numberOfFields = std::sscanf(nameEnd + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu", &userTicks, &systemTicks);
+    if (numberOfFields != 2) {
+      continue;
+    }
+
+    auto &sample = samples[numberOfTasks];
+    auto const nameSize = std::min<std::size_t>(nameEnd - nameBegin - 1, resourceNameSize - 1);
+
+    sample.id = static_cast<uint32_t>(std::strtoul(entry->d_name, nullptr, 10));
+    sample.runTime_InUS = static_cast<uint32_t>((userTicks + systemTicks) * 1000000 / ticksPerSecond);
+    sample.stackHighWaterMark_InBytes = resourceUnknown;
+    std::memcpy(sample.name, nameBegin + 1, nameSize);
+    sample.name[nameSize] = '\0';
+
+    numberOfTasks += 1;
+  }
+
+  closedir(directory);
+
+  return numberOfTasks;
+}
+
+void ResourceMonitor::readHeap(uint32_t &freeHeapInBytes, uint32_t &minimumFreeHeapInBytes) {
+  freeHeapInBytes = resourceUnknown;
+  minimumFreeHeapInBytes = resourceUnknown;
+}
+
+#endif
+
+void ResourceMonitor::sampleHeap() {
+  readHeap(m_report.freeHeap_InBytes, m_report.minimumFreeHeap_InBytes);
+}
+
+void ResourceMonitor::sampleTasks() {
+  auto const previousIndex = m_taskSampleIndex;
+  auto const currentIndex = m_taskSampleIndex ^ 1;
+
+  auto const &previousSamples = m_taskSamples[previousIndex];
+  auto const numberOfPreviousSamples = m_numberOfTaskSamples[previousIndex];
+
+  auto &samples = m_taskSamples[currentIndex];
+
+  uint32_t totalRunTime_InUS = 0;
+  auto const numberOfTasks = readTasks(samples.data(), totalRunTime_InUS);
+
+  // Run time counters are 32 bit and wrap, the unsigned difference stays right between two samples
+  auto const elapsedRunTime_InUS = totalRunTime_InUS - m_lastTotalRunTime_InUS;
+
+  for (uint32_t index = 0; index < numberOfTasks; ++index) {
+    auto const &sample = samples[index];
+    auto &task = m_report.tasks[index];
+
+    uint32_t cpuUsage_InPercentage = 0;
+
+    for (uint32_t previousIndexOfTask = 0; previousIndexOfTask < numberOfPreviousSamples; ++previousIndexOfTask) {
+      auto const &previousSample = previousSamples[previousIndexOfTask];
+      if (previousSample.id != sample.id or elapsedRunTime_InUS == 0) {
+        continue;
+      }
+
+      auto const taskRunTime_InUS = sample.runTime_InUS - previousSample.runTime_InUS;
+      cpuUsage_InPercentage = static_cast<uint32_t>(static_cast<uint64_t>(taskRunTime_InUS) * 100 / elapsedRunTime_InUS);
+      break;
+    }
+
+    std::memcpy(task.name, sample.name, resourceNameSize);
+    task.stackHighWaterMark_InBytes = sample.stackHighWaterMark_InBytes;
+    task.cpuUsage_InPercentage = cpuUsage_InPercentage > 100 ? 100 : cpuUsage_InPercentage;
+  }
+
+  m_report.numberOfTasks = numberOfTasks;
+  m_numberOfTaskSamples[currentIndex] = numberOfTasks;
+  m_taskSampleIndex = currentIndex;
+  m_lastTotalRunTime_InUS = totalRunTime_InUS;
+}
+
+void ResourceMonitor::sampleLoops(uint64_t const elapsedTimeInUS) {
+  for (uint32_t index = 0; index < m_numberOfLoopSamples; ++index) {
+    auto &loopSample = m_loopSamples[index];
+    auto &loop = m_report.loops[index];
+
+    auto const numberOfLoops = loopSample.loopCounter->getNumberOfLoops();
+    auto const elapsedLoops = numberOfLoops - loopSample.numberOfLoops;
+    loopSample.numberOfLoops = numberOfLoops;
+
+    uint32_t frequency_InHertz = 0;
+    if (elapsedTimeInUS > 0) {
+      frequency_InHertz = static_cast<uint32_t>(static_cast<uint64_t>(elapsedLoops) * 1000000 / elapsedTimeInUS);
+    }
+
+    std::strncpy(loop.name, loopSample.loopCounter->getName(), resourceNameSize - 1);
+    loop.name[resourceNameSize - 1] = '\0';
+    loop.frequency_InHertz = frequency_InHertz;
+    loop.expectedFrequency_InHertz = loopSample.expectedFrequency_InHertz;
+  }
+
+  m_report.numberOfLoops = m_numberOfLoopSamples;
+}
+
+void ResourceMonitor::checkThresholds() {
+  if (m_report.minimumFreeHeap_InBytes < m_thresholds.minimumHeap_InBytes) {
+    warn(RESOURCE_WARNING_HEAP, "heap", m_report.minimumFreeHeap_InBytes);
+  }
+
+  for (uint32_t index = 0; index < m_report.numberOfTasks; ++index) {
+    auto const &task = m_report.tasks[index];
+
+    if (task.stackHighWaterMark_InBytes < m_thresholds.minimumStack_InBytes) {
+      warn(RESOURCE_WARNING_STACK, task.name, task.stackHighWaterMark_InBytes);
+    }
+
+    // Idle tasks soak up whatever is left, a busy idle task is good news
+    if (task.cpuUsage_InPercentage > m_thresholds.maximumCpuUsage_InPercentage and std::strncmp(task.name, "IDLE", 4) != 0) {
+      warn(RESOURCE_WARNING_CPU, task.name, task.cpuUsage_InPercentage);
+    }
+  }
+
+  for (uint32_t index = 0; index < m_report.numberOfLoops; ++index) {
+    auto const &loop = m_report.loops[index];
+
+    auto const minimumFrequency_InHertz = static_cast<uint64_t>(loop.expectedFrequency_InHertz) * m_thresholds.minimumLoopFrequency_InPercentage / 100;
+    if (loop.frequency_InHertz < minimumFrequency_InHertz) {
+      warn(RESOURCE_WARNING_LOOP, loop.name, loop.frequency_InHertz);
+    }
+  }
+}
+
+void ResourceMonitor::logReport() const {
+  ESP_LOGI(tag, "Heap free %lu, minimum %lu", static_cast<unsigned long>(m_report.freeHeap_InBytes), static_cast<unsigned long>(m_report.minimumFreeHeap_InBytes));
+
+  for (uint32_t index = 0; index < m_report.numberOfLoops; ++index) {
+    auto const &loop = m_report.loops[index];
+    ESP_LOGI(tag, "Loop %s %lu/%lu Hz", loop.name, static_cast<unsigned long>(loop.frequency_InHertz), static_cast<unsigned long>(loop.expectedFrequency_InHertz));
+  }
+
+  for (uint32_t index = 0; index < m_report.numberOfTasks; ++index) {
+    auto const &task = m_report.tasks[index];
+    ESP_LOGD(tag, "Task %-16s cpu %3u%% stack %lu", task.name, task.cpuUsage_InPercentage, static_cast<unsigned long>(task.stackHighWaterMark_InBytes));
+  }
+}
+
+void ResourceMonitor::warn(ResourceWarning const warning, char const *name, uint32_t const value) {
+  ESP_LOGW(tag, "%s past threshold, %lu", name, static_cast<unsigned long>(value));
+
+  if (m_warningCallbackFunction) {
+    m_warningCallbackFunction(warning, name, value);
+  }
+}
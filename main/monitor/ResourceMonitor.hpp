@@ -0,0 +1,142 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+
+#include "executor/Node.hpp"
+#include "clock/SystemClock.hpp"
+#include "monitor/LoopCounter.hpp"
+
+constexpr uint32_t const resourceNameSize = 16;
+constexpr uint32_t const resourceMaximumTasks = 24;
+constexpr uint32_t const resourceMaximumLoops = 4;
+
+// Figures the platform can not measure, host threads have no stack high-water mark and no heap limit
+constexpr uint32_t const resourceUnknown = UINT32_MAX;
+
+struct TaskUsage {
+  char name[resourceNameSize];
+  uint32_t stackHighWaterMark_InBytes;
+  uint8_t cpuUsage_InPercentage;
+};
+
+struct LoopUsage {
+  char name[resourceNameSize];
+  uint32_t frequency_InHertz;
+  uint32_t expectedFrequency_InHertz;
+};
+
+struct ResourceReport {
+  uint32_t freeHeap_InBytes;
+  uint32_t minimumFreeHeap_InBytes;
+  uint32_t numberOfTasks;
+  TaskUsage tasks[resourceMaximumTasks];
+  uint32_t numberOfLoops;
+  LoopUsage loops[resourceMaximumLoops];
+};
+
+struct ResourceThresholds {
+  uint32_t minimumStack_InBytes = 512;
+  uint32_t minimumHeap_InBytes = 16 * 1024;
+  uint8_t maximumCpuUsage_InPercentage = 80;
+  uint8_t minimumLoopFrequency_InPercentage = 90;
+};
+
+enum ResourceWarning {
+  RESOURCE_WARNING_STACK,
+  RESOURCE_WARNING_HEAP,
+  RESOURCE_WARNING_CPU,
+  RESOURCE_WARNING_LOOP,
+};
+
+using ResourceReportCallbackFunction = std::function<void(ResourceReport const &)>;
+using ResourceWarningCallbackFunction = std::function<void(ResourceWarning, char const *, uint32_t)>;
+
+/**
+ * Samples stacks, heap, per task CPU share and executor loop rates.
+ * Meant to run at 1 Hz or slower, the task snapshot briefly suspends the scheduler.
+ * CPU share is relative to one core, a pinned task at 100 % saturates its core.
+ */
+class ResourceMonitor : public executor::Node {
+public:
+  explicit ResourceMonitor(ResourceThresholds const &thresholds = {}, IClockPtr clock = getSystemClock());
+  ~ResourceMonitor() override = default;
+
+public:
+  void registerReportCallback(ResourceReportCallbackFunction const &reportCallbackFunction);
+  void registerWarningCallback(ResourceWarningCallbackFunction const &warningCallbackFunction);
+
+public:
+  void addLoopCounter(LoopCounterPtr loopCounter, uint32_t expectedFrequencyInHertz);
+
+private:
+  void process() override;
+
+private:
+  struct TaskSample {
+    uint32_t id;
+    char name[resourceNameSize];
+    uint32_t runTime_InUS;
+    uint32_t stackHighWaterMark_InBytes;
+  };
+
+  struct LoopSample {
+    LoopCounterPtr loopCounter;
+    uint32_t expectedFrequency_InHertz;
+    uint32_t numberOfLoops;
+  };
+
+private:
+  static uint32_t readTasks(TaskSample *samples, uint32_t &totalRunTimeInUS);
+  static void readHeap(uint32_t &freeHeapInBytes, uint32_t &minimumFreeHeapInBytes);
+
+private:
+  void sampleTasks();
+  void sampleHeap();
+  void sampleLoops(uint64_t elapsedTimeInUS);
+  void checkThresholds();
+  void logReport() const;
+  void warn(ResourceWarning warning, char const *name, uint32_t value);
+
+private:
+  ResourceReportCallbackFunction m_reportCallbackFunction;
+  ResourceWarningCallbackFunction m_warningCallbackFunction;
+
+private:
+  ResourceThresholds const m_thresholds;
+  IClockPtr m_clock;
+
+private:
+  ResourceReport m_report;
+  uint64_t m_lastSampleTime_InUS;
+
+private:
+  bool m_isWarmedUp;
+  uint32_t m_lastTotalRunTime_InUS;
+  uint32_t m_taskSampleIndex;
+  uint32_t m_numberOfTaskSamples[2];
+  std::array<TaskSample, resourceMaximumTasks> m_taskSamples[2];
+
+private:
+  uint32_t m_numberOfLoopSamples;
+  std::array<LoopSample, resourceMaximumLoops> m_loopSamples;
+};
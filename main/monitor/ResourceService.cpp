@@ -0,0 +1,89 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include "ResourceService.hpp"
+
+#include <cstring>
+
+constexpr char const *serviceUuid = "5e3a0101-6b1c-4a6f-9a3e-7c2d0f4b8e10";
+constexpr char const *reportCharacteristicUuid = "5e3a0102-6b1c-4a6f-9a3e-7c2d0f4b8e10";
+
+constexpr std::size_t const reportMaximumSize = 512;
+constexpr std::size_t const loopRecordSize = resourceNameSize + 4 + 4;
+constexpr std::size_t const taskRecordSize = resourceNameSize + 4 + 1;
+
+static_assert(4 + 4 + 1 + loopRecordSize * resourceMaximumLoops + 1 <= reportMaximumSize, "Loops must always fit in the report");
+
+namespace {
+
+uint8_t *writeUint32(uint8_t *buffer, uint32_t const value) {
+  buffer[0] = static_cast<uint8_t>(value);
+  buffer[1] = static_cast<uint8_t>(value >> 8);
+  buffer[2] = static_cast<uint8_t>(value >> 16);
+  buffer[3] = static_cast<uint8_t>(value >> 24);
+  return buffer + 4;
+}
+
+uint8_t *writeName(uint8_t *buffer, char const *name) {
+  std::memcpy(buffer, name, resourceNameSize);
+  return buffer + resourceNameSize;
+}
+
+}// namespace
+
+ResourceService::ResourceService(NimBLEServer *server) : m_reportCharacteristic(nullptr) {
+  auto const service = server->createService(serviceUuid);
+
+  m_reportCharacteristic = service->createCharacteristic(reportCharacteristicUuid, NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::NOTIFY);
+
+  service->start();
+}
+
+void ResourceService::publish(ResourceReport const &report) {
+  uint8_t buffer[reportMaximumSize] = {0};
+  uint8_t *const end = buffer + reportMaximumSize;
+
+  auto *position = writeUint32(buffer, report.freeHeap_InBytes);
+  position = writeUint32(position, report.minimumFreeHeap_InBytes);
+
+  *position++ = static_cast<uint8_t>(report.numberOfLoops);
+  for (uint32_t index = 0; index < report.numberOfLoops; ++index) {
+    auto const &loop = report.loops[index];
+
+    position = writeName(position, loop.name);
+    position = writeUint32(position, loop.frequency_InHertz);
+    position = writeUint32(position, loop.expectedFrequency_InHertz);
+  }
+
+  auto *const numberOfTasksPosition = position++;
+
+  uint8_t numberOfTasks = 0;
+  while (numberOfTasks < report.numberOfTasks and position + taskRecordSize <= end) {
+    auto const &task = report.tasks[numberOfTasks];
+
+    position = writeName(position, task.name);
+    position = writeUint32(position, task.stackHighWaterMark_InBytes);
+    *position++ = task.cpuUsage_InPercentage;
+
+    numberOfTasks += 1;
+  }
+  *numberOfTasksPosition = numberOfTasks;
+
+  m_reportCharacteristic->setValue(buffer, position - buffer);
+  m_reportCharacteristic->notify();
+}
@@ -0,0 +1,44 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include "NimBLEDevice.h"
+
+#include "monitor/ResourceMonitor.hpp"
+
+/**
+ * BLE view of the resource monitor, one read and notify characteristic.
+ *
+ *   [u32 free heap][u32 minimum free heap]
+ *   [u8 number of loops] { [16 bytes name][u32 frequency][u32 expected frequency] }
+ *   [u8 number of tasks] { [16 bytes name][u32 stack high-water mark][u8 cpu %] }
+ *
+ * Tasks that do not fit in one attribute are left out. All numbers are little endian.
+ */
+class ResourceService {
+public:
+  explicit ResourceService(NimBLEServer *server);
+  ~ResourceService() = default;
+
+public:
+  void publish(ResourceReport const &report);
+
+private:
+  NimBLECharacteristic *m_reportCharacteristic;
+};
@@ -0,0 +1,96 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include "OtaImageValidator.hpp"
+
+#include <cinttypes>
+
+#include <esp_log.h>
+
+#ifdef ESP_PLATFORM
+#include <esp_ota_ops.h>
+#endif
+
+constexpr char const *tag = "ota_validator";
+
+OtaImageValidator::OtaImageValidator(OtaImageValidatorConfiguration const &configuration, IClockPtr clock) : m_configuration(configuration),
+                                                                                                         m_clock(std::move(clock)),
+                                                                                                         m_isHealthy(false),
+                                                                                                         m_isValidated(false),
+                                                                                                         m_healthyStartTime_InUS(0) {
+}
+
+bool OtaImageValidator::isValidated() const {
+  return m_isValidated;
+}
+
+void OtaImageValidator::processReport(ResourceReport const &report) {
+  if (m_isValidated) {
+    return;
+  }
+
+  if (not isHealthy(report)) {
+    m_isHealthy = false;
+    return;
+  }
+
+  auto const currentTime_InUS = m_clock->getTime_InUS();
+
+  if (not m_isHealthy) {
+    m_isHealthy = true;
+    m_healthyStartTime_InUS = currentTime_InUS;
+  }
+
+  if (currentTime_InUS - m_healthyStartTime_InUS < m_configuration.healthyTime_InUS) {
+    return;
+  }
+
+  markValid();
+}
+
+bool OtaImageValidator::isHealthy(ResourceReport const &report) const {
+  // Nothing is known about an image whose loops are not watched
+  if (report.numberOfLoops == 0) {
+    return false;
+  }
+
+  for (uint32_t index = 0; index < report.numberOfLoops; ++index) {
+    auto const &loop = report.loops[index];
+
+    if (static_cast<uint64_t>(loop.frequency_InHertz) * 100 < static_cast<uint64_t>(loop.expectedFrequency_InHertz) * m_configuration.minimumLoopFrequency_InPercentage) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void OtaImageValidator::markValid() {
+  m_isValidated = true;
+
+#ifdef ESP_PLATFORM
+  // Does nothing for an image that is not waiting for verification
+  auto const returnCode = esp_ota_mark_app_valid_cancel_rollback();
+  if (returnCode != ESP_OK) {
+    ESP_LOGE(tag, "Failed to confirm the image: %s", esp_err_to_name(returnCode));
+    return;
+  }
+#endif
+
+  ESP_LOGI(tag, "Loops ran at rate for %" PRIu32 " ms, image confirmed", m_configuration.healthyTime_InUS / 1000);
+}
@@ -0,0 +1,66 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <memory>
+#include <cstdint>
+
+#include "clock/SystemClock.hpp"
+#include "monitor/ResourceMonitor.hpp"
+
+struct OtaImageValidatorConfiguration {
+  uint32_t healthyTime_InUS = 10 * 1000000;
+  uint8_t minimumLoopFrequency_InPercentage = 90;
+};
+
+/**
+ * Confirms a freshly updated image once the control loops have run at their rate for the healthy time.
+ * Until then the bootloader rolls back to the previous image on the next reset.
+ */
+class OtaImageValidator {
+public:
+  explicit OtaImageValidator(OtaImageValidatorConfiguration const &configuration = {}, IClockPtr clock = getSystemClock());
+  ~OtaImageValidator() = default;
+
+public:
+  [[nodiscard]] bool isValidated() const;
+
+public:
+  /**
+   * Fed with every resource report, a single slow loop restarts the healthy time
+   */
+  void processReport(ResourceReport const &report);
+
+private:
+  [[nodiscard]] bool isHealthy(ResourceReport const &report) const;
+
+private:
+  void markValid();
+
+private:
+  OtaImageValidatorConfiguration const m_configuration;
+  IClockPtr m_clock;
+
+private:
+  bool m_isHealthy;
+  bool m_isValidated;
+  uint64_t m_healthyStartTime_InUS;
+};
+
+using OtaImageValidatorPtr = std::shared_ptr<OtaImageValidator>;
@@ -0,0 +1,183 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include "OtaReceiver.hpp"
+
+#include <cstring>
+
+OtaReceiver::OtaReceiver(IOtaWriterPtr writer) : m_writer(std::move(writer)),
+                                                 m_creditCallbackFunction(nullptr),
+                                                 m_stateCallbackFunction(nullptr),
+                                                 m_state(OTA_STATE_IDLE),
+                                                 m_isBeginRequested(false),
+                                                 m_isAbortRequested(false),
+                                                 m_chunks(),
+                                                 m_imageSize(0),
+                                                 m_imageHash(),
+                                                 m_expectedSequence(0),
+                                                 m_receivedSize(0),
+                                                 m_writtenSize(0),
+                                                 m_hashContext() {
+  mbedtls_sha256_init(&m_hashContext);
+}
+
+OtaReceiver::~OtaReceiver() {
+  mbedtls_sha256_free(&m_hashContext);
+}
+
+void OtaReceiver::registerCreditCallback(OtaCreditCallbackFunction const &creditCallbackFunction) {
+  m_creditCallbackFunction = creditCallbackFunction;
+}
+
+void OtaReceiver::registerStateCallback(OtaStateCallbackFunction const &stateCallbackFunction) {
+  m_stateCallbackFunction = stateCallbackFunction;
+}
+
+OtaState OtaReceiver::getState() const {
+  return m_state.load();
+}
+
+bool OtaReceiver::begin(uint32_t const imageSize, OtaHash const &imageHash) {
+  if (m_state.load() == OTA_STATE_RECEIVING or m_isBeginRequested.load()) {
+    return false;
+  }
+
+  m_imageSize = imageSize;
+  m_imageHash = imageHash;
+  m_expectedSequence = 0;
+  m_receivedSize = 0;
+
+  m_isBeginRequested.store(true);
+
+  return true;
+}
+
+bool OtaReceiver::receive(uint16_t const sequence, uint8_t const *data, std::size_t const size) {
+  if (m_state.load() != OTA_STATE_RECEIVING) {
+    return false;
+  }
+
+  if (sequence != m_expectedSequence or size == 0 or size > otaChunkMaxSize or m_receivedSize + size > m_imageSize) {
+    abort();
+    return false;
+  }
+
+  Chunk chunk = {};
+  chunk.size = static_cast<uint16_t>(size);
+  std::memcpy(chunk.data.data(), data, size);
+
+  // The sender ran out of credits, the chunk can not be kept
+  if (not m_chunks.push(chunk)) {
+    abort();
+    return false;
+  }
+
+  m_expectedSequence += 1;
+  m_receivedSize += size;
+
+  return true;
+}
+
+void OtaReceiver::abort() {
+  m_isAbortRequested.store(true);
+}
+
+void OtaReceiver::process() {
+  Chunk chunk = {};
+
+  if (m_isAbortRequested.exchange(false)) {
+    if (m_state.load() == OTA_STATE_RECEIVING) {
+      fail();
+    }
+  }
+
+  if (m_isBeginRequested.load()) {
+    while (m_chunks.pop(chunk)) {
+    }
+
+    m_writtenSize = 0;
+    mbedtls_sha256_starts(&m_hashContext, 0);
+
+    auto const isStarted = m_writer->begin(m_imageSize);
+
+    m_state.store(isStarted ? OTA_STATE_RECEIVING : OTA_STATE_FAILED);
+    m_isBeginRequested.store(false);
+
+    if (m_stateCallbackFunction) {
+      m_stateCallbackFunction(m_state.load());
+    }
+
+    if (isStarted and m_creditCallbackFunction) {
+      m_creditCallbackFunction(otaChunkQueueSize);
+    }
+  }
+
+  if (m_state.load() != OTA_STATE_RECEIVING) {
+    return;
+  }
+
+  uint16_t credits = 0;
+
+  while (m_chunks.pop(chunk)) {
+    mbedtls_sha256_update(&m_hashContext, chunk.data.data(), chunk.size);
+
+    if (not m_writer->write(chunk.data.data(), chunk.size)) {
+      return fail();
+    }
+
+    m_writtenSize += chunk.size;
+    credits += 1;
+  }
+
+  if (m_writtenSize >= m_imageSize) {
+    return finish();
+  }
+
+  if (credits > 0 and m_creditCallbackFunction) {
+    m_creditCallbackFunction(credits);
+  }
+}
+
+void OtaReceiver::finish() {
+  OtaHash hash = {};
+  mbedtls_sha256_finish(&m_hashContext, hash.data());
+
+  if (hash != m_imageHash) {
+    return fail();
+  }
+
+  if (not m_writer->end()) {
+    m_state.store(OTA_STATE_FAILED);
+  } else {
+    m_state.store(OTA_STATE_DONE);
+  }
+
+  if (m_stateCallbackFunction) {
+    m_stateCallbackFunction(m_state.load());
+  }
+}
+
+void OtaReceiver::fail() {
+  m_writer->abort();
+
+  m_state.store(OTA_STATE_FAILED);
+
+  if (m_stateCallbackFunction) {
+    m_stateCallbackFunction(m_state.load());
+  }
+}
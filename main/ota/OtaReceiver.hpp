@@ -0,0 +1,101 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <array>
+#include <functional>
+
+#include <mbedtls/sha256.h>
+
+#include "ota/interface/IOtaWriter.hpp"
+#include "runtime/RingBuffer.hpp"
+
+constexpr std::size_t const otaChunkMaxSize = 512;
+constexpr std::size_t const otaChunkQueueSize = 16;
+constexpr std::size_t const otaHashSize = 32;
+
+enum OtaState {
+  OTA_STATE_IDLE = 0,
+  OTA_STATE_RECEIVING,
+  OTA_STATE_DONE,
+  OTA_STATE_FAILED
+};
+
+using OtaHash = std::array<uint8_t, otaHashSize>;
+using OtaCreditCallbackFunction = std::function<void(uint16_t)>;
+using OtaStateCallbackFunction = std::function<void(OtaState)>;
+
+/**
+ * Reassembles a firmware image streamed as numbered chunks.
+ *
+ * The transport side calls begin(), receive() and abort(), it only checks the order and queues chunks.
+ * The writer side calls process() from its own task, hashes and writes the queued chunks and returns credits.
+ * The sender may have at most as many chunks in flight as it holds credits.
+ */
+class OtaReceiver {
+public:
+  explicit OtaReceiver(IOtaWriterPtr writer);
+  ~OtaReceiver();
+
+public:
+  void registerCreditCallback(OtaCreditCallbackFunction const &creditCallbackFunction);
+  void registerStateCallback(OtaStateCallbackFunction const &stateCallbackFunction);
+
+public:
+  [[nodiscard]] OtaState getState() const;
+
+public:
+  bool begin(uint32_t imageSize, OtaHash const &imageHash);
+  bool receive(uint16_t sequence, uint8_t const *data, std::size_t size);
+  void abort();
+
+public:
+  void process();
+
+private:
+  void finish();
+  void fail();
+
+private:
+  struct Chunk {
+    uint16_t size;
+    std::array<uint8_t, otaChunkMaxSize> data;
+  };
+
+private:
+  IOtaWriterPtr m_writer;
+  OtaCreditCallbackFunction m_creditCallbackFunction;
+  OtaStateCallbackFunction m_stateCallbackFunction;
+
+private:
+  std::atomic<OtaState> m_state;
+  std::atomic<bool> m_isBeginRequested;
+  std::atomic<bool> m_isAbortRequested;
+  RingBuffer<Chunk, otaChunkQueueSize> m_chunks;
+
+private:
+  uint32_t m_imageSize;
+  OtaHash m_imageHash;
+  uint16_t m_expectedSequence;
+  uint32_t m_receivedSize;
+
+private:
+  uint32_t m_writtenSize;
+  mbedtls_sha256_context m_hashContext;
+};
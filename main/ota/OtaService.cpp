@@ -0,0 +1,170 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include "OtaService.hpp"
+
+#include <thread>
+#include <cstring>
+#include <esp_log.h>
+#include <esp_system.h>
+
+#include "ota/OtaWriter.hpp"
+#include "runtime/Task.hpp"
+
+constexpr char const *tag = "ota_service";
+
+constexpr char const *serviceUuid = "5e3a0001-6b1c-4a6f-9a3e-7c2d0f4b8e10";
+constexpr char const *controlCharacteristicUuid = "5e3a0002-6b1c-4a6f-9a3e-7c2d0f4b8e10";
+constexpr char const *dataCharacteristicUuid = "5e3a0003-6b1c-4a6f-9a3e-7c2d0f4b8e10";
+
+constexpr uint8_t const commandBegin = 0x01;
+constexpr uint8_t const commandAbort = 0x02;
+constexpr uint8_t const notificationCredits = 0x10;
+constexpr uint8_t const notificationState = 0x11;
+
+constexpr uint32_t const writerTaskPriority = 2;
+constexpr uint32_t const writerTaskStackSize = 6144;
+constexpr auto const writerTaskPeriod = std::chrono::milliseconds(2);
+constexpr auto const restartDelay = std::chrono::milliseconds(500);
+
+OtaService::OtaService(NimBLEServer *server) : m_updatePermissionCallbackFunction(nullptr),
+                                               m_receiver(std::make_unique<OtaReceiver>(std::make_unique<OtaWriter>())),
+                                               m_controlCharacteristic(nullptr),
+                                               m_dataCharacteristic(nullptr) {
+  auto const service = server->createService(serviceUuid);
+
+  m_controlCharacteristic = service->createCharacteristic(controlCharacteristicUuid, NIMBLE_PROPERTY::WRITE | NIMBLE_PROPERTY::NOTIFY);
+  m_controlCharacteristic->setCallbacks(this);
+
+  m_dataCharacteristic = service->createCharacteristic(dataCharacteristicUuid, NIMBLE_PROPERTY::WRITE_NR);
+  m_dataCharacteristic->setCallbacks(this);
+
+  service->start();
+
+  NimBLEDevice::getAdvertising()->addServiceUUID(serviceUuid);
+
+  m_receiver->registerCreditCallback([this](uint16_t const credits) { notifyCredits(credits); });
+  m_receiver->registerStateCallback([this](OtaState const state) { notifyState(state); });
+
+  // Flash writes run in their own low priority task, the BLE host and the control loop never wait for them
+  runtime::startPinnedTask("ota", runtime::controlCore, writerTaskPriority, writerTaskStackSize, [this]() { processUpdate(); });
+}
+
+void OtaService::registerUpdatePermissionCallback(OtaUpdatePermissionCallbackFunction const &updatePermissionCallbackFunction) {
+  m_updatePermissionCallbackFunction = updatePermissionCallbackFunction;
+}
+
+void OtaService::onWrite(NimBLECharacteristic *characteristic, [[maybe_unused]] NimBLEConnInfo &connectionInfo) {
+  auto const value = characteristic->getValue();
+
+  if (characteristic == m_dataCharacteristic) {
+    return processData(value.data(), value.size());
+  }
+
+  if (characteristic == m_controlCharacteristic) {
+    return processControl(value.data(), value.size());
+  }
+}
+
+void OtaService::processControl(uint8_t const *data, std::size_t const size) {
+  if (size < 1) {
+    return;
+  }
+
+  if (data[0] == commandBegin and size == 1 + sizeof(uint32_t) + otaHashSize) {
+    uint32_t imageSize = 0;
+    std::memcpy(&imageSize, &data[1], sizeof(imageSize));
+
+    OtaHash imageHash = {};
+    std::memcpy(imageHash.data(), &data[1 + sizeof(uint32_t)], otaHashSize);
+
+    if (not isUpdatePermitted()) {
+      ESP_LOGW(tag, "Update refused, the vehicle is not parked");
+      return notifyState(OTA_STATE_FAILED);
+    }
+
+    if (not m_receiver->begin(imageSize, imageHash)) {
+      ESP_LOGW(tag, "Update already in progress");
+    }
+    return;
+  }
+
+  if (data[0] == commandAbort) {
+    m_receiver->abort();
+    return;
+  }
+
+  ESP_LOGW(tag, "Unknown command 0x%02x", data[0]);
+}
+
+void OtaService::processData(uint8_t const *data, std::size_t const size) {
+  if (size <= sizeof(uint16_t)) {
+    return;
+  }
+
+  uint16_t sequence = 0;
+  std::memcpy(&sequence, data, sizeof(sequence));
+
+  m_receiver->receive(sequence, &data[sizeof(uint16_t)], size - sizeof(uint16_t));
+}
+
+void OtaService::processUpdate() {
+  while (true) {
+    // Every flash write suspends the caches and with them the control and motion code running from flash.
+    // Once the vehicle moves the queued chunks wait, credits are not returned and the sender holds off.
+    if (isUpdatePermitted()) {
+      m_receiver->process();
+    }
+
+    // A restart drops the throttle control, it only happens with the vehicle parked
+    if (m_receiver->getState() == OTA_STATE_DONE and isUpdatePermitted()) {
+      // Lets the state notification go out, the vehicle has to be still parked afterwards
+      std::this_thread::sleep_for(restartDelay);
+
+      if (isUpdatePermitted()) {
+        ESP_LOGI(tag, "Vehicle parked, restarting into the new image");
+        esp_restart();
+      }
+    }
+
+    std::this_thread::sleep_for(writerTaskPeriod);
+  }
+}
+
+bool OtaService::isUpdatePermitted() const {
+  if (not m_updatePermissionCallbackFunction) {
+    return false;
+  }
+
+  return m_updatePermissionCallbackFunction();
+}
+
+void OtaService::notifyCredits(uint16_t const credits) {
+  uint8_t notification[1 + sizeof(uint16_t)] = {notificationCredits};
+  std::memcpy(&notification[1], &credits, sizeof(credits));
+
+  m_controlCharacteristic->notify(notification, sizeof(notification));
+}
+
+void OtaService::notifyState(OtaState const state) {
+  uint8_t const notification[2] = {notificationState, static_cast<uint8_t>(state)};
+
+  m_controlCharacteristic->notify(notification, sizeof(notification));
+
+  ESP_LOGI(tag, "Update state %d", state);
+}
@@ -0,0 +1,81 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <memory>
+#include <functional>
+
+#include "NimBLEDevice.h"
+
+#include "ota/OtaReceiver.hpp"
+
+/**
+ * BLE firmware update service.
+ *
+ * Control characteristic, write and notify:
+ *   0x01 begin   [u32 image size][32 bytes SHA-256 of the image]
+ *   0x02 abort
+ *   0x10 credits [u16 number of chunks the client may send], notification
+ *   0x11 state   [u8 OtaState], notification
+ *
+ * Data characteristic, write without response:
+ *   [u16 sequence][up to 512 bytes of the image]
+ *
+ * All numbers are little endian.
+ */
+using OtaUpdatePermissionCallbackFunction = std::function<bool()>;
+
+class OtaService : public NimBLECharacteristicCallbacks {
+public:
+  explicit OtaService(NimBLEServer *server);
+  ~OtaService() override = default;
+
+public:
+  /**
+   * Asked before an update begins, before every flash write and before the restart into the new image.
+   * Flash writes stall the caches of both cores, so the whole update only runs with the vehicle parked.
+   * While it returns false the writes pause and the sender waits for credits. Without a callback no update is accepted.
+   */
+  void registerUpdatePermissionCallback(OtaUpdatePermissionCallbackFunction const &updatePermissionCallbackFunction);
+
+private:
+  void onWrite(NimBLECharacteristic *characteristic, NimBLEConnInfo &connectionInfo) override;
+
+private:
+  void processControl(uint8_t const *data, std::size_t size);
+  void processData(uint8_t const *data, std::size_t size);
+  void processUpdate();
+
+private:
+  [[nodiscard]] bool isUpdatePermitted() const;
+
+private:
+  void notifyCredits(uint16_t credits);
+  void notifyState(OtaState state);
+
+private:
+  OtaUpdatePermissionCallbackFunction m_updatePermissionCallbackFunction;
+
+private:
+  std::unique_ptr<OtaReceiver> m_receiver;
+
+private:
+  NimBLECharacteristic *m_controlCharacteristic;
+  NimBLECharacteristic *m_dataCharacteristic;
+};
@@ -0,0 +1,107 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include "OtaWriter.hpp"
+
+#include <cinttypes>
+
+#include <esp_log.h>
+
+constexpr char const *tag = "ota_writer";
+
+OtaWriter::OtaWriter() : m_partition(nullptr),
+                         m_handle(0) {
+}
+
+OtaWriter::~OtaWriter() {
+  OtaWriter::abort();
+}
+
+bool OtaWriter::begin(uint32_t const imageSize) {
+  abort();
+
+  m_partition = esp_ota_get_next_update_partition(nullptr);
+  if (m_partition == nullptr) {
+    ESP_LOGE(tag, "No OTA partition available");
+    return false;
+  }
+
+  if (imageSize > m_partition->size) {
+    ESP_LOGE(tag, "Image of %" PRIu32 " bytes does not fit into %s", imageSize, m_partition->label);
+    return false;
+  }
+
+  // Sectors are erased one at a time as the writes reach them, erasing the whole partition up front stalls both cores
+  auto const returnCode = esp_ota_begin(m_partition, OTA_WITH_SEQUENTIAL_WRITES, &m_handle);
+  if (returnCode != ESP_OK) {
+    ESP_LOGE(tag, "Failed to begin update: %s", esp_err_to_name(returnCode));
+    m_handle = 0;
+    return false;
+  }
+
+  ESP_LOGI(tag, "Writing %" PRIu32 " bytes to %s", imageSize, m_partition->label);
+
+  return true;
+}
+
+bool OtaWriter::write(uint8_t const *data, std::size_t const size) {
+  if (m_handle == 0) {
+    return false;
+  }
+
+  auto const returnCode = esp_ota_write(m_handle, data, size);
+  if (returnCode != ESP_OK) {
+    ESP_LOGE(tag, "Failed to write: %s", esp_err_to_name(returnCode));
+    return false;
+  }
+
+  return true;
+}
+
+bool OtaWriter::end() {
+  if (m_handle == 0) {
+    return false;
+  }
+
+  auto returnCode = esp_ota_end(m_handle);
+  m_handle = 0;
+
+  if (returnCode != ESP_OK) {
+    ESP_LOGE(tag, "Image validation failed: %s", esp_err_to_name(returnCode));
+    return false;
+  }
+
+  returnCode = esp_ota_set_boot_partition(m_partition);
+  if (returnCode != ESP_OK) {
+    ESP_LOGE(tag, "Failed to select boot partition: %s", esp_err_to_name(returnCode));
+    return false;
+  }
+
+  ESP_LOGI(tag, "Update written, %s selected for the next boot", m_partition->label);
+
+  return true;
+}
+
+void OtaWriter::abort() {
+  if (m_handle == 0) {
+    return;
+  }
+
+  esp_ota_abort(m_handle);
+  m_handle = 0;
+}
@@ -0,0 +1,42 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <esp_ota_ops.h>
+
+#include "ota/interface/IOtaWriter.hpp"
+
+/**
+ * Writes the image into the next OTA partition
+ */
+class OtaWriter : public IOtaWriter {
+public:
+  OtaWriter();
+  ~OtaWriter() override;
+
+public:
+  bool begin(uint32_t imageSize) override;
+  bool write(uint8_t const *data, std::size_t size) override;
+  bool end() override;
+  void abort() override;
+
+private:
+  esp_partition_t const *m_partition;
+  esp_ota_handle_t m_handle;
+};
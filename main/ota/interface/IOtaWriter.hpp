@@ -0,0 +1,43 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Destination of a firmware image, the inactive OTA partition on the device
+ */
+class IOtaWriter {
+public:
+  virtual ~IOtaWriter() = default;
+
+public:
+  virtual bool begin(uint32_t imageSize) = 0;
+  virtual bool write(uint8_t const *data, std::size_t size) = 0;
+
+  /**
+   * Validate the written image and select it for the next boot
+   */
+  virtual bool end() = 0;
+  virtual void abort() = 0;
+};
+
+using IOtaWriterPtr = std::unique_ptr<IOtaWriter>;
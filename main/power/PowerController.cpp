@@ -0,0 +1,195 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include "PowerController.hpp"
+
+#include "log/DeferredLog.hpp"
+
+#ifdef ESP_PLATFORM
+#include <esp_sleep.h>
+#include <driver/gpio.h>
+#endif
+
+PowerController::PowerController(uint32_t const pollPeriodInUS, IClockPtr clock) : m_parkCallbackFunction(nullptr),
+                                                                                   m_wakeCallbackFunction(nullptr),
+                                                                                   m_pedalPollFunction(nullptr),
+                                                                                   m_parkPermissionCallbackFunction(nullptr),
+                                                                                   m_pollPeriod_InUS(pollPeriodInUS),
+                                                                                   m_wakeButtonPinNumbers(),
+                                                                                   m_numberOfWakeButtons(0),
+                                                                                   m_clock(std::move(clock)),
+                                                                                   m_powerManager(),
+                                                                                   m_state(POWER_STATE_ACTIVE),
+                                                                                   m_vehicleRevolutions_InRevolutionsPerMinute(0) {
+  m_powerManager.notifyActivity(m_clock->getTime_InUS());
+}
+
+void PowerController::registerParkCallback(PowerParkCallbackFunction const &parkCallbackFunction) {
+  m_parkCallbackFunction = parkCallbackFunction;
+}
+
+void PowerController::registerWakeCallback(PowerWakeCallbackFunction const &wakeCallbackFunction) {
+  m_wakeCallbackFunction = wakeCallbackFunction;
+}
+
+void PowerController::registerPedalPollCallback(PowerPedalPollFunction const &pedalPollFunction) {
+  m_pedalPollFunction = pedalPollFunction;
+}
+
+void PowerController::registerParkPermissionCallback(PowerParkPermissionCallbackFunction const &parkPermissionCallbackFunction) {
+  m_parkPermissionCallbackFunction = parkPermissionCallbackFunction;
+}
+
+void PowerController::setPolicy(PowerPolicy const &policy) {
+  m_powerManager.setPolicy(policy);
+}
+
+void PowerController::addWakeButton(uint8_t const pinNumber) {
+  if (m_numberOfWakeButtons >= powerMaximalWakeButtons) {
+    return;
+  }
+
+  m_wakeButtonPinNumbers[m_numberOfWakeButtons] = pinNumber;
+  m_numberOfWakeButtons += 1;
+}
+
+PowerState PowerController::getState() const {
+  return m_state;
+}
+
+uint32_t PowerController::getWakeLatency_InUS() const {
+  return m_powerManager.getWakeLatency_InUS();
+}
+
+uint32_t PowerController::getMaximalWakeLatency_InUS() const {
+  return m_powerManager.getMaximalWakeLatency_InUS();
+}
+
+uint32_t PowerController::getNumberOfLateWakes() const {
+  return m_powerManager.getNumberOfLateWakes();
+}
+
+void PowerController::setVehicleRPM(uint32_t const revolutionPerMinute) {
+  m_vehicleRevolutions_InRevolutionsPerMinute = revolutionPerMinute;
+}
+
+void PowerController::notifyPedalActivity() {
+  auto const time_InUS = m_clock->getTime_InUS();
+
+  m_powerManager.notifyActivity(time_InUS);
+  m_powerManager.requestWake(time_InUS, WAKE_SOURCE_PEDAL);
+  applyState();
+}
+
+void PowerController::notifyButton() {
+  auto const time_InUS = m_clock->getTime_InUS();
+
+  m_powerManager.notifyActivity(time_InUS);
+  m_powerManager.requestWake(time_InUS, WAKE_SOURCE_BUTTON);
+  applyState();
+}
+
+void PowerController::notifyCommand() {
+  if (not m_powerManager.notifyCommand(m_clock->getTime_InUS())) {
+    return;
+  }
+
+  deferredLog(LOG_POWER_CONTROLLER_WAKE_LATENCY, static_cast<int32_t>(m_powerManager.getWakeLatency_InUS()), static_cast<int32_t>(m_powerManager.getNumberOfLateWakes()));
+  applyState();
+}
+
+void PowerController::process() {
+  m_powerManager.update(m_clock->getTime_InUS(), m_vehicleRevolutions_InRevolutionsPerMinute, isParkPermitted());
+  applyState();
+
+  if (m_state != POWER_STATE_PARKED) {
+    return;
+  }
+
+  auto const sleepStartTime_InUS = m_clock->getTime_InUS();
+
+  auto const wakeSource = sleep();
+  if (wakeSource == WAKE_SOURCE_NONE) {
+    return;
+  }
+
+  // The pedal is only looked at when the poll period is over and may have moved right after the sleep started,
+  // so its latency counts from the sleep entry. A button edge ends the sleep at once.
+  auto const wakeTime_InUS = wakeSource == WAKE_SOURCE_PEDAL ? sleepStartTime_InUS : m_clock->getTime_InUS();
+
+  m_powerManager.requestWake(wakeTime_InUS, wakeSource);
+  applyState();
+}
+
+bool PowerController::isParkPermitted() const {
+  if (not m_parkPermissionCallbackFunction) {
+    return false;
+  }
+
+  return m_parkPermissionCallbackFunction();
+}
+
+WakeSource PowerController::sleep() {
+#ifdef ESP_PLATFORM
+  for (uint32_t i = 0; i < m_numberOfWakeButtons; i++) {
+    auto const pinNumber = static_cast<gpio_num_t>(m_wakeButtonPinNumbers[i]);
+    auto const wakeLevel = gpio_get_level(pinNumber) ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL;
+
+    ESP_ERROR_CHECK(gpio_wakeup_enable(pinNumber, wakeLevel));
+  }
+
+  ESP_ERROR_CHECK(esp_sleep_enable_gpio_wakeup());
+  ESP_ERROR_CHECK(esp_sleep_enable_timer_wakeup(m_pollPeriod_InUS));
+  esp_light_sleep_start();
+
+  auto const wakeupCause = esp_sleep_get_wakeup_cause();
+
+  for (uint32_t i = 0; i < m_numberOfWakeButtons; i++) {
+    ESP_ERROR_CHECK(gpio_wakeup_disable(static_cast<gpio_num_t>(m_wakeButtonPinNumbers[i])));
+  }
+
+  if (wakeupCause == ESP_SLEEP_WAKEUP_GPIO) {
+    return WAKE_SOURCE_BUTTON;
+  }
+#endif
+
+  if (m_pedalPollFunction and m_pedalPollFunction()) {
+    return WAKE_SOURCE_PEDAL;
+  }
+
+  return WAKE_SOURCE_NONE;
+}
+
+void PowerController::applyState() {
+  auto const state = m_powerManager.getState();
+  if (state == m_state) {
+    return;
+  }
+
+  if (state == POWER_STATE_PARKED and m_parkCallbackFunction) {
+    m_parkCallbackFunction();
+  }
+
+  if (state == POWER_STATE_WAKING and m_wakeCallbackFunction) {
+    m_wakeCallbackFunction(m_powerManager.getWakeSource());
+  }
+
+  m_state = state;
+
+  deferredLog(LOG_POWER_CONTROLLER_STATE, m_state, m_powerManager.getWakeSource());
+}
@@ -0,0 +1,113 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <array>
+#include <functional>
+
+#include "executor/Node.hpp"
+#include "clock/SystemClock.hpp"
+#include "power/PowerManager.hpp"
+
+constexpr uint32_t const powerMaximalWakeButtons = 4;
+
+using PowerParkCallbackFunction = std::function<void()>;
+using PowerWakeCallbackFunction = std::function<void(WakeSource)>;
+using PowerPedalPollFunction = std::function<bool()>;
+using PowerParkPermissionCallbackFunction = std::function<bool()>;
+
+/**
+ * Parks the unit while the engine stands and the pedal is left alone.
+ * Parked, every process() light-sleeps the SoC for one poll period, wakes early on a button edge
+ * and otherwise asks the pedal poll whether the pedal moved. The owner stops and restarts peripherals in the callbacks.
+ */
+class PowerController : public executor::Node {
+public:
+  explicit PowerController(uint32_t pollPeriodInUS = 50 * 1000, IClockPtr clock = getSystemClock());
+  ~PowerController() override = default;
+
+public:
+  void registerParkCallback(PowerParkCallbackFunction const &parkCallbackFunction);
+  void registerWakeCallback(PowerWakeCallbackFunction const &wakeCallbackFunction);
+  void registerPedalPollCallback(PowerPedalPollFunction const &pedalPollFunction);
+
+  /**
+   * Asked before parking, true once the pedal is released and the throttle is closed.
+   * The driver sleeps when parked, so without a callback the unit never parks.
+   */
+  void registerParkPermissionCallback(PowerParkPermissionCallbackFunction const &parkPermissionCallbackFunction);
+
+public:
+  void setPolicy(PowerPolicy const &policy);
+
+  /**
+   * Wake on any level change of the pin, the level at the moment of parking is taken as idle
+   */
+  void addWakeButton(uint8_t pinNumber);
+
+public:
+  [[nodiscard]] PowerState getState() const;
+  [[nodiscard]] uint32_t getWakeLatency_InUS() const;
+  [[nodiscard]] uint32_t getMaximalWakeLatency_InUS() const;
+  [[nodiscard]] uint32_t getNumberOfLateWakes() const;
+
+public:
+  void setVehicleRPM(uint32_t revolutionPerMinute);
+
+public:
+  void notifyPedalActivity();
+  void notifyButton();
+
+  /**
+   * Called with every motor command, the first one after a wake closes the latency measurement.
+   * A pedal wake is measured from the start of the sleep it was found after, any other from the wake request.
+   */
+  void notifyCommand();
+
+private:
+  void process() override;
+
+private:
+  [[nodiscard]] bool isParkPermitted() const;
+  [[nodiscard]] WakeSource sleep();
+
+private:
+  void applyState();
+
+private:
+  PowerParkCallbackFunction m_parkCallbackFunction;
+  PowerWakeCallbackFunction m_wakeCallbackFunction;
+  PowerPedalPollFunction m_pedalPollFunction;
+  PowerParkPermissionCallbackFunction m_parkPermissionCallbackFunction;
+
+private:
+  uint32_t const m_pollPeriod_InUS;
+  std::array<uint8_t, powerMaximalWakeButtons> m_wakeButtonPinNumbers;
+  uint32_t m_numberOfWakeButtons;
+
+private:
+  IClockPtr m_clock;
+  PowerManager m_powerManager;
+  PowerState m_state;
+
+private:
+  uint32_t m_vehicleRevolutions_InRevolutionsPerMinute;
+};
+
+using PowerControllerPtr = std::shared_ptr<PowerController>;
@@ -0,0 +1,114 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include "PowerManager.hpp"
+
+PowerManager::PowerManager(PowerPolicy const &policy) : m_policy(policy),
+                                                        m_state(POWER_STATE_ACTIVE),
+                                                        m_wakeSource(WAKE_SOURCE_NONE),
+                                                        m_lastActivityTime_InUS(0),
+                                                        m_wakeStartTime_InUS(0),
+                                                        m_wakeLatency_InUS(0),
+                                                        m_maximalWakeLatency_InUS(0),
+                                                        m_numberOfLateWakes(0) {
+}
+
+void PowerManager::setPolicy(PowerPolicy const &policy) {
+  m_policy = policy;
+}
+
+PowerState PowerManager::getState() const {
+  return m_state;
+}
+
+WakeSource PowerManager::getWakeSource() const {
+  return m_wakeSource;
+}
+
+uint32_t PowerManager::getWakeLatency_InUS() const {
+  return m_wakeLatency_InUS;
+}
+
+uint32_t PowerManager::getMaximalWakeLatency_InUS() const {
+  return m_maximalWakeLatency_InUS;
+}
+
+uint32_t PowerManager::getNumberOfLateWakes() const {
+  return m_numberOfLateWakes;
+}
+
+void PowerManager::notifyActivity(uint64_t const timeInUS) {
+  m_lastActivityTime_InUS = timeInUS;
+}
+
+bool PowerManager::notifyCommand(uint64_t const timeInUS) {
+  m_lastActivityTime_InUS = timeInUS;
+
+  if (m_state != POWER_STATE_WAKING) {
+    return false;
+  }
+
+  m_state = POWER_STATE_ACTIVE;
+  m_wakeLatency_InUS = static_cast<uint32_t>(timeInUS - m_wakeStartTime_InUS);
+
+  if (m_wakeLatency_InUS > m_maximalWakeLatency_InUS) {
+    m_maximalWakeLatency_InUS = m_wakeLatency_InUS;
+  }
+
+  if (m_wakeLatency_InUS > m_policy.maximalWakeLatency_InUS) {
+    m_numberOfLateWakes += 1;
+  }
+
+  return true;
+}
+
+void PowerManager::requestWake(uint64_t const timeInUS, WakeSource const wakeSource) {
+  m_lastActivityTime_InUS = timeInUS;
+
+  if (m_state != POWER_STATE_PARKED) {
+    return;
+  }
+
+  m_state = POWER_STATE_WAKING;
+  m_wakeSource = wakeSource;
+  m_wakeStartTime_InUS = timeInUS;
+}
+
+void PowerManager::update(uint64_t const timeInUS, uint32_t const revolutionPerMinute, bool const isAtRest) {
+  if (revolutionPerMinute > 0) {
+    requestWake(timeInUS, WAKE_SOURCE_ENGINE);
+  }
+
+  // A wake that needs no motor move, e.g. a button, is over without a latency sample
+  if (m_state == POWER_STATE_WAKING) {
+    if (timeInUS - m_wakeStartTime_InUS < m_policy.wakeTimeout_InUS) {
+      return;
+    }
+
+    m_state = POWER_STATE_ACTIVE;
+  }
+
+  if (m_state != POWER_STATE_ACTIVE or revolutionPerMinute > 0 or not isAtRest) {
+    return;
+  }
+
+  if (timeInUS - m_lastActivityTime_InUS >= m_policy.parkDelay_InUS) {
+    m_state = POWER_STATE_PARKED;
+    m_wakeSource = WAKE_SOURCE_NONE;
+  }
+}
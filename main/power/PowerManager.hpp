@@ -0,0 +1,101 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <cstdint>
+
+enum PowerState {
+  POWER_STATE_ACTIVE = 0,
+  POWER_STATE_PARKED,
+  POWER_STATE_WAKING
+};
+
+enum WakeSource {
+  WAKE_SOURCE_NONE = 0,
+  WAKE_SOURCE_PEDAL,
+  WAKE_SOURCE_BUTTON,
+  WAKE_SOURCE_ENGINE
+};
+
+struct PowerPolicy {
+  uint32_t parkDelay_InUS = 30 * 1000000;
+  // A pedal wake counts from the sleep entry, the bound holds one poll period of the controller and the way to the first command
+  uint32_t maximalWakeLatency_InUS = 60 * 1000;
+  uint32_t wakeTimeout_InUS = 1000 * 1000;
+};
+
+/**
+ * Decides when the unit parks and measures how long it takes to command the motor again after a wake.
+ * Parks once the engine stands, the pedal was idle for the park delay and the owner reports the throttle at rest,
+ * knows nothing about sleep or peripherals.
+ */
+class PowerManager {
+public:
+  explicit PowerManager(PowerPolicy const &policy = {});
+  ~PowerManager() = default;
+
+public:
+  void setPolicy(PowerPolicy const &policy);
+
+public:
+  [[nodiscard]] PowerState getState() const;
+  [[nodiscard]] WakeSource getWakeSource() const;
+
+public:
+  /**
+   * Time from the last wake to the first motor command, zero until one was issued
+   */
+  [[nodiscard]] uint32_t getWakeLatency_InUS() const;
+  [[nodiscard]] uint32_t getMaximalWakeLatency_InUS() const;
+
+  /**
+   * Wakes whose first command came later than the policy allows
+   */
+  [[nodiscard]] uint32_t getNumberOfLateWakes() const;
+
+public:
+  void notifyActivity(uint64_t timeInUS);
+
+  /**
+   * @return True when the command completed a wake
+   */
+  bool notifyCommand(uint64_t timeInUS);
+
+public:
+  void requestWake(uint64_t timeInUS, WakeSource wakeSource);
+
+  /**
+   * @param isAtRest Pedal released and throttle closed, parking never starts without it
+   */
+  void update(uint64_t timeInUS, uint32_t revolutionPerMinute, bool isAtRest);
+
+private:
+  PowerPolicy m_policy;
+
+private:
+  PowerState m_state;
+  WakeSource m_wakeSource;
+  uint64_t m_lastActivityTime_InUS;
+  uint64_t m_wakeStartTime_InUS;
+
+private:
+  uint32_t m_wakeLatency_InUS;
+  uint32_t m_maximalWakeLatency_InUS;
+  uint32_t m_numberOfLateWakes;
+};
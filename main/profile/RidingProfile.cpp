@@ -0,0 +1,75 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include "RidingProfile.hpp"
+
+constexpr uint32_t const weightOne = 256;
+constexpr uint32_t const throttleMapStep_InPercentage = 100 / (throttleMapSize - 1);
+
+namespace {
+
+uint32_t blend(uint32_t const from, uint32_t const to, uint32_t const weightQ8) {
+  return (from * (weightOne - weightQ8) + to * weightQ8) / weightOne;
+}
+
+float blend(float const from, float const to, uint32_t const weightQ8) {
+  return from + (to - from) * static_cast<float>(weightQ8) / weightOne;
+}
+
+}// namespace
+
+RidingProfile ridingProfileBlend(RidingProfile const &from, RidingProfile const &to, uint32_t const weightQ8) {
+  if (weightQ8 >= weightOne) {
+    return to;
+  }
+
+  RidingProfile result = {};
+
+  for (uint32_t index = 0; index < throttleMapSize; ++index) {
+    result.throttleMap_InPercentage[index] = static_cast<uint8_t>(blend(uint32_t{from.throttleMap_InPercentage[index]}, uint32_t{to.throttleMap_InPercentage[index]}, weightQ8));
+  }
+
+  result.filterMinCutoff_InMilliHertz = blend(from.filterMinCutoff_InMilliHertz, to.filterMinCutoff_InMilliHertz, weightQ8);
+  result.filterBeta = blend(from.filterBeta, to.filterBeta, weightQ8);
+
+  result.motorSpeed_InStepsPerSecond = blend(from.motorSpeed_InStepsPerSecond, to.motorSpeed_InStepsPerSecond, weightQ8);
+  result.motorAcceleration_InStepsPerSecondPerSecond = blend(from.motorAcceleration_InStepsPerSecondPerSecond, to.motorAcceleration_InStepsPerSecondPerSecond, weightQ8);
+  result.motorDeceleration_InStepsPerSecondPerSecond = blend(from.motorDeceleration_InStepsPerSecondPerSecond, to.motorDeceleration_InStepsPerSecondPerSecond, weightQ8);
+
+  result.revolutionLimit_InRPM = blend(from.revolutionLimit_InRPM, to.revolutionLimit_InRPM, weightQ8);
+  result.cruiseMinimalRevolutions_InRPM = blend(from.cruiseMinimalRevolutions_InRPM, to.cruiseMinimalRevolutions_InRPM, weightQ8);
+  result.cruiseMaximalRevolutions_InRPM = blend(from.cruiseMaximalRevolutions_InRPM, to.cruiseMaximalRevolutions_InRPM, weightQ8);
+  result.cruiseStep_InPercentage = blend(from.cruiseStep_InPercentage, to.cruiseStep_InPercentage, weightQ8);
+
+  return result;
+}
+
+uint32_t ridingProfileMapThrottle(RidingProfile const &profile, uint32_t const pedalInPercentage) {
+  if (pedalInPercentage >= 100) {
+    return profile.throttleMap_InPercentage[throttleMapSize - 1];
+  }
+
+  auto const index = pedalInPercentage / throttleMapStep_InPercentage;
+  auto const remainder = pedalInPercentage % throttleMapStep_InPercentage;
+
+  auto const lower = static_cast<uint32_t>(profile.throttleMap_InPercentage[index]);
+  auto const upper = static_cast<uint32_t>(profile.throttleMap_InPercentage[index + 1]);
+
+  // Maps may fall as well as rise
+  return (lower * (throttleMapStep_InPercentage - remainder) + upper * remainder) / throttleMapStep_InPercentage;
+}
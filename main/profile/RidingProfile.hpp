@@ -0,0 +1,103 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+constexpr uint32_t const ridingProfileCount = 3;
+constexpr uint32_t const throttleMapSize = 11;
+
+/**
+ * Everything a riding mode changes, plain values so a profile can be copied and blended freely
+ */
+struct RidingProfile {
+  // Output opening at 0, 10 .. 100 % pedal
+  std::array<uint8_t, throttleMapSize> throttleMap_InPercentage;
+
+  // Pedal filter, see AdaptiveFilter
+  uint32_t filterMinCutoff_InMilliHertz;
+  uint32_t filterBeta;
+
+  float motorSpeed_InStepsPerSecond;
+  float motorAcceleration_InStepsPerSecondPerSecond;
+  float motorDeceleration_InStepsPerSecondPerSecond;
+
+  uint32_t revolutionLimit_InRPM;
+  uint32_t cruiseMinimalRevolutions_InRPM;
+  uint32_t cruiseMaximalRevolutions_InRPM;
+  uint32_t cruiseStep_InPercentage;
+};
+
+/**
+ * Soft, road and sport, in ModeButton order
+ */
+constexpr std::array<RidingProfile, ridingProfileCount> const defaultRidingProfiles = {{
+    {
+        .throttleMap_InPercentage = {0, 4, 9, 15, 22, 30, 40, 52, 66, 82, 100},
+        .filterMinCutoff_InMilliHertz = 500,
+        .filterBeta = 10,
+        .motorSpeed_InStepsPerSecond = 450,
+        .motorAcceleration_InStepsPerSecondPerSecond = 5000,
+        .motorDeceleration_InStepsPerSecondPerSecond = 10000,
+        .revolutionLimit_InRPM = 6000,
+        .cruiseMinimalRevolutions_InRPM = 2500,
+        .cruiseMaximalRevolutions_InRPM = 6000,
+        .cruiseStep_InPercentage = 5,
+    },
+    {
+        .throttleMap_InPercentage = {0, 7, 14, 22, 31, 40, 50, 61, 73, 86, 100},
+        .filterMinCutoff_InMilliHertz = 1000,
+        .filterBeta = 20,
+        .motorSpeed_InStepsPerSecond = 750,
+        .motorAcceleration_InStepsPerSecondPerSecond = 10000,
+        .motorDeceleration_InStepsPerSecondPerSecond = 20000,
+        .revolutionLimit_InRPM = 6000,
+        .cruiseMinimalRevolutions_InRPM = 2500,
+        .cruiseMaximalRevolutions_InRPM = 6000,
+        .cruiseStep_InPercentage = 10,
+    },
+    {
+        .throttleMap_InPercentage = {0, 10, 20, 30, 40, 50, 60, 70, 80, 90, 100},
+        .filterMinCutoff_InMilliHertz = 1000,
+        .filterBeta = 40,
+        .motorSpeed_InStepsPerSecond = 1500,
+        .motorAcceleration_InStepsPerSecondPerSecond = 15000,
+        .motorDeceleration_InStepsPerSecondPerSecond = 30000,
+        .revolutionLimit_InRPM = 6000,
+        .cruiseMinimalRevolutions_InRPM = 2500,
+        .cruiseMaximalRevolutions_InRPM = 6000,
+        .cruiseStep_InPercentage = 10,
+    },
+}};
+
+/**
+ * Profile used when no selector is attached, a straight throttle map and the historic limits
+ */
+constexpr RidingProfile const defaultRidingProfile = defaultRidingProfiles[2];
+
+/**
+ * Field by field blend, weight 0 gives from and 256 gives to
+ */
+RidingProfile ridingProfileBlend(RidingProfile const &from, RidingProfile const &to, uint32_t weightQ8);
+
+/**
+ * Throttle map lookup with linear interpolation between the points
+ */
+uint32_t ridingProfileMapThrottle(RidingProfile const &profile, uint32_t pedalInPercentage);
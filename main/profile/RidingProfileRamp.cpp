@@ -0,0 +1,64 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include "RidingProfileRamp.hpp"
+
+RidingProfileRamp::RidingProfileRamp(RidingProfileSelectorPtr selector, uint32_t const rampTimeInUS) : m_selector(std::move(selector)),
+                                                                                                        m_rampTime_InUS(rampTimeInUS),
+                                                                                                        m_targetProfile(m_selector->getProfile()),
+                                                                                                        m_fromProfile(*m_targetProfile),
+                                                                                                        m_profile(*m_targetProfile),
+                                                                                                        m_isRamping(false),
+                                                                                                        m_rampStartTime_InUS(0) {
+}
+
+bool RidingProfileRamp::isRamping() const {
+  return m_isRamping;
+}
+
+RidingProfile const &RidingProfileRamp::getProfile() const {
+  return m_profile;
+}
+
+bool RidingProfileRamp::update(uint64_t const timeInUS) {
+  auto const *const profile = m_selector->getProfile();
+
+  if (profile != m_targetProfile) {
+    m_targetProfile = profile;
+    m_fromProfile = m_profile;
+    m_rampStartTime_InUS = timeInUS;
+    m_isRamping = true;
+  }
+
+  if (not m_isRamping) {
+    return false;
+  }
+
+  auto const elapsedTime_InUS = timeInUS - m_rampStartTime_InUS;
+
+  if (elapsedTime_InUS >= m_rampTime_InUS) {
+    m_profile = *m_targetProfile;
+    m_isRamping = false;
+    return true;
+  }
+
+  auto const weightQ8 = static_cast<uint32_t>(elapsedTime_InUS * 256 / m_rampTime_InUS);
+  m_profile = ridingProfileBlend(m_fromProfile, *m_targetProfile, weightQ8);
+
+  return true;
+}
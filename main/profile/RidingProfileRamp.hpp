@@ -0,0 +1,59 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <memory>
+
+#include "profile/RidingProfileSelector.hpp"
+
+/**
+ * Per consumer view of the selected profile.
+ * Reads the published pointer once per update and blends from whatever was in effect to the new profile,
+ * so a switch mid-ramp starts from the blended values and never steps.
+ */
+class RidingProfileRamp {
+public:
+  explicit RidingProfileRamp(RidingProfileSelectorPtr selector, uint32_t rampTimeInUS = 300 * 1000);
+  ~RidingProfileRamp() = default;
+
+public:
+  [[nodiscard]] bool isRamping() const;
+  [[nodiscard]] RidingProfile const &getProfile() const;
+
+public:
+  /**
+   * @return True when the profile in effect changed
+   */
+  bool update(uint64_t timeInUS);
+
+private:
+  RidingProfileSelectorPtr m_selector;
+  uint32_t const m_rampTime_InUS;
+
+private:
+  RidingProfile const *m_targetProfile;
+  RidingProfile m_fromProfile;
+  RidingProfile m_profile;
+
+private:
+  bool m_isRamping;
+  uint64_t m_rampStartTime_InUS;
+};
+
+using RidingProfileRampPtr = std::unique_ptr<RidingProfileRamp>;
@@ -0,0 +1,35 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include "RidingProfileSelector.hpp"
+
+RidingProfileSelector::RidingProfileSelector(std::array<RidingProfile, ridingProfileCount> const &profiles, uint32_t const initialProfileIndex) : m_profiles(profiles),
+                                                                                                                                                   m_profile(&m_profiles[initialProfileIndex < ridingProfileCount ? initialProfileIndex : ridingProfileCount - 1]) {
+}
+
+RidingProfile const *RidingProfileSelector::getProfile() const {
+  return m_profile.load(std::memory_order_acquire);
+}
+
+void RidingProfileSelector::select(uint32_t const profileIndex) {
+  if (profileIndex >= ridingProfileCount) {
+    return;
+  }
+
+  m_profile.store(&m_profiles[profileIndex], std::memory_order_release);
+}
@@ -0,0 +1,47 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+#include "profile/RidingProfile.hpp"
+
+/**
+ * Owns the profiles and publishes the selected one as a single pointer.
+ * The profiles never change after construction, so a reader holding an old pointer still sees a whole profile.
+ * Any task may read, one task selects.
+ */
+class RidingProfileSelector {
+public:
+  explicit RidingProfileSelector(std::array<RidingProfile, ridingProfileCount> const &profiles = defaultRidingProfiles, uint32_t initialProfileIndex = ridingProfileCount - 1);
+  ~RidingProfileSelector() = default;
+
+public:
+  [[nodiscard]] RidingProfile const *getProfile() const;
+
+public:
+  void select(uint32_t profileIndex);
+
+private:
+  std::array<RidingProfile, ridingProfileCount> const m_profiles;
+  std::atomic<RidingProfile const *> m_profile;
+};
+
+using RidingProfileSelectorPtr = std::shared_ptr<RidingProfileSelector>;
@@ -0,0 +1,79 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#ifndef ESP_PLATFORM
+
+#include <cstddef>
+#include <cstdint>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+ * Read only memory mapping of a ride log on the host
+ */
+class MappedFile {
+public:
+  explicit MappedFile(char const *path) : m_data(nullptr), m_size(0) {
+    auto const fileDescriptor = open(path, O_RDONLY);
+    if (fileDescriptor < 0) {
+      return;
+    }
+
+    struct stat fileStatus = {};
+    if (fstat(fileDescriptor, &fileStatus) == 0 and fileStatus.st_size > 0) {
+      auto *const data = mmap(nullptr, static_cast<std::size_t>(fileStatus.st_size), PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+      if (data != MAP_FAILED) {
+        madvise(data, static_cast<std::size_t>(fileStatus.st_size), MADV_SEQUENTIAL);
+
+        m_data = static_cast<uint8_t const *>(data);
+        m_size = static_cast<std::size_t>(fileStatus.st_size);
+      }
+    }
+
+    close(fileDescriptor);
+  }
+
+  ~MappedFile() {
+    if (m_data != nullptr) {
+      munmap(const_cast<uint8_t *>(m_data), m_size);
+    }
+  }
+
+  MappedFile(MappedFile const &) = delete;
+  MappedFile &operator=(MappedFile const &) = delete;
+
+public:
+  [[nodiscard]] uint8_t const *getData() const {
+    return m_data;
+  }
+
+  [[nodiscard]] std::size_t getSize() const {
+    return m_size;
+  }
+
+private:
+  uint8_t const *m_data;
+  std::size_t m_size;
+};
+
+#endif
@@ -0,0 +1,74 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Ride log stream layout.
+ *
+ * A RideLogHeader followed by records. Each record is a RideLogRecordHeader and `size` payload bytes.
+ * Time is stored as the delta to the previous record, so hours of riding fit in 32 bit fields.
+ * All fields are little endian and records are not padded, readers must not assume alignment.
+ */
+
+constexpr uint32_t const rideLogMagic = 0x4C435445;// "ETCL"
+constexpr uint16_t const rideLogVersion = 2;
+
+enum RideLogRecordType : uint8_t {
+  RIDE_LOG_RECORD_TIME = 0,
+  RIDE_LOG_RECORD_ADC_FRAME = 1,
+  RIDE_LOG_RECORD_VEHICLE = 2,
+  RIDE_LOG_RECORD_BUTTONS = 3,
+  RIDE_LOG_RECORD_OUTPUT = 4
+};
+
+#pragma pack(push, 1)
+
+struct RideLogHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t reserved;
+};
+
+struct RideLogRecordHeader {
+  uint8_t type;
+  uint8_t reserved;
+  uint16_t size;
+  uint32_t timeDelta_InUS;
+};
+
+struct RideLogVehicle {
+  uint16_t revolutionPerMinute;
+  uint8_t speed_InKilometersPerHour;
+  uint8_t clutchIsEnabled;
+};
+
+struct RideLogButtons {
+  int8_t modeButtonState;
+  uint8_t setupButtonState;
+  uint8_t launchButtonState;
+};
+
+struct RideLogOutput {
+  uint32_t command;
+  int32_t motorPosition;
+};
+
+#pragma pack(pop)
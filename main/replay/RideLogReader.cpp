@@ -0,0 +1,80 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include "RideLogReader.hpp"
+
+#include <cstring>
+
+namespace {
+
+bool checkHeader(uint8_t const *data, std::size_t const size) {
+  if (data == nullptr or size < sizeof(RideLogHeader)) {
+    return false;
+  }
+
+  RideLogHeader header = {};
+  std::memcpy(&header, data, sizeof(header));
+
+  return header.magic == rideLogMagic and header.version == rideLogVersion;
+}
+
+}// namespace
+
+RideLogReader::RideLogReader(uint8_t const *data, std::size_t const size) : m_data(data),
+                                                                            m_size(size),
+                                                                            m_isValid(checkHeader(data, size)),
+                                                                            m_offset(sizeof(RideLogHeader)),
+                                                                            m_time_InUS(0) {
+}
+
+bool RideLogReader::isValid() const {
+  return m_isValid;
+}
+
+bool RideLogReader::next(RideLogRecord &record) {
+  if (not m_isValid) {
+    return false;
+  }
+
+  if (m_offset + sizeof(RideLogRecordHeader) > m_size) {
+    return false;
+  }
+
+  RideLogRecordHeader header = {};
+  std::memcpy(&header, &m_data[m_offset], sizeof(header));
+
+  auto const payloadOffset = m_offset + sizeof(RideLogRecordHeader);
+  if (payloadOffset + header.size > m_size) {
+    return false;
+  }
+
+  m_time_InUS += header.timeDelta_InUS;
+  m_offset = payloadOffset + header.size;
+
+  record.type = static_cast<RideLogRecordType>(header.type);
+  record.time_InUS = m_time_InUS;
+  record.payload = &m_data[payloadOffset];
+  record.size = header.size;
+
+  return true;
+}
+
+void RideLogReader::rewind() {
+  m_offset = sizeof(RideLogHeader);
+  m_time_InUS = 0;
+}
@@ -0,0 +1,56 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <cstddef>
+
+#include "replay/RideLog.hpp"
+
+struct RideLogRecord {
+  RideLogRecordType type;
+  uint64_t time_InUS;
+  uint8_t const *payload;
+  uint16_t size;
+};
+
+/**
+ * Walks the records of a ride log in place, nothing is copied.
+ * Meant to run over a memory mapped file so the log never has to fit in RAM.
+ */
+class RideLogReader {
+public:
+  RideLogReader(uint8_t const *data, std::size_t size);
+  ~RideLogReader() = default;
+
+public:
+  [[nodiscard]] bool isValid() const;
+
+public:
+  bool next(RideLogRecord &record);
+  void rewind();
+
+private:
+  uint8_t const *const m_data;
+  std::size_t const m_size;
+  bool const m_isValid;
+
+private:
+  std::size_t m_offset;
+  uint64_t m_time_InUS;
+};
@@ -0,0 +1,75 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include "RideLogWriter.hpp"
+
+RideLogWriter::RideLogWriter(RideLogSinkFunction sinkFunction) : m_sinkFunction(std::move(sinkFunction)),
+                                                                 m_lastTime_InUS(0) {
+  RideLogHeader const header = {
+      .magic = rideLogMagic,
+      .version = rideLogVersion,
+      .reserved = 0,
+  };
+
+  m_sinkFunction(reinterpret_cast<uint8_t const *>(&header), sizeof(header));
+}
+
+void RideLogWriter::writeFrame(uint64_t const timeInUS, uint8_t const *frame, uint16_t const size) {
+  writeRecord(RIDE_LOG_RECORD_ADC_FRAME, timeInUS, frame, size);
+}
+
+void RideLogWriter::writeVehicle(uint64_t const timeInUS, RideLogVehicle const &vehicle) {
+  writeRecord(RIDE_LOG_RECORD_VEHICLE, timeInUS, &vehicle, sizeof(vehicle));
+}
+
+void RideLogWriter::writeButtons(uint64_t const timeInUS, RideLogButtons const &buttons) {
+  writeRecord(RIDE_LOG_RECORD_BUTTONS, timeInUS, &buttons, sizeof(buttons));
+}
+
+void RideLogWriter::writeOutput(uint64_t const timeInUS, RideLogOutput const &output) {
+  writeRecord(RIDE_LOG_RECORD_OUTPUT, timeInUS, &output, sizeof(output));
+}
+
+void RideLogWriter::writeRecord(RideLogRecordType const type, uint64_t const timeInUS, void const *payload, uint16_t const size) {
+  auto timeDelta_InUS = timeInUS - m_lastTime_InUS;
+
+  // Gaps longer than the field are split with empty records so the absolute time is never lost
+  while (timeDelta_InUS > UINT32_MAX) {
+    RideLogRecordHeader const gap = {
+        .type = RIDE_LOG_RECORD_TIME,
+        .reserved = 0,
+        .size = 0,
+        .timeDelta_InUS = UINT32_MAX,
+    };
+    m_sinkFunction(reinterpret_cast<uint8_t const *>(&gap), sizeof(gap));
+
+    timeDelta_InUS -= UINT32_MAX;
+  }
+
+  RideLogRecordHeader const header = {
+      .type = type,
+      .reserved = 0,
+      .size = size,
+      .timeDelta_InUS = static_cast<uint32_t>(timeDelta_InUS),
+  };
+
+  m_sinkFunction(reinterpret_cast<uint8_t const *>(&header), sizeof(header));
+  m_sinkFunction(static_cast<uint8_t const *>(payload), size);
+
+  m_lastTime_InUS = timeInUS;
+}
@@ -0,0 +1,49 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <functional>
+
+#include "replay/RideLog.hpp"
+
+using RideLogSinkFunction = std::function<void(uint8_t const *, std::size_t)>;
+
+/**
+ * Streams ride log records into a sink, a file on the host or a transport on the device
+ */
+class RideLogWriter {
+public:
+  explicit RideLogWriter(RideLogSinkFunction sinkFunction);
+  ~RideLogWriter() = default;
+
+public:
+  void writeFrame(uint64_t timeInUS, uint8_t const *frame, uint16_t size);
+  void writeVehicle(uint64_t timeInUS, RideLogVehicle const &vehicle);
+  void writeButtons(uint64_t timeInUS, RideLogButtons const &buttons);
+  void writeOutput(uint64_t timeInUS, RideLogOutput const &output);
+
+private:
+  void writeRecord(RideLogRecordType type, uint64_t timeInUS, void const *payload, uint16_t size);
+
+private:
+  RideLogSinkFunction m_sinkFunction;
+
+private:
+  uint64_t m_lastTime_InUS;
+};
@@ -0,0 +1,153 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include "RideReplay.hpp"
+
+#include <cstring>
+#include <algorithm>
+
+constexpr uint64_t const digestOffsetBasis = 0xcbf29ce484222325;
+constexpr uint64_t const digestPrime = 0x100000001b3;
+
+namespace {
+
+bool nextOutput(RideLogReader &reader, RideLogRecord &record) {
+  while (reader.next(record)) {
+    if (record.type == RIDE_LOG_RECORD_OUTPUT) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+}// namespace
+
+RideReplay::RideReplay(RideLogReader reader, uint32_t const tickPeriodInUS) : m_reader(reader),
+                                                                              m_tickPeriod_InUS(tickPeriodInUS > 0 ? tickPeriodInUS : 1),
+                                                                              m_frameCallbackFunction(nullptr),
+                                                                              m_vehicleCallbackFunction(nullptr),
+                                                                              m_buttonsCallbackFunction(nullptr),
+                                                                              m_tickCallbackFunction(nullptr),
+                                                                              m_nextTickTime_InUS(0) {
+}
+
+void RideReplay::registerFrameCallback(RideReplayFrameCallbackFunction const &frameCallbackFunction) {
+  m_frameCallbackFunction = frameCallbackFunction;
+}
+
+void RideReplay::registerVehicleCallback(RideReplayVehicleCallbackFunction const &vehicleCallbackFunction) {
+  m_vehicleCallbackFunction = vehicleCallbackFunction;
+}
+
+void RideReplay::registerButtonsCallback(RideReplayButtonsCallbackFunction const &buttonsCallbackFunction) {
+  m_buttonsCallbackFunction = buttonsCallbackFunction;
+}
+
+void RideReplay::registerTickCallback(RideReplayTickCallbackFunction const &tickCallbackFunction) {
+  m_tickCallbackFunction = tickCallbackFunction;
+}
+
+uint64_t RideReplay::run() {
+  uint64_t numberOfRecords = 0;
+
+  m_reader.rewind();
+  m_nextTickTime_InUS = 0;
+
+  RideLogRecord record = {};
+
+  while (m_reader.next(record)) {
+    tickUntil(record.time_InUS);
+
+    numberOfRecords += 1;
+
+    if (record.type == RIDE_LOG_RECORD_ADC_FRAME and m_frameCallbackFunction) {
+      m_frameCallbackFunction(record.payload, record.size);
+    }
+
+    if (record.type == RIDE_LOG_RECORD_VEHICLE and record.size == sizeof(RideLogVehicle) and m_vehicleCallbackFunction) {
+      RideLogVehicle vehicle = {};
+      std::memcpy(&vehicle, record.payload, sizeof(vehicle));
+      m_vehicleCallbackFunction(vehicle);
+    }
+
+    if (record.type == RIDE_LOG_RECORD_BUTTONS and record.size == sizeof(RideLogButtons) and m_buttonsCallbackFunction) {
+      RideLogButtons buttons = {};
+      std::memcpy(&buttons, record.payload, sizeof(buttons));
+      m_buttonsCallbackFunction(buttons);
+    }
+  }
+
+  return numberOfRecords;
+}
+
+void RideReplay::tickUntil(uint64_t const timeInUS) {
+  while (m_nextTickTime_InUS <= timeInUS) {
+    if (m_tickCallbackFunction) {
+      m_tickCallbackFunction(m_nextTickTime_InUS);
+    }
+
+    m_nextTickTime_InUS += m_tickPeriod_InUS;
+  }
+}
+
+uint64_t rideLogOutputDigest(RideLogReader reader) {
+  auto digest = digestOffsetBasis;
+
+  RideLogRecord record = {};
+
+  while (nextOutput(reader, record)) {
+    for (auto shift = 0; shift < 64; shift += 8) {
+      digest = (digest ^ ((record.time_InUS >> shift) & 0xFF)) * digestPrime;
+    }
+
+    for (uint16_t i = 0; i < record.size; i++) {
+      digest = (digest ^ record.payload[i]) * digestPrime;
+    }
+  }
+
+  return digest;
+}
+
+bool rideLogFindFirstDifference(RideLogReader reference, RideLogReader candidate, uint64_t &timeInUS) {
+  RideLogRecord referenceRecord = {};
+  RideLogRecord candidateRecord = {};
+
+  while (true) {
+    auto const hasReference = nextOutput(reference, referenceRecord);
+    auto const hasCandidate = nextOutput(candidate, candidateRecord);
+
+    if (not hasReference and not hasCandidate) {
+      return false;
+    }
+
+    if (hasReference != hasCandidate) {
+      timeInUS = hasReference ? referenceRecord.time_InUS : candidateRecord.time_InUS;
+      return true;
+    }
+
+    auto const isSame = referenceRecord.time_InUS == candidateRecord.time_InUS
+                        and referenceRecord.size == candidateRecord.size
+                        and std::memcmp(referenceRecord.payload, candidateRecord.payload, referenceRecord.size) == 0;
+
+    if (not isSame) {
+      timeInUS = std::min(referenceRecord.time_InUS, candidateRecord.time_InUS);
+      return true;
+    }
+  }
+}
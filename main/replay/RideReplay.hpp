@@ -0,0 +1,78 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <functional>
+
+#include "replay/RideLogReader.hpp"
+
+using RideReplayFrameCallbackFunction = std::function<void(uint8_t const *, uint32_t)>;
+using RideReplayVehicleCallbackFunction = std::function<void(RideLogVehicle const &)>;
+using RideReplayButtonsCallbackFunction = std::function<void(RideLogButtons const &)>;
+using RideReplayTickCallbackFunction = std::function<void(uint64_t)>;
+
+/**
+ * Feeds a recorded ride back into the control chain as fast as possible.
+ * Inputs are delivered in recorded order, between them the tick callback runs once per control period of log time.
+ */
+class RideReplay {
+public:
+  explicit RideReplay(RideLogReader reader, uint32_t tickPeriodInUS = 1000);
+  ~RideReplay() = default;
+
+public:
+  void registerFrameCallback(RideReplayFrameCallbackFunction const &frameCallbackFunction);
+  void registerVehicleCallback(RideReplayVehicleCallbackFunction const &vehicleCallbackFunction);
+  void registerButtonsCallback(RideReplayButtonsCallbackFunction const &buttonsCallbackFunction);
+  void registerTickCallback(RideReplayTickCallbackFunction const &tickCallbackFunction);
+
+public:
+  /**
+   * Replay the whole log
+   * @return Number of replayed records
+   */
+  uint64_t run();
+
+private:
+  void tickUntil(uint64_t timeInUS);
+
+private:
+  RideLogReader m_reader;
+  uint32_t const m_tickPeriod_InUS;
+
+private:
+  RideReplayFrameCallbackFunction m_frameCallbackFunction;
+  RideReplayVehicleCallbackFunction m_vehicleCallbackFunction;
+  RideReplayButtonsCallbackFunction m_buttonsCallbackFunction;
+  RideReplayTickCallbackFunction m_tickCallbackFunction;
+
+private:
+  uint64_t m_nextTickTime_InUS;
+};
+
+/**
+ * Digest of the output records of a log, equal digests mean identical command and motor trajectories
+ */
+uint64_t rideLogOutputDigest(RideLogReader reader);
+
+/**
+ * Time of the first output record that differs between two logs
+ * @return false when the output trajectories are identical
+ */
+bool rideLogFindFirstDifference(RideLogReader reference, RideLogReader candidate, uint64_t &timeInUS);
@@ -0,0 +1,104 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * Latest value mailbox between two cores.
+ * Exactly one writer, any number of readers, never blocks the writer.
+ * A sequence counter guards the payload, readers retry while a write is in progress.
+ */
+template<typename T>
+class Mailbox {
+  static_assert(std::is_trivially_copyable_v<T>, "Mailbox payload must be trivially copyable");
+  static_assert(std::is_trivially_default_constructible_v<T>, "Mailbox payload is rebuilt from words, it must not need a constructor");
+
+public:
+  Mailbox() : m_sequence(0), m_words() {
+    for (auto &word : m_words) {
+      word.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  explicit Mailbox(T const &value) : Mailbox() {
+    write(value);
+  }
+
+public:
+  /**
+   * Sequence number of the last published value, changes on every write
+   */
+  [[nodiscard]] uint32_t getSequence() const {
+    return m_sequence.load(std::memory_order_acquire) >> 1;
+  }
+
+public:
+  void write(T const &value) {
+    std::array<uint32_t, numberOfWords> words = {};
+    std::memcpy(words.data(), &value, sizeof(T));
+
+    auto const sequence = m_sequence.load(std::memory_order_relaxed);
+
+    m_sequence.store(sequence + 1, std::memory_order_relaxed);
+
+    // A reader seeing any of these words also sees the odd sequence above and retries
+    for (std::size_t i = 0; i < numberOfWords; i++) {
+      m_words[i].store(words[i], std::memory_order_release);
+    }
+
+    m_sequence.store(sequence + 2, std::memory_order_release);
+  }
+
+  /**
+   * Copy out a consistent snapshot
+   * @return Sequence number of the snapshot
+   */
+  uint32_t read(T &value) const {
+    std::array<uint32_t, numberOfWords> words = {};
+
+    while (true) {
+      auto const sequenceBefore = m_sequence.load(std::memory_order_acquire);
+      if (sequenceBefore & 1) {
+        continue;
+      }
+
+      for (std::size_t i = 0; i < numberOfWords; i++) {
+        words[i] = m_words[i].load(std::memory_order_acquire);
+      }
+
+      auto const sequenceAfter = m_sequence.load(std::memory_order_relaxed);
+      if (sequenceBefore == sequenceAfter) {
+        std::memcpy(&value, words.data(), sizeof(T));
+        return sequenceAfter >> 1;
+      }
+    }
+  }
+
+private:
+  static constexpr std::size_t const numberOfWords = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+private:
+  std::atomic<uint32_t> m_sequence;
+  std::array<std::atomic<uint32_t>, numberOfWords> m_words;
+};
@@ -0,0 +1,104 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Bounded lock-free queue, many producers on any core and a single consumer.
+ * Producers never wait, a push into a full buffer fails and the value is dropped.
+ */
+template<typename T, std::size_t Size>
+class RingBuffer {
+  static_assert(Size > 0 and (Size & (Size - 1)) == 0, "RingBuffer size must be a power of two");
+
+public:
+  RingBuffer() : m_slots(), m_pushPosition(0), m_popPosition(0), m_numberOfDropped(0) {
+    for (std::size_t i = 0; i < Size; i++) {
+      m_slots[i].sequence.store(static_cast<uint32_t>(i), std::memory_order_relaxed);
+    }
+  }
+
+public:
+  [[nodiscard]] uint32_t getNumberOfDropped() const {
+    return m_numberOfDropped.load(std::memory_order_relaxed);
+  }
+
+public:
+  bool push(T const &value) {
+    auto position = m_pushPosition.load(std::memory_order_relaxed);
+
+    while (true) {
+      auto &slot = m_slots[position & mask];
+      auto const sequence = slot.sequence.load(std::memory_order_acquire);
+      auto const difference = static_cast<int32_t>(sequence - position);
+
+      if (difference == 0) {
+        if (m_pushPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+          slot.value = value;
+          slot.sequence.store(position + 1, std::memory_order_release);
+          return true;
+        }
+        continue;
+      }
+
+      if (difference < 0) {
+        m_numberOfDropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      }
+
+      position = m_pushPosition.load(std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * Must only be called from the consumer
+   */
+  bool pop(T &value) {
+    auto &slot = m_slots[m_popPosition & mask];
+    auto const sequence = slot.sequence.load(std::memory_order_acquire);
+
+    if (static_cast<int32_t>(sequence - (m_popPosition + 1)) < 0) {
+      return false;
+    }
+
+    value = slot.value;
+    slot.sequence.store(m_popPosition + Size, std::memory_order_release);
+    m_popPosition += 1;
+
+    return true;
+  }
+
+private:
+  static constexpr uint32_t const mask = Size - 1;
+
+  struct Slot {
+    std::atomic<uint32_t> sequence;
+    T value;
+  };
+
+private:
+  std::array<Slot, Size> m_slots;
+  std::atomic<uint32_t> m_pushPosition;
+  uint32_t m_popPosition;
+  std::atomic<uint32_t> m_numberOfDropped;
+};
@@ -0,0 +1,77 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include "Task.hpp"
+
+#include <memory>
+
+#ifdef ESP_PLATFORM
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <esp_log.h>
+#else
+#include <thread>
+#include <pthread.h>
+#endif
+
+namespace runtime {
+
+#ifdef ESP_PLATFORM
+
+constexpr char const *tag = "task";
+
+namespace {
+
+void runTask(void *argument) {
+  std::unique_ptr<TaskFunction> const function(static_cast<TaskFunction *>(argument));
+
+  (*function)();
+
+  vTaskDelete(nullptr);
+}
+
+}// namespace
+
+void startPinnedTask(char const *name, int32_t const core, uint32_t const priority, uint32_t const stackSize, TaskFunction function) {
+  auto *argument = new TaskFunction(std::move(function));
+
+  auto const returnCode = xTaskCreatePinnedToCore(runTask, name, stackSize, argument, priority, nullptr, core);
+  if (returnCode != pdPASS) {
+    ESP_LOGE(tag, "Failed to start task %s on core %ld", name, core);
+    delete argument;
+  }
+}
+
+#else
+
+void startPinnedTask(char const *name, int32_t const core, [[maybe_unused]] uint32_t const priority, [[maybe_unused]] uint32_t const stackSize, TaskFunction function) {
+  std::thread thread(std::move(function));
+
+  pthread_setname_np(thread.native_handle(), name);
+
+  cpu_set_t cpuSet;
+  CPU_ZERO(&cpuSet);
+  CPU_SET(core, &cpuSet);
+  pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set_t), &cpuSet);
+
+  thread.detach();
+}
+
+#endif
+
+}// namespace runtime
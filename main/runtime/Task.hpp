@@ -0,0 +1,37 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+namespace runtime {
+
+constexpr int32_t const controlCore = 0;
+constexpr int32_t const motionCore = 1;
+
+using TaskFunction = std::function<void()>;
+
+/**
+ * Run the function in its own task pinned to a core.
+ * On the host the task is a detached std::thread and the core is only a hint.
+ */
+void startPinnedTask(char const *name, int32_t core, uint32_t priority, uint32_t stackSize, TaskFunction function);
+
+}// namespace runtime
@@ -0,0 +1,110 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include "DriverPowerManager.hpp"
+
+#include <cmath>
+
+constexpr float const decayHysteresis = 0.9;
+
+DriverPowerManager::DriverPowerManager(DriverPowerPolicy const &policy) : m_policy(policy),
+                                                                          m_state(DRIVER_POWER_STATE_ACTIVE),
+                                                                          m_decayMode(DECAY_MODE_SLOW),
+                                                                          m_lastMotionTime_InUS(0),
+                                                                          m_wakeStartTime_InUS(0) {
+}
+
+void DriverPowerManager::setPolicy(DriverPowerPolicy const &policy) {
+  m_policy = policy;
+}
+
+DriverPowerState DriverPowerManager::getState() const {
+  return m_state;
+}
+
+DecayMode DriverPowerManager::getDecayMode() const {
+  return m_decayMode;
+}
+
+uint8_t DriverPowerManager::getCurrent_InPercentage() const {
+  if (m_state == DRIVER_POWER_STATE_HOLD) {
+    return m_policy.holdCurrent_InPercentage;
+  }
+
+  return 100;
+}
+
+bool DriverPowerManager::isReady() const {
+  return m_state == DRIVER_POWER_STATE_ACTIVE or m_state == DRIVER_POWER_STATE_HOLD;
+}
+
+void DriverPowerManager::requestWake(uint64_t const timeInUS) {
+  m_lastMotionTime_InUS = timeInUS;
+
+  if (m_state == DRIVER_POWER_STATE_SLEEP) {
+    m_state = DRIVER_POWER_STATE_WAKING;
+    m_wakeStartTime_InUS = timeInUS;
+  }
+
+  if (m_state == DRIVER_POWER_STATE_HOLD) {
+    m_state = DRIVER_POWER_STATE_ACTIVE;
+  }
+}
+
+void DriverPowerManager::requestSleep() {
+  m_state = DRIVER_POWER_STATE_SLEEP;
+}
+
+void DriverPowerManager::update(uint64_t const timeInUS, float const speedInStepsPerSecond, bool const isMoving, bool const isClosed) {
+  if (isMoving) {
+    requestWake(timeInUS);
+  }
+
+  if (not isClosed) {
+    m_lastMotionTime_InUS = timeInUS;
+  }
+
+  if (m_state == DRIVER_POWER_STATE_WAKING) {
+    if (timeInUS - m_wakeStartTime_InUS < m_policy.wakeTime_InUS) {
+      return;
+    }
+
+    m_state = DRIVER_POWER_STATE_ACTIVE;
+    m_lastMotionTime_InUS = timeInUS;
+  }
+
+  // Fast decay keeps up with the back EMF at high step rates, slow decay is quieter and smoother at low speed
+  auto const speed = std::fabs(speedInStepsPerSecond);
+  if (speed >= m_policy.fastDecaySpeed_InStepsPerSecond) {
+    m_decayMode = DECAY_MODE_FAST;
+  }
+
+  if (speed < m_policy.fastDecaySpeed_InStepsPerSecond * decayHysteresis) {
+    m_decayMode = DECAY_MODE_SLOW;
+  }
+
+  auto const timeWithoutMotion_InUS = timeInUS - m_lastMotionTime_InUS;
+
+  if (m_state == DRIVER_POWER_STATE_ACTIVE and timeWithoutMotion_InUS >= m_policy.holdDelay_InUS) {
+    m_state = DRIVER_POWER_STATE_HOLD;
+  }
+
+  if (m_state == DRIVER_POWER_STATE_HOLD and m_policy.sleepDelay_InUS > 0 and timeWithoutMotion_InUS >= m_policy.sleepDelay_InUS) {
+    m_state = DRIVER_POWER_STATE_SLEEP;
+  }
+}
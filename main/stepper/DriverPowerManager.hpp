@@ -0,0 +1,91 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <cstdint>
+
+enum DecayMode {
+  DECAY_MODE_SLOW = 0,
+  DECAY_MODE_FAST
+};
+
+enum DriverPowerState {
+  DRIVER_POWER_STATE_ACTIVE = 0,
+  DRIVER_POWER_STATE_HOLD,
+  DRIVER_POWER_STATE_SLEEP,
+  DRIVER_POWER_STATE_WAKING
+};
+
+struct DriverPowerPolicy {
+  float fastDecaySpeed_InStepsPerSecond = 800;
+  // Applied through VREF, boards without a VREF output hold at the run current
+  uint8_t holdCurrent_InPercentage = 50;
+  uint32_t holdDelay_InUS = 200 * 1000;
+  uint32_t sleepDelay_InUS = 5 * 1000000;
+  uint32_t wakeTime_InUS = 2 * 1000;
+};
+
+/**
+ * Decides decay mode, current and sleep of the stepper driver from motion and time.
+ * Knows nothing about pins, the owner applies the result to the driver.
+ */
+class DriverPowerManager {
+public:
+  explicit DriverPowerManager(DriverPowerPolicy const &policy = {});
+  ~DriverPowerManager() = default;
+
+public:
+  void setPolicy(DriverPowerPolicy const &policy);
+
+public:
+  [[nodiscard]] DriverPowerState getState() const;
+  [[nodiscard]] DecayMode getDecayMode() const;
+  [[nodiscard]] uint8_t getCurrent_InPercentage() const;
+
+public:
+  /**
+   * Steps may only be issued when the driver is ready
+   */
+  [[nodiscard]] bool isReady() const;
+
+public:
+  /**
+   * Leave hold or sleep ahead of motion, the wake time runs while the request travels to the motor
+   */
+  void requestWake(uint64_t timeInUS);
+
+  /**
+   * Sleep right away instead of after the sleep delay, the next motion wakes the driver as usual
+   */
+  void requestSleep();
+
+  /**
+   * @param isClosed Current is only reduced and the driver only sleeps against the closed stop, anywhere else the return spring back drives the motor
+   */
+  void update(uint64_t timeInUS, float speedInStepsPerSecond, bool isMoving, bool isClosed);
+
+private:
+  DriverPowerPolicy m_policy;
+
+private:
+  DriverPowerState m_state;
+  DecayMode m_decayMode;
+  uint64_t m_lastMotionTime_InUS;
+  uint64_t m_wakeStartTime_InUS;
+};
@@ -0,0 +1,307 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include "MotionIdentification.hpp"
+
+#include <algorithm>
+
+MotionIdentification::MotionIdentification(MotionIdentificationConfiguration const &configuration) : m_configuration(configuration),
+                                                                                                     m_state(MOTION_IDENTIFICATION_STATE_IDLE),
+                                                                                                     m_command(),
+                                                                                                     m_limits(),
+                                                                                                     m_isCommandChanged(false),
+                                                                                                     m_strokeReference_InMillivolts(0),
+                                                                                                     m_homeReference_InMillivolts(0),
+                                                                                                     m_stroke_InSteps(0),
+                                                                                                     m_direction(MOTION_DIRECTION_OPENING),
+                                                                                                     m_phase(MOTION_IDENTIFICATION_PHASE_SPEED),
+                                                                                                     m_levelSpeed_InStepsPerSecond(0),
+                                                                                                     m_levelAcceleration_InStepsPerSecondPerSecond(0),
+                                                                                                     m_passed(),
+                                                                                                     m_repetition(0),
+                                                                                                     m_moveStartTime_InUS(0),
+                                                                                                     m_arrivalTime_InUS(0),
+                                                                                                     m_isArrived(false),
+                                                                                                     m_isHomeSeen(false),
+                                                                                                     m_homeSeenPosition_InSteps(0) {
+}
+
+void MotionIdentification::setConfiguration(MotionIdentificationConfiguration const &configuration) {
+  m_configuration = configuration;
+}
+
+MotionIdentificationState MotionIdentification::getState() const {
+  return m_state;
+}
+
+bool MotionIdentification::isRunning() const {
+  return m_state != MOTION_IDENTIFICATION_STATE_IDLE and m_state != MOTION_IDENTIFICATION_STATE_DONE and m_state != MOTION_IDENTIFICATION_STATE_FAILED;
+}
+
+bool MotionIdentification::isSucceeded() const {
+  return m_state == MOTION_IDENTIFICATION_STATE_DONE;
+}
+
+MotionCommand const &MotionIdentification::getCommand() const {
+  return m_command;
+}
+
+MotionLimits const &MotionIdentification::getLimits() const {
+  return m_limits;
+}
+
+void MotionIdentification::start(uint64_t const timeInUS) {
+  m_strokeReference_InMillivolts = 0;
+  m_homeReference_InMillivolts = 0;
+  m_stroke_InSteps = 0;
+
+  m_direction = MOTION_DIRECTION_OPENING;
+  m_phase = MOTION_IDENTIFICATION_PHASE_SPEED;
+  m_levelSpeed_InStepsPerSecond = m_configuration.startSpeed_InStepsPerSecond;
+  m_levelAcceleration_InStepsPerSecondPerSecond = m_configuration.startAcceleration_InStepsPerSecondPerSecond;
+  m_passed = {0, 0};
+
+  // The step counter is only trusted after homing against the stop
+  moveTo(timeInUS, MOTION_IDENTIFICATION_STATE_HOMING, 0, false);
+  m_command.isHomingRequested = true;
+}
+
+void MotionIdentification::stop() {
+  if (not isRunning()) {
+    return;
+  }
+
+  finish(MOTION_IDENTIFICATION_STATE_FAILED);
+}
+
+bool MotionIdentification::update(uint64_t const timeInUS, MotionSample const &sample) {
+  if (not isRunning()) {
+    return false;
+  }
+
+  if (m_state == MOTION_IDENTIFICATION_STATE_HOMING) {
+    m_isCommandChanged = false;
+
+    // Learn what the throttle sensor reads at both ends of the stroke while moving gently
+    moveTo(timeInUS, MOTION_IDENTIFICATION_STATE_REFERENCE_STROKE, m_configuration.stroke_InPercentage, false);
+    return true;
+  }
+
+  if (sample.inHome and not m_isHomeSeen) {
+    m_isHomeSeen = true;
+    m_homeSeenPosition_InSteps = sample.position_InSteps;
+  }
+
+  // A coarse slew passes the target and turns back to it in fine steps, only standing on it counts
+  if (sample.distanceToTarget_InSteps != 0) {
+    m_isArrived = false;
+  }
+
+  if (not m_isArrived) {
+    if (sample.distanceToTarget_InSteps == 0) {
+      m_isArrived = true;
+      m_arrivalTime_InUS = timeInUS;
+    } else if (timeInUS - m_moveStartTime_InUS >= m_configuration.moveTimeout_InUS) {
+      // A stalled test move is a failed level, a stalled safe move means the mechanism is stuck
+      if (m_state == MOTION_IDENTIFICATION_STATE_TESTING) {
+        failLevel(timeInUS);
+      } else {
+        finish(MOTION_IDENTIFICATION_STATE_FAILED);
+      }
+    }
+  }
+
+  if (m_isArrived and timeInUS - m_arrivalTime_InUS >= m_configuration.settleTime_InUS) {
+    if (m_state == MOTION_IDENTIFICATION_STATE_REFERENCE_STROKE) {
+      m_strokeReference_InMillivolts = sample.throttlePosition_InMillivolts;
+      m_stroke_InSteps = sample.position_InSteps;
+      moveTo(timeInUS, MOTION_IDENTIFICATION_STATE_REFERENCE_HOME, 0, false);
+    } else if (m_state == MOTION_IDENTIFICATION_STATE_REFERENCE_HOME) {
+      m_homeReference_InMillivolts = sample.throttlePosition_InMillivolts;
+
+      // Without a sensor that follows the stroke only the home switch would be left to tell lost steps
+      if (not sample.inHome or not isThrottleOff(m_strokeReference_InMillivolts, m_homeReference_InMillivolts)) {
+        finish(MOTION_IDENTIFICATION_STATE_FAILED);
+      } else {
+        startLevel(timeInUS);
+      }
+    } else if (m_state == MOTION_IDENTIFICATION_STATE_PREPARING) {
+      auto const position_InPercentage = m_direction == MOTION_DIRECTION_OPENING ? m_configuration.stroke_InPercentage : 0;
+      moveTo(timeInUS, MOTION_IDENTIFICATION_STATE_TESTING, position_InPercentage, true);
+    } else if (m_state == MOTION_IDENTIFICATION_STATE_TESTING) {
+      if (m_direction == MOTION_DIRECTION_OPENING) {
+        if (isThrottleOff(sample.throttlePosition_InMillivolts, m_strokeReference_InMillivolts)) {
+          failLevel(timeInUS);
+        } else {
+          moveTo(timeInUS, MOTION_IDENTIFICATION_STATE_RETURNING, 0, false);
+        }
+      } else {
+        if (not sample.inHome or isThrottleOff(sample.throttlePosition_InMillivolts, m_homeReference_InMillivolts)) {
+          failLevel(timeInUS);
+        } else {
+          passRepetition(timeInUS);
+        }
+      }
+    } else if (m_state == MOTION_IDENTIFICATION_STATE_RETURNING) {
+      // Steps lost while opening leave the counter ahead, the switch then closes before step zero
+      if (not sample.inHome or m_homeSeenPosition_InSteps > m_configuration.homeTolerance_InSteps) {
+        failLevel(timeInUS);
+      } else {
+        passRepetition(timeInUS);
+      }
+    }
+  }
+
+  auto const isCommandChanged = m_isCommandChanged;
+  m_isCommandChanged = false;
+
+  return isCommandChanged;
+}
+
+DirectionLimits MotionIdentification::getLevelLimits() const {
+  if (m_phase == MOTION_IDENTIFICATION_PHASE_ACCELERATION or m_stroke_InSteps <= 0) {
+    return {m_levelSpeed_InStepsPerSecond, m_levelAcceleration_InStepsPerSecondPerSecond};
+  }
+
+  // A speed the test move never reaches would pass untested, the ramps may take half of the stroke at most
+  auto const rampAcceleration_InStepsPerSecondPerSecond = 2 * m_levelSpeed_InStepsPerSecond * m_levelSpeed_InStepsPerSecond / static_cast<float>(m_stroke_InSteps);
+  auto const acceleration_InStepsPerSecondPerSecond = std::max(m_levelAcceleration_InStepsPerSecondPerSecond, rampAcceleration_InStepsPerSecondPerSecond);
+
+  return {m_levelSpeed_InStepsPerSecond, std::min(acceleration_InStepsPerSecondPerSecond, m_configuration.maximalAcceleration_InStepsPerSecondPerSecond)};
+}
+
+bool MotionIdentification::isThrottleOff(uint32_t const throttlePositionInMillivolts, uint32_t const referenceInMillivolts) const {
+  auto const difference_InMillivolts = throttlePositionInMillivolts > referenceInMillivolts ? throttlePositionInMillivolts - referenceInMillivolts : referenceInMillivolts - throttlePositionInMillivolts;
+
+  return difference_InMillivolts > m_configuration.throttleTolerance_InMillivolts;
+}
+
+void MotionIdentification::moveTo(uint64_t const timeInUS, MotionIdentificationState const state, uint32_t const positionInPercentage, bool const isTest) {
+  DirectionLimits const safeLimits = {m_configuration.safeSpeed_InStepsPerSecond, m_configuration.safeAcceleration_InStepsPerSecondPerSecond};
+
+  m_state = state;
+  m_command.position_InPercentage = positionInPercentage;
+  m_command.limits.opening = safeLimits;
+  m_command.limits.closing = safeLimits;
+  m_command.isHomingRequested = false;
+  m_isCommandChanged = true;
+
+  if (isTest and m_direction == MOTION_DIRECTION_OPENING) {
+    m_command.limits.opening = getLevelLimits();
+  }
+
+  if (isTest and m_direction == MOTION_DIRECTION_CLOSING) {
+    m_command.limits.closing = getLevelLimits();
+  }
+
+  m_moveStartTime_InUS = timeInUS;
+  m_isArrived = false;
+  m_isHomeSeen = false;
+  m_homeSeenPosition_InSteps = 0;
+}
+
+void MotionIdentification::startLevel(uint64_t const timeInUS) {
+  m_repetition = 0;
+
+  auto const position_InPercentage = m_direction == MOTION_DIRECTION_OPENING ? 0 : m_configuration.stroke_InPercentage;
+  moveTo(timeInUS, MOTION_IDENTIFICATION_STATE_PREPARING, position_InPercentage, false);
+}
+
+void MotionIdentification::passRepetition(uint64_t const timeInUS) {
+  m_repetition += 1;
+
+  if (m_repetition < m_configuration.repetitions) {
+    auto const position_InPercentage = m_direction == MOTION_DIRECTION_OPENING ? 0 : m_configuration.stroke_InPercentage;
+    return moveTo(timeInUS, MOTION_IDENTIFICATION_STATE_PREPARING, position_InPercentage, false);
+  }
+
+  m_passed = getLevelLimits();
+
+  auto const growth = static_cast<float>(m_configuration.growth_InPercentage) / 100;
+
+  if (m_phase == MOTION_IDENTIFICATION_PHASE_SPEED) {
+    if (m_levelSpeed_InStepsPerSecond >= m_configuration.maximalSpeed_InStepsPerSecond) {
+      return finishPhase(timeInUS);
+    }
+
+    m_levelSpeed_InStepsPerSecond = std::min(m_levelSpeed_InStepsPerSecond * growth, m_configuration.maximalSpeed_InStepsPerSecond);
+  } else {
+    if (m_levelAcceleration_InStepsPerSecondPerSecond >= m_configuration.maximalAcceleration_InStepsPerSecondPerSecond) {
+      return finishPhase(timeInUS);
+    }
+
+    m_levelAcceleration_InStepsPerSecondPerSecond = std::min(m_levelAcceleration_InStepsPerSecondPerSecond * growth, m_configuration.maximalAcceleration_InStepsPerSecondPerSecond);
+  }
+
+  startLevel(timeInUS);
+}
+
+void MotionIdentification::failLevel(uint64_t const timeInUS) {
+  finishPhase(timeInUS);
+
+  // Lost steps leave the counter wrong, whatever comes next starts from the stop again
+  m_command.isHomingRequested = true;
+  m_isCommandChanged = true;
+}
+
+void MotionIdentification::finishPhase(uint64_t const timeInUS) {
+  if (m_phase == MOTION_IDENTIFICATION_PHASE_SPEED) {
+    // Not even the start level passed, the start values are too aggressive for this throttle body
+    if (m_passed.speed_InStepsPerSecond == 0) {
+      return finish(MOTION_IDENTIFICATION_STATE_FAILED);
+    }
+
+    // The speed ladder ran at the start acceleration, so that one is proven already
+    m_phase = MOTION_IDENTIFICATION_PHASE_ACCELERATION;
+    m_levelSpeed_InStepsPerSecond = m_passed.speed_InStepsPerSecond;
+    m_levelAcceleration_InStepsPerSecondPerSecond = m_passed.acceleration_InStepsPerSecondPerSecond;
+    m_repetition = m_configuration.repetitions;
+
+    return passRepetition(timeInUS);
+  }
+
+  auto const margin = static_cast<float>(m_configuration.margin_InPercentage) / 100;
+  DirectionLimits const limits = {m_passed.speed_InStepsPerSecond * margin, m_passed.acceleration_InStepsPerSecondPerSecond * margin};
+
+  if (m_direction == MOTION_DIRECTION_OPENING) {
+    m_limits.opening = limits;
+
+    m_direction = MOTION_DIRECTION_CLOSING;
+    m_phase = MOTION_IDENTIFICATION_PHASE_SPEED;
+    m_levelSpeed_InStepsPerSecond = m_configuration.startSpeed_InStepsPerSecond;
+    m_levelAcceleration_InStepsPerSecondPerSecond = m_configuration.startAcceleration_InStepsPerSecondPerSecond;
+    m_passed = {0, 0};
+
+    return startLevel(timeInUS);
+  }
+
+  m_limits.closing = limits;
+
+  finish(MOTION_IDENTIFICATION_STATE_DONE);
+}
+
+void MotionIdentification::finish(MotionIdentificationState const state) {
+  m_state = state;
+  m_command.position_InPercentage = 0;
+  m_command.isHomingRequested = false;
+  m_isCommandChanged = true;
+
+  if (state == MOTION_IDENTIFICATION_STATE_DONE) {
+    m_command.limits = m_limits;
+  }
+}
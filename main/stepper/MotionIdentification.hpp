@@ -0,0 +1,143 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <cstdint>
+
+#include "stepper/MotionLimits.hpp"
+#include "stepper/interface/IMotionRoutine.hpp"
+
+enum MotionIdentificationState {
+  MOTION_IDENTIFICATION_STATE_IDLE = 0,
+  MOTION_IDENTIFICATION_STATE_HOMING,
+  MOTION_IDENTIFICATION_STATE_REFERENCE_STROKE,
+  MOTION_IDENTIFICATION_STATE_REFERENCE_HOME,
+  MOTION_IDENTIFICATION_STATE_PREPARING,
+  MOTION_IDENTIFICATION_STATE_TESTING,
+  MOTION_IDENTIFICATION_STATE_RETURNING,
+  MOTION_IDENTIFICATION_STATE_DONE,
+  MOTION_IDENTIFICATION_STATE_FAILED
+};
+
+enum MotionIdentificationPhase {
+  MOTION_IDENTIFICATION_PHASE_SPEED = 0,
+  MOTION_IDENTIFICATION_PHASE_ACCELERATION
+};
+
+struct MotionIdentificationConfiguration {
+  float safeSpeed_InStepsPerSecond = 300;
+  float safeAcceleration_InStepsPerSecondPerSecond = 3000;
+
+  float startSpeed_InStepsPerSecond = 500;
+  float startAcceleration_InStepsPerSecondPerSecond = 5000;
+  float maximalSpeed_InStepsPerSecond = 4000;
+  float maximalAcceleration_InStepsPerSecondPerSecond = 120000;
+
+  // Every passed level raises the tested value by this factor
+  uint32_t growth_InPercentage = 125;
+  // Share of the highest passed values kept as limits
+  uint32_t margin_InPercentage = 80;
+
+  uint32_t stroke_InPercentage = 80;
+  uint32_t repetitions = 3;
+
+  int32_t homeTolerance_InSteps = 8;
+  uint32_t throttleTolerance_InMillivolts = 40;
+
+  uint32_t settleTime_InUS = 100 * 1000;
+  uint32_t moveTimeout_InUS = 3 * 1000000;
+};
+
+/**
+ * Guided identification of the throttle body motion limits.
+ * For each direction it raises the speed at a gentle acceleration, steep enough to cruise over half of the stroke,
+ * then the acceleration at the found speed, repeating every level a few times between safe moves. Lost steps show up as
+ * the home switch closing away from step zero on the slow return, as an open switch at step zero
+ * or as a throttle position off the reference learned with safe moves.
+ * The run fails when the throttle sensor does not follow the reference stroke, a missing reading included.
+ */
+class MotionIdentification : public IMotionRoutine {
+public:
+  explicit MotionIdentification(MotionIdentificationConfiguration const &configuration = {});
+  ~MotionIdentification() override = default;
+
+public:
+  void setConfiguration(MotionIdentificationConfiguration const &configuration);
+
+public:
+  [[nodiscard]] MotionIdentificationState getState() const;
+  [[nodiscard]] bool isRunning() const override;
+  [[nodiscard]] bool isSucceeded() const override;
+
+public:
+  [[nodiscard]] MotionCommand const &getCommand() const override;
+
+  /**
+   * Identified limits with the margin applied, valid once the state is done
+   */
+  [[nodiscard]] MotionLimits const &getLimits() const;
+
+public:
+  void start(uint64_t timeInUS) override;
+  void stop() override;
+
+public:
+  bool update(uint64_t timeInUS, MotionSample const &sample) override;
+
+private:
+  [[nodiscard]] DirectionLimits getLevelLimits() const;
+  [[nodiscard]] bool isThrottleOff(uint32_t throttlePositionInMillivolts, uint32_t referenceInMillivolts) const;
+
+private:
+  void moveTo(uint64_t timeInUS, MotionIdentificationState state, uint32_t positionInPercentage, bool isTest);
+  void startLevel(uint64_t timeInUS);
+  void passRepetition(uint64_t timeInUS);
+  void failLevel(uint64_t timeInUS);
+  void finishPhase(uint64_t timeInUS);
+  void finish(MotionIdentificationState state);
+
+private:
+  MotionIdentificationConfiguration m_configuration;
+
+private:
+  MotionIdentificationState m_state;
+  MotionCommand m_command;
+  MotionLimits m_limits;
+  bool m_isCommandChanged;
+
+private:
+  uint32_t m_strokeReference_InMillivolts;
+  uint32_t m_homeReference_InMillivolts;
+  int32_t m_stroke_InSteps;
+
+private:
+  MotionDirection m_direction;
+  MotionIdentificationPhase m_phase;
+  float m_levelSpeed_InStepsPerSecond;
+  float m_levelAcceleration_InStepsPerSecondPerSecond;
+  DirectionLimits m_passed;
+  uint32_t m_repetition;
+
+private:
+  uint64_t m_moveStartTime_InUS;
+  uint64_t m_arrivalTime_InUS;
+  bool m_isArrived;
+  bool m_isHomeSeen;
+  int32_t m_homeSeenPosition_InSteps;
+};
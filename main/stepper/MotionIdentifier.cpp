@@ -0,0 +1,257 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include "MotionIdentifier.hpp"
+
+#include <cstdio>
+#include <cinttypes>
+#include <algorithm>
+
+#include "log/DeferredLog.hpp"
+
+constexpr char const *storageNamespace = "motion";
+constexpr char const *openingSpeedKey = "open_speed";
+constexpr char const *openingAccelerationKey = "open_accel";
+constexpr char const *closingSpeedKey = "close_speed";
+constexpr char const *closingAccelerationKey = "close_accel";
+constexpr char const *numberOfSpeedBandsKey = "bands";
+constexpr char const *speedBandLowKeyFormat = "band%" PRIu8 "_low";
+constexpr char const *speedBandHighKeyFormat = "band%" PRIu8 "_high";
+
+constexpr std::size_t const storageKeyMaximalSize = 16;
+
+MotionIdentifier::MotionIdentifier(std::shared_ptr<MotorController> motorController, IClockPtr clock) : m_startCallbackFunction(nullptr),
+                                                                                                        m_finishCallbackFunction(nullptr),
+                                                                                                        m_motorController(std::move(motorController)),
+                                                                                                        m_clock(std::move(clock)),
+                                                                                                        m_storage(std::make_unique<Storage>(storageNamespace)),
+                                                                                                        m_configuration(),
+                                                                                                        m_sweepConfiguration(),
+                                                                                                        m_identification(),
+                                                                                                        m_resonanceSweep(),
+                                                                                                        m_routine(nullptr),
+                                                                                                        m_limits(),
+                                                                                                        m_speedBands(),
+                                                                                                        m_savedSpeed_InStepsPerSecond(0),
+                                                                                                        m_savedAcceleration_InStepsPerSecondPerSecond(0),
+                                                                                                        m_savedDeceleration_InStepsPerSecondPerSecond(0),
+                                                                                                        m_isStartRequested(false),
+                                                                                                        m_isSweepRequested(false),
+                                                                                                        m_isStopRequested(false),
+                                                                                                        m_isRunning(false),
+                                                                                                        m_throttlePosition_InMillivolts(0) {
+  MotionLimits const defaultLimits = {};
+
+  m_limits.opening.speed_InStepsPerSecond = static_cast<float>(m_storage->getValue(openingSpeedKey, static_cast<uint32_t>(defaultLimits.opening.speed_InStepsPerSecond)));
+  m_limits.opening.acceleration_InStepsPerSecondPerSecond = static_cast<float>(m_storage->getValue(openingAccelerationKey, static_cast<uint32_t>(defaultLimits.opening.acceleration_InStepsPerSecondPerSecond)));
+  m_limits.closing.speed_InStepsPerSecond = static_cast<float>(m_storage->getValue(closingSpeedKey, static_cast<uint32_t>(defaultLimits.closing.speed_InStepsPerSecond)));
+  m_limits.closing.acceleration_InStepsPerSecondPerSecond = static_cast<float>(m_storage->getValue(closingAccelerationKey, static_cast<uint32_t>(defaultLimits.closing.acceleration_InStepsPerSecondPerSecond)));
+
+  auto const numberOfSpeedBands = std::min(m_storage->getValue(numberOfSpeedBandsKey, 0), speedBandsMaximum);
+  for (uint32_t i = 0; i < numberOfSpeedBands; i++) {
+    char lowKey[storageKeyMaximalSize] = {};
+    char highKey[storageKeyMaximalSize] = {};
+    std::snprintf(lowKey, sizeof(lowKey), speedBandLowKeyFormat, static_cast<uint8_t>(i));
+    std::snprintf(highKey, sizeof(highKey), speedBandHighKeyFormat, static_cast<uint8_t>(i));
+
+    speedBandsAdd(m_speedBands, {static_cast<float>(m_storage->getValue(lowKey, 0)), static_cast<float>(m_storage->getValue(highKey, 0))});
+  }
+
+  m_motorController->setMotionLimits(m_limits);
+  m_motorController->setSpeedBands(m_speedBands);
+}
+
+void MotionIdentifier::registerStartCallback(MotionIdentifierStartCallbackFunction const &startCallbackFunction) {
+  m_startCallbackFunction = startCallbackFunction;
+}
+
+void MotionIdentifier::registerFinishCallback(MotionIdentifierFinishCallbackFunction const &finishCallbackFunction) {
+  m_finishCallbackFunction = finishCallbackFunction;
+}
+
+void MotionIdentifier::setConfiguration(MotionIdentificationConfiguration const &configuration) {
+  m_configuration = configuration;
+  m_identification.setConfiguration(m_configuration);
+}
+
+void MotionIdentifier::setSweepConfiguration(ResonanceSweepConfiguration const &configuration) {
+  m_sweepConfiguration = configuration;
+  m_resonanceSweep.setConfiguration(m_sweepConfiguration);
+}
+
+bool MotionIdentifier::isRunning() const {
+  return m_isRunning.load(std::memory_order_relaxed);
+}
+
+void MotionIdentifier::start() {
+  m_isStartRequested.store(true, std::memory_order_relaxed);
+}
+
+void MotionIdentifier::startSweep() {
+  m_isSweepRequested.store(true, std::memory_order_relaxed);
+}
+
+void MotionIdentifier::stop() {
+  m_isStopRequested.store(true, std::memory_order_relaxed);
+}
+
+void MotionIdentifier::setThrottlePosition(uint32_t const throttlePositionInMillivolts) {
+  m_throttlePosition_InMillivolts.store(throttlePositionInMillivolts, std::memory_order_relaxed);
+}
+
+void MotionIdentifier::process() {
+  auto const isStartRequested = m_isStartRequested.exchange(false, std::memory_order_relaxed);
+  auto const isSweepRequested = m_isSweepRequested.exchange(false, std::memory_order_relaxed);
+
+  if (m_isStopRequested.exchange(false, std::memory_order_relaxed) and m_routine) {
+    m_routine->stop();
+    return finish();
+  }
+
+  if (m_routine == nullptr and isStartRequested) {
+    return startRoutine(m_identification);
+  }
+
+  if (m_routine == nullptr and isSweepRequested) {
+    return startRoutine(m_resonanceSweep);
+  }
+
+  if (m_routine == nullptr) {
+    return;
+  }
+
+  MotionSample const sample = {
+      .position_InSteps = m_motorController->getPosition(),
+      .distanceToTarget_InSteps = m_motorController->getDistanceToTarget(),
+      .inHome = m_motorController->inHome(),
+      .throttlePosition_InMillivolts = m_throttlePosition_InMillivolts.load(std::memory_order_relaxed),
+  };
+
+  if (m_routine->update(m_clock->getTime_InUS(), sample)) {
+    applyCommand();
+  }
+
+  if (not m_routine->isRunning()) {
+    finish();
+  }
+}
+
+void MotionIdentifier::startRoutine(IMotionRoutine &routine) {
+  if (m_startCallbackFunction) {
+    m_startCallbackFunction();
+  }
+
+  m_routine = &routine;
+
+  // Test moves may exceed the ride settings, the limits of each command keep them in bounds
+  m_savedSpeed_InStepsPerSecond = m_motorController->getSpeed();
+  m_savedAcceleration_InStepsPerSecondPerSecond = m_motorController->getAcceleration();
+  m_savedDeceleration_InStepsPerSecondPerSecond = m_motorController->getDeceleration();
+
+  auto const speed_InStepsPerSecond = std::max(m_configuration.maximalSpeed_InStepsPerSecond, m_sweepConfiguration.endSpeed_InStepsPerSecond);
+  auto const acceleration_InStepsPerSecondPerSecond = std::max(m_configuration.maximalAcceleration_InStepsPerSecondPerSecond, m_sweepConfiguration.acceleration_InStepsPerSecondPerSecond);
+
+  m_motorController->setSpeed(speed_InStepsPerSecond);
+  m_motorController->setAcceleration(acceleration_InStepsPerSecondPerSecond);
+  m_motorController->setDeceleration(acceleration_InStepsPerSecondPerSecond);
+
+  // The sweep has to cruise at every speed, known bands included
+  if (m_routine == &m_resonanceSweep) {
+    m_motorController->setSpeedBands({});
+  }
+
+  m_routine->start(m_clock->getTime_InUS());
+  m_isRunning.store(true, std::memory_order_relaxed);
+
+  deferredLog(LOG_MOTION_IDENTIFIER_STARTED, m_routine == &m_resonanceSweep);
+
+  applyCommand();
+}
+
+void MotionIdentifier::applyCommand() {
+  auto const &command = m_routine->getCommand();
+
+  if (command.isHomingRequested) {
+    m_motorController->moveToHome();
+  }
+
+  m_motorController->setMotionLimits(command.limits);
+  m_motorController->setPosition(command.position_InPercentage);
+}
+
+void MotionIdentifier::finish() {
+  auto const isSucceeded = m_routine->isSucceeded();
+
+  if (isSucceeded and m_routine == &m_identification) {
+    m_limits = m_identification.getLimits();
+    storeMotionLimits();
+  }
+
+  if (isSucceeded and m_routine == &m_resonanceSweep) {
+    m_speedBands = m_resonanceSweep.getSpeedBands();
+    storeSpeedBands();
+  }
+
+  deferredLog(LOG_MOTION_IDENTIFIER_FINISHED, m_routine == &m_resonanceSweep, isSucceeded);
+
+  m_motorController->setSpeed(m_savedSpeed_InStepsPerSecond);
+  m_motorController->setAcceleration(m_savedAcceleration_InStepsPerSecondPerSecond);
+  m_motorController->setDeceleration(m_savedDeceleration_InStepsPerSecondPerSecond);
+  m_motorController->setMotionLimits(m_limits);
+  m_motorController->setSpeedBands(m_speedBands);
+
+  m_routine = nullptr;
+  m_isRunning.store(false, std::memory_order_relaxed);
+
+  if (m_finishCallbackFunction) {
+    m_finishCallbackFunction(isSucceeded);
+  }
+}
+
+void MotionIdentifier::storeMotionLimits() {
+  m_storage->setValue(openingSpeedKey, static_cast<uint32_t>(m_limits.opening.speed_InStepsPerSecond));
+  m_storage->setValue(openingAccelerationKey, static_cast<uint32_t>(m_limits.opening.acceleration_InStepsPerSecondPerSecond));
+  m_storage->setValue(closingSpeedKey, static_cast<uint32_t>(m_limits.closing.speed_InStepsPerSecond));
+  m_storage->setValue(closingAccelerationKey, static_cast<uint32_t>(m_limits.closing.acceleration_InStepsPerSecondPerSecond));
+  m_storage->commit();
+
+  deferredLog(LOG_MOTION_IDENTIFIER_SPEED, MOTION_DIRECTION_OPENING, static_cast<int32_t>(m_limits.opening.speed_InStepsPerSecond));
+  deferredLog(LOG_MOTION_IDENTIFIER_ACCELERATION, MOTION_DIRECTION_OPENING, static_cast<int32_t>(m_limits.opening.acceleration_InStepsPerSecondPerSecond));
+  deferredLog(LOG_MOTION_IDENTIFIER_SPEED, MOTION_DIRECTION_CLOSING, static_cast<int32_t>(m_limits.closing.speed_InStepsPerSecond));
+  deferredLog(LOG_MOTION_IDENTIFIER_ACCELERATION, MOTION_DIRECTION_CLOSING, static_cast<int32_t>(m_limits.closing.acceleration_InStepsPerSecondPerSecond));
+}
+
+void MotionIdentifier::storeSpeedBands() {
+  m_storage->setValue(numberOfSpeedBandsKey, m_speedBands.numberOfBands);
+
+  for (uint32_t i = 0; i < m_speedBands.numberOfBands; i++) {
+    auto const &band = m_speedBands.bands[i];
+
+    char lowKey[storageKeyMaximalSize] = {};
+    char highKey[storageKeyMaximalSize] = {};
+    std::snprintf(lowKey, sizeof(lowKey), speedBandLowKeyFormat, static_cast<uint8_t>(i));
+    std::snprintf(highKey, sizeof(highKey), speedBandHighKeyFormat, static_cast<uint8_t>(i));
+
+    m_storage->setValue(lowKey, static_cast<uint32_t>(band.low_InStepsPerSecond));
+    m_storage->setValue(highKey, static_cast<uint32_t>(band.high_InStepsPerSecond));
+
+    deferredLog(LOG_MOTION_IDENTIFIER_SPEED_BAND, static_cast<int32_t>(band.low_InStepsPerSecond), static_cast<int32_t>(band.high_InStepsPerSecond));
+  }
+
+  m_storage->commit();
+}
@@ -0,0 +1,114 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <functional>
+
+#include "Storage.hpp"
+#include "executor/Node.hpp"
+#include "clock/SystemClock.hpp"
+#include "stepper/MotorController.hpp"
+#include "stepper/ResonanceSweep.hpp"
+#include "stepper/MotionIdentification.hpp"
+
+using MotionIdentifierStartCallbackFunction = std::function<void()>;
+using MotionIdentifierFinishCallbackFunction = std::function<void(bool)>;
+
+/**
+ * Runs next to MotorController on the motion core and drives it through the identification or the resonance sweep.
+ * Identified limits and speed bands are stored and applied to the controller, at construction the stored ones are applied.
+ * Start, stop and the throttle position may come from any core.
+ */
+class MotionIdentifier : public executor::Node {
+public:
+  explicit MotionIdentifier(std::shared_ptr<MotorController> motorController, IClockPtr clock = getSystemClock());
+  ~MotionIdentifier() override = default;
+
+public:
+  /**
+   * Called on the motion core before the first move, the owner stops everything else that moves the motor
+   */
+  void registerStartCallback(MotionIdentifierStartCallbackFunction const &startCallbackFunction);
+
+  /**
+   * Called on the motion core with true when new limits or bands were stored
+   */
+  void registerFinishCallback(MotionIdentifierFinishCallbackFunction const &finishCallbackFunction);
+
+public:
+  void setConfiguration(MotionIdentificationConfiguration const &configuration);
+  void setSweepConfiguration(ResonanceSweepConfiguration const &configuration);
+
+public:
+  [[nodiscard]] bool isRunning() const;
+
+public:
+  void start();
+  void startSweep();
+  void stop();
+
+public:
+  void setThrottlePosition(uint32_t throttlePositionInMillivolts);
+
+private:
+  void process() override;
+
+private:
+  void startRoutine(IMotionRoutine &routine);
+  void applyCommand();
+  void finish();
+  void storeMotionLimits();
+  void storeSpeedBands();
+
+private:
+  MotionIdentifierStartCallbackFunction m_startCallbackFunction;
+  MotionIdentifierFinishCallbackFunction m_finishCallbackFunction;
+
+private:
+  std::shared_ptr<MotorController> m_motorController;
+  IClockPtr m_clock;
+  StoragePtr m_storage;
+
+private:
+  MotionIdentificationConfiguration m_configuration;
+  ResonanceSweepConfiguration m_sweepConfiguration;
+  MotionIdentification m_identification;
+  ResonanceSweep m_resonanceSweep;
+  IMotionRoutine *m_routine;
+
+private:
+  MotionLimits m_limits;
+  SpeedBands m_speedBands;
+
+private:
+  float m_savedSpeed_InStepsPerSecond;
+  float m_savedAcceleration_InStepsPerSecondPerSecond;
+  float m_savedDeceleration_InStepsPerSecondPerSecond;
+
+private:
+  std::atomic<bool> m_isStartRequested;
+  std::atomic<bool> m_isSweepRequested;
+  std::atomic<bool> m_isStopRequested;
+  std::atomic<bool> m_isRunning;
+  std::atomic<uint32_t> m_throttlePosition_InMillivolts;
+};
+
+using MotionIdentifierPtr = std::shared_ptr<MotionIdentifier>;
@@ -0,0 +1,41 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <cstdint>
+
+enum MotionDirection {
+  MOTION_DIRECTION_OPENING = 0,
+  MOTION_DIRECTION_CLOSING
+};
+
+struct DirectionLimits {
+  float speed_InStepsPerSecond;
+  float acceleration_InStepsPerSecondPerSecond;
+};
+
+/**
+ * Highest speed and acceleration the throttle body follows without losing steps.
+ * Opening works against the return spring, closing is helped by it, so both are kept apart.
+ * The acceleration limit caps the deceleration of the same direction as well.
+ */
+struct MotionLimits {
+  DirectionLimits opening = {1500, 30000};
+  DirectionLimits closing = {1500, 30000};
+};
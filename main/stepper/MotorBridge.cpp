@@ -0,0 +1,91 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include "MotorBridge.hpp"
+
+MotorBridge::MotorBridge(std::shared_ptr<MotorController> motorController, MotorSetpointMailboxPtr setpointMailbox, MotorStatusMailboxPtr statusMailbox, IClockPtr clock) :
+    m_motorController(std::move(motorController)),
+    m_setpointMailbox(std::move(setpointMailbox)),
+    m_statusMailbox(std::move(statusMailbox)),
+    m_clock(std::move(clock)),
+    m_profileRamp(nullptr),
+    m_setpointSequence(0),
+    m_wakeRequest(0),
+    m_sleepRequest(0),
+    m_isSuspended(false) {
+}
+
+void MotorBridge::setProfileSelector(RidingProfileSelectorPtr profileSelector) {
+  m_profileRamp = std::make_unique<RidingProfileRamp>(std::move(profileSelector));
+
+  auto const &profile = m_profileRamp->getProfile();
+  m_motorController->setSpeed(profile.motorSpeed_InStepsPerSecond);
+  m_motorController->setAcceleration(profile.motorAcceleration_InStepsPerSecondPerSecond);
+  m_motorController->setDeceleration(profile.motorDeceleration_InStepsPerSecondPerSecond);
+}
+
+void MotorBridge::suspend() {
+  m_isSuspended = true;
+}
+
+void MotorBridge::resume() {
+  m_isSuspended = false;
+
+  // A sequence that cannot match makes the next process() read the latest setpoint again
+  m_setpointSequence = m_setpointMailbox->getSequence() - 1;
+}
+
+void MotorBridge::process() {
+  if (m_isSuspended) {
+    return;
+  }
+
+  if (m_profileRamp and m_profileRamp->update(m_clock->getTime_InUS())) {
+    auto const &profile = m_profileRamp->getProfile();
+
+    m_motorController->setSpeed(profile.motorSpeed_InStepsPerSecond);
+    m_motorController->setAcceleration(profile.motorAcceleration_InStepsPerSecondPerSecond);
+    m_motorController->setDeceleration(profile.motorDeceleration_InStepsPerSecondPerSecond);
+  }
+
+  if (m_setpointMailbox->getSequence() != m_setpointSequence) {
+    MotorSetpoint setpoint = {};
+    m_setpointSequence = m_setpointMailbox->read(setpoint);
+
+    // Sleep first, a wake published right after the sleep may overwrite it before it is read
+    if (setpoint.sleepRequest != m_sleepRequest) {
+      m_sleepRequest = setpoint.sleepRequest;
+      m_motorController->sleep();
+    }
+
+    if (setpoint.wakeRequest != m_wakeRequest) {
+      m_wakeRequest = setpoint.wakeRequest;
+      m_motorController->wakeUp();
+    }
+
+    if (not m_profileRamp) {
+      m_motorController->setSpeed(setpoint.speed);
+    }
+    m_motorController->setPosition(setpoint.position, setpoint.trace);
+  }
+
+  m_statusMailbox->write({
+      .position = m_motorController->getPosition(),
+      .distanceToTarget = m_motorController->getDistanceToTarget(),
+  });
+}
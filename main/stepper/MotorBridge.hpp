@@ -0,0 +1,87 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <memory>
+
+#include "executor/Node.hpp"
+#include "runtime/Mailbox.hpp"
+#include "clock/SystemClock.hpp"
+#include "profile/RidingProfileRamp.hpp"
+#include "stepper/MotorController.hpp"
+#include "trace/TraceTag.hpp"
+
+struct MotorSetpoint {
+  uint32_t position;
+  float speed;
+  uint32_t wakeRequest;
+  uint32_t sleepRequest;
+  TraceTag trace;
+};
+
+struct MotorStatus {
+  int32_t position;
+  int32_t distanceToTarget;
+};
+
+using MotorSetpointMailboxPtr = std::shared_ptr<Mailbox<MotorSetpoint>>;
+using MotorStatusMailboxPtr = std::shared_ptr<Mailbox<MotorStatus>>;
+
+/**
+ * Runs next to MotorController on the motion core.
+ * Applies setpoints published by the control core and publishes the motor status back.
+ */
+class MotorBridge : public executor::Node {
+public:
+  MotorBridge(std::shared_ptr<MotorController> motorController, MotorSetpointMailboxPtr setpointMailbox, MotorStatusMailboxPtr statusMailbox, IClockPtr clock = getSystemClock());
+  ~MotorBridge() override = default;
+
+public:
+  /**
+   * Motor speed and ramps follow the selected riding profile, the setpoint speed is ignored from then on
+   */
+  void setProfileSelector(RidingProfileSelectorPtr profileSelector);
+
+public:
+  /**
+   * Stop applying setpoints while something else drives the motor, resume applies the latest one again
+   */
+  void suspend();
+  void resume();
+
+private:
+  void process() override;
+
+private:
+  std::shared_ptr<MotorController> m_motorController;
+  MotorSetpointMailboxPtr m_setpointMailbox;
+  MotorStatusMailboxPtr m_statusMailbox;
+
+private:
+  IClockPtr m_clock;
+  RidingProfileRampPtr m_profileRamp;
+
+private:
+  uint32_t m_setpointSequence;
+  uint32_t m_wakeRequest;
+  uint32_t m_sleepRequest;
+
+private:
+  bool m_isSuspended;
+};
@@ -19,98 +19,329 @@
 #include "MotorController.hpp"
 
 #include <thread>
-#include <esp_log.h>
-#include <esp_timer.h>
+#include <cstdlib>
+#include <algorithm>
 
 #include "MotorDriver.hpp"
+#include "log/DeferredLog.hpp"
 
-constexpr char const *tag = "motor_controller";
+// Positions and speeds of this class are in fine microsteps, the library works in the currently selected microstep
+constexpr uint32_t const fineMicrostep = 32;
+constexpr uint32_t const coarseMicrostep = 8;
 
-MotorController::MotorController(float const minSpeed, float const maxSpeed, uint32_t const maxSteps) :
+// Mode pins are only switched where every microstep table shares the same current vector
+constexpr int32_t const fullStep_InSteps = fineMicrostep;
+
+// The translator passes its home state once per electrical cycle, every four full steps
+constexpr int32_t const translatorCycle_InSteps = 4 * fullStep_InSteps;
+
+// Moves longer than this run in coarse microsteps
+constexpr int32_t const coarseDistance_InSteps = 4 * fullStep_InSteps;
+
+// The maximal speed is a step pulse rate, in coarse microsteps every pulse covers this many fine microsteps
+constexpr uint32_t const coarseStepRatio = fineMicrostep / coarseMicrostep;
+
+namespace {
+
+int32_t alignToFullStep(int32_t const position_InSteps) {
+  if (position_InSteps <= 0) {
+    return 0;
+  }
+
+  return (position_InSteps + fullStep_InSteps / 2) / fullStep_InSteps * fullStep_InSteps;
+}
+
+}// namespace
+
+MotorController::MotorController(float const minSpeed, float const maxSpeed, uint32_t const maxSteps, IClockPtr clock) :
     m_maxSteps(maxSteps),
-    m_sleepAfterMotion_InUS(5 * 1000000),
     m_maxSpeed(maxSpeed),
     m_minSpeed(minSpeed),
-    m_motorDriver(std::make_shared<MotorDriver>()),
+    m_clock(std::move(clock)),
+    m_motorDriver(std::make_shared<MotorDriver>(m_clock)),
     m_motorController(std::make_unique<motor::MotorController>(m_motorDriver)),
+    m_powerManager(),
     m_speed(m_maxSpeed),
-    m_lastMotionTime_InUS(0) {
-  m_motorController->setMicrostep(32);
+    m_acceleration(0),
+    m_deceleration(0),
+    m_motionLimits(),
+    m_speedBands(),
+    m_powerState(DRIVER_POWER_STATE_ACTIVE),
+    m_microstep(fineMicrostep),
+    m_targetPosition_InSteps(0),
+    m_isHomeLost(false) {
+  m_motorController->setMicrostep(m_microstep);
 }
 
 void MotorController::setSpeed(float const speed) {
+  auto const previousSpeed = m_speed;
+
   m_speed = speed;
 
-  if (m_speed > m_maxSpeed) {
-    m_speed = m_maxSpeed;
+  if (m_speed > m_maxSpeed * coarseStepRatio) {
+    m_speed = m_maxSpeed * coarseStepRatio;
   }
 
   if (m_speed < m_minSpeed) {
     m_speed = m_minSpeed;
   }
+
+  if (m_speed != previousSpeed) {
+    applyMovingTarget();
+  }
 }
 
 void MotorController::setAcceleration(float const acceleration) {
-  m_motorController->setAccelerationInStepsPerSecondPerSecond(acceleration);
+  if (acceleration == m_acceleration) {
+    return;
+  }
+
+  m_acceleration = acceleration;
+  m_motorController->setAccelerationInStepsPerSecondPerSecond(m_acceleration / getStepRatio());
+
+  applyMovingTarget();
 }
 
 void MotorController::setDeceleration(float const deceleration) {
-  m_motorController->setDecelerationInStepsPerSecondPerSecond(deceleration);
+  if (deceleration == m_deceleration) {
+    return;
+  }
+
+  m_deceleration = deceleration;
+  m_motorController->setDecelerationInStepsPerSecondPerSecond(m_deceleration / getStepRatio());
+
+  applyMovingTarget();
+}
+
+void MotorController::setPowerPolicy(DriverPowerPolicy const &powerPolicy) {
+  m_powerManager.setPolicy(powerPolicy);
 }
 
-void MotorController::setPosition(uint32_t const position) {
+void MotorController::setMotionLimits(MotionLimits const &motionLimits) {
+  m_motionLimits = motionLimits;
+}
+
+float MotorController::getSpeed() const {
+  return m_speed;
+}
+
+float MotorController::getAcceleration() const {
+  return m_acceleration;
+}
+
+float MotorController::getDeceleration() const {
+  return m_deceleration;
+}
+
+void MotorController::setSpeedBands(SpeedBands const &speedBands) {
+  m_speedBands = speedBands;
+}
+
+void MotorController::setLatencyHistogram(LatencyHistogramPtr latencyHistogram) {
+  m_motorDriver->setLatencyHistogram(std::move(latencyHistogram));
+}
+
+int32_t MotorController::getPosition() const {
+  return m_motorController->getCurrentPositionInSteps() * getStepRatio();
+}
+
+int32_t MotorController::getDistanceToTarget() const {
+  return m_targetPosition_InSteps - getPosition();
+}
+
+bool MotorController::inHome() const {
+  return m_motorDriver->inHome();
+}
+
+void MotorController::setPosition(uint32_t const position, TraceTag const traceTag) {
+  auto const targetPosition_InSteps = static_cast<int32_t>(position * m_maxSteps / 100);
+  if (targetPosition_InSteps == m_targetPosition_InSteps and m_motorDriver->isEnabled()) {
+    return;
+  }
+
   if (not m_motorDriver->isEnabled()) {
     m_motorDriver->enable();
   }
 
-  if (m_motorDriver->isSleeping()) {
-    m_motorDriver->wake();
-  }
+  wakeUp();
 
-  auto const position_InSteps = position * m_maxSteps / 100;
-  auto const distanceToTargetSigned = m_motorController->getDistanceToTargetSigned();
+  m_targetPosition_InSteps = targetPosition_InSteps;
 
-  if (distanceToTargetSigned > 0) {
-    m_motorController->setSpeedInStepsPerSecond(m_speed);
-  }
+  // An untraced target or one the motor already stands on must not leave an older tag to close on its steps
+  m_motorDriver->traceNextStep(getPosition() == m_targetPosition_InSteps ? TraceTag{} : traceTag);
 
-  if (distanceToTargetSigned < 0) {
-    m_motorController->setSpeedInStepsPerSecond(m_maxSpeed);
+  if (m_motorController->getDistanceToTargetSigned() == 0) {
+    return selectMicrostep();
   }
 
-  m_motorController->setTargetPositionInSteps(static_cast<int32_t>(position_InSteps));
+  applyTarget();
 }
 
 void MotorController::moveToHome() {
-  auto const stepsToHome = static_cast<int32_t>(-m_maxSteps);
-  ESP_LOGI(tag, "Moving relative %ld steps", stepsToHome);
+  // At least the whole range, in whole translator cycles
+  auto const cycles = (static_cast<int32_t>(m_maxSteps) + translatorCycle_InSteps - 1) / translatorCycle_InSteps;
+  auto const stepsToHome = -cycles * translatorCycle_InSteps;
+  deferredLog(LOG_MOTOR_CONTROLLER_MOVING_HOME, stepsToHome);
 
   m_motorDriver->enable();
   m_motorDriver->wake();
+  switchMicrostep(fineMicrostep);
+  m_targetPosition_InSteps = 0;
+  m_isHomeLost = false;
+
+  // The reset comes before the travel, the rotor may jump by up to two full steps here where it does not matter.
+  // Whole cycles from the home state end in the home state again at the stop, so zero is a full step on the translator grid.
+  // Resetting at the stop instead would move the field, and with it the zero, by up to two full steps.
+  m_motorDriver->resetTranslator();
+  m_motorController->setCurrentPositionInSteps(0);
+
   m_motorController->setSpeedInStepsPerSecond(m_maxSpeed);
   m_motorController->moveToPositionInSteps(stepsToHome);
   m_motorController->setCurrentPositionAsHomeAndStop();
 }
 
+void MotorController::wakeUp() {
+  m_powerManager.requestWake(m_clock->getTime_InUS());
+  applyPowerState();
+}
+
+void MotorController::sleep() {
+  m_powerManager.requestSleep();
+  applyPowerState();
+}
+
 void MotorController::process() {
   if (not m_motorDriver->isEnabled()) {
     return;
   }
 
-  if (m_motorDriver->isSleeping()) {
+  auto const isMoving = m_motorController->getDistanceToTargetSigned() != 0;
+  auto const speed = m_motorController->getCurrentVelocityInStepsPerSecond() * static_cast<float>(getStepRatio());
+
+  m_powerManager.update(m_clock->getTime_InUS(), speed, isMoving, isClosed());
+  applyPowerState();
+
+  if (not m_powerManager.isReady()) {
     return;
   }
 
+  if (m_isHomeLost) {
+    auto const targetPosition_InSteps = m_targetPosition_InSteps;
+    moveToHome();
+    m_targetPosition_InSteps = targetPosition_InSteps;
+
+    return selectMicrostep();
+  }
+
   m_motorController->processMovement();
 
-  if (not m_motorController->isHomed()) {
-    m_lastMotionTime_InUS = esp_timer_get_time();
+  if (not isMoving) {
+    selectMicrostep();
+  }
+}
+
+int32_t MotorController::getStepRatio() const {
+  return static_cast<int32_t>(fineMicrostep / m_microstep);
+}
+
+bool MotorController::isClosed() const {
+  return m_targetPosition_InSteps == 0 and getPosition() == 0;
+}
+
+void MotorController::applyTarget() {
+  auto const ratio = getStepRatio();
+  auto const distance_InSteps = m_targetPosition_InSteps - getPosition();
+
+  // The step pulse rate caps the speed, so a coarse slew reaches ratio times the speed of a fine one
+  auto const maxSpeed = m_maxSpeed * static_cast<float>(ratio);
+
+  // Opening follows the selected mode speed, closing is always as fast as the throttle body allows
+  auto const &limits = distance_InSteps > 0 ? m_motionLimits.opening : m_motionLimits.closing;
+  auto const speedLimit = std::min(maxSpeed, limits.speed_InStepsPerSecond);
+  auto const requestedSpeed = std::min(distance_InSteps > 0 ? m_speed : maxSpeed, speedLimit);
+
+  // The library only dwells at the set speed, ramps cross the bands without settling in them
+  auto const speed = speedBandsAvoid(m_speedBands, requestedSpeed, m_minSpeed, speedLimit);
+  auto const acceleration = std::min(m_acceleration, limits.acceleration_InStepsPerSecondPerSecond);
+  auto const deceleration = std::min(m_deceleration, limits.acceleration_InStepsPerSecondPerSecond);
+
+  m_motorController->setSpeedInStepsPerSecond(speed / static_cast<float>(ratio));
+  m_motorController->setAccelerationInStepsPerSecondPerSecond(acceleration / static_cast<float>(ratio));
+  m_motorController->setDecelerationInStepsPerSecondPerSecond(deceleration / static_cast<float>(ratio));
+
+  if (m_microstep == fineMicrostep) {
+    m_motorController->setTargetPositionInSteps(m_targetPosition_InSteps);
+    return;
+  }
+
+  // A coarse move ends on the full step nearest to the target, selectMicrostep() finishes it in fine steps
+  m_motorController->setTargetPositionInSteps(alignToFullStep(m_targetPosition_InSteps) / ratio);
+}
+
+void MotorController::applyMovingTarget() {
+  // setPosition() returns early for an unchanged target, a move in progress has to pick up new speeds and ramps here
+  if (m_motorController->getDistanceToTargetSigned() == 0) {
+    return;
+  }
+
+  applyTarget();
+}
+
+void MotorController::selectMicrostep() {
+  auto const position_InSteps = getPosition();
+  auto const distance_InSteps = m_targetPosition_InSteps - position_InSteps;
+
+  auto microstep = fineMicrostep;
+  if (std::abs(distance_InSteps) >= coarseDistance_InSteps and position_InSteps % fullStep_InSteps == 0) {
+    microstep = coarseMicrostep;
+  }
+
+  if (microstep == m_microstep) {
+    if (distance_InSteps != 0) {
+      applyTarget();
+    }
     return;
   }
 
-  auto const currentTime_InUS = esp_timer_get_time();
-  auto const timeWithoutMotion = currentTime_InUS - m_lastMotionTime_InUS;
-  if (timeWithoutMotion >= m_sleepAfterMotion_InUS) {
+  switchMicrostep(microstep);
+  applyTarget();
+}
+
+void MotorController::switchMicrostep(uint32_t const microstep) {
+  if (microstep == m_microstep) {
+    return;
+  }
+
+  // Only called at rest on a full step, so the position converts between units without remainder
+  auto const position_InSteps = getPosition();
+
+  m_microstep = microstep;
+  m_motorController->setMicrostep(m_microstep);
+  m_motorController->setCurrentPositionInSteps(position_InSteps / getStepRatio());
+
+  m_motorController->setAccelerationInStepsPerSecondPerSecond(m_acceleration / getStepRatio());
+  m_motorController->setDecelerationInStepsPerSecondPerSecond(m_deceleration / getStepRatio());
+}
+
+void MotorController::applyPowerState() {
+  m_motorDriver->setDecayMode(m_powerManager.getDecayMode());
+  m_motorDriver->setCurrent(m_powerManager.getCurrent_InPercentage());
+
+  auto const powerState = m_powerManager.getState();
+  if (powerState == m_powerState) {
+    return;
+  }
+
+  if (powerState == DRIVER_POWER_STATE_SLEEP) {
     m_motorDriver->sleep();
+
+    // Unpowered away from the stop the spring moves the throttle, the step count is only trusted again after homing
+    m_isHomeLost = m_isHomeLost or not isClosed();
+  }
+
+  if (powerState == DRIVER_POWER_STATE_WAKING) {
+    m_motorDriver->wake();
   }
+
+  m_powerState = powerState;
 }
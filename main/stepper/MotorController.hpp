@@ -19,6 +19,11 @@
 #pragma once
 
 #include "stepper/MotorDriver.hpp"
+#include "stepper/SpeedBands.hpp"
+#include "stepper/MotionLimits.hpp"
+#include "stepper/DriverPowerManager.hpp"
+#include "trace/TraceTag.hpp"
+#include "trace/LatencyHistogram.hpp"
 #include "executor/Node.hpp"
 #include "motor/MotorController.hpp"
 #include "motor/interface/ILimiter.hpp"
@@ -26,34 +31,86 @@
 
 class MotorController : public executor::Node {
 public:
-  explicit MotorController(float minSpeed = 100, float maxSpeed = 1000, uint32_t maxSteps = 200);
+  explicit MotorController(float minSpeed = 100, float maxSpeed = 1000, uint32_t maxSteps = 200, IClockPtr clock = getSystemClock());
   ~MotorController() override = default;
 
 public:
   void setSpeed(float speed);
   void setAcceleration(float acceleration);
   void setDeceleration(float deceleration);
+  void setPowerPolicy(DriverPowerPolicy const &powerPolicy);
+
+  /**
+   * Caps the selected speed and ramps per direction, applied from the next target on
+   */
+  void setMotionLimits(MotionLimits const &motionLimits);
+
+  /**
+   * Cruise speeds are kept out of the bands, ramps still pass through them
+   */
+  void setSpeedBands(SpeedBands const &speedBands);
+
+  /**
+   * Pedal to step latencies of traced setpoints are recorded here
+   */
+  void setLatencyHistogram(LatencyHistogramPtr latencyHistogram);
+
+public:
+  [[nodiscard]] float getSpeed() const;
+  [[nodiscard]] float getAcceleration() const;
+  [[nodiscard]] float getDeceleration() const;
+
+public:
+  [[nodiscard]] int32_t getPosition() const;
+  [[nodiscard]] int32_t getDistanceToTarget() const;
+  [[nodiscard]] bool inHome() const;
 
 public:
-  void setPosition(uint32_t position);
+  /**
+   * @param traceTag Closed by the first step edge the new target causes
+   */
+  void setPosition(uint32_t position, TraceTag traceTag = {});
 
 public:
   void moveToHome();
+  void wakeUp();
+  void sleep();
 
 private:
   void process() override;
 
+private:
+  [[nodiscard]] int32_t getStepRatio() const;
+  [[nodiscard]] bool isClosed() const;
+
+private:
+  void applyTarget();
+  void applyMovingTarget();
+  void selectMicrostep();
+  void switchMicrostep(uint32_t microstep);
+  void applyPowerState();
+
 private:
   uint32_t const m_maxSteps;
-  uint32_t const m_sleepAfterMotion_InUS;
   float const m_maxSpeed;
   float const m_minSpeed;
 
 private:
-  IDriverPtr m_motorDriver;
+  IClockPtr m_clock;
+  std::shared_ptr<MotorDriver> m_motorDriver;
   MotorControllerPtr m_motorController;
+  DriverPowerManager m_powerManager;
 
 private:
   float m_speed;
-  uint32_t m_lastMotionTime_InUS;
+  float m_acceleration;
+  float m_deceleration;
+  MotionLimits m_motionLimits;
+  SpeedBands m_speedBands;
+  DriverPowerState m_powerState;
+
+private:
+  uint32_t m_microstep;
+  int32_t m_targetPosition_InSteps;
+  bool m_isHomeLost;
 };
@@ -19,23 +19,43 @@
 #include "MotorDriver.hpp"
 
 #include <thread>
-#include <esp_timer.h>
 
-#include "gpio/InputPin.hpp"
-#include "gpio/OutputPin.hpp"
+#ifdef ESP_PLATFORM
+#include <driver/ledc.h>
+#endif
 
-MotorDriver::MotorDriver() : m_stepPin(std::make_unique<gpio::OutputPin>(11)),
-                             m_decayPin(std::make_unique<gpio::OutputPin>(14, gpio::PIN_LEVEL_HIGH)),
-                             m_mode0Pin(std::make_unique<gpio::OutputPin>(10)),
-                             m_mode1Pin(std::make_unique<gpio::OutputPin>(9)),
-                             m_mode2Pin(std::make_unique<gpio::OutputPin>(20)),
-                             m_resetPin(std::make_unique<gpio::OutputPin>(48, gpio::PIN_LEVEL_HIGH)),
-                             m_sleepPin(std::make_unique<gpio::OutputPin>(47, gpio::PIN_LEVEL_HIGH)),
-                             m_enablePin(std::make_unique<gpio::OutputPin>(12)),
-                             m_directionPin(std::make_unique<gpio::OutputPin>(13)),
+#include "board/Board.hpp"
+#include "board/Gpio.hpp"
+#include "gpio/InputPin.hpp"
 
-                             m_inHomePin(std::make_unique<gpio::InputPin>(19, gpio::PIN_LEVEL_HIGH)),
-                             m_isFaultPin(std::make_unique<gpio::InputPin>(21, gpio::PIN_LEVEL_HIGH)),
+// The DRV8825 regulates the winding current to VREF with its own chopper, so the current is lowered through VREF.
+// Where the board has it, VREF is a LEDC output behind an RC low pass, full scale gives the run current.
+constexpr bool const hasCurrentReference = Board::currentReferencePinNumber >= 0;
+constexpr uint32_t const referenceDutyResolution_InBits = 10;
+constexpr uint32_t const referenceDutyMaximum = 1 << referenceDutyResolution_InBits;
+constexpr uint32_t const referenceSupplyVoltage_InMillivolts = 3300;
+
+#ifdef ESP_PLATFORM
+constexpr ledc_mode_t const referenceSpeedMode = LEDC_LOW_SPEED_MODE;
+constexpr ledc_timer_t const referenceTimer = LEDC_TIMER_0;
+constexpr ledc_channel_t const referenceChannel = LEDC_CHANNEL_0;
+constexpr uint32_t const referenceFrequency_InHertz = 40000;
+#endif
+
+// Low time of nRESET, comfortably above what the DRV8825 latches
+constexpr uint32_t const resetPulseTime_InUS = 5;
+
+// MODE2..MODE0 of the DRV8825, one pattern per microstep
+constexpr auto const microstep1Pattern = Board::ModePins::pattern(0b000);
+constexpr auto const microstep2Pattern = Board::ModePins::pattern(0b001);
+constexpr auto const microstep4Pattern = Board::ModePins::pattern(0b010);
+constexpr auto const microstep8Pattern = Board::ModePins::pattern(0b011);
+constexpr auto const microstep16Pattern = Board::ModePins::pattern(0b100);
+constexpr auto const microstep32Pattern = Board::ModePins::pattern(0b101);
+
+MotorDriver::MotorDriver(IClockPtr clock) : m_clock(std::move(clock)),
+                             m_inHomePin(std::make_unique<gpio::InputPin>(Board::inHomePinNumber, gpio::PIN_LEVEL_HIGH)),
+                             m_isFaultPin(std::make_unique<gpio::InputPin>(Board::faultPinNumber, gpio::PIN_LEVEL_HIGH)),
 
                              m_stepMinimalTime(2),
                              m_stepUpTime(0),
@@ -44,73 +64,125 @@ MotorDriver::MotorDriver() : m_stepPin(std::make_unique<gpio::OutputPin>(11)),
                              m_minimalPeriod(1 / 250000),
                              m_lastStepTime(0),
 
+                             m_latencyHistogram(nullptr),
+                             m_pendingTraceTag(),
+
                              m_isEnabled(false),
                              m_isSleeping(false),
-                             m_microstep(1) {
+                             m_microstep(1),
+                             m_decayMode(DECAY_MODE_FAST),
+                             m_current_InPercentage(100) {
+  // Out of reset, awake, outputs disabled, fast decay, everything else low
+  board::gpioWriteGroup<Board::DriverOutputPins>(0);
+  board::gpioWrite<Board::DecayPin>(true);
+  board::gpioConfigureOutputs(Board::DriverOutputPins::mask());
+
+#ifdef ESP_PLATFORM
+  if constexpr (hasCurrentReference) {
+    ledc_timer_config_t const referenceTimerConfiguration = {
+        .speed_mode = referenceSpeedMode,
+        .duty_resolution = static_cast<ledc_timer_bit_t>(referenceDutyResolution_InBits),
+        .timer_num = referenceTimer,
+        .freq_hz = referenceFrequency_InHertz,
+        .clk_cfg = LEDC_AUTO_CLK,
+    };
+    ESP_ERROR_CHECK(ledc_timer_config(&referenceTimerConfiguration));
+
+    ledc_channel_config_t const referenceChannelConfiguration = {
+        .gpio_num = Board::currentReferencePinNumber,
+        .speed_mode = referenceSpeedMode,
+        .channel = referenceChannel,
+        .intr_type = LEDC_INTR_DISABLE,
+        .timer_sel = referenceTimer,
+        .duty = 0,
+        .hpoint = 0,
+    };
+    ESP_ERROR_CHECK(ledc_channel_config(&referenceChannelConfiguration));
+  }
+#endif
+
+  applyCurrentReference();
+
   MotorDriver::setDirection(motor::driver::MOTOR_ROTATE_CW);
   MotorDriver::setMicrostep(motor::driver::MOTOR_FULL_STEP);
 }
 
-//uint32_t MotorDriver::getMicrostep() const {
-//  return m_microstep;
-//}
+uint32_t MotorDriver::getMicrostep() const {
+  return m_microstep;
+}
 
 void MotorDriver::setDirection(int8_t direction) {
   if (direction == motor::driver::MOTOR_ROTATE_CW) {
-    m_directionPin->setLevel(gpio::PIN_LEVEL_LOW);
+    board::gpioWrite<Board::DirectionPin>(false);
   }
 
   if (direction == motor::driver::MOTOR_ROTATE_CCW) {
-    m_directionPin->setLevel(gpio::PIN_LEVEL_HIGH);
+    board::gpioWrite<Board::DirectionPin>(true);
+  }
+}
+
+void MotorDriver::setDecayMode(DecayMode const decayMode) {
+  if (decayMode == m_decayMode) {
+    return;
+  }
+
+  m_decayMode = decayMode;
+
+  if (decayMode == DECAY_MODE_FAST) {
+    board::gpioWrite<Board::DecayPin>(true);
+  }
+
+  if (decayMode == DECAY_MODE_SLOW) {
+    board::gpioWrite<Board::DecayPin>(false);
   }
 }
 
+void MotorDriver::setCurrent(uint8_t const currentInPercentage) {
+  auto const current_InPercentage = currentInPercentage > 100 ? static_cast<uint8_t>(100) : currentInPercentage;
+
+  if (current_InPercentage == m_current_InPercentage) {
+    return;
+  }
+
+  m_current_InPercentage = current_InPercentage;
+
+  applyCurrentReference();
+}
+
 void MotorDriver::setMicrostep(uint32_t const microstep) {
   if (microstep >= 32) {
     m_microstep = 32;
-    m_mode0Pin->setLevel(gpio::PIN_LEVEL_HIGH);
-    m_mode1Pin->setLevel(gpio::PIN_LEVEL_LOW);
-    m_mode2Pin->setLevel(gpio::PIN_LEVEL_HIGH);
+    board::gpioApply(microstep32Pattern);
     return;
   }
 
   if (microstep >= 16) {
     m_microstep = 16;
-    m_mode0Pin->setLevel(gpio::PIN_LEVEL_LOW);
-    m_mode1Pin->setLevel(gpio::PIN_LEVEL_LOW);
-    m_mode2Pin->setLevel(gpio::PIN_LEVEL_HIGH);
+    board::gpioApply(microstep16Pattern);
     return;
   }
 
   if (microstep >= 8) {
     m_microstep = 8;
-    m_mode0Pin->setLevel(gpio::PIN_LEVEL_HIGH);
-    m_mode1Pin->setLevel(gpio::PIN_LEVEL_HIGH);
-    m_mode2Pin->setLevel(gpio::PIN_LEVEL_LOW);
+    board::gpioApply(microstep8Pattern);
     return;
   }
 
   if (microstep >= 4) {
     m_microstep = 4;
-    m_mode0Pin->setLevel(gpio::PIN_LEVEL_LOW);
-    m_mode1Pin->setLevel(gpio::PIN_LEVEL_HIGH);
-    m_mode2Pin->setLevel(gpio::PIN_LEVEL_LOW);
+    board::gpioApply(microstep4Pattern);
     return;
   }
 
   if (microstep >= 2) {
     m_microstep = 2;
-    m_mode0Pin->setLevel(gpio::PIN_LEVEL_HIGH);
-    m_mode1Pin->setLevel(gpio::PIN_LEVEL_LOW);
-    m_mode2Pin->setLevel(gpio::PIN_LEVEL_LOW);
+    board::gpioApply(microstep2Pattern);
     return;
   }
 
   if (microstep >= 1) {
     m_microstep = 1;
-    m_mode0Pin->setLevel(gpio::PIN_LEVEL_LOW);
-    m_mode1Pin->setLevel(gpio::PIN_LEVEL_LOW);
-    m_mode2Pin->setLevel(gpio::PIN_LEVEL_LOW);
+    board::gpioApply(microstep1Pattern);
     return;
   }
 }
@@ -119,40 +191,77 @@ bool MotorDriver::isEnabled() const {
   return m_isEnabled;
 }
 
-//bool MotorDriver::isSleeping() const {
-//  return m_isSleeping;
-//}
+bool MotorDriver::isSleeping() const {
+  return m_isSleeping;
+}
+
+bool MotorDriver::inHome() const {
+  return m_inHomePin->getLevel() == gpio::PIN_LEVEL_LOW;
+}
 
-//bool MotorDriver::inHome() const {
-//  return m_inHomePin->getLevel() == gpio::PIN_LEVEL_LOW;
-//}
+bool MotorDriver::isFault() const {
+  return m_isFaultPin->getLevel() == gpio::PIN_LEVEL_LOW;
+}
 
-//bool MotorDriver::isFault() const {
-//  return m_isFaultPin->getLevel() == gpio::PIN_LEVEL_LOW;
-//}
+bool MotorDriver::hasCurrentControl() {
+  return hasCurrentReference;
+}
+
+uint8_t MotorDriver::getCurrent_InPercentage() const {
+  return m_current_InPercentage;
+}
 
 void MotorDriver::enable() {
-  m_enablePin->setLevel(gpio::PIN_LEVEL_LOW);
+  board::gpioWrite<Board::EnablePin>(true);
   m_isEnabled = true;
 }
 
 void MotorDriver::disable() {
-  m_enablePin->setLevel(gpio::PIN_LEVEL_HIGH);
+  board::gpioWrite<Board::EnablePin>(false);
   m_isEnabled = false;
 }
 
-//void MotorDriver::sleep() {
-//  m_sleepPin->setLevel(gpio::PIN_LEVEL_LOW);
-//  m_isSleeping = true;
-//}
+void MotorDriver::applyCurrentReference() {
+  if constexpr (hasCurrentReference) {
+    auto const reference_InMillivolts = Board::currentReferenceFullScale_InMillivolts * m_current_InPercentage / 100;
+    auto const duty = referenceDutyMaximum * reference_InMillivolts / referenceSupplyVoltage_InMillivolts;
+
+#ifdef ESP_PLATFORM
+    ESP_ERROR_CHECK(ledc_set_duty(referenceSpeedMode, referenceChannel, duty));
+    ESP_ERROR_CHECK(ledc_update_duty(referenceSpeedMode, referenceChannel));
+#else
+    // There is no LEDC on the host, only the duty is worked out
+    static_cast<void>(duty);
+#endif
+  }
+}
 
-//void MotorDriver::wake() {
-//  m_sleepPin->setLevel(gpio::PIN_LEVEL_HIGH);
-//  m_isSleeping = false;
-//}
+void MotorDriver::sleep() {
+  board::gpioWrite<Board::SleepPin>(true);
+  m_isSleeping = true;
+}
+
+void MotorDriver::wake() {
+  board::gpioWrite<Board::SleepPin>(false);
+  m_isSleeping = false;
+}
+
+void MotorDriver::resetTranslator() {
+  board::gpioWrite<Board::ResetPin>(true);
+  std::this_thread::sleep_for(std::chrono::microseconds(resetPulseTime_InUS));
+  board::gpioWrite<Board::ResetPin>(false);
+}
+
+void MotorDriver::setLatencyHistogram(LatencyHistogramPtr latencyHistogram) {
+  m_latencyHistogram = std::move(latencyHistogram);
+}
+
+void MotorDriver::traceNextStep(TraceTag const traceTag) {
+  m_pendingTraceTag = traceTag;
+}
 
 void MotorDriver::stepUp() {
-  auto const currentTime = esp_timer_get_time();
+  auto const currentTime = m_clock->getTime_InUS();
 
   auto const timeBetweenSteps = currentTime - m_lastStepTime;
   auto const timeBetweenEdges = currentTime - m_stepDownTime;
@@ -165,12 +274,17 @@ void MotorDriver::stepUp() {
     }
   }
 
-  m_stepPin->setLevel(gpio::PIN_LEVEL_HIGH);
-  m_stepUpTime = esp_timer_get_time();
+  board::gpioWrite<Board::StepPin>(true);
+  m_stepUpTime = m_clock->getTime_InUS();
+
+  if (m_pendingTraceTag.sequence != 0 and m_latencyHistogram) {
+    m_latencyHistogram->record(static_cast<uint32_t>(m_stepUpTime - m_pendingTraceTag.time_InUS));
+    m_pendingTraceTag = {};
+  }
 }
 
 void MotorDriver::stepDown() {
-  auto const currentTime = esp_timer_get_time();
+  auto const currentTime = m_clock->getTime_InUS();
 
   auto const timeBetweenEdges = currentTime - m_stepUpTime;
 
@@ -178,6 +292,6 @@ void MotorDriver::stepDown() {
     std::this_thread::sleep_for(std::chrono::microseconds(timeBetweenEdges));
   }
 
-  m_stepPin->setLevel(gpio::PIN_LEVEL_LOW);
-  m_stepDownTime = m_lastStepTime = esp_timer_get_time();
+  board::gpioWrite<Board::StepPin>(false);
+  m_stepDownTime = m_lastStepTime = m_clock->getTime_InUS();
 }
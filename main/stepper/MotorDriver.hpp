@@ -22,16 +22,18 @@
 
 #include "gpio/PinLevel.hpp"
 #include "gpio/interface/IInputPin.hpp"
-#include "gpio/interface/IOutputPin.hpp"
 #include "motor/driver/interface/IDriver.hpp"
+#include "clock/SystemClock.hpp"
+#include "stepper/DriverPowerManager.hpp"
+#include "trace/TraceTag.hpp"
+#include "trace/LatencyHistogram.hpp"
 
 using PinLevel = gpio::PinLevel;
 using PinInput = IInputPinPtr<PinLevel>;
-using PinOutput = IOutputPinPtr<PinLevel>;
 
 class MotorDriver : public motor::driver::interface::IDriver {
 public:
-  MotorDriver();
+  explicit MotorDriver(IClockPtr clock = getSystemClock());
   ~MotorDriver() override = default;
 
 public:
@@ -41,6 +43,18 @@ public:
   void setDirection(int8_t direction) override;
   void setMicrostep(uint32_t microstep) override;
 
+public:
+  void setDecayMode(DecayMode decayMode);
+
+  /**
+   * Share of the run current through VREF, the driver's own chopper regulates to it.
+   * Has no effect on a board without a VREF output, see hasCurrentControl().
+   */
+  void setCurrent(uint8_t currentInPercentage);
+
+  [[nodiscard]] static bool hasCurrentControl();
+  [[nodiscard]] uint8_t getCurrent_InPercentage() const;
+
 public:
   [[nodiscard]] bool isEnabled() const override;
   [[nodiscard]] bool isSleeping() const override;
@@ -55,20 +69,25 @@ public:
   void sleep() override;
   void wake() override;
 
+  /**
+   * Pulses nRESET, the translator returns to its home state, a full step in every microstep mode
+   */
+  void resetTranslator();
+
+public:
+  void setLatencyHistogram(LatencyHistogramPtr latencyHistogram);
+
+  /**
+   * The next step edge closes the trace, a newer tag replaces one that did not get a step yet
+   */
+  void traceNextStep(TraceTag traceTag);
+
 public:
   void stepUp() override;
   void stepDown() override;
 
 private:
-  PinOutput m_stepPin;
-  PinOutput m_decayPin;
-  PinOutput m_mode0Pin;
-  PinOutput m_mode1Pin;
-  PinOutput m_mode2Pin;
-  PinOutput m_resetPin;
-  PinOutput m_sleepPin;
-  PinOutput m_enablePin;
-  PinOutput m_directionPin;
+  IClockPtr m_clock;
 
 private:
   PinInput m_inHomePin;
@@ -76,15 +95,24 @@ private:
 
 private:
   uint32_t const m_stepMinimalTime;
-  uint32_t m_stepUpTime;
-  uint32_t m_stepDownTime;
+  uint64_t m_stepUpTime;
+  uint64_t m_stepDownTime;
 
 private:
   uint32_t const m_minimalPeriod;
-  uint32_t m_lastStepTime;
+  uint64_t m_lastStepTime;
+
+private:
+  LatencyHistogramPtr m_latencyHistogram;
+  TraceTag m_pendingTraceTag;
+
+private:
+  void applyCurrentReference();
 
 private:
   bool m_isEnabled;
   bool m_isSleeping;
   uint32_t m_microstep;
+  DecayMode m_decayMode;
+  uint8_t m_current_InPercentage;
 };
@@ -0,0 +1,169 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include "ResonanceSweep.hpp"
+
+ResonanceSweep::ResonanceSweep(ResonanceSweepConfiguration const &configuration) : m_configuration(configuration),
+                                                                                   m_state(RESONANCE_SWEEP_STATE_IDLE),
+                                                                                   m_command(),
+                                                                                   m_speedBands(),
+                                                                                   m_isCommandChanged(false),
+                                                                                   m_speed_InStepsPerSecond(0),
+                                                                                   m_repetition(0),
+                                                                                   m_moveStartTime_InUS(0),
+                                                                                   m_arrivalTime_InUS(0),
+                                                                                   m_isArrived(false),
+                                                                                   m_isHomeSeen(false),
+                                                                                   m_homeSeenPosition_InSteps(0) {
+}
+
+void ResonanceSweep::setConfiguration(ResonanceSweepConfiguration const &configuration) {
+  m_configuration = configuration;
+}
+
+ResonanceSweepState ResonanceSweep::getState() const {
+  return m_state;
+}
+
+bool ResonanceSweep::isRunning() const {
+  return m_state == RESONANCE_SWEEP_STATE_HOMING or m_state == RESONANCE_SWEEP_STATE_OPENING or m_state == RESONANCE_SWEEP_STATE_CLOSING;
+}
+
+bool ResonanceSweep::isSucceeded() const {
+  return m_state == RESONANCE_SWEEP_STATE_DONE;
+}
+
+MotionCommand const &ResonanceSweep::getCommand() const {
+  return m_command;
+}
+
+SpeedBands const &ResonanceSweep::getSpeedBands() const {
+  return m_speedBands;
+}
+
+void ResonanceSweep::start(uint64_t const timeInUS) {
+  m_speedBands = {};
+  m_speed_InStepsPerSecond = m_configuration.startSpeed_InStepsPerSecond;
+  m_repetition = 0;
+
+  moveTo(timeInUS, RESONANCE_SWEEP_STATE_HOMING, 0);
+  m_command.isHomingRequested = true;
+}
+
+void ResonanceSweep::stop() {
+  if (not isRunning()) {
+    return;
+  }
+
+  m_state = RESONANCE_SWEEP_STATE_FAILED;
+}
+
+bool ResonanceSweep::update(uint64_t const timeInUS, MotionSample const &sample) {
+  if (not isRunning()) {
+    return false;
+  }
+
+  if (m_state == RESONANCE_SWEEP_STATE_HOMING) {
+    m_isCommandChanged = false;
+
+    moveTo(timeInUS, RESONANCE_SWEEP_STATE_OPENING, m_configuration.stroke_InPercentage);
+    return true;
+  }
+
+  if (sample.inHome and not m_isHomeSeen) {
+    m_isHomeSeen = true;
+    m_homeSeenPosition_InSteps = sample.position_InSteps;
+  }
+
+  auto isLost = false;
+
+  // A coarse slew passes the target and turns back to it in fine steps, only standing on it counts
+  if (sample.distanceToTarget_InSteps != 0) {
+    m_isArrived = false;
+  }
+
+  if (not m_isArrived) {
+    if (sample.distanceToTarget_InSteps == 0) {
+      m_isArrived = true;
+      m_arrivalTime_InUS = timeInUS;
+    } else if (timeInUS - m_moveStartTime_InUS >= m_configuration.moveTimeout_InUS) {
+      isLost = true;
+    }
+  }
+
+  if (m_isArrived and timeInUS - m_arrivalTime_InUS >= m_configuration.settleTime_InUS) {
+    if (m_state == RESONANCE_SWEEP_STATE_OPENING) {
+      moveTo(timeInUS, RESONANCE_SWEEP_STATE_CLOSING, 0);
+    } else if (not sample.inHome or m_homeSeenPosition_InSteps > m_configuration.homeTolerance_InSteps) {
+      isLost = true;
+    } else {
+      m_repetition += 1;
+
+      if (m_repetition < m_configuration.repetitions) {
+        moveTo(timeInUS, RESONANCE_SWEEP_STATE_OPENING, m_configuration.stroke_InPercentage);
+      } else {
+        nextSpeed(timeInUS);
+      }
+    }
+  }
+
+  if (isLost) {
+    auto const halfStep_InStepsPerSecond = m_configuration.speedStep_InStepsPerSecond / 2;
+    speedBandsAdd(m_speedBands, {m_speed_InStepsPerSecond - halfStep_InStepsPerSecond, m_speed_InStepsPerSecond + halfStep_InStepsPerSecond});
+
+    nextSpeed(timeInUS);
+
+    // The step counter is off after lost steps, the next speed starts from the stop again
+    m_command.isHomingRequested = true;
+  }
+
+  auto const isCommandChanged = m_isCommandChanged;
+  m_isCommandChanged = false;
+
+  return isCommandChanged;
+}
+
+void ResonanceSweep::moveTo(uint64_t const timeInUS, ResonanceSweepState const state, uint32_t const positionInPercentage) {
+  DirectionLimits const limits = {m_speed_InStepsPerSecond, m_configuration.acceleration_InStepsPerSecondPerSecond};
+
+  m_state = state;
+  m_command.position_InPercentage = positionInPercentage;
+  m_command.limits.opening = limits;
+  m_command.limits.closing = limits;
+  m_command.isHomingRequested = false;
+  m_isCommandChanged = true;
+
+  m_moveStartTime_InUS = timeInUS;
+  m_isArrived = false;
+  m_isHomeSeen = false;
+  m_homeSeenPosition_InSteps = 0;
+}
+
+void ResonanceSweep::nextSpeed(uint64_t const timeInUS) {
+  m_repetition = 0;
+  m_speed_InStepsPerSecond += m_configuration.speedStep_InStepsPerSecond;
+
+  if (m_speed_InStepsPerSecond > m_configuration.endSpeed_InStepsPerSecond) {
+    m_state = RESONANCE_SWEEP_STATE_DONE;
+    m_command.position_InPercentage = 0;
+    m_isCommandChanged = true;
+    return;
+  }
+
+  moveTo(timeInUS, RESONANCE_SWEEP_STATE_OPENING, m_configuration.stroke_InPercentage);
+}
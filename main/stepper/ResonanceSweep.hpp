@@ -0,0 +1,105 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <cstdint>
+
+#include "stepper/SpeedBands.hpp"
+#include "stepper/interface/IMotionRoutine.hpp"
+
+enum ResonanceSweepState {
+  RESONANCE_SWEEP_STATE_IDLE = 0,
+  RESONANCE_SWEEP_STATE_HOMING,
+  RESONANCE_SWEEP_STATE_OPENING,
+  RESONANCE_SWEEP_STATE_CLOSING,
+  RESONANCE_SWEEP_STATE_DONE,
+  RESONANCE_SWEEP_STATE_FAILED
+};
+
+struct ResonanceSweepConfiguration {
+  float startSpeed_InStepsPerSecond = 200;
+  float endSpeed_InStepsPerSecond = 4000;
+  float speedStep_InStepsPerSecond = 100;
+
+  // Steep ramps, most of the stroke is spent cruising at the tested speed
+  float acceleration_InStepsPerSecondPerSecond = 40000;
+
+  uint32_t stroke_InPercentage = 90;
+  uint32_t repetitions = 2;
+
+  int32_t homeTolerance_InSteps = 8;
+
+  uint32_t settleTime_InUS = 100 * 1000;
+  uint32_t moveTimeout_InUS = 3 * 1000000;
+};
+
+/**
+ * Finds the forbidden speed bands.
+ * Cruises through the stroke and back at each speed of the sweep and watches the home switch on the way back,
+ * a switch closing away from step zero or open at step zero means steps were lost at that speed.
+ * Every such speed becomes a band one sweep step wide, neighbours merge.
+ */
+class ResonanceSweep : public IMotionRoutine {
+public:
+  explicit ResonanceSweep(ResonanceSweepConfiguration const &configuration = {});
+  ~ResonanceSweep() override = default;
+
+public:
+  void setConfiguration(ResonanceSweepConfiguration const &configuration);
+
+public:
+  [[nodiscard]] ResonanceSweepState getState() const;
+  [[nodiscard]] bool isRunning() const override;
+  [[nodiscard]] bool isSucceeded() const override;
+
+public:
+  [[nodiscard]] MotionCommand const &getCommand() const override;
+  [[nodiscard]] SpeedBands const &getSpeedBands() const;
+
+public:
+  void start(uint64_t timeInUS) override;
+  void stop() override;
+
+public:
+  bool update(uint64_t timeInUS, MotionSample const &sample) override;
+
+private:
+  void moveTo(uint64_t timeInUS, ResonanceSweepState state, uint32_t positionInPercentage);
+  void nextSpeed(uint64_t timeInUS);
+
+private:
+  ResonanceSweepConfiguration m_configuration;
+
+private:
+  ResonanceSweepState m_state;
+  MotionCommand m_command;
+  SpeedBands m_speedBands;
+  bool m_isCommandChanged;
+
+private:
+  float m_speed_InStepsPerSecond;
+  uint32_t m_repetition;
+
+private:
+  uint64_t m_moveStartTime_InUS;
+  uint64_t m_arrivalTime_InUS;
+  bool m_isArrived;
+  bool m_isHomeSeen;
+  int32_t m_homeSeenPosition_InSteps;
+};
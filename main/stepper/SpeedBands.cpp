@@ -0,0 +1,90 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include "SpeedBands.hpp"
+
+#include <algorithm>
+
+void speedBandsAdd(SpeedBands &speedBands, SpeedBand band) {
+  auto &bands = speedBands.bands;
+
+  // Swallow every band the new one overlaps or touches, the survivors stay sorted
+  uint32_t numberOfBands = 0;
+  for (uint32_t i = 0; i < speedBands.numberOfBands; i++) {
+    if (bands[i].high_InStepsPerSecond >= band.low_InStepsPerSecond and bands[i].low_InStepsPerSecond <= band.high_InStepsPerSecond) {
+      band.low_InStepsPerSecond = std::min(band.low_InStepsPerSecond, bands[i].low_InStepsPerSecond);
+      band.high_InStepsPerSecond = std::max(band.high_InStepsPerSecond, bands[i].high_InStepsPerSecond);
+      continue;
+    }
+
+    bands[numberOfBands] = bands[i];
+    numberOfBands += 1;
+  }
+
+  if (numberOfBands == speedBandsMaximum) {
+    uint32_t nearest = 0;
+    float nearestDistance = 0;
+
+    for (uint32_t i = 0; i < numberOfBands; i++) {
+      auto const distance = bands[i].low_InStepsPerSecond > band.high_InStepsPerSecond ? bands[i].low_InStepsPerSecond - band.high_InStepsPerSecond : band.low_InStepsPerSecond - bands[i].high_InStepsPerSecond;
+
+      if (i == 0 or distance < nearestDistance) {
+        nearest = i;
+        nearestDistance = distance;
+      }
+    }
+
+    band.low_InStepsPerSecond = std::min(band.low_InStepsPerSecond, bands[nearest].low_InStepsPerSecond);
+    band.high_InStepsPerSecond = std::max(band.high_InStepsPerSecond, bands[nearest].high_InStepsPerSecond);
+
+    std::copy(bands.begin() + nearest + 1, bands.begin() + numberOfBands, bands.begin() + nearest);
+    numberOfBands -= 1;
+  }
+
+  auto position = numberOfBands;
+  while (position > 0 and bands[position - 1].low_InStepsPerSecond > band.low_InStepsPerSecond) {
+    bands[position] = bands[position - 1];
+    position -= 1;
+  }
+
+  bands[position] = band;
+  speedBands.numberOfBands = numberOfBands + 1;
+}
+
+float speedBandsAvoid(SpeedBands const &speedBands, float const speedInStepsPerSecond, float const minimalSpeedInStepsPerSecond, float const maximalSpeedInStepsPerSecond) {
+  for (uint32_t i = 0; i < speedBands.numberOfBands; i++) {
+    auto const &band = speedBands.bands[i];
+
+    // The edges themselves are allowed, the band is where the sweep lost steps
+    if (speedInStepsPerSecond <= band.low_InStepsPerSecond or speedInStepsPerSecond >= band.high_InStepsPerSecond) {
+      continue;
+    }
+
+    if (band.low_InStepsPerSecond >= minimalSpeedInStepsPerSecond) {
+      return band.low_InStepsPerSecond;
+    }
+
+    if (band.high_InStepsPerSecond <= maximalSpeedInStepsPerSecond) {
+      return band.high_InStepsPerSecond;
+    }
+
+    return speedInStepsPerSecond;
+  }
+
+  return speedInStepsPerSecond;
+}
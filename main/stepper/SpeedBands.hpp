@@ -0,0 +1,51 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+constexpr uint32_t const speedBandsMaximum = 4;
+
+struct SpeedBand {
+  float low_InStepsPerSecond;
+  float high_InStepsPerSecond;
+};
+
+/**
+ * Speeds the motor may pass through under acceleration but must never cruise at,
+ * the mid-band resonances where the torque drops and steps get lost.
+ * Kept sorted and without overlaps.
+ */
+struct SpeedBands {
+  std::array<SpeedBand, speedBandsMaximum> bands = {};
+  uint32_t numberOfBands = 0;
+};
+
+/**
+ * Insert a band, merging it with bands it overlaps or touches.
+ * When all slots are taken it widens the nearest band instead.
+ */
+void speedBandsAdd(SpeedBands &speedBands, SpeedBand band);
+
+/**
+ * Cruise speed outside every band, the lower edge of a band is preferred so the request is never exceeded.
+ * When that edge falls below the minimal speed the upper edge is taken if it stays within the maximal speed.
+ */
+float speedBandsAvoid(SpeedBands const &speedBands, float speedInStepsPerSecond, float minimalSpeedInStepsPerSecond, float maximalSpeedInStepsPerSecond);
@@ -0,0 +1,72 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <cstdint>
+
+#include "stepper/MotionLimits.hpp"
+
+/**
+ * Motor state seen by a routine on each update
+ */
+struct MotionSample {
+  int32_t position_InSteps;
+  int32_t distanceToTarget_InSteps;
+  bool inHome;
+  // Zero when no throttle position sensor is connected, the home switch is used alone then
+  uint32_t throttlePosition_InMillivolts;
+};
+
+/**
+ * Move the owner has to apply to the motor
+ */
+struct MotionCommand {
+  uint32_t position_InPercentage;
+  MotionLimits limits;
+  bool isHomingRequested;
+};
+
+/**
+ * Guided test moves that learn something about the throttle body.
+ * Knows nothing about the motor, the owner applies the commands and feeds back samples.
+ */
+class IMotionRoutine {
+public:
+  virtual ~IMotionRoutine() = default;
+
+public:
+  [[nodiscard]] virtual bool isRunning() const = 0;
+
+  /**
+   * Result is valid, checked once the routine stopped running
+   */
+  [[nodiscard]] virtual bool isSucceeded() const = 0;
+
+public:
+  [[nodiscard]] virtual MotionCommand const &getCommand() const = 0;
+
+public:
+  virtual void start(uint64_t timeInUS) = 0;
+  virtual void stop() = 0;
+
+  /**
+   * @return True when the command changed
+   */
+  virtual bool update(uint64_t timeInUS, MotionSample const &sample) = 0;
+};
@@ -0,0 +1,67 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#ifndef ESP_PLATFORM
+
+#include "PosixTransport.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+
+PosixTransport::PosixTransport(char const *path) : m_fileDescriptor(open(path, O_RDWR | O_NOCTTY | O_NONBLOCK)) {
+  if (m_fileDescriptor < 0) {
+    return;
+  }
+
+  termios attributes = {};
+  if (tcgetattr(m_fileDescriptor, &attributes) == 0) {
+    cfmakeraw(&attributes);
+    tcsetattr(m_fileDescriptor, TCSANOW, &attributes);
+  }
+}
+
+PosixTransport::~PosixTransport() {
+  if (m_fileDescriptor >= 0) {
+    close(m_fileDescriptor);
+  }
+}
+
+bool PosixTransport::isOpen() const {
+  return m_fileDescriptor >= 0;
+}
+
+std::size_t PosixTransport::write(uint8_t const *data, std::size_t const size) {
+  auto const numberOfBytes = ::write(m_fileDescriptor, data, size);
+  if (numberOfBytes < 0) {
+    return 0;
+  }
+
+  return static_cast<std::size_t>(numberOfBytes);
+}
+
+std::size_t PosixTransport::read(uint8_t *data, std::size_t const size) {
+  auto const numberOfBytes = ::read(m_fileDescriptor, data, size);
+  if (numberOfBytes < 0) {
+    return 0;
+  }
+
+  return static_cast<std::size_t>(numberOfBytes);
+}
+
+#endif
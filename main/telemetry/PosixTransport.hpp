@@ -0,0 +1,44 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#ifndef ESP_PLATFORM
+
+#include "telemetry/interface/ITransport.hpp"
+
+/**
+ * Host transport over a tty or pseudo-terminal, opened raw and non blocking
+ */
+class PosixTransport : public ITransport {
+public:
+  explicit PosixTransport(char const *path);
+  ~PosixTransport() override;
+
+public:
+  [[nodiscard]] bool isOpen() const;
+
+public:
+  std::size_t write(uint8_t const *data, std::size_t size) override;
+  std::size_t read(uint8_t *data, std::size_t size) override;
+
+private:
+  int m_fileDescriptor;
+};
+
+#endif
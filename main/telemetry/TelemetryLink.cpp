@@ -0,0 +1,223 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include "TelemetryLink.hpp"
+
+constexpr std::size_t const crcSize = 2;
+constexpr std::size_t const receiveChunkSize = 256;
+
+namespace {
+
+constexpr std::array<uint16_t, 256> createCrcTable() {
+  std::array<uint16_t, 256> table = {};
+
+  for (uint32_t index = 0; index < table.size(); ++index) {
+    auto crc = static_cast<uint16_t>(index << 8);
+
+    for (uint32_t bit = 0; bit < 8; ++bit) {
+      crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+    }
+
+    table[index] = crc;
+  }
+
+  return table;
+}
+
+constexpr auto const crcTable = createCrcTable();
+
+uint16_t updateCrc(uint16_t const crc, uint8_t const value) {
+  return static_cast<uint16_t>((crc << 8) ^ crcTable[((crc >> 8) ^ value) & 0xFF]);
+}
+
+constexpr std::size_t getMaximalEncodedSize(std::size_t const size) {
+  // COBS adds one byte per 254 and the first code byte, plus the delimiter
+  return size + size / 254 + 2;
+}
+
+}// namespace
+
+TelemetryLink::TelemetryLink(ITransportPtr transport) : m_transport(std::move(transport)),
+                                                        m_commandFunctions(),
+                                                        m_batch(),
+                                                        m_batchSize(0),
+                                                        m_codePosition(0),
+                                                        m_code(1),
+                                                        m_numberOfDropped(0),
+                                                        m_frame(),
+                                                        m_frameSize(0),
+                                                        m_isFrameOverflow(false) {
+}
+
+void TelemetryLink::registerCommand(uint8_t const command, TelemetryCommandFunction const &commandFunction) {
+  if (command >= telemetryMaximalCommands) {
+    return;
+  }
+
+  m_commandFunctions[command] = commandFunction;
+}
+
+bool TelemetryLink::send(TelemetryChannel const channel, uint8_t const *payload, std::size_t const size) {
+  if (m_batchSize + getMaximalEncodedSize(1 + size + crcSize) > m_batch.size()) {
+    m_numberOfDropped += 1;
+    return false;
+  }
+
+  m_codePosition = m_batchSize++;
+  m_code = 1;
+
+  uint16_t crc = 0xFFFF;
+
+  crc = updateCrc(crc, channel);
+  encodeByte(channel);
+
+  for (std::size_t index = 0; index < size; ++index) {
+    crc = updateCrc(crc, payload[index]);
+    encodeByte(payload[index]);
+  }
+
+  encodeByte(static_cast<uint8_t>(crc));
+  encodeByte(static_cast<uint8_t>(crc >> 8));
+
+  m_batch[m_codePosition] = m_code;
+  m_batch[m_batchSize++] = 0;
+
+  return true;
+}
+
+uint32_t TelemetryLink::getNumberOfDropped() const {
+  return m_numberOfDropped;
+}
+
+void TelemetryLink::flush() {
+  if (m_batchSize == 0) {
+    return;
+  }
+
+  // A short write cuts a frame, the host drops it on the CRC and resynchronises on the next delimiter
+  auto const numberOfBytes = m_transport->write(m_batch.data(), m_batchSize);
+  if (numberOfBytes < m_batchSize) {
+    m_numberOfDropped += 1;
+  }
+
+  m_batchSize = 0;
+}
+
+void TelemetryLink::process() {
+  receive();
+  flush();
+}
+
+void TelemetryLink::encodeByte(uint8_t const value) {
+  if (value == 0) {
+    m_batch[m_codePosition] = m_code;
+    m_codePosition = m_batchSize++;
+    m_code = 1;
+    return;
+  }
+
+  m_batch[m_batchSize++] = value;
+  m_code += 1;
+
+  if (m_code == 0xFF) {
+    m_batch[m_codePosition] = m_code;
+    m_codePosition = m_batchSize++;
+    m_code = 1;
+  }
+}
+
+void TelemetryLink::receive() {
+  uint8_t chunk[receiveChunkSize] = {0};
+
+  auto numberOfBytes = m_transport->read(chunk, sizeof(chunk));
+
+  while (numberOfBytes > 0) {
+    for (std::size_t index = 0; index < numberOfBytes; ++index) {
+      auto const value = chunk[index];
+
+      if (value != 0) {
+        if (m_frameSize < m_frame.size()) {
+          m_frame[m_frameSize++] = value;
+        } else {
+          m_isFrameOverflow = true;
+        }
+        continue;
+      }
+
+      if (not m_isFrameOverflow) {
+        dispatch(m_frame.data(), m_frameSize);
+      }
+
+      m_frameSize = 0;
+      m_isFrameOverflow = false;
+    }
+
+    numberOfBytes = m_transport->read(chunk, sizeof(chunk));
+  }
+}
+
+void TelemetryLink::dispatch(uint8_t *frame, std::size_t const size) {
+  // COBS decode in place, the output never runs ahead of the input
+  std::size_t readPosition = 0;
+  std::size_t writePosition = 0;
+
+  while (readPosition < size) {
+    auto const code = frame[readPosition++];
+    if (code == 0 or readPosition + code - 1 > size) {
+      return;
+    }
+
+    for (uint8_t index = 1; index < code; ++index) {
+      frame[writePosition++] = frame[readPosition++];
+    }
+
+    if (code != 0xFF and readPosition < size) {
+      frame[writePosition++] = 0;
+    }
+  }
+
+  if (writePosition < 1 + crcSize) {
+    return;
+  }
+
+  auto const dataSize = writePosition - crcSize;
+
+  uint16_t crc = 0xFFFF;
+  for (std::size_t index = 0; index < dataSize; ++index) {
+    crc = updateCrc(crc, frame[index]);
+  }
+
+  auto const receivedCrc = static_cast<uint16_t>(frame[dataSize] | (frame[dataSize + 1] << 8));
+  if (crc != receivedCrc) {
+    return;
+  }
+
+  if (frame[0] != TELEMETRY_CHANNEL_COMMAND or dataSize < 2) {
+    return;
+  }
+
+  auto const command = frame[1];
+
+  auto status = TELEMETRY_COMMAND_STATUS_UNKNOWN;
+  if (command < telemetryMaximalCommands and m_commandFunctions[command]) {
+    status = m_commandFunctions[command](frame + 2, dataSize - 2);
+  }
+
+  uint8_t const response[] = {command, status};
+  send(TELEMETRY_CHANNEL_RESPONSE, response, sizeof(response));
+}
@@ -0,0 +1,102 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <array>
+#include <functional>
+
+#include "executor/Node.hpp"
+#include "telemetry/interface/ITransport.hpp"
+
+enum TelemetryChannel : uint8_t {
+  TELEMETRY_CHANNEL_RIDE_LOG = 0,
+  TELEMETRY_CHANNEL_COMMAND = 1,
+  TELEMETRY_CHANNEL_RESPONSE = 2,
+  TELEMETRY_CHANNEL_LATENCY = 3,
+};
+
+enum TelemetryCommandStatus : uint8_t {
+  TELEMETRY_COMMAND_STATUS_OK = 0,
+  TELEMETRY_COMMAND_STATUS_UNKNOWN = 1,
+  TELEMETRY_COMMAND_STATUS_INVALID = 2,
+};
+
+constexpr std::size_t const telemetryBatchSize = 8192;
+constexpr std::size_t const telemetryMaximalFrameSize = 1024;
+constexpr std::size_t const telemetryMaximalCommands = 32;
+
+using TelemetryCommandFunction = std::function<TelemetryCommandStatus(uint8_t const *, std::size_t)>;
+
+/**
+ * Transport agnostic framing and command dispatch.
+ *
+ * Frame before encoding: [u8 channel][payload][u16 CRC-16/CCITT of channel and payload]
+ * Frames are COBS encoded and end with a zero byte, a receiver resynchronises on the next zero.
+ *
+ * Command payload:  [u8 command][arguments]
+ * Response payload: [u8 command][u8 TelemetryCommandStatus]
+ *
+ * Payloads are COBS encoded straight into one batch buffer and the whole batch goes to the transport once per tick.
+ * Not thread safe, send from the executor the link runs in.
+ */
+class TelemetryLink : public executor::Node {
+public:
+  explicit TelemetryLink(ITransportPtr transport);
+  ~TelemetryLink() override = default;
+
+public:
+  void registerCommand(uint8_t command, TelemetryCommandFunction const &commandFunction);
+
+public:
+  /**
+   * @return False when the batch is full and the frame was dropped
+   */
+  bool send(TelemetryChannel channel, uint8_t const *payload, std::size_t size);
+
+  [[nodiscard]] uint32_t getNumberOfDropped() const;
+
+public:
+  void flush();
+
+private:
+  void process() override;
+
+private:
+  void encodeByte(uint8_t value);
+  void receive();
+  void dispatch(uint8_t *frame, std::size_t size);
+
+private:
+  ITransportPtr m_transport;
+
+private:
+  std::array<TelemetryCommandFunction, telemetryMaximalCommands> m_commandFunctions;
+
+private:
+  alignas(4) std::array<uint8_t, telemetryBatchSize> m_batch;
+  std::size_t m_batchSize;
+  std::size_t m_codePosition;
+  uint8_t m_code;
+  uint32_t m_numberOfDropped;
+
+private:
+  std::array<uint8_t, telemetryMaximalFrameSize> m_frame;
+  std::size_t m_frameSize;
+  bool m_isFrameOverflow;
+};
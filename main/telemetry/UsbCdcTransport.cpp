@@ -0,0 +1,52 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include "UsbCdcTransport.hpp"
+
+#include <esp_err.h>
+#include <driver/usb_serial_jtag.h>
+
+UsbCdcTransport::UsbCdcTransport(uint32_t const bufferSize) {
+  usb_serial_jtag_driver_config_t configuration = {
+      .tx_buffer_size = bufferSize,
+      .rx_buffer_size = 1024,
+  };
+  ESP_ERROR_CHECK(usb_serial_jtag_driver_install(&configuration));
+}
+
+UsbCdcTransport::~UsbCdcTransport() {
+  ESP_ERROR_CHECK(usb_serial_jtag_driver_uninstall());
+}
+
+std::size_t UsbCdcTransport::write(uint8_t const *data, std::size_t const size) {
+  auto const numberOfBytes = usb_serial_jtag_write_bytes(data, size, 0);
+  if (numberOfBytes < 0) {
+    return 0;
+  }
+
+  return static_cast<std::size_t>(numberOfBytes);
+}
+
+std::size_t UsbCdcTransport::read(uint8_t *data, std::size_t const size) {
+  auto const numberOfBytes = usb_serial_jtag_read_bytes(data, size, 0);
+  if (numberOfBytes < 0) {
+    return 0;
+  }
+
+  return static_cast<std::size_t>(numberOfBytes);
+}
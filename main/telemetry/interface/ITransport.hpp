@@ -0,0 +1,45 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Byte stream to a host computer, USB-CDC on the device and a tty or pseudo-terminal on Linux.
+ * Neither call blocks.
+ */
+class ITransport {
+public:
+  virtual ~ITransport() = default;
+
+public:
+  /**
+   * @return Number of bytes taken, the rest is dropped by the caller
+   */
+  virtual std::size_t write(uint8_t const *data, std::size_t size) = 0;
+
+  /**
+   * @return Number of bytes available and copied, zero when there is nothing to read
+   */
+  virtual std::size_t read(uint8_t *data, std::size_t size) = 0;
+};
+
+using ITransportPtr = std::unique_ptr<ITransport>;
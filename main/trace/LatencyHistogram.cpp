@@ -0,0 +1,111 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include "LatencyHistogram.hpp"
+
+#include <algorithm>
+
+namespace {
+
+uint32_t findPercentile(std::array<uint32_t, latencyNumberOfBuckets> const &counts, uint32_t const numberOfSamples, uint32_t const perMille) {
+  // Rank of the sample at the percentile, rounded up so p99 of 100 samples is the 99th one
+  auto const rank = static_cast<uint32_t>((static_cast<uint64_t>(numberOfSamples) * perMille + 999) / 1000);
+
+  uint32_t numberOfSeen = 0;
+  for (uint32_t i = 0; i < latencyNumberOfBuckets; i++) {
+    numberOfSeen += counts[i];
+
+    if (numberOfSeen >= rank) {
+      return (i + 1) * latencyBucketWidth_InUS;
+    }
+  }
+
+  return latencyNumberOfBuckets * latencyBucketWidth_InUS;
+}
+
+LatencySummary summarize(std::array<uint32_t, latencyNumberOfBuckets> const &counts, uint32_t maximum_InUS) {
+  uint32_t numberOfSamples = 0;
+  uint32_t highestBucket = 0;
+
+  for (uint32_t i = 0; i < latencyNumberOfBuckets; i++) {
+    numberOfSamples += counts[i];
+
+    if (counts[i] > 0) {
+      highestBucket = i;
+    }
+  }
+
+  if (numberOfSamples == 0) {
+    return {0, 0, 0, 0};
+  }
+
+  // A sample racing a window change can leave its maximum in the other window, its bucket still bounds it
+  maximum_InUS = std::max(maximum_InUS, highestBucket * latencyBucketWidth_InUS);
+
+  return {
+      .numberOfSamples = numberOfSamples,
+      .p50_InUS = std::min(findPercentile(counts, numberOfSamples, 500), maximum_InUS),
+      .p99_InUS = std::min(findPercentile(counts, numberOfSamples, 990), maximum_InUS),
+      .maximum_InUS = maximum_InUS,
+  };
+}
+
+}// namespace
+
+LatencyHistogram::LatencyHistogram() : m_buckets(),
+                                       m_maximum_InUS(0) {
+  reset();
+}
+
+LatencySummary LatencyHistogram::getSummary() const {
+  std::array<uint32_t, latencyNumberOfBuckets> counts = {};
+
+  for (uint32_t i = 0; i < latencyNumberOfBuckets; i++) {
+    counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+  }
+
+  return summarize(counts, m_maximum_InUS.load(std::memory_order_relaxed));
+}
+
+LatencySummary LatencyHistogram::takeSummary() {
+  std::array<uint32_t, latencyNumberOfBuckets> counts = {};
+
+  for (uint32_t i = 0; i < latencyNumberOfBuckets; i++) {
+    counts[i] = m_buckets[i].exchange(0, std::memory_order_relaxed);
+  }
+
+  return summarize(counts, m_maximum_InUS.exchange(0, std::memory_order_relaxed));
+}
+
+void LatencyHistogram::record(uint32_t const latencyInUS) {
+  auto const index = std::min(latencyInUS / latencyBucketWidth_InUS, latencyNumberOfBuckets - 1);
+  m_buckets[index].fetch_add(1, std::memory_order_relaxed);
+
+  // Single writer, a plain compare is enough
+  if (latencyInUS > m_maximum_InUS.load(std::memory_order_relaxed)) {
+    m_maximum_InUS.store(latencyInUS, std::memory_order_relaxed);
+  }
+}
+
+void LatencyHistogram::reset() {
+  for (auto &bucket : m_buckets) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+
+  m_maximum_InUS.store(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,63 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+
+constexpr uint32_t const latencyBucketWidth_InUS = 20;
+constexpr uint32_t const latencyNumberOfBuckets = 512;
+
+struct LatencySummary {
+  uint32_t numberOfSamples;
+  uint32_t p50_InUS;
+  uint32_t p99_InUS;
+  uint32_t maximum_InUS;
+};
+
+/**
+ * Fixed width latency histogram, filled from one core and read from any other without locks.
+ * Percentiles are reported as the upper edge of their bucket, latencies beyond the last bucket land in it.
+ */
+class LatencyHistogram {
+public:
+  LatencyHistogram();
+  ~LatencyHistogram() = default;
+
+public:
+  [[nodiscard]] LatencySummary getSummary() const;
+
+  /**
+   * Summary of what was recorded since the last call, the histogram starts over with it.
+   * A sample recorded meanwhile counts in exactly one of the two windows.
+   */
+  LatencySummary takeSummary();
+
+public:
+  void record(uint32_t latencyInUS);
+  void reset();
+
+private:
+  std::array<std::atomic<uint32_t>, latencyNumberOfBuckets> m_buckets;
+  std::atomic<uint32_t> m_maximum_InUS;
+};
+
+using LatencyHistogramPtr = std::shared_ptr<LatencyHistogram>;
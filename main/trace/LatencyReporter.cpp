@@ -0,0 +1,46 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#include "LatencyReporter.hpp"
+
+#include "log/DeferredLog.hpp"
+
+LatencyReporter::LatencyReporter(LatencyHistogramPtr histogram) : m_reportCallbackFunction(nullptr),
+                                                                  m_histogram(std::move(histogram)) {
+}
+
+void LatencyReporter::registerReportCallback(LatencyReportCallbackFunction const &reportCallbackFunction) {
+  m_reportCallbackFunction = reportCallbackFunction;
+}
+
+void LatencyReporter::process() {
+  // Every report covers its own window, an old spike must not keep showing up as the maximum
+  auto const summary = m_histogram->takeSummary();
+
+  // Nothing moved since the last report, the pedal is at rest
+  if (summary.numberOfSamples == 0) {
+    return;
+  }
+
+  deferredLog(LOG_LATENCY_REPORTER_PERCENTILES, static_cast<int32_t>(summary.p50_InUS), static_cast<int32_t>(summary.p99_InUS));
+  deferredLog(LOG_LATENCY_REPORTER_MAXIMUM, static_cast<int32_t>(summary.maximum_InUS), static_cast<int32_t>(summary.numberOfSamples));
+
+  if (m_reportCallbackFunction) {
+    m_reportCallbackFunction(summary);
+  }
+}
@@ -0,0 +1,47 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <functional>
+
+#include "executor/Node.hpp"
+#include "trace/LatencyHistogram.hpp"
+
+using LatencyReportCallbackFunction = std::function<void(LatencySummary const &)>;
+
+/**
+ * Publishes the pedal to step latency distribution of every report window, add it to an executor at the report rate
+ */
+class LatencyReporter : public executor::Node {
+public:
+  explicit LatencyReporter(LatencyHistogramPtr histogram);
+  ~LatencyReporter() override = default;
+
+public:
+  void registerReportCallback(LatencyReportCallbackFunction const &reportCallbackFunction);
+
+private:
+  void process() override;
+
+private:
+  LatencyReportCallbackFunction m_reportCallbackFunction;
+
+private:
+  LatencyHistogramPtr m_histogram;
+};
@@ -0,0 +1,31 @@
+// Copyright 2024 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Created by jadjer on 19.10.26.
+//
+
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Follows one ADC frame through the control path to the motor.
+ * Sequence zero marks a value that was not caused by a traced frame.
+ * Kept trivial so it can travel through a Mailbox, value-initialize it with {} where it is not caused by a frame.
+ */
+struct TraceTag {
+  uint32_t sequence;
+  uint64_t time_InUS;
+};